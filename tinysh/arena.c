@@ -0,0 +1,154 @@
+/***********************************************************************************************************
+ * Filename: arena.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements a bump allocator. Everything a command needs while it is parsed and run (the
+ * argument arrays in particular) comes from one arena that is reset after the command, so parsing does no
+ * per-token malloc and nothing has to be freed piece by piece.
+ **********************************************************************************************************/
+
+#include "arena.h"
+
+#include <stdlib.h>
+
+/**
+* Function: initializeArena
+* -------------------------------------------
+* Prepares an empty arena; no memory is taken until the first allocation
+*
+* arena - the arena to initialize
+*/
+void initializeArena(struct arena *arena)
+{
+	arena->first = NULL;
+	arena->current = NULL;
+}
+
+/**
+* Function: addBlock
+* -------------------------------------------
+* Makes a block with room for at least size bytes the arena's current block, reusing a block kept from
+* before the last reset when it is big enough
+*
+* arena - the arena to grow
+* size - the number of bytes the block must hold
+*/
+static void addBlock(struct arena *arena, size_t size)
+{
+	struct arenaBlock *block = arena->current ? arena->current->next : arena->first;
+
+	// Skip kept blocks too small for this request; they are used again after the next reset
+	while (block != NULL && block->size < size)
+		block = block->next;
+
+	if (block == NULL)
+	{
+		size_t blockSize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+		block = malloc(sizeof(struct arenaBlock) + blockSize);
+		if (block == NULL)
+			abort();
+		block->size = blockSize;
+		// New blocks go right after the current one so the kept ones stay reachable
+		if (arena->current == NULL)
+		{
+			block->next = arena->first;
+			arena->first = block;
+		}
+		else
+		{
+			block->next = arena->current->next;
+			arena->current->next = block;
+		}
+	}
+	block->used = 0;
+	arena->current = block;
+}
+
+/**
+* Function: arenaAllocate
+* -------------------------------------------
+* Returns size bytes of memory from the arena, adding a block when the current one is full. The memory
+* stays valid until the arena is reset
+*
+* arena - the arena to allocate from
+* size - the number of bytes needed
+*/
+void * arenaAllocate(struct arena *arena, size_t size)
+{
+	void *memory;
+	size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+
+	if (arena->current == NULL || arena->current->size - arena->current->used < size)
+		addBlock(arena, size);
+
+	memory = arena->current->data + arena->current->used;
+	arena->current->used += size;
+	return memory;
+}
+
+/**
+* Function: resetArena
+* -------------------------------------------
+* Releases everything allocated from the arena in one step, keeping its blocks for the next command
+*
+* arena - the arena to reset
+*/
+void resetArena(struct arena *arena)
+{
+	arena->current = arena->first;
+	if (arena->current != NULL)
+		arena->current->used = 0;
+}
+
+/**
+* Function: markArena
+* -------------------------------------------
+* Returns the arena's current position for rewindArena
+*
+* arena - the arena to mark
+*/
+struct arenaMark markArena(struct arena *arena)
+{
+	struct arenaMark mark;
+
+	mark.block = arena->current;
+	mark.used = arena->current ? arena->current->used : 0;
+	return mark;
+}
+
+/**
+* Function: rewindArena
+* -------------------------------------------
+* Releases everything allocated from the arena since a mark, keeping what was allocated before it
+*
+* arena - the arena to rewind
+* mark - a position returned by markArena since the arena was last reset
+*/
+void rewindArena(struct arena *arena, struct arenaMark mark)
+{
+	// Blocks filled after the mark follow its block, so they are reused like after a reset
+	arena->current = mark.block;
+	if (arena->current != NULL)
+		arena->current->used = mark.used;
+}
+
+/**
+* Function: freeArena
+* -------------------------------------------
+* Returns every block of the arena to the system
+*
+* arena - the arena to free
+*/
+void freeArena(struct arena *arena)
+{
+	struct arenaBlock *block = arena->first;
+	struct arenaBlock *next;
+	while (block != NULL)
+	{
+		next = block->next;
+		free(block);
+		block = next;
+	}
+	initializeArena(arena);
+}
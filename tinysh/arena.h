@@ -0,0 +1,90 @@
+/***********************************************************************************************************
+ * Filename: arena.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the bump allocator holding per-command parse results
+ **********************************************************************************************************/
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE 16384
+#define ARENA_ALIGNMENT 16
+
+struct arenaBlock
+{
+	struct arenaBlock *next;
+	size_t size;
+	size_t used;
+	char data[];
+};
+
+struct arena
+{
+	struct arenaBlock *first;
+	struct arenaBlock *current;
+};
+
+// A position in an arena to rewind to, so memory taken after it can be released without a full reset
+struct arenaMark
+{
+	struct arenaBlock *block;
+	size_t used;
+};
+
+/**
+* Function: initializeArena
+* -------------------------------------------
+* Prepares an empty arena; no memory is taken until the first allocation
+*
+* arena - the arena to initialize
+*/
+void initializeArena(struct arena *arena);
+/**
+* Function: arenaAllocate
+* -------------------------------------------
+* Returns size bytes of memory from the arena, adding a block when the current one is full. The memory
+* stays valid until the arena is reset
+*
+* arena - the arena to allocate from
+* size - the number of bytes needed
+*/
+void * arenaAllocate(struct arena *arena, size_t size);
+/**
+* Function: resetArena
+* -------------------------------------------
+* Releases everything allocated from the arena in one step, keeping its blocks for the next command
+*
+* arena - the arena to reset
+*/
+void resetArena(struct arena *arena);
+/**
+* Function: markArena
+* -------------------------------------------
+* Returns the arena's current position for rewindArena
+*
+* arena - the arena to mark
+*/
+struct arenaMark markArena(struct arena *arena);
+/**
+* Function: rewindArena
+* -------------------------------------------
+* Releases everything allocated from the arena since a mark, keeping what was allocated before it
+*
+* arena - the arena to rewind
+* mark - a position returned by markArena since the arena was last reset
+*/
+void rewindArena(struct arena *arena, struct arenaMark mark);
+/**
+* Function: freeArena
+* -------------------------------------------
+* Returns every block of the arena to the system
+*
+* arena - the arena to free
+*/
+void freeArena(struct arena *arena);
+
+#endif /* ARENA_H_ */
@@ -0,0 +1,294 @@
+/***********************************************************************************************************
+ * Filename: benchmark.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Benchmark driver run by 'make bench'. It links the shell's modules and measures the hot
+ * paths directly: commands per second through processCommand (an in-process builtin and /bin/true),
+ * parseArgs throughput on a large generated line, prompt-to-prompt latency with 1, 100 and 1000 live
+ * background jobs, lines per second for a batch script run by ./smallsh, and command substitutions per
+ * second run in the shell and forked. Each result is printed as one "name<TAB>value<TAB>unit" line, always
+ * in the same order, so runs can be diffed between builds.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "cli.h"
+#include "shell.h"
+#include "jobs.h"
+#include "arena.h"
+#include "util.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define BUILTIN_ITERATIONS 200000
+#define EXTERNAL_ITERATIONS 2000
+#define PARSE_TOKENS 100000
+#define PARSE_ITERATIONS 50
+#define PROMPT_ITERATIONS 20000
+#define BATCH_LINES 50000
+#define BUILTIN_SUBSTITUTIONS 100000
+#define EXTERNAL_SUBSTITUTIONS 2000
+
+extern char **environ;
+
+// Results go to the original standard out; the shell's own messages go to /dev/null
+static int resultsFd;
+
+/**
+* Function: secondsNow
+* -------------------------------------------
+* Returns the current reading of the monotonic clock in seconds
+*/
+static double secondsNow()
+{
+	return monotonicNanoseconds() / 1e9;
+}
+
+/**
+* Function: report
+* -------------------------------------------
+* Prints one benchmark result
+*
+* name - the name of the measurement; never changes between builds
+* value - the measured value
+* unit - the unit of the value
+*/
+static void report(const char *name, double value, const char *unit)
+{
+	dprintf(resultsFd, "%s\t%.1f\t%s\n", name, value, unit);
+}
+
+/**
+* Function: commandsPerSecond
+* -------------------------------------------
+* Parses a command once and returns how many times per second processCommand runs it
+*
+* commandText - the command to run
+* iterations - how many times to run it
+*/
+static double commandsPerSecond(const char *commandText, int iterations)
+{
+	int i;
+	double start;
+	char *line = strdup(commandText);
+	struct parsedCommand parsed;
+	struct parsedCommand command;
+	struct shellStatus status = { 0, 0, 0, 0 };
+	struct arena arena;
+
+	initializeArena(&arena);
+	parseArgs(line, &parsed, &arena);
+	start = secondsNow();
+	for (i = 0; i < iterations; i++)
+	{
+		// processCommand may adjust the command (background flag), so each run gets a fresh copy
+		command = parsed;
+		processCommand(&command, &status);
+	}
+	start = secondsNow() - start;
+	freeArena(&arena);
+	free(line);
+	return iterations / start;
+}
+
+/**
+* Function: parseTokensPerSecond
+* -------------------------------------------
+* Returns how many tokens per second parseArgs splits out of a large generated line mixing plain words,
+* quotes, escapes and operators
+*/
+static double parseTokensPerSecond()
+{
+	static const char *words[] = { "word", "'single quoted'", "\"double \\\"quoted\\\"\"", "esc\\ aped", "|", "x" };
+	int i;
+	size_t length = 0;
+	size_t capacity = PARSE_TOKENS * 24;
+	long tokens = 0;
+	double elapsed = 0;
+	double start;
+	char *line = malloc(capacity);
+	char *copy = malloc(capacity);
+	struct parsedCommand command;
+	struct arena arena;
+
+	// Never start or end on a pipe so the line always parses
+	for (i = 0; i < PARSE_TOKENS; i++)
+	{
+		const char *word = i == 0 || i == PARSE_TOKENS - 1 ? "x" : words[i % 6];
+		length += sprintf(line + length, "%s ", word);
+	}
+
+	initializeArena(&arena);
+	for (i = 0; i < PARSE_ITERATIONS; i++)
+	{
+		// Parsing happens in place, so every run starts from a fresh copy (not timed)
+		memcpy(copy, line, length + 1);
+		start = secondsNow();
+		parseArgs(copy, &command, &arena);
+		elapsed += secondsNow() - start;
+		tokens += command.numberOfArgs;
+		resetArena(&arena);
+	}
+	freeArena(&arena);
+	free(line);
+	free(copy);
+	return tokens / elapsed;
+}
+
+/**
+* Function: promptLatency
+* -------------------------------------------
+* Starts background jobs, then returns the mean time in microseconds of one pass through the prompt loop
+* (parse, run a builtin, reset the arena, reap with monitorBackgroundPids) while they are alive. The jobs
+* are killed and reaped before returning
+*
+* liveJobs - how many background jobs stay alive during the measurement
+*/
+static double promptLatency(int liveJobs)
+{
+	int i;
+	double start;
+	char line[32];
+	pid_t *pids = malloc(sizeof(pid_t) * liveJobs);
+	struct parsedCommand command;
+	struct shellStatus status = { 0, 0, 0, 0 };
+	struct arena arena;
+
+	initializeArena(&arena);
+	for (i = 0; i < liveJobs; i++)
+	{
+		strcpy(line, "sleep 600 &");
+		parseArgs(line, &command, &arena);
+		pids[i] = processCommand(&command, &status);
+		resetArena(&arena);
+	}
+
+	start = secondsNow();
+	for (i = 0; i < PROMPT_ITERATIONS; i++)
+	{
+		strcpy(line, "true");
+		parseArgs(line, &command, &arena);
+		processCommand(&command, &status);
+		resetArena(&arena);
+		monitorBackgroundPids();
+	}
+	start = secondsNow() - start;
+
+	for (i = 0; i < liveJobs; i++)
+		if (pids[i] > 0)
+			kill(pids[i], SIGKILL);
+	while (numberOfJobs() > 0)
+	{
+		monitorBackgroundPids();
+		usleep(1000);
+	}
+	freeArena(&arena);
+	free(pids);
+	return start / PROMPT_ITERATIONS * 1e6;
+}
+
+/**
+* Function: batchLinesPerSecond
+* -------------------------------------------
+* Writes a script of builtins and redirections, runs it with ./smallsh and returns the lines per second
+* it got through (process start-up included)
+*/
+static double batchLinesPerSecond()
+{
+	static const char *lines[] = {
+		"true", "echo batch line > /dev/null", "[ 1 -eq 1 ]", "printf '%s\\n' a b > /dev/null", "status > /dev/null"
+	};
+	int i;
+	int childStatus;
+	double start;
+	char scriptPath[] = "/tmp/tinysh-bench-XXXXXX";
+	char *args[] = { "./smallsh", scriptPath, NULL };
+	FILE *script;
+	pid_t pid;
+	int scriptFd = mkstemp(scriptPath);
+
+	if (scriptFd < 0)
+		return 0;
+	script = fdopen(scriptFd, "w");
+	for (i = 0; i < BATCH_LINES; i++)
+		fprintf(script, "%s\n", lines[i % 5]);
+	fclose(script);
+
+	start = secondsNow();
+	if (posix_spawn(&pid, "./smallsh", NULL, NULL, args, environ) != 0)
+	{
+		unlink(scriptPath);
+		return 0;
+	}
+	waitpid(pid, &childStatus, 0);
+	start = secondsNow() - start;
+	unlink(scriptPath);
+	return BATCH_LINES / start;
+}
+
+/**
+* Function: substitutionsPerSecond
+* -------------------------------------------
+* Returns how many times per second parseArgs expands a line holding one command substitution, which runs
+* its command each time
+*
+* lineText - the line to parse
+* iterations - how many times to parse it
+*/
+static double substitutionsPerSecond(const char *lineText, int iterations)
+{
+	int i;
+	double start;
+	size_t length = strlen(lineText);
+	char *line = malloc(length + 1);
+	struct parsedCommand command;
+	struct arena arena;
+
+	initializeArena(&arena);
+	start = secondsNow();
+	for (i = 0; i < iterations; i++)
+	{
+		memcpy(line, lineText, length + 1);
+		parseArgs(line, &command, &arena);
+		resetArena(&arena);
+	}
+	start = secondsNow() - start;
+	freeArena(&arena);
+	free(line);
+	return iterations / start;
+}
+
+int main()
+{
+	int devNull = open("/dev/null", O_WRONLY);
+	struct sigaction ignoreAction = {0};
+
+	// Run like the shell does: SIGINT ignored so children get it reset, chatter sent to /dev/null
+	ignoreAction.sa_handler = SIG_IGN;
+	sigaction(SIGINT, &ignoreAction, NULL);
+	resultsFd = dup(STDOUT_FILENO);
+	dup2(devNull, STDOUT_FILENO);
+	close(devNull);
+
+	report("builtin_commands_per_second", commandsPerSecond("true", BUILTIN_ITERATIONS), "commands/s");
+	report("external_commands_per_second", commandsPerSecond("/bin/true", EXTERNAL_ITERATIONS), "commands/s");
+	report("parse_tokens_per_second", parseTokensPerSecond(), "tokens/s");
+	report("prompt_latency_1_job", promptLatency(1), "us");
+	report("prompt_latency_100_jobs", promptLatency(100), "us");
+	report("prompt_latency_1000_jobs", promptLatency(1000), "us");
+	report("batch_lines_per_second", batchLinesPerSecond(), "lines/s");
+	report("builtin_substitutions_per_second",
+		substitutionsPerSecond("x=$(pwd)", BUILTIN_SUBSTITUTIONS), "substitutions/s");
+	report("external_substitutions_per_second",
+		substitutionsPerSecond("x=$(/bin/true)", EXTERNAL_SUBSTITUTIONS), "substitutions/s");
+	return 0;
+}
@@ -0,0 +1,702 @@
+/***********************************************************************************************************
+ * Filename: builtins.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the builtin lookup and the common utilities (echo, printf, true, false, pwd,
+ * test) that run inside the shell process instead of paying a fork + exec. Each utility formats its whole
+ * output in memory and hands it to the output descriptor with a single write.
+ **********************************************************************************************************/
+
+#include "builtins.h"
+#include "cli.h"
+#include "util.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define OUTPUT_BUFFER_STARTING_SIZE 256
+
+struct outputBuffer
+{
+	char *data;
+	size_t length;
+	size_t capacity;
+};
+
+/**
+* Function: appendOutput
+* -------------------------------------------
+* Appends bytes to an output buffer, doubling it as needed
+*
+* output - the buffer to append to
+* data - the bytes to append
+* length - the number of bytes
+*/
+static void appendOutput(struct outputBuffer *output, const char *data, size_t length)
+{
+	if (output->length + length > output->capacity)
+	{
+		size_t newCapacity = output->capacity ? output->capacity : OUTPUT_BUFFER_STARTING_SIZE;
+		while (newCapacity < output->length + length)
+			newCapacity *= 2;
+		output->data = realloc(output->data, newCapacity);
+		output->capacity = newCapacity;
+	}
+	memcpy(output->data + output->length, data, length);
+	output->length += length;
+}
+
+/**
+* Function: appendFormatted
+* -------------------------------------------
+* Appends printf-style formatted text to an output buffer
+*
+* output - the buffer to append to
+* format - the printf(3) format
+*/
+static void appendFormatted(struct outputBuffer *output, const char *format, ...)
+{
+	char small[128];
+	int length;
+	va_list arguments;
+
+	va_start(arguments, format);
+	length = vsnprintf(small, sizeof(small), format, arguments);
+	va_end(arguments);
+	if (length < 0)
+		return;
+	if ((size_t) length < sizeof(small))
+	{
+		appendOutput(output, small, length);
+		return;
+	}
+
+	char *large = malloc(length + 1);
+	va_start(arguments, format);
+	vsnprintf(large, length + 1, format, arguments);
+	va_end(arguments);
+	appendOutput(output, large, length);
+	free(large);
+}
+
+/**
+* Function: flushOutput
+* -------------------------------------------
+* Writes an output buffer to a file descriptor in one go and frees it; returns 0 on success and 1 if the
+* write failed
+*
+* output - the buffer to write
+* outputFd - where to write it
+*/
+static int flushOutput(struct outputBuffer *output, int outputFd)
+{
+	int result = 0;
+	if (output->length > 0 && writeAll(outputFd, output->data, output->length) < 0)
+		result = 1;
+	free(output->data);
+	output->data = NULL;
+	output->length = output->capacity = 0;
+	return result;
+}
+
+/**
+* Function: executeEchoCommand
+* -------------------------------------------
+* Defines logic for the 'echo' shell command, which writes its arguments separated by spaces; '-n' leaves
+* off the trailing newline
+*/
+int executeEchoCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int i = 1;
+	int newline = 1;
+	struct outputBuffer output = { NULL, 0, 0 };
+
+	if (inputArgs[1] != NULL && strcmp(inputArgs[1], "-n") == 0)
+	{
+		newline = 0;
+		i = 2;
+	}
+	for (; inputArgs[i] != NULL; i++)
+	{
+		appendOutput(&output, inputArgs[i], strlen(inputArgs[i]));
+		if (inputArgs[i + 1] != NULL)
+			appendOutput(&output, " ", 1);
+	}
+	if (newline)
+		appendOutput(&output, "\n", 1);
+	return flushOutput(&output, outputFd);
+}
+
+/**
+* Function: appendEscape
+* -------------------------------------------
+* Appends the character a backslash escape stands for and advances past it; returns 1 for '\c', which
+* ends all output, and 0 otherwise
+*
+* output - the buffer to append to
+* text - points at the character after the backslash; moved past the escape
+*/
+static int appendEscape(struct outputBuffer *output, const char **text)
+{
+	char c = **text;
+	int value = 0;
+	int digits = 0;
+
+	(*text)++;
+	switch (c)
+	{
+		case 'n': c = '\n'; break;
+		case 't': c = '\t'; break;
+		case 'r': c = '\r'; break;
+		case 'a': c = '\a'; break;
+		case 'b': c = '\b'; break;
+		case 'f': c = '\f'; break;
+		case 'v': c = '\v'; break;
+		case 'e': c = 27; break;
+		case '\\': break;
+		case 'c': return 1;
+		case '0':
+			// \0NNN is an octal byte
+			while (digits < 3 && **text >= '0' && **text <= '7')
+			{
+				value = value * 8 + (**text - '0');
+				(*text)++;
+				digits++;
+			}
+			c = (char) value;
+			break;
+		case 0:
+			// A lone trailing backslash stands for itself
+			(*text)--;
+			c = '\\';
+			break;
+		default:
+			appendOutput(output, "\\", 1);
+			break;
+	}
+	appendOutput(output, &c, 1);
+	return 0;
+}
+
+/**
+* Function: parseNumber
+* -------------------------------------------
+* Converts a printf argument to a number ('c makes the character code); reports invalid numbers and
+* records the failure in error
+*
+* arg - the argument text
+* error - set to 1 when the argument is not a valid number
+*/
+static long long parseNumber(const char *arg, int *error)
+{
+	char *end;
+	long long value;
+
+	if (arg[0] == '\'' || arg[0] == '"')
+		return (unsigned char) arg[1];
+
+	errno = 0;
+	value = strtoll(arg, &end, 0);
+	if (end == arg || *end != 0 || errno != 0)
+	{
+		// Large unsigned values are still fine for %u %o %x
+		if (errno == ERANGE && arg[0] != '-')
+			return (long long) strtoull(arg, NULL, 0);
+		fprintf(stderr, "printf: %s: invalid number\n", arg);
+		*error = 1;
+	}
+	return value;
+}
+
+/**
+* Function: formatOnce
+* -------------------------------------------
+* Runs through the printf format one time, consuming arguments as conversions need them; returns 1 if
+* output should stop ('\c' or an invalid directive) and 0 otherwise
+*
+* output - the buffer to append to
+* format - the printf format
+* args - the next unused argument; advanced past each one consumed
+* error - set to 1 if any argument or directive was invalid
+*/
+static int formatOnce(struct outputBuffer *output, const char *format, char ***args, int *error)
+{
+	char specification[64];
+	const char *text = format;
+	const char *start;
+	char *arg;
+	size_t length;
+
+	while (*text != 0)
+	{
+		if (*text == '\\')
+		{
+			text++;
+			if (appendEscape(output, &text))
+				return 1;
+			continue;
+		}
+		if (*text != '%')
+		{
+			start = text;
+			while (*text != 0 && *text != '%' && *text != '\\')
+				text++;
+			appendOutput(output, start, text - start);
+			continue;
+		}
+		if (text[1] == '%')
+		{
+			appendOutput(output, "%", 1);
+			text += 2;
+			continue;
+		}
+
+		// Collect flags, width and precision into a format of our own
+		start = text++;
+		while (*text != 0 && strchr("-+ #0", *text) != NULL)
+			text++;
+		while (*text >= '0' && *text <= '9')
+			text++;
+		if (*text == '.')
+		{
+			text++;
+			while (*text >= '0' && *text <= '9')
+				text++;
+		}
+		length = text - start;
+		if (*text == 0 || length + 4 > sizeof(specification))
+		{
+			fprintf(stderr, "printf: %s: invalid directive\n", start);
+			*error = 1;
+			return 1;
+		}
+		memcpy(specification, start, length);
+
+		// Missing arguments read as empty strings and zero
+		arg = **args != NULL ? *(*args)++ : "";
+		switch (*text)
+		{
+			case 's':
+				strcpy(specification + length, "s");
+				appendFormatted(output, specification, arg);
+				break;
+			case 'b':
+			{
+				// %b expands escapes in its argument
+				struct outputBuffer expanded = { NULL, 0, 0 };
+				const char *escaped = arg;
+				int stop = 0;
+				while (*escaped != 0 && !stop)
+				{
+					if (*escaped == '\\')
+					{
+						escaped++;
+						stop = appendEscape(&expanded, &escaped);
+					}
+					else
+						appendOutput(&expanded, escaped++, 1);
+				}
+				appendOutput(&expanded, "", 1);
+				strcpy(specification + length, "s");
+				appendFormatted(output, specification, expanded.data);
+				free(expanded.data);
+				if (stop)
+					return 1;
+				break;
+			}
+			case 'c':
+				strcpy(specification + length, "c");
+				appendFormatted(output, specification, arg[0]);
+				break;
+			case 'd':
+			case 'i':
+				strcpy(specification + length, "lld");
+				appendFormatted(output, specification, arg[0] ? parseNumber(arg, error) : 0LL);
+				break;
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X':
+				specification[length] = 'l';
+				specification[length + 1] = 'l';
+				specification[length + 2] = *text;
+				specification[length + 3] = 0;
+				appendFormatted(output, specification,
+					(unsigned long long) (arg[0] ? parseNumber(arg, error) : 0LL));
+				break;
+			default:
+				fprintf(stderr, "printf: %%%c: invalid directive\n", *text);
+				*error = 1;
+				return 1;
+		}
+		text++;
+	}
+	return 0;
+}
+
+/**
+* Function: executePrintfCommand
+* -------------------------------------------
+* Defines logic for the 'printf' shell command, which formats its arguments like printf(3) (%s %b %c %d %i
+* %u %o %x %X %%, flags, width and precision), reusing the format until every argument is consumed
+*/
+int executePrintfCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int error = 0;
+	char **args;
+	char **before;
+	struct outputBuffer output = { NULL, 0, 0 };
+
+	if (inputArgs[1] == NULL)
+	{
+		fprintf(stderr, "printf: usage: printf format [arguments]\n");
+		return 2;
+	}
+
+	args = inputArgs + 2;
+	do
+	{
+		before = args;
+		if (formatOnce(&output, inputArgs[1], &args, &error))
+			break;
+	}
+	// The format is used again only while it keeps consuming arguments
+	while (*args != NULL && args != before);
+
+	if (flushOutput(&output, outputFd))
+		return 1;
+	return error;
+}
+
+/**
+* Function: executeTrueCommand
+* -------------------------------------------
+* Defines logic for the 'true' shell command, which does nothing successfully
+*/
+int executeTrueCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	return 0;
+}
+
+/**
+* Function: executeFalseCommand
+* -------------------------------------------
+* Defines logic for the 'false' shell command, which does nothing unsuccessfully
+*/
+int executeFalseCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	return 1;
+}
+
+/**
+* Function: executePwdCommand
+* -------------------------------------------
+* Defines logic for the 'pwd' shell command, which prints the current working directory
+*/
+int executePwdCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	char workingDirectory[PATH_MAXIMUM];
+	size_t length;
+
+	if (getcwd(workingDirectory, sizeof(workingDirectory) - 1) == NULL)
+	{
+		perror("pwd");
+		return 1;
+	}
+	length = strlen(workingDirectory);
+	workingDirectory[length++] = '\n';
+	return writeAll(outputFd, workingDirectory, length) < 0 ? 1 : 0;
+}
+
+struct testParser
+{
+	char **args;
+	int position;
+	int numberOfArgs;
+	int error;
+};
+
+static int testOr(struct testParser *parser);
+
+/**
+* Function: testError
+* -------------------------------------------
+* Reports a problem with a test expression and marks the evaluation as failed; returns 0
+*
+* parser - the expression being evaluated
+* message - what went wrong
+* arg - the argument at fault
+*/
+static int testError(struct testParser *parser, const char *message, const char *arg)
+{
+	if (!parser->error)
+		fprintf(stderr, "test: %s: %s\n", arg, message);
+	parser->error = 1;
+	return 0;
+}
+
+/**
+* Function: testInteger
+* -------------------------------------------
+* Converts an operand of an integer comparison
+*
+* parser - the expression being evaluated
+* arg - the operand text
+*/
+static long long testInteger(struct testParser *parser, const char *arg)
+{
+	char *end;
+	long long value = strtoll(arg, &end, 10);
+	if (end == arg || *end != 0)
+		testError(parser, "integer expression expected", arg);
+	return value;
+}
+
+/**
+* Function: testUnary
+* -------------------------------------------
+* Evaluates a unary test (-e -f -d -r -w -x -s -L -h -p -S -b -c -t -z -n); returns -1 if op isn't one
+*
+* parser - the expression being evaluated
+* op - the operator
+* arg - the operand
+*/
+static int testUnary(struct testParser *parser, const char *op, const char *arg)
+{
+	struct stat fileInfo;
+
+	if (op[0] != '-' || op[1] == 0 || op[2] != 0)
+		return -1;
+	switch (op[1])
+	{
+		case 'z': return arg[0] == 0;
+		case 'n': return arg[0] != 0;
+		case 't': return isatty(atoi(arg));
+		case 'r': return access(arg, R_OK) == 0;
+		case 'w': return access(arg, W_OK) == 0;
+		case 'x': return access(arg, X_OK) == 0;
+		case 'L':
+		case 'h': return lstat(arg, &fileInfo) == 0 && S_ISLNK(fileInfo.st_mode);
+		case 'e':
+		case 'f':
+		case 'd':
+		case 's':
+		case 'p':
+		case 'S':
+		case 'b':
+		case 'c':
+			if (stat(arg, &fileInfo) != 0)
+				return 0;
+			switch (op[1])
+			{
+				case 'f': return S_ISREG(fileInfo.st_mode);
+				case 'd': return S_ISDIR(fileInfo.st_mode);
+				case 's': return fileInfo.st_size > 0;
+				case 'p': return S_ISFIFO(fileInfo.st_mode);
+				case 'S': return S_ISSOCK(fileInfo.st_mode);
+				case 'b': return S_ISBLK(fileInfo.st_mode);
+				case 'c': return S_ISCHR(fileInfo.st_mode);
+				default: return 1;
+			}
+	}
+	(void) parser;
+	return -1;
+}
+
+/**
+* Function: testBinary
+* -------------------------------------------
+* Evaluates a binary test (= == != < > -eq -ne -lt -le -gt -ge); returns -1 if op isn't one
+*
+* parser - the expression being evaluated
+* left - the left operand
+* op - the operator
+* right - the right operand
+*/
+static int testBinary(struct testParser *parser, const char *left, const char *op, const char *right)
+{
+	if (strcmp(op, "=") == 0 || strcmp(op, "==") == 0)
+		return strcmp(left, right) == 0;
+	if (strcmp(op, "!=") == 0)
+		return strcmp(left, right) != 0;
+	if (strcmp(op, "<") == 0)
+		return strcmp(left, right) < 0;
+	if (strcmp(op, ">") == 0)
+		return strcmp(left, right) > 0;
+	if (strcmp(op, "-eq") == 0)
+		return testInteger(parser, left) == testInteger(parser, right);
+	if (strcmp(op, "-ne") == 0)
+		return testInteger(parser, left) != testInteger(parser, right);
+	if (strcmp(op, "-lt") == 0)
+		return testInteger(parser, left) < testInteger(parser, right);
+	if (strcmp(op, "-le") == 0)
+		return testInteger(parser, left) <= testInteger(parser, right);
+	if (strcmp(op, "-gt") == 0)
+		return testInteger(parser, left) > testInteger(parser, right);
+	if (strcmp(op, "-ge") == 0)
+		return testInteger(parser, left) >= testInteger(parser, right);
+	return -1;
+}
+
+/**
+* Function: testPrimary
+* -------------------------------------------
+* Evaluates a parenthesized expression, a binary or unary test, or a lone string (true when non-empty)
+*
+* parser - the expression being evaluated
+*/
+static int testPrimary(struct testParser *parser)
+{
+	char **args = parser->args + parser->position;
+	int remaining = parser->numberOfArgs - parser->position;
+	int result;
+
+	if (remaining <= 0)
+		return testError(parser, "argument expected", parser->args[-1]);
+
+	// Binary tests bind tighter than parentheses so '( = (' still compares strings
+	if (remaining >= 3 && (result = testBinary(parser, args[0], args[1], args[2])) >= 0)
+	{
+		parser->position += 3;
+		return result;
+	}
+	if (strcmp(args[0], "(") == 0)
+	{
+		parser->position++;
+		result = testOr(parser);
+		if (parser->position >= parser->numberOfArgs || strcmp(parser->args[parser->position], ")") != 0)
+			return testError(parser, "missing `)'", args[0]);
+		parser->position++;
+		return result;
+	}
+	if (remaining >= 2 && (result = testUnary(parser, args[0], args[1])) >= 0)
+	{
+		parser->position += 2;
+		return result;
+	}
+	parser->position++;
+	return args[0][0] != 0;
+}
+
+/**
+* Function: testNot
+* -------------------------------------------
+* Evaluates an expression optionally negated with '!'
+*
+* parser - the expression being evaluated
+*/
+static int testNot(struct testParser *parser)
+{
+	if (parser->position < parser->numberOfArgs - 1 && strcmp(parser->args[parser->position], "!") == 0)
+	{
+		parser->position++;
+		return !testNot(parser);
+	}
+	return testPrimary(parser);
+}
+
+/**
+* Function: testAnd
+* -------------------------------------------
+* Evaluates expressions joined by '-a'
+*
+* parser - the expression being evaluated
+*/
+static int testAnd(struct testParser *parser)
+{
+	int result = testNot(parser);
+	while (parser->position < parser->numberOfArgs && strcmp(parser->args[parser->position], "-a") == 0)
+	{
+		parser->position++;
+		result = testNot(parser) && result;
+	}
+	return result;
+}
+
+/**
+* Function: testOr
+* -------------------------------------------
+* Evaluates expressions joined by '-o'
+*
+* parser - the expression being evaluated
+*/
+static int testOr(struct testParser *parser)
+{
+	int result = testAnd(parser);
+	while (parser->position < parser->numberOfArgs && strcmp(parser->args[parser->position], "-o") == 0)
+	{
+		parser->position++;
+		result = testAnd(parser) || result;
+	}
+	return result;
+}
+
+/**
+* Function: executeTestCommand
+* -------------------------------------------
+* Defines logic for the 'test' and '[' shell commands, which evaluate file checks, string and integer
+* comparisons combined with !, -a, -o and parentheses; returns 0 for true, 1 for false and 2 on error
+*/
+int executeTestCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int result;
+	struct testParser parser = { inputArgs + 1, 0, 0, 0 };
+
+	while (parser.args[parser.numberOfArgs] != NULL)
+		parser.numberOfArgs++;
+
+	// '[' must be closed by a final ']' that isn't part of the expression
+	if (strcmp(inputArgs[0], "[") == 0)
+	{
+		if (parser.numberOfArgs == 0 || strcmp(parser.args[parser.numberOfArgs - 1], "]") != 0)
+		{
+			fprintf(stderr, "[: missing `]'\n");
+			return 2;
+		}
+		parser.numberOfArgs--;
+	}
+	if (parser.numberOfArgs == 0)
+		return 1;
+
+	result = testOr(&parser);
+	if (!parser.error && parser.position < parser.numberOfArgs)
+		testError(&parser, "unexpected argument", parser.args[parser.position]);
+	if (parser.error)
+		return 2;
+	return result ? 0 : 1;
+}
+
+/**
+* Function: compareBuiltinName
+* -------------------------------------------
+* Orders a name against a registry entry for bsearch
+*
+* name - the command name being looked up
+* entry - a registry entry
+*/
+static int compareBuiltinName(const void *name, const void *entry)
+{
+	return strcmp((const char *) name, ((const struct builtinCommand *) entry)->name);
+}
+
+/**
+* Function: findBuiltin
+* -------------------------------------------
+* Returns the registry entry whose name exactly matches the command name (binary search over the sorted
+* table) or NULL if the command isn't a builtin
+*
+* table - the registry, sorted by name
+* numberOfBuiltins - the length of the table
+* commandName - the name to look up
+*/
+const struct builtinCommand * findBuiltin(
+	const struct builtinCommand *table, int numberOfBuiltins, const char *commandName)
+{
+	return bsearch(commandName, table, numberOfBuiltins, sizeof(struct builtinCommand), compareBuiltinName);
+}
@@ -0,0 +1,88 @@
+/***********************************************************************************************************
+ * Filename: builtins.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the builtin registry and the common utilities run in-process
+ **********************************************************************************************************/
+
+#ifndef BUILTINS_H_
+#define BUILTINS_H_
+
+struct shellStatus;
+
+/*
+ * A builtin receives its arguments (inputArgs[0] is its name), the descriptors to use as standard in and
+ * out (already redirected when the command used < or >) and the shell's status; it returns its exit value
+ */
+typedef int (*builtinHandler)(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+
+// The builtin's exit value becomes the shell's last status, like the external command it replaces
+#define BUILTIN_SETS_STATUS 1
+// Can run for a long time: started with '&' it runs in a child like a pipeline stage instead of in the shell
+#define BUILTIN_FORKS_IN_BACKGROUND 2
+// Reads standard in: when that is the terminal it runs in a child so ^C can interrupt it
+#define BUILTIN_FORKS_ON_TERMINAL 4
+// Only reads its input and writes its output, leaving the shell alone: $(COMMAND) runs it in the shell
+#define BUILTIN_OUTPUT_ONLY 8
+
+struct builtinCommand
+{
+	const char *name;
+	builtinHandler handler;
+	int flags;
+};
+
+/**
+* Function: executeEchoCommand
+* -------------------------------------------
+* Defines logic for the 'echo' shell command, which writes its arguments separated by spaces; '-n' leaves
+* off the trailing newline
+*/
+int executeEchoCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executePrintfCommand
+* -------------------------------------------
+* Defines logic for the 'printf' shell command, which formats its arguments like printf(3) (%s %b %c %d %i
+* %u %o %x %X %%, flags, width and precision), reusing the format until every argument is consumed
+*/
+int executePrintfCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executeTrueCommand
+* -------------------------------------------
+* Defines logic for the 'true' shell command, which does nothing successfully
+*/
+int executeTrueCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executeFalseCommand
+* -------------------------------------------
+* Defines logic for the 'false' shell command, which does nothing unsuccessfully
+*/
+int executeFalseCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executePwdCommand
+* -------------------------------------------
+* Defines logic for the 'pwd' shell command, which prints the current working directory
+*/
+int executePwdCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executeTestCommand
+* -------------------------------------------
+* Defines logic for the 'test' and '[' shell commands, which evaluate file checks, string and integer
+* comparisons combined with !, -a, -o and parentheses; returns 0 for true, 1 for false and 2 on error
+*/
+int executeTestCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: findBuiltin
+* -------------------------------------------
+* Returns the registry entry whose name exactly matches the command name (binary search over the sorted
+* table) or NULL if the command isn't a builtin
+*
+* table - the registry, sorted by name
+* numberOfBuiltins - the length of the table
+* commandName - the name to look up
+*/
+const struct builtinCommand * findBuiltin(
+	const struct builtinCommand *table, int numberOfBuiltins, const char *commandName);
+
+#endif /* BUILTINS_H_ */
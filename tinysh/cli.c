@@ -7,94 +7,1706 @@
  **********************************************************************************************************/
 
 #include "cli.h"
+#include "substitute.h"
+#include "variables.h"
+#include "wildcard.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define PENDING_NONE 0
+#define PENDING_INPUT_REDIRECT 1
+#define PENDING_OUTPUT_REDIRECT 2
+#define PENDING_HERE_DOCUMENT 3
+#define PENDING_HERE_STRING 4
+
+// What a template word stands for besides the PENDING_ roles of the word after an operator
+#define TEMPLATE_ALL_PARAMETERS 5	// "$@"
+#define TEMPLATE_PIPE 6				// the end of a pipeline stage
+
+// The parts a template word is built from
+#define PART_TEXT 0					// unquoted text, as typed
+#define PART_QUOTED_TEXT 1			// quoted or escaped text, without its quotes
+#define PART_PARAMETER 2			// the name of a $ reference
+#define PART_SUBSTITUTION 3			// a $(COMMAND) or `COMMAND` as typed
+
+// A word of a command template, or a pipe between two stages
+struct templateWord
+{
+	int role;					// PENDING_NONE for an argument, another PENDING_ role or a TEMPLATE_ role
+	int quoted;					// binary flag denoting a quote or escape, which keeps an empty word
+	int expanded;				// binary flag denoting an unquoted expansion, which drops an empty word
+	int pattern;				// binary flag denoting an unquoted *, ? or [...] to match file names with
+	int firstPart;
+	int numberOfParts;
+};
+
+struct templatePart
+{
+	int kind;					// PART_TEXT, PART_QUOTED_TEXT, PART_PARAMETER or PART_SUBSTITUTION
+	int quoted;					// PART_PARAMETER and PART_SUBSTITUTION: binary flag, between double quotes
+	size_t start;				// where the part's text starts in the template's text
+	size_t length;
+};
+
+// A command template while it is being compiled; the arrays grow as needed
+struct templateBuilder
+{
+	struct templateWord *words;
+	int numberOfWords;
+	int wordCapacity;
+	struct templatePart *parts;
+	int numberOfParts;
+	int partCapacity;
+	int firstPart;				// the first part of the word being compiled
+	char *text;
+	size_t textLength;
+	size_t textCapacity;
+	int runInBackground;
+	int expanded;
+};
+
+// The output of a command substitution in a here-document, kept from measuring the document to building it
+struct substitutionOutput
+{
+	char *text;
+	struct substitutionOutput *next;
+};
+
+/*
+ * Function:  isOperator
+ * --------------------------------
+ * Returns 1 if an unquoted character ends a word and has a meaning of its own; 0 otherwise
+ *
+ *	c: the character to check
+ */
+static int isOperator(char c)
+{
+	return c == '|' || c == '&' || c == '<' || c == '>';
+}
+
+/*
+ * Function:  appendArg
+ * --------------------------------
+ * Appends an argument (or a NULL stage terminator) to the command, doubling the arena-backed argument
+ * array when it is full
+ *
+ *  command: the command being built
+ *  arena: provides the argument array
+ *  maxNumberOfArgs: the number of entries the current array has room for
+ *	arg: the argument to append
+ */
+static void appendArg(struct parsedCommand *command, struct arena *arena, int *maxNumberOfArgs, char *arg)
+{
+	if (command->numberOfArgs == *maxNumberOfArgs)
+	{
+		char **newArgs;
+		*maxNumberOfArgs = *maxNumberOfArgs ? *maxNumberOfArgs * 2 : STARTING_NUMBER_OF_ARGS;
+		newArgs = arenaAllocate(arena, sizeof(char *) * *maxNumberOfArgs);
+		if (command->numberOfArgs > 0)
+			memcpy(newArgs, command->args, sizeof(char *) * command->numberOfArgs);
+		command->args = newArgs;
+	}
+	command->args[command->numberOfArgs++] = arg;
+}
+
+/*
+ * Function:  syntaxError
+ * --------------------------------
+ * Reports a syntax error and returns -1 for parseArgs to pass on
+ *
+ *	token: the text that could not be parsed
+ */
+static int syntaxError(const char *token)
+{
+	fprintf(stderr, "syntax error near unexpected token `%s'\n", token);
+	return -1;
+}
+
+/*
+ * Function:  parameterName
+ * --------------------------------
+ * Returns where the source continues after the $NAME, ${NAME}, $$, $?, $#, $@, $* or $N (${NN} past 9)
+ * reference at source and assigns its name, or returns NULL if the $ starts no reference
+ *
+ *	source: points at the $
+ *	name: assigned the start of the name, inside source
+ *	nameLength: assigned the length of the name
+ */
+static const char * parameterName(const char *source, const char **name, size_t *nameLength)
+{
+	const char *start = source + 1;
+	size_t length = 0;
+	int braced = *start == '{';
+
+	start += braced;
+	if (strchr("$?#@*", *start) != NULL && *start != 0)
+		length = 1;
+	else if (isdigit((unsigned char) *start))
+		while (isdigit((unsigned char) start[length]) && (braced || length == 0))
+			length++;
+	else if (isalpha((unsigned char) *start) || *start == '_')
+		while (isalnum((unsigned char) start[length]) || start[length] == '_')
+			length++;
+	else
+		return NULL;
+	// Anything but a name between braces is kept as typed
+	if (braced && start[length] != '}')
+		return NULL;
+
+	*name = start;
+	*nameLength = length;
+	return start + length + braced;
+}
+
+/*
+ * Function:  findParameter
+ * --------------------------------
+ * Returns where the source continues after the $ reference at source and assigns its value (empty when
+ * the variable is unset), or returns NULL if the $ starts no reference
+ *
+ *	source: points at the $
+ *	value: assigned the value of the reference
+ */
+static char * findParameter(char *source, const char **value)
+{
+	const char *name;
+	size_t nameLength;
+	const char *after = parameterName(source, &name, &nameLength);
+
+	if (after == NULL)
+		return NULL;
+	*value = lookupVariable(name, nameLength);
+	if (*value == NULL)
+		*value = "";
+	return (char *) after;
+}
+
+/*
+ * Function:  expandParameter
+ * --------------------------------
+ * Copies the value of the $ reference at source into the word being built and returns where the source
+ * continues; a $ that starts no reference is copied as is. The word is built in place while values fit in
+ * the text they replace and moves to the arena, with room for the rest of the line, once one doesn't
+ *
+ *	source: points at the $
+ *	word: the start of the word being built; reassigned when it moves to the arena
+ *	destination: where the next byte of the word goes; advanced past the value
+ *	wordEnd: NULL while the word is built in place, otherwise the end of its arena buffer
+ *	arena: provides the word's buffer once it outgrows its place
+ */
+static char * expandParameter(char *source, char **word, char **destination, char **wordEnd, struct arena *arena)
+{
+	char *after;
+	char *limit;
+	char *moved;
+	const char *value;
+	size_t valueLength;
+	size_t remaining;
+	size_t used;
+
+	after = findParameter(source, &value);
+	if (after == NULL)
+	{
+		*(*destination)++ = *source;
+		return source + 1;
+	}
+	valueLength = strlen(value);
+	remaining = strlen(after);
+	limit = *wordEnd ? *wordEnd - remaining - 1 : after;
+	if (*destination + valueLength > limit)
+	{
+		used = *destination - *word;
+		moved = arenaAllocate(arena, used + valueLength + remaining + 1);
+		memcpy(moved, *word, used);
+		*word = moved;
+		*destination = moved + used;
+		*wordEnd = moved + used + valueLength + remaining + 1;
+	}
+	memcpy(*destination, value, valueLength);
+	*destination += valueLength;
+	return after;
+}
+
+/*
+ * Function:  endsWord
+ * --------------------------------
+ * Returns 1 if an unquoted character ends a word and 0 otherwise
+ *
+ *	c: the character to check
+ */
+static int endsWord(char c)
+{
+	return c == 0 || c == ' ' || c == '\t' || isOperator(c);
+}
+
+/*
+ * Function:  startsCommandSubstitution
+ * --------------------------------
+ * Returns 1 if a $(COMMAND) or `COMMAND` starts at source and 0 otherwise
+ *
+ *	source: the character to check
+ */
+static int startsCommandSubstitution(const char *source)
+{
+	return *source == '`' || (*source == '$' && source[1] == '(');
+}
+
+/*
+ * Function:  allParametersLength
+ * --------------------------------
+ * Returns the length of a word that is exactly $@ or "$@" (braces allowed), which expands to one argument
+ * per positional parameter, or 0 for any other word
+ *
+ *	source: the start of the word, as typed
+ */
+static int allParametersLength(const char *source)
+{
+	static const char *forms[] = { "$@", "\"$@\"", "${@}", "\"${@}\"", NULL };
+	int length;
+	int i;
+
+	for (i = 0; forms[i] != NULL; i++)
+	{
+		length = strlen(forms[i]);
+		if (strncmp(source, forms[i], length) == 0 && endsWord(source[length]))
+			return length;
+	}
+	return 0;
+}
+
+/*
+ * Function:  hasWildcard
+ * --------------------------------
+ * Returns 1 if the word starting at source has an unquoted * or ?, or an unquoted [ closed later by an
+ * unquoted ]; 0 otherwise. A lone [, as in the test command, is an ordinary word, and so is a word with a
+ * command substitution, which only runs once
+ *
+ *	source: the start of the word, as typed
+ */
+static int hasWildcard(const char *source)
+{
+	char quote = 0;
+	int bracket = 0;
+	int wildcard = 0;
+
+	for (; quote != 0 || !endsWord(*source); source++)
+	{
+		if (quote != '\'' && startsCommandSubstitution(source))
+			return 0;
+		if (quote != 0)
+		{
+			if (*source == 0)
+				return 0;
+			if (*source == quote)
+				quote = 0;
+			else if (quote == '"' && *source == '\\' && source[1] != 0)
+				source++;
+		}
+		else if (*source == '\\' && source[1] != 0)
+			source++;
+		else if (*source == '\'' || *source == '"')
+			quote = *source;
+		else if (*source == '*' || *source == '?' || (*source == ']' && bracket))
+			wildcard = 1;
+		else if (*source == '[')
+			bracket = 1;
+	}
+	return wildcard;
+}
+
+/*
+ * Function:  appendPattern
+ * --------------------------------
+ * Appends a character to a wildcard pattern, escaping it when it has to match literally
+ *
+ *	pattern: the pattern being built; reallocated as it grows
+ *	length: the length of the pattern so far
+ *	capacity: the size of the pattern's buffer
+ *	c: the character to append
+ *	literal: 1 = the character was quoted, escaped or came from an expansion
+ */
+static void appendPattern(char **pattern, size_t *length, size_t *capacity, char c, int literal)
+{
+	if (*length + 3 > *capacity)
+	{
+		*capacity = *capacity ? *capacity * 2 : STARTING_NUMBER_OF_ARGS;
+		*pattern = realloc(*pattern, *capacity);
+	}
+	if (literal && strchr("*?[]\\", c) != NULL)
+		(*pattern)[(*length)++] = '\\';
+	(*pattern)[(*length)++] = c;
+	(*pattern)[*length] = 0;
+}
+
+/*
+ * Function:  buildPattern
+ * --------------------------------
+ * Returns the wildcard pattern of the word starting at source (newly allocated): quotes and escapes are
+ * removed and $ references expanded as for the word itself, but every character that didn't come from
+ * unquoted text is escaped so only the wildcards typed as such match more than themselves
+ *
+ *	source: the start of the word, as typed
+ */
+char * buildPattern(char *source)
+{
+	char *pattern = NULL;
+	size_t length = 0;
+	size_t capacity = 0;
+	char quote = 0;
+	char *after;
+	const char *value;
+
+	appendPattern(&pattern, &length, &capacity, 0, 0);
+	length = 0;
+	while (*source != 0 && (quote != 0 || !endsWord(*source)))
+	{
+		if (*source == '$' && quote != '\'' && (after = findParameter(source, &value)) != NULL)
+		{
+			for (; *value != 0; value++)
+				appendPattern(&pattern, &length, &capacity, *value, 1);
+			source = after;
+		}
+		else if (quote == 0 && (*source == '\'' || *source == '"'))
+			quote = *source++;
+		else if (quote != 0 && *source == quote)
+		{
+			quote = 0;
+			source++;
+		}
+		else if (*source == '\\' && source[1] != 0 &&
+			(quote == 0 || (quote == '"' && strchr("\"\\$`", source[1]) != NULL)))
+		{
+			appendPattern(&pattern, &length, &capacity, source[1], 1);
+			source += 2;
+		}
+		else
+			appendPattern(&pattern, &length, &capacity, *source++, quote != 0);
+	}
+	return pattern;
+}
+
+/*
+ * Function:  hereDocumentWord
+ * --------------------------------
+ * Returns where the WORD of the << at source ends and assigns it without its quotes and escapes (newly
+ * allocated), as parseArgs reads it; NULL if the word is missing
+ *
+ *	source: points after the <<
+ *	commandEnd: where the command ends
+ *	word: assigned the word
+ *	stripTabs: assigned 1 for <<-WORD
+ */
+static const char * hereDocumentWord(const char *source, const char *commandEnd, char **word, int *stripTabs)
+{
+	char *destination = *word = malloc(commandEnd - source + 1);
+	char quote;
+
+	*stripTabs = *source == '-';
+	source += *stripTabs;
+	while (source < commandEnd && (*source == ' ' || *source == '\t'))
+		source++;
+	while (source < commandEnd && !endsWord(*source))
+	{
+		if (*source == '\\' && source + 1 < commandEnd)
+			source++;
+		else if (*source == '\'' || *source == '"')
+		{
+			quote = *source++;
+			while (source < commandEnd && *source != quote)
+			{
+				if (quote == '"' && *source == '\\' && source + 1 < commandEnd && strchr("\"\\$`", source[1]))
+					source++;
+				*destination++ = *source++;
+			}
+			source++;
+			continue;
+		}
+		*destination++ = *source++;
+	}
+	*destination = 0;
+	if (destination == *word)
+	{
+		free(*word);
+		return NULL;
+	}
+	return source;
+}
+
+/*
+ * Function:  nextHereDocument
+ * --------------------------------
+ * Returns where the next unquoted << starting a here-document is in a command (past the <<), or NULL
+ *
+ *	source: where to start looking
+ *	commandEnd: where the command ends
+ */
+static const char * nextHereDocument(const char *source, const char *commandEnd)
+{
+	char quote;
+
+	while (source < commandEnd)
+	{
+		if (*source == '\\')
+			source += 2;
+		else if (*source == '\'' || *source == '"')
+		{
+			quote = *source++;
+			while (source < commandEnd && *source != quote)
+				source += quote == '"' && *source == '\\' ? 2 : 1;
+			source++;
+		}
+		else if (*source == '<' && source + 1 < commandEnd && source[1] == '<')
+		{
+			// <<< is a here-string, on the command's own line
+			if (source + 2 == commandEnd || source[2] != '<')
+				return source + 2;
+			source += 3;
+		}
+		else
+			source++;
+	}
+	return NULL;
+}
+
+/*
+ * Function:  opensHereDocument
+ * --------------------------------
+ * Returns 1 if a command has an unquoted <<WORD, whose body is on the lines after it, and 0 otherwise
+ *
+ *	command: the start of the command
+ *	commandEnd: where the command ends
+ */
+int opensHereDocument(const char *command, const char *commandEnd)
+{
+	return nextHereDocument(command, commandEnd) != NULL;
+}
+
+/*
+ * Function:  skipHereDocuments
+ * --------------------------------
+ * Returns where the bodies of the here-documents a command opens end, past the line holding the last
+ * one's WORD, or NULL if the text ends first; bodies itself when the command opens none
+ *
+ *	command: the start of the command
+ *	commandEnd: where the command ends
+ *	bodies: where the first body starts, the line after the command's
+ *	awaitedWord: when the text ends first, assigned the WORD of the unfinished body (newly allocated);
+ *	may be NULL
+ */
+const char * skipHereDocuments(const char *command, const char *commandEnd, const char *bodies,
+	char **awaitedWord)
+{
+	const char *line;
+	const char *lineEnd;
+	char *word;
+	size_t wordLength;
+	int stripTabs;
+
+	while ((command = nextHereDocument(command, commandEnd)) != NULL)
+	{
+		command = hereDocumentWord(command, commandEnd, &word, &stripTabs);
+		// parseArgs reports the missing word
+		if (command == NULL)
+			return bodies;
+		wordLength = strlen(word);
+		do
+		{
+			if (bodies == NULL || *bodies == 0)
+			{
+				if (awaitedWord != NULL)
+					*awaitedWord = word;
+				else
+					free(word);
+				return NULL;
+			}
+			for (line = bodies; stripTabs && *line == '\t'; line++)
+				;
+			lineEnd = strchr(line, '\n');
+			if (lineEnd == NULL)
+				lineEnd = line + strlen(line);
+			bodies = *lineEnd != 0 ? lineEnd + 1 : lineEnd;
+		}
+		while ((size_t) (lineEnd - line) != wordLength || strncmp(line, word, wordLength) != 0);
+		free(word);
+	}
+	return bodies;
+}
+
+/*
+ * Function:  commandSubstitutionEnd
+ * --------------------------------
+ * Returns where the $(COMMAND) or `COMMAND` at source ends, past its ) or closing `, or NULL if it isn't
+ * closed on its line. Quotes and escapes inside are skipped, and parentheses nest
+ *
+ *	source: points at the $ or `
+ */
+const char * commandSubstitutionEnd(const char *source)
+{
+	int depth = 1;
+	char quote;
+
+	if (*source == '`')
+	{
+		for (source++; *source != 0 && *source != '\n' && *source != '`'; source++)
+			if (*source == '\\' && source[1] != 0 && source[1] != '\n')
+				source++;
+		return *source == '`' ? source + 1 : NULL;
+	}
+	for (source += 2; *source != 0 && *source != '\n'; source++)
+	{
+		if (*source == '\\' && source[1] != 0 && source[1] != '\n')
+			source++;
+		else if (*source == '\'' || *source == '"')
+		{
+			quote = *source++;
+			while (*source != 0 && *source != '\n' && *source != quote)
+				source += quote == '"' && *source == '\\' && source[1] != 0 ? 2 : 1;
+			if (*source != quote)
+				return NULL;
+		}
+		else if (*source == '(')
+			depth++;
+		else if (*source == ')' && --depth == 0)
+			return source + 1;
+	}
+	return NULL;
+}
+
+/*
+ * Function:  hasCommandSubstitution
+ * --------------------------------
+ * Returns 1 if text may hold a $(COMMAND) or `COMMAND` and 0 otherwise. Any $( or ` counts, quoted or not,
+ * since quotes mean nothing in a here-document's body
+ *
+ *	text: the text to check
+ */
+int hasCommandSubstitution(const char *text)
+{
+	for (; *text != 0; text++)
+		if (startsCommandSubstitution(text))
+			return 1;
+	return 0;
+}
+
+/*
+ * Function:  runCommandSubstitution
+ * --------------------------------
+ * Runs the command of a $(COMMAND) or `COMMAND` and returns its output without trailing newlines (newly
+ * allocated). The command is copied out first, as words and documents are built over the text it is in
+ *
+ *	source: points at the $ or `
+ *	end: where commandSubstitutionEnd found it ends
+ *	arena: provides the copy of the command
+ */
+static char * runCommandSubstitution(const char *source, const char *end, struct arena *arena)
+{
+	char *text;
+	char *destination;
+	size_t length;
+
+	if (*source == '`')
+	{
+		text = destination = arenaAllocate(arena, end - source);
+		for (source++; source < end - 1; source++)
+		{
+			// Inside backquotes \`, \\ and \$ stand for the character itself
+			if (*source == '\\' && strchr("`\\$", source[1]) != NULL)
+				source++;
+			*destination++ = *source;
+		}
+		*destination = 0;
+	}
+	else
+	{
+		length = end - source - 3;
+		text = arenaAllocate(arena, length + 1);
+		memcpy(text, source + 2, length);
+		text[length] = 0;
+	}
+	return substituteCommand(text, arena);
+}
+
+/*
+ * Function:  appendText
+ * --------------------------------
+ * Adds text to an expanded here-document, or only counts it while the document is being measured
+ *
+ *	expanded: the document being built, or NULL while measuring
+ *	length: the length so far; advanced past the text
+ *	text: the text to add
+ *	textLength: the length of the text
+ */
+static void appendText(char *expanded, size_t *length, const char *text, size_t textLength)
+{
+	if (expanded != NULL)
+		memcpy(expanded + *length, text, textLength);
+	*length += textLength;
+}
+
+/*
+ * Function:  expandHereDocument
+ * --------------------------------
+ * Returns a here-document body with its $ references and command substitutions expanded and \$, \\, \`
+ * and \newline unescaped, in the arena; measured first so it is built in one allocation. Each command runs
+ * once, while measuring, and its output is kept for building
+ *
+ *	body: the body as typed
+ *	arena: provides the expanded body and the outputs
+ */
+static char * expandHereDocument(const char *body, struct arena *arena)
+{
+	struct substitutionOutput *outputs = NULL;
+	struct substitutionOutput **lastOutput = &outputs;
+	struct substitutionOutput *output = NULL;
+	char *expanded = NULL;
+	char *captured;
+	size_t length = 0;
+	const char *source;
+	const char *after;
+	const char *value;
+	int pass;
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		length = 0;
+		for (source = body; *source != 0;)
+		{
+			if (*source == '\\' && source[1] != 0 && strchr("$\\`\n", source[1]) != NULL)
+			{
+				if (source[1] != '\n')
+					appendText(expanded, &length, source + 1, 1);
+				source += 2;
+			}
+			else if (startsCommandSubstitution(source) && (after = commandSubstitutionEnd(source)) != NULL)
+			{
+				if (expanded == NULL)
+				{
+					captured = runCommandSubstitution(source, after, arena);
+					output = arenaAllocate(arena, sizeof(struct substitutionOutput) + strlen(captured) + 1);
+					output->text = (char *) (output + 1);
+					strcpy(output->text, captured);
+					free(captured);
+					output->next = NULL;
+					*lastOutput = output;
+					lastOutput = &output->next;
+				}
+				else
+				{
+					output = outputs;
+					outputs = outputs->next;
+				}
+				appendText(expanded, &length, output->text, strlen(output->text));
+				source = after;
+			}
+			else if (*source == '$' && (after = findParameter((char *) source, &value)) != NULL)
+			{
+				appendText(expanded, &length, value, strlen(value));
+				source = after;
+			}
+			else
+				appendText(expanded, &length, source++, 1);
+		}
+		if (expanded == NULL)
+			expanded = arenaAllocate(arena, length + 1);
+	}
+	expanded[length] = 0;
+	return expanded;
+}
+
+/*
+ * Function:  readHereDocument
+ * --------------------------------
+ * Takes the body of a here-document from the lines after the command, up to the line holding only its
+ * WORD, and makes it the command's standard in; returns 0, or -1 if the text ends first. The body is
+ * gathered in place, so it points into the parsed text unless it has references to expand
+ *
+ *	word: the here-document's WORD, unquoted
+ *	literal: 1 = WORD was quoted, so the body is taken as typed
+ *	stripTabs: 1 = <<-WORD; leading tabs are dropped from the body and the closing line
+ *	bodies: the first line not yet taken by a here-document; advanced past this one
+ *	command: assigned the here-document
+ *	arena: provides the body when it is expanded
+ */
+static int readHereDocument(char *word, int literal, int stripTabs, char **bodies, struct parsedCommand *command,
+	struct arena *arena)
+{
+	char *body = *bodies;
+	char *destination = body;
+	char *line = body;
+	char *lineEnd;
+	size_t wordLength = strlen(word);
+
+	while (1)
+	{
+		if (line == NULL || *line == 0)
+		{
+			fprintf(stderr, "here-document ended by end of file (wanted `%s')\n", word);
+			return -1;
+		}
+		while (stripTabs && *line == '\t')
+			line++;
+		lineEnd = strchr(line, '\n');
+		if (lineEnd == NULL)
+			lineEnd = line + strlen(line);
+		if ((size_t) (lineEnd - line) == wordLength && strncmp(line, word, wordLength) == 0)
+			break;
+		// Lines only move towards the start when tabs were dropped, so the body stays in place
+		memmove(destination, line, lineEnd - line);
+		destination += lineEnd - line;
+		if (*lineEnd == 0)
+			line = lineEnd;
+		else
+		{
+			*destination++ = '\n';
+			line = lineEnd + 1;
+		}
+	}
+	*bodies = *lineEnd != 0 ? lineEnd + 1 : lineEnd;
+	*destination = 0;
+
+	command->redirectInput = REDIRECT_HERE_DOCUMENT;
+	command->inputRedirect = word;
+	command->hereDocument = body;
+	if (!literal && strpbrk(body, "$\\`") != NULL)
+	{
+		command->hereDocument = expandHereDocument(body, arena);
+		command->expanded = 1;
+	}
+	return 0;
+}
+
+/*
+ * Function:  addProcessSubstitution
+ * --------------------------------
+ * Records a <(COMMAND) or >(COMMAND) word, as an argument or as the target of the pending redirection,
+ * and returns where the source continues after its ), or NULL if the ) is missing or the word goes on past
+ * it. The command is terminated in place and stands in for the word until processCommand starts it
+ *
+ *	source: points at the (
+ *	output: 1 = >(COMMAND); 0 = <(COMMAND)
+ *	pending: PENDING_NONE, PENDING_INPUT_REDIRECT or PENDING_OUTPUT_REDIRECT
+ *  command: the command being built
+ *  arena: provides the record and the argument array
+ *  maxNumberOfArgs: the number of entries the current argument array has room for
+ */
+static char * addProcessSubstitution(char *source, int output, int pending, struct parsedCommand *command,
+	struct arena *arena, int *maxNumberOfArgs)
+{
+	struct processSubstitution *substitution;
+	char *end = source + 1;
+	int depth = 1;
+	char quote;
+
+	while (*end != 0)
+	{
+		if (*end == '\\' && end[1] != 0)
+			end++;
+		else if (*end == '\'' || *end == '"')
+		{
+			quote = *end++;
+			while (*end != 0 && *end != quote)
+				end += quote == '"' && *end == '\\' && end[1] != 0 ? 2 : 1;
+			if (*end == 0)
+				return NULL;
+		}
+		else if (*end == '(')
+			depth++;
+		else if (*end == ')' && --depth == 0)
+			break;
+		end++;
+	}
+	if (*end != ')' || !endsWord(end[1]))
+		return NULL;
+	*end = 0;
+
+	substitution = arenaAllocate(arena, sizeof(struct processSubstitution));
+	substitution->text = source + 1;
+	substitution->output = output;
+	substitution->next = command->substitutions;
+	command->substitutions = substitution;
+	if (pending == PENDING_INPUT_REDIRECT)
+	{
+		substitution->target = SUBSTITUTE_INPUT_REDIRECT;
+		command->redirectInput = REDIRECT_FILE;
+		command->inputRedirect = substitution->text;
+		command->hereDocument = NULL;
+	}
+	else if (pending == PENDING_OUTPUT_REDIRECT)
+	{
+		substitution->target = SUBSTITUTE_OUTPUT_REDIRECT;
+		command->redirectOutput = 1;
+		command->outputRedirect = substitution->text;
+	}
+	else
+	{
+		substitution->target = command->numberOfArgs;
+		appendArg(command, arena, maxNumberOfArgs, substitution->text);
+	}
+	// The word names a pipe that only exists while the command runs
+	command->expanded = 1;
+	return end + 1;
+}
+
+/*
+ * Function:  assignsVariable
+ * --------------------------------
+ * Returns 1 if the word built so far starts with NAME= and only assignments come before it in its stage,
+ * so it sets a variable and a command substitution in it isn't split; 0 otherwise
+ *
+ *	word: the start of the word being built
+ *	destination: where the next byte of the word goes
+ *  command: the command being built
+ *  stageStart: the first argument of the current stage
+ */
+static int assignsVariable(const char *word, const char *destination, struct parsedCommand *command,
+	int stageStart)
+{
+	const char *name = word;
+	int i;
+
+	if (word == destination || (!isalpha((unsigned char) *name) && *name != '_'))
+		return 0;
+	while (name < destination && (isalnum((unsigned char) *name) || *name == '_'))
+		name++;
+	if (name == destination || *name != '=')
+		return 0;
+	for (i = stageStart; i < command->numberOfArgs; i++)
+		if (!isAssignment(command->args[i]))
+			return 0;
+	return 1;
+}
+
+/*
+ * Function:  expandCommandSubstitution
+ * --------------------------------
+ * Runs the $(COMMAND) or `COMMAND` at source, copies its output into the word being built and returns
+ * where the source continues, or NULL if it isn't closed. The word moves to the arena with room for the
+ * output and the rest of the line. When split, each run of blanks and newlines in the output ends the
+ * word there: it becomes an argument and the next word starts after it
+ *
+ *	source: points at the $ or `
+ *	split: 1 = split the output into arguments; 0 = keep it in the word
+ *	word: the start of the word being built; reassigned when it moves or a new word starts
+ *	destination: where the next byte of the word goes; advanced past the output
+ *	wordEnd: assigned the end of the word's arena buffer
+ *	quoted: cleared when a new word starts
+ *  command: the command being built; given the words split off
+ *  arena: provides the word, the command's text and the argument array
+ *  maxNumberOfArgs: the number of entries the current argument array has room for
+ */
+static char * expandCommandSubstitution(char *source, int split, char **word, char **destination, char **wordEnd,
+	int *quoted, struct parsedCommand *command, struct arena *arena, int *maxNumberOfArgs)
+{
+	char *end = (char *) commandSubstitutionEnd(source);
+	char *output;
+	char *value;
+	char *moved;
+	size_t length;
+	size_t used;
+
+	if (end == NULL)
+		return NULL;
+	output = runCommandSubstitution(source, end, arena);
+	command->expanded = 1;
+	command->substituted = 1;
+
+	length = strlen(output);
+	used = *destination - *word;
+	moved = arenaAllocate(arena, used + length + strlen(end) + 1);
+	memcpy(moved, *word, used);
+	*word = moved;
+	*destination = moved + used;
+	*wordEnd = moved + used + length + strlen(end) + 1;
+	for (value = output; *value != 0; value++)
+	{
+		if (split && (*value == ' ' || *value == '\t' || *value == '\n'))
+		{
+			// The blank the word ends at leaves room for its terminator
+			if (*destination != *word)
+			{
+				*(*destination)++ = 0;
+				appendArg(command, arena, maxNumberOfArgs, *word);
+				*word = *destination;
+				*quoted = 0;
+			}
+			continue;
+		}
+		*(*destination)++ = *value;
+	}
+	free(output);
+	return end;
+}
+
 /*
  * Function:  parseArgs
  * --------------------------------
- * Utility function to accept and parse input from user
- *
- *	inputBuffer: holds each input line given in terminal
- *  inputArgs: array holding each individual argument/command when not a redirection or background process req
- *	inputRedirect: holds the name of the file for redirecting input
- *  outputRedirect: holds the name of the file for redirecting output
- *	backgroundProcess: binary indicator to denote whether command should be executed in background or foreground
- */
-void parseArgs(
-    char *inputBuffer, char **inputArgs, int *redirectInput, int *redirectOutput,
-    char *inputRedirect, char *outputRedirect, int *backgroundProcess)
-{
-	char *token;
-	char *separator = " ";
-	int nextIsInputRedirect = 0;
-	int alreadyRedirectedInput = 0;
-	int nextIsOutputRedirect = 0;
-	int alreadyRedirectedOutput = 0;
-	int argsCount = 0;
-    fgets(inputBuffer, MAX_INPUT_BUFFER, stdin);
-
-    // If not command was given then nothing to do
-    if (inputBuffer[0] != '\n')
-    {
-
-        // Tokenize the input given by user and iterate over each token where any two tokens are separated by a space
-        token = strtok(inputBuffer, separator);
-        while (token != NULL)
-        {
-        	// First remove trailing newline from fgets
-        	token[strcspn(token, "\n")] = 0;
-        	// An input redirection was provided with "<" so record input file name
-        	if (nextIsInputRedirect) 
-        	{
-        		strcpy(inputRedirect, token); 
-        		nextIsInputRedirect = 0;
-        		alreadyRedirectedInput = 1;
-        	} 
-        	// An output redirection was provided with ">" so record output file name
-        	else if (nextIsOutputRedirect)
-        	{
-        		strcpy(outputRedirect, token); 
-        		nextIsOutputRedirect = 0;
-        		alreadyRedirectedOutput = 1;
-        	}
-        	// A request to run command in background was given so keep track in binary indicator
-        	else if (strncmp(token, "&", 1) == 0)
-        		*backgroundProcess = 1;
-        	// A request to redirect input was given so keep note that next argument is input filename
-        	else if (strncmp(token, "<", 1) == 0 && !alreadyRedirectedInput)
-            {
-        		nextIsInputRedirect = 1;
-                *redirectInput = 1;
-            }
-        	// A request to redirect output was given so keep note that next argument is output filename
-        	else if (strncmp(token, ">", 1) == 0 && !alreadyRedirectedOutput)
-            {
-        		nextIsOutputRedirect = 1;
-                *redirectOutput = 1;
-            }
-        	// Anything else refers to a command itself or other argument not handled above
-        	else
-        	{
-        		inputArgs[argsCount] = token;
-        		argsCount++;
-        	}
-
-        	// Get next token
-        	token = strtok(NULL, separator);
-        }
-        inputArgs[argsCount] = NULL;
-    }
+ * Utility function to parse a line of input from the user in a single pass; returns 0 on success and -1
+ * on a syntax error. Words may be quoted with '' or "" and characters escaped with \; words are split on
+ * spaces and tabs, and | < > & << <<< are recognized without spaces around them. $NAME, ${NAME}, $$, $?
+ * and the positional parameters are expanded outside single quotes; values aren't split into words, and an
+ * unquoted expansion that comes out empty leaves no argument, while a "$@" word becomes one argument per
+ * positional parameter. An argument with an unquoted *, ? or [...] is replaced by the sorted paths it
+ * matches, or kept as typed when none match; each directory is read once per line. Words are unquoted in
+ * place so arguments point into inputBuffer, unless an expansion made the word longer than its text;
+ * those words, matched paths and the argument array come from the arena. $(COMMAND) and `COMMAND` run as
+ * they are reached and are replaced by the command's output without its trailing newlines, split into
+ * arguments at blanks and newlines unless quoted, redirected or assigned to a variable. The bodies of <<WORD
+ * here-documents are the lines after the first, each up to a line holding only WORD (<<-WORD drops leading
+ * tabs), with $ references and command substitutions expanded unless WORD is quoted. <(COMMAND) and
+ * >(COMMAND) words are recorded for processCommand to start
+ *
+ *	inputBuffer: holds the input line, followed by any here-document bodies; it is split in place
+ *  command: assigned the arguments, pipeline stages, redirections and background indicator
+ *  arena: provides the argument array; reset by the caller once the command has run
+ */
+int parseArgs(char *inputBuffer, struct parsedCommand *command, struct arena *arena)
+{
+	char *source = inputBuffer;
+	char *destination;
+	char *word;
+	char *wordEnd;
+	char *after;
+	int quoted;
+	int expanded;
+	char *pattern;
+	char **matches;
+	int numberOfMatches;
+	int i;
+	struct wildcardCache wildcards;
+	int wildcardsReady = 0;
+	const struct positionalParameters *parameters;
+	int length;
+	char operator;
+	char operatorText[2] = { 0, 0 };
+	int pending = PENDING_NONE;
+	int stripTabs = 0;
+	int maxNumberOfArgs = 0;
+	int stageStart = 0;
+	// Here-document bodies are on the lines after the command's own
+	char *bodies = strchr(inputBuffer, '\n');
+
+	memset(command, 0, sizeof(struct parsedCommand));
+	command->numberOfStages = 1;
+	if (bodies != NULL)
+		*bodies++ = 0;
+
+	while (1)
+	{
+		// Words are separated by any run of spaces and tabs
+		while (*source == ' ' || *source == '\t')
+			source++;
+		// An unquoted # at the start of a word comments out the rest of the line
+		if (*source == 0 || *source == '#')
+			break;
+
+		if (isOperator(*source))
+			operator = *source++;
+		// "$@" passes each positional parameter on as an argument of its own
+		else if (pending == PENDING_NONE && (length = allParametersLength(source)) > 0)
+		{
+			source += length;
+			parameters = currentPositionalParameters();
+			for (i = 0; i < parameters->count; i++)
+				appendArg(command, arena, &maxNumberOfArgs, parameters->args[i]);
+			command->expanded = 1;
+			operator = *source;
+			if (operator != 0)
+				source++;
+			if (!isOperator(operator))
+				continue;
+		}
+		else
+		{
+			// Copy the word onto itself without its quotes and escapes; it can only get shorter
+			word = destination = source;
+			wordEnd = NULL;
+			quoted = 0;
+			expanded = 0;
+			// File names are only expanded for arguments; the pattern is taken before the word is unquoted
+			pattern = pending == PENDING_NONE && hasWildcard(source) ? buildPattern(source) : NULL;
+			while (!endsWord(*source))
+			{
+				// An unquoted $(COMMAND) or `COMMAND` is split into arguments unless redirected or assigned
+				if (startsCommandSubstitution(source) && pending != PENDING_HERE_DOCUMENT)
+				{
+					after = expandCommandSubstitution(source, pending == PENDING_NONE &&
+						!assignsVariable(word, destination, command, stageStart), &word, &destination, &wordEnd,
+						&quoted, command, arena, &maxNumberOfArgs);
+					if (after == NULL)
+					{
+						free(pattern);
+						return syntaxError(*source == '`' ? "`" : "$(");
+					}
+					source = after;
+					expanded = 1;
+				}
+				// A here-document's WORD is taken as typed
+				else if (*source == '$' && pending != PENDING_HERE_DOCUMENT)
+				{
+					source = expandParameter(source, &word, &destination, &wordEnd, arena);
+					expanded = 1;
+				}
+				else if (*source == '\\')
+				{
+					quoted = 1;
+					source++;
+					if (*source != 0)
+						*destination++ = *source++;
+				}
+				else if (*source == '\'')
+				{
+					quoted = 1;
+					source++;
+					while (*source != 0 && *source != '\'')
+						*destination++ = *source++;
+					if (*source == 0)
+					{
+						free(pattern);
+						return syntaxError("'");
+					}
+					source++;
+				}
+				else if (*source == '"')
+				{
+					quoted = 1;
+					source++;
+					while (*source != 0 && *source != '"')
+					{
+						if (startsCommandSubstitution(source) && pending != PENDING_HERE_DOCUMENT)
+						{
+							after = expandCommandSubstitution(source, 0, &word, &destination, &wordEnd, &quoted,
+								command, arena, &maxNumberOfArgs);
+							if (after == NULL)
+							{
+								free(pattern);
+								return syntaxError(*source == '`' ? "`" : "$(");
+							}
+							source = after;
+							continue;
+						}
+						if (*source == '$' && pending != PENDING_HERE_DOCUMENT)
+						{
+							source = expandParameter(source, &word, &destination, &wordEnd, arena);
+							// A quoted expansion keeps its argument even when empty, but still depends on variables
+							command->expanded = 1;
+							continue;
+						}
+						if (*source == '\\' && source[1] != 0 && strchr("\"\\$`", source[1]) != NULL)
+							source++;
+						*destination++ = *source++;
+					}
+					if (*source == 0)
+					{
+						free(pattern);
+						return syntaxError("\"");
+					}
+					source++;
+				}
+				else
+					*destination++ = *source++;
+			}
+
+			// Remember what ended the word before its terminator overwrites it
+			operator = *source;
+			if (operator != 0)
+				source++;
+			*destination = 0;
+
+			// An input redirection was provided with "<" so record input file name
+			if (pending == PENDING_INPUT_REDIRECT)
+			{
+				command->redirectInput = REDIRECT_FILE;
+				command->inputRedirect = word;
+				command->hereDocument = NULL;
+			}
+			// A here-string feeds the word itself, followed by a newline
+			else if (pending == PENDING_HERE_STRING)
+			{
+				command->redirectInput = REDIRECT_HERE_STRING;
+				command->inputRedirect = word;
+				command->hereDocument = word;
+			}
+			else if (pending == PENDING_HERE_DOCUMENT)
+			{
+				if (readHereDocument(word, quoted, stripTabs, &bodies, command, arena) != 0)
+				{
+					free(pattern);
+					return -1;
+				}
+			}
+			// An output redirection was provided with ">" so record output file name
+			else if (pending == PENDING_OUTPUT_REDIRECT)
+				command->outputRedirect = word;
+			// A pattern is replaced by the paths it matches, or kept as typed when none match
+			else if (pattern != NULL)
+			{
+				if (!wildcardsReady)
+				{
+					initializeWildcardCache(&wildcards, arena);
+					wildcardsReady = 1;
+				}
+				numberOfMatches = expandWildcards(pattern, &wildcards, &matches);
+				free(pattern);
+				for (i = 0; i < numberOfMatches; i++)
+					appendArg(command, arena, &maxNumberOfArgs, matches[i]);
+				if (numberOfMatches == 0)
+					appendArg(command, arena, &maxNumberOfArgs, word);
+				command->expanded = 1;
+			}
+			// Anything else refers to a command itself or other argument, unless it was only an empty expansion
+			else if (destination != word || quoted || !expanded)
+				appendArg(command, arena, &maxNumberOfArgs, word);
+			command->expanded |= expanded;
+			pending = PENDING_NONE;
+
+			if (!isOperator(operator))
+				continue;
+		}
+
+		operatorText[0] = operator;
+		// <(COMMAND) and >(COMMAND) stand for a pipe from or to the command, as an argument or a redirection
+		if ((operator == '<' || operator == '>') && *source == '(' &&
+			(pending == PENDING_NONE || pending == PENDING_INPUT_REDIRECT || pending == PENDING_OUTPUT_REDIRECT))
+		{
+			source = addProcessSubstitution(source, operator == '>', pending, command, arena, &maxNumberOfArgs);
+			if (source == NULL)
+				return syntaxError("(");
+			pending = PENDING_NONE;
+			continue;
+		}
+		// A redirection needs a file name before anything else
+		if (pending != PENDING_NONE)
+			return syntaxError(operatorText);
+
+		// A pipe ends the current stage; a NULL entry separates it from the next command
+		if (operator == '|')
+		{
+			// Each side of a pipe needs a command
+			if (command->numberOfArgs == stageStart)
+				return syntaxError("|");
+			appendArg(command, arena, &maxNumberOfArgs, NULL);
+			stageStart = command->numberOfArgs;
+			command->numberOfStages++;
+		}
+		// A request to run command in background was given so keep track in binary indicator
+		else if (operator == '&')
+			command->runInBackground = 1;
+		// A request to redirect input was given so keep note that next argument is input filename; <<WORD
+		// takes a here-document and <<<WORD a here-string instead
+		else if (operator == '<')
+		{
+			pending = PENDING_INPUT_REDIRECT;
+			if (source[0] == '<' && source[1] == '<')
+			{
+				pending = PENDING_HERE_STRING;
+				source += 2;
+			}
+			else if (source[0] == '<')
+			{
+				pending = PENDING_HERE_DOCUMENT;
+				stripTabs = source[1] == '-';
+				source += 1 + stripTabs;
+			}
+		}
+		// A request to redirect output was given so keep note that next argument is output filename
+		else if (operator == '>')
+		{
+			pending = PENDING_OUTPUT_REDIRECT;
+			command->redirectOutput = 1;
+		}
+	}
+
+	if (pending != PENDING_NONE)
+		return syntaxError("newline");
+	// A trailing pipe leaves the last stage without a command
+	if (command->numberOfStages > 1 && command->numberOfArgs == stageStart)
+		return syntaxError("|");
+	appendArg(command, arena, &maxNumberOfArgs, NULL);
+	return 0;
+}
+
+/*
+ * Function:  addTemplatePart
+ * --------------------------------
+ * Adds a part to the word being compiled; text continues the word's last part when both are the same kind
+ *
+ *	builder: the template being compiled
+ *	kind: PART_TEXT, PART_QUOTED_TEXT, PART_PARAMETER or PART_SUBSTITUTION
+ *	quoted: 1 = the part is between double quotes
+ *	text: the part's text
+ *	length: the length of the text
+ */
+static void addTemplatePart(struct templateBuilder *builder, int kind, int quoted, const char *text, size_t length)
+{
+	struct templatePart *last = builder->numberOfParts > builder->firstPart ?
+		&builder->parts[builder->numberOfParts - 1] : NULL;
+
+	if (builder->textLength + length > builder->textCapacity)
+	{
+		builder->textCapacity = builder->textCapacity * 2 + length;
+		builder->text = realloc(builder->text, builder->textCapacity);
+	}
+	memcpy(builder->text + builder->textLength, text, length);
+	builder->textLength += length;
+	if (last != NULL && last->kind == kind && kind <= PART_QUOTED_TEXT)
+	{
+		last->length += length;
+		return;
+	}
+
+	if (builder->numberOfParts == builder->partCapacity)
+	{
+		builder->partCapacity = builder->partCapacity ? builder->partCapacity * 2 : STARTING_NUMBER_OF_ARGS;
+		builder->parts = realloc(builder->parts, sizeof(struct templatePart) * builder->partCapacity);
+	}
+	last = &builder->parts[builder->numberOfParts++];
+	last->kind = kind;
+	last->quoted = quoted;
+	last->start = builder->textLength - length;
+	last->length = length;
+}
+
+/*
+ * Function:  addTemplateWord
+ * --------------------------------
+ * Ends the word being compiled, made of the parts added since the last word
+ *
+ *	builder: the template being compiled
+ *	role: PENDING_NONE for an argument, another PENDING_ role or a TEMPLATE_ role
+ *	quoted: 1 = the word has a quote or escape
+ *	expanded: 1 = the word has an unquoted expansion
+ *	pattern: 1 = the word matches file names
+ */
+static void addTemplateWord(struct templateBuilder *builder, int role, int quoted, int expanded, int pattern)
+{
+	struct templateWord *word;
+
+	if (builder->numberOfWords == builder->wordCapacity)
+	{
+		builder->wordCapacity = builder->wordCapacity ? builder->wordCapacity * 2 : STARTING_NUMBER_OF_ARGS;
+		builder->words = realloc(builder->words, sizeof(struct templateWord) * builder->wordCapacity);
+	}
+	word = &builder->words[builder->numberOfWords++];
+	word->role = role;
+	word->quoted = quoted;
+	word->expanded = expanded;
+	word->pattern = pattern;
+	word->firstPart = builder->firstPart;
+	word->numberOfParts = builder->numberOfParts - builder->firstPart;
+	builder->firstPart = builder->numberOfParts;
+}
+
+/*
+ * Function:  compileTemplateParameter
+ * --------------------------------
+ * Adds the $ reference at source to the word being compiled and returns where the source continues; a $
+ * that starts no reference is text
+ *
+ *	builder: the template being compiled
+ *	source: points at the $
+ *	quoted: 1 = the reference is between double quotes
+ */
+static const char * compileTemplateParameter(struct templateBuilder *builder, const char *source, int quoted)
+{
+	const char *name;
+	size_t nameLength;
+	const char *after = parameterName(source, &name, &nameLength);
+
+	builder->expanded = 1;
+	if (after == NULL)
+	{
+		addTemplatePart(builder, quoted ? PART_QUOTED_TEXT : PART_TEXT, 0, source, 1);
+		return source + 1;
+	}
+	addTemplatePart(builder, PART_PARAMETER, quoted, name, nameLength);
+	return after;
+}
+
+/*
+ * Function:  compileTemplateWord
+ * --------------------------------
+ * Compiles the word at source as parseArgs reads it and returns where the word ends, or NULL on a quote
+ * or command substitution that isn't closed
+ *
+ *	builder: the template being compiled
+ *	source: the start of the word, as typed
+ *	role: PENDING_NONE for an argument or the PENDING_ role of the word after an operator
+ */
+static const char * compileTemplateWord(struct templateBuilder *builder, const char *source, int role)
+{
+	const char *end;
+	int quoted = 0;
+	int expanded = 0;
+	int pattern = role == PENDING_NONE && hasWildcard(source);
+
+	while (!endsWord(*source))
+	{
+		if (startsCommandSubstitution(source))
+		{
+			if ((end = commandSubstitutionEnd(source)) == NULL)
+				return NULL;
+			addTemplatePart(builder, PART_SUBSTITUTION, 0, source, end - source);
+			source = end;
+			expanded = 1;
+		}
+		else if (*source == '$')
+		{
+			source = compileTemplateParameter(builder, source, 0);
+			expanded = 1;
+		}
+		else if (*source == '\\')
+		{
+			quoted = 1;
+			source++;
+			if (*source != 0)
+				addTemplatePart(builder, PART_QUOTED_TEXT, 0, source++, 1);
+		}
+		else if (*source == '\'')
+		{
+			quoted = 1;
+			for (end = ++source; *end != 0 && *end != '\''; end++)
+				;
+			if (*end == 0)
+				return NULL;
+			addTemplatePart(builder, PART_QUOTED_TEXT, 0, source, end - source);
+			source = end + 1;
+		}
+		else if (*source == '"')
+		{
+			quoted = 1;
+			source++;
+			while (*source != 0 && *source != '"')
+			{
+				if (startsCommandSubstitution(source))
+				{
+					if ((end = commandSubstitutionEnd(source)) == NULL)
+						return NULL;
+					addTemplatePart(builder, PART_SUBSTITUTION, 1, source, end - source);
+					source = end;
+					continue;
+				}
+				if (*source == '$')
+				{
+					source = compileTemplateParameter(builder, source, 1);
+					continue;
+				}
+				if (*source == '\\' && source[1] != 0 && strchr("\"\\$`", source[1]) != NULL)
+					source++;
+				addTemplatePart(builder, PART_QUOTED_TEXT, 0, source++, 1);
+			}
+			if (*source == 0)
+				return NULL;
+			source++;
+		}
+		else
+			addTemplatePart(builder, PART_TEXT, 0, source++, 1);
+	}
+	builder->expanded |= expanded | pattern;
+	addTemplateWord(builder, role, quoted, expanded, pattern);
+	return source;
+}
+
+/*
+ * Function:  compileTemplate
+ * --------------------------------
+ * Tokenizes a line once into a template of its words, whose quotes are already removed and whose $
+ * references, command substitutions and file name patterns are marked to be expanded each time the
+ * template is instantiated. Returns the template in the arena, or NULL if the line has a here-document,
+ * a process substitution or a syntax error, which are left to parseArgs. Nothing runs while compiling
+ *
+ *	line: the line as typed; left untouched
+ *	arena: provides the template
+ */
+struct commandTemplate * compileTemplate(const char *line, struct arena *arena)
+{
+	struct templateBuilder builder;
+	struct commandTemplate *template = NULL;
+	const char *source = line;
+	char *storage;
+	int pending = PENDING_NONE;
+	int length;
+	char operator;
+
+	memset(&builder, 0, sizeof(builder));
+	// The lines after the first hold here-document bodies
+	if (strchr(line, '\n') != NULL)
+		return NULL;
+	while (1)
+	{
+		while (*source == ' ' || *source == '\t')
+			source++;
+		if (*source == 0 || *source == '#')
+			break;
+
+		if (isOperator(*source))
+			operator = *source++;
+		else
+		{
+			if (pending == PENDING_NONE && (length = allParametersLength(source)) > 0)
+			{
+				source += length;
+				addTemplateWord(&builder, TEMPLATE_ALL_PARAMETERS, 0, 0, 0);
+				builder.expanded = 1;
+			}
+			else if ((source = compileTemplateWord(&builder, source, pending)) == NULL)
+				break;
+			pending = PENDING_NONE;
+			operator = *source;
+			if (operator != 0)
+				source++;
+			if (!isOperator(operator))
+				continue;
+		}
+
+		// Process substitutions, here-documents and misplaced operators go to parseArgs
+		if (((operator == '<' || operator == '>') && *source == '(') || pending != PENDING_NONE)
+			break;
+		if (operator == '|')
+			addTemplateWord(&builder, TEMPLATE_PIPE, 0, 0, 0);
+		else if (operator == '&')
+			builder.runInBackground = 1;
+		else if (operator == '<' && source[0] == '<' && source[1] == '<')
+		{
+			pending = PENDING_HERE_STRING;
+			source += 2;
+		}
+		else if (operator == '<' && source[0] == '<')
+			break;
+		else
+			pending = operator == '<' ? PENDING_INPUT_REDIRECT : PENDING_OUTPUT_REDIRECT;
+	}
+
+	if (source != NULL && (*source == 0 || *source == '#') && pending == PENDING_NONE)
+	{
+		template = arenaAllocate(arena, sizeof(struct commandTemplate) +
+			sizeof(struct templateWord) * builder.numberOfWords +
+			sizeof(struct templatePart) * builder.numberOfParts + builder.textLength);
+		template->size = sizeof(struct commandTemplate) + sizeof(struct templateWord) * builder.numberOfWords +
+			sizeof(struct templatePart) * builder.numberOfParts + builder.textLength;
+		template->numberOfWords = builder.numberOfWords;
+		template->numberOfParts = builder.numberOfParts;
+		template->runInBackground = builder.runInBackground;
+		template->expanded = builder.expanded;
+		storage = (char *) (template + 1);
+		memcpy(storage, builder.words, sizeof(struct templateWord) * builder.numberOfWords);
+		storage += sizeof(struct templateWord) * builder.numberOfWords;
+		memcpy(storage, builder.parts, sizeof(struct templatePart) * builder.numberOfParts);
+		storage += sizeof(struct templatePart) * builder.numberOfParts;
+		memcpy(storage, builder.text, builder.textLength);
+	}
+	free(builder.words);
+	free(builder.parts);
+	free(builder.text);
+	return template;
+}
+
+/*
+ * Function:  appendToWord
+ * --------------------------------
+ * Appends bytes to a word being instantiated, moving it to a buffer twice as large in the arena when it is
+ * full; the word always keeps room for its terminator
+ *
+ *	word: the word's buffer; reassigned when it moves
+ *	used: the length of the word so far; advanced past the bytes
+ *	capacity: the size of the word's buffer
+ *	bytes: the bytes to append
+ *	length: the number of bytes
+ *	arena: provides the larger buffer
+ */
+static void appendToWord(char **word, size_t *used, size_t *capacity, const char *bytes, size_t length,
+	struct arena *arena)
+{
+	char *moved;
+
+	if (*used + length + 1 > *capacity)
+	{
+		*capacity = (*used + length + 1) * 2;
+		moved = arenaAllocate(arena, *capacity);
+		memcpy(moved, *word, *used);
+		*word = moved;
+	}
+	memcpy(*word + *used, bytes, length);
+	*used += length;
+}
+
+/*
+ * Function:  instantiateTemplate
+ * --------------------------------
+ * Builds a command from a template as parseArgs would build it from the line the template was compiled
+ * from, expanding only the marked parts: $ references are looked up, command substitutions run and file
+ * name patterns are matched again. Returns 0 on success and -1 on a syntax error, which only a pipeline
+ * stage left empty by its expansions can cause
+ *
+ *	template: the template, from compileTemplate
+ *  command: assigned the arguments, pipeline stages, redirections and background indicator
+ *  arena: provides the arguments and the argument array; reset by the caller once the command has run
+ */
+int instantiateTemplate(const struct commandTemplate *template, struct parsedCommand *command, struct arena *arena)
+{
+	const struct templateWord *words = (const struct templateWord *) (template + 1);
+	const struct templatePart *parts = (const struct templatePart *) (words + template->numberOfWords);
+	const char *text = (const char *) (parts + template->numberOfParts);
+	const struct templateWord *templateWord;
+	const struct templatePart *part;
+	const struct positionalParameters *parameters;
+	struct wildcardCache wildcards;
+	int wildcardsReady = 0;
+	char *word;
+	size_t used;
+	size_t capacity;
+	char *pattern;
+	size_t patternLength;
+	size_t patternCapacity;
+	char *output;
+	const char *value;
+	size_t j;
+	int quoted;
+	int split;
+	char **matches;
+	int numberOfMatches;
+	int maxNumberOfArgs = 0;
+	int stageStart = 0;
+	int i;
+	int k;
+
+	memset(command, 0, sizeof(struct parsedCommand));
+	command->numberOfStages = 1;
+	command->runInBackground = template->runInBackground;
+	command->expanded = template->expanded;
+
+	for (i = 0; i < template->numberOfWords; i++)
+	{
+		templateWord = &words[i];
+		if (templateWord->role == TEMPLATE_PIPE)
+		{
+			if (command->numberOfArgs == stageStart)
+				return syntaxError("|");
+			appendArg(command, arena, &maxNumberOfArgs, NULL);
+			stageStart = command->numberOfArgs;
+			command->numberOfStages++;
+			continue;
+		}
+		if (templateWord->role == TEMPLATE_ALL_PARAMETERS)
+		{
+			parameters = currentPositionalParameters();
+			for (k = 0; k < parameters->count; k++)
+				appendArg(command, arena, &maxNumberOfArgs, parameters->args[k]);
+			continue;
+		}
+
+		capacity = STARTING_NUMBER_OF_ARGS;
+		for (k = 0; k < templateWord->numberOfParts; k++)
+			capacity += parts[templateWord->firstPart + k].length;
+		word = arenaAllocate(arena, capacity);
+		used = 0;
+		quoted = templateWord->quoted;
+		pattern = NULL;
+		patternLength = 0;
+		patternCapacity = 0;
+		if (templateWord->pattern)
+		{
+			appendPattern(&pattern, &patternLength, &patternCapacity, 0, 0);
+			patternLength = 0;
+		}
+
+		for (k = 0; k < templateWord->numberOfParts; k++)
+		{
+			part = &parts[templateWord->firstPart + k];
+			if (part->kind == PART_SUBSTITUTION)
+			{
+				output = runCommandSubstitution(text + part->start, text + part->start + part->length, arena);
+				command->substituted = 1;
+				// As in parseArgs, an unquoted output is split into arguments unless redirected or assigned
+				split = templateWord->role == PENDING_NONE && !part->quoted &&
+					!assignsVariable(word, word + used, command, stageStart);
+				for (value = output; *value != 0; value++)
+				{
+					if (split && (*value == ' ' || *value == '\t' || *value == '\n'))
+					{
+						if (used > 0)
+						{
+							word[used] = 0;
+							appendArg(command, arena, &maxNumberOfArgs, word);
+							word = arenaAllocate(arena, capacity);
+							used = 0;
+							quoted = 0;
+						}
+						continue;
+					}
+					appendToWord(&word, &used, &capacity, value, 1, arena);
+				}
+				free(output);
+				continue;
+			}
+			if (part->kind == PART_PARAMETER)
+			{
+				value = lookupVariable(text + part->start, part->length);
+				if (value == NULL)
+					value = "";
+			}
+			else
+				value = text + part->start;
+			j = part->kind == PART_PARAMETER ? strlen(value) : part->length;
+			appendToWord(&word, &used, &capacity, value, j, arena);
+			// Only wildcards typed outside quotes match more than themselves
+			if (pattern != NULL)
+				for (; j > 0; j--)
+					appendPattern(&pattern, &patternLength, &patternCapacity, *value++, part->kind != PART_TEXT);
+		}
+		word[used] = 0;
+
+		if (templateWord->role == PENDING_INPUT_REDIRECT)
+		{
+			command->redirectInput = REDIRECT_FILE;
+			command->inputRedirect = word;
+			command->hereDocument = NULL;
+		}
+		else if (templateWord->role == PENDING_HERE_STRING)
+		{
+			command->redirectInput = REDIRECT_HERE_STRING;
+			command->inputRedirect = word;
+			command->hereDocument = word;
+		}
+		else if (templateWord->role == PENDING_OUTPUT_REDIRECT)
+		{
+			command->redirectOutput = 1;
+			command->outputRedirect = word;
+		}
+		else if (pattern != NULL)
+		{
+			if (!wildcardsReady)
+			{
+				initializeWildcardCache(&wildcards, arena);
+				wildcardsReady = 1;
+			}
+			numberOfMatches = expandWildcards(pattern, &wildcards, &matches);
+			free(pattern);
+			for (k = 0; k < numberOfMatches; k++)
+				appendArg(command, arena, &maxNumberOfArgs, matches[k]);
+			if (numberOfMatches == 0)
+				appendArg(command, arena, &maxNumberOfArgs, word);
+		}
+		else if (used > 0 || quoted || !templateWord->expanded)
+			appendArg(command, arena, &maxNumberOfArgs, word);
+	}
+
+	if (command->numberOfStages > 1 && command->numberOfArgs == stageStart)
+		return syntaxError("|");
+	appendArg(command, arena, &maxNumberOfArgs, NULL);
+	return 0;
 }
 
 /*
  * Function:  displayPrompt
  * --------------------------------
  * Utility function to display user prompt in terminal
+ *
+ *	prompt: the prompt to display, PROMPT or CONTINUATION_PROMPT inside a block
  */
-void displayPrompt() 
+void displayPrompt(const char *prompt)
 {
-	fprintf(stdout, ":");
+	fputs(prompt, stdout);
 }
@@ -9,34 +9,169 @@
 #ifndef CLI_H_
 #define CLI_H_
 
+#include "arena.h"
+
+#include <stddef.h>
+
 #define PATH_MAXIMUM 4096
-#define MAX_INPUT_BUFFER 2048
-#define MAX_ARGS 512
-#define MAX_REDIRECT_FILENAME_SIZE 128
+#define STARTING_NUMBER_OF_ARGS 16
+#define PROMPT ":"
+#define CONTINUATION_PROMPT "> "
+
+// What a command's standard in comes from when redirectInput is set
+#define REDIRECT_FILE 1				// < FILE
+#define REDIRECT_HERE_DOCUMENT 2	// <<WORD, the lines up to WORD
+#define REDIRECT_HERE_STRING 3		// <<<WORD, the word and a newline
+
+// Where a process substitution's /dev/fd/N goes when it isn't an argument
+#define SUBSTITUTE_INPUT_REDIRECT -1
+#define SUBSTITUTE_OUTPUT_REDIRECT -2
+
+// A <(COMMAND) or >(COMMAND) word, which becomes /dev/fd/N once the command is started
+struct processSubstitution
+{
+	char *text;					// the command between the parentheses
+	int output;					// 1 = >(COMMAND), which reads what is written to the pipe; 0 = <(COMMAND)
+	int target;					// the argument it stands for, or SUBSTITUTE_INPUT_REDIRECT/OUTPUT_REDIRECT
+	struct processSubstitution *next;
+};
+
+struct parsedCommand
+{
+	char **args;				// every stage's arguments; each stage ends with a NULL entry
+	int numberOfArgs;			// entries in args including the NULL after each stage
+	int numberOfStages;			// commands connected by "|" (1 for a plain command)
+	int redirectInput;			// 0, or REDIRECT_FILE, REDIRECT_HERE_DOCUMENT or REDIRECT_HERE_STRING
+	int redirectOutput;			// binary flag denoting whether output needs redirection or not
+	char *inputRedirect;		// name of the file for redirecting input (the here-document's WORD)
+	char *outputRedirect;		// name of the file for redirecting output
+	int runInBackground;		// binary indicator to denote whether command should run in background
+	int expanded;				// binary flag denoting whether anything was expanded: variables, "$@", file
+								// names, command or process substitutions, or a here-document's body
+	int substituted;			// binary flag denoting whether the output of a $(COMMAND) was substituted
+	char *hereDocument;			// the text a here-document or here-string feeds standard in, or NULL
+	struct processSubstitution *substitutions;	// the <(COMMAND) and >(COMMAND) words, or NULL
+};
+
+// A command line tokenized once, for lines run over and over whose words have to be expanded every time.
+// The words, their parts and the text they point at follow the header in one block of size bytes, found by
+// offsets rather than pointers so the block can be copied as is
+struct commandTemplate
+{
+	size_t size;
+	int numberOfWords;			// words, including one for each | between stages
+	int numberOfParts;
+	int runInBackground;
+	int expanded;				// binary flag denoting whether anything in the line is expanded
+};
 
 /*
  * Function:  parseArgs
  * --------------------------------
- * Utility function to accept and parse input from user
+ * Utility function to parse a line of input from the user in a single pass; returns 0 on success and -1
+ * on a syntax error. Words may be quoted with '' or "" and characters escaped with \; words are split on
+ * spaces and tabs, and | < > & << <<< are recognized without spaces around them. $NAME, ${NAME}, $$, $?
+ * and the positional parameters are expanded outside single quotes; values aren't split into words, and an
+ * unquoted expansion that comes out empty leaves no argument, while a "$@" word becomes one argument per
+ * positional parameter. An argument with an unquoted *, ? or [...] is replaced by the sorted paths it
+ * matches, or kept as typed when none match; each directory is read once per line. Words are unquoted in
+ * place so arguments point into inputBuffer, unless an expansion made the word longer than its text;
+ * those words, matched paths and the argument array come from the arena. $(COMMAND) and `COMMAND` run as
+ * they are reached and are replaced by the command's output without its trailing newlines, split into
+ * arguments at blanks and newlines unless quoted, redirected or assigned to a variable. The bodies of <<WORD
+ * here-documents are the lines after the first, each up to a line holding only WORD (<<-WORD drops leading
+ * tabs), with $ references and command substitutions expanded unless WORD is quoted. <(COMMAND) and
+ * >(COMMAND) words are recorded for processCommand to start
+ *
+ *	inputBuffer: holds the input line, followed by any here-document bodies; it is split in place
+ *  command: assigned the arguments, pipeline stages, redirections and background indicator
+ *  arena: provides the argument array; reset by the caller once the command has run
+ */
+int parseArgs(char *inputBuffer, struct parsedCommand *command, struct arena *arena);
+/*
+ * Function:  compileTemplate
+ * --------------------------------
+ * Tokenizes a line once into a template of its words, whose quotes are already removed and whose $
+ * references, command substitutions and file name patterns are marked to be expanded each time the
+ * template is instantiated. Returns the template in the arena, or NULL if the line has a here-document,
+ * a process substitution or a syntax error, which are left to parseArgs. Nothing runs while compiling
+ *
+ *	line: the line as typed; left untouched
+ *	arena: provides the template
+ */
+struct commandTemplate * compileTemplate(const char *line, struct arena *arena);
+/*
+ * Function:  instantiateTemplate
+ * --------------------------------
+ * Builds a command from a template as parseArgs would build it from the line the template was compiled
+ * from, expanding only the marked parts: $ references are looked up, command substitutions run and file
+ * name patterns are matched again. Returns 0 on success and -1 on a syntax error, which only a pipeline
+ * stage left empty by its expansions can cause
+ *
+ *	template: the template, from compileTemplate
+ *  command: assigned the arguments, pipeline stages, redirections and background indicator
+ *  arena: provides the arguments and the argument array; reset by the caller once the command has run
+ */
+int instantiateTemplate(const struct commandTemplate *template, struct parsedCommand *command, struct arena *arena);
+/*
+ * Function:  buildPattern
+ * --------------------------------
+ * Returns the wildcard pattern of the word starting at source (newly allocated): quotes and escapes are
+ * removed and $ references expanded as for the word itself, but every character that didn't come from
+ * unquoted text is escaped so only the wildcards typed as such match more than themselves
+ *
+ *	source: the start of the word, as typed
+ */
+char * buildPattern(char *source);
+/*
+ * Function:  commandSubstitutionEnd
+ * --------------------------------
+ * Returns where the $(COMMAND) or `COMMAND` at source ends, past its ) or closing `, or NULL if it isn't
+ * closed on its line. Quotes and escapes inside are skipped, and parentheses nest
+ *
+ *	source: points at the $ or `
+ */
+const char * commandSubstitutionEnd(const char *source);
+/*
+ * Function:  hasCommandSubstitution
+ * --------------------------------
+ * Returns 1 if text may hold a $(COMMAND) or `COMMAND` and 0 otherwise. Any $( or ` counts, quoted or not,
+ * since quotes mean nothing in a here-document's body
+ *
+ *	text: the text to check
+ */
+int hasCommandSubstitution(const char *text);
+/*
+ * Function:  opensHereDocument
+ * --------------------------------
+ * Returns 1 if a command has an unquoted <<WORD, whose body is on the lines after it, and 0 otherwise
+ *
+ *	command: the start of the command
+ *	commandEnd: where the command ends
+ */
+int opensHereDocument(const char *command, const char *commandEnd);
+/*
+ * Function:  skipHereDocuments
+ * --------------------------------
+ * Returns where the bodies of the here-documents a command opens end, past the line holding the last
+ * one's WORD, or NULL if the text ends first; bodies itself when the command opens none
  *
- *	inputBuffer: holds each input line given in terminal
- *  inputArgs: array holding each individual argument/command when not a redirection or background process req
- *  redirectInput: binary flag denoting whether input needs redirection or not
- *  redirectOutput: binary glag denoting whether output needs redirection or not
- *	inputRedirect: holds the name of the file for redirecting input
- *  outputRedirect: holds the name of the file for redirecting output
- *	backgroundProcess: binary indicator to denote whether command should be executed in background or foreground
+ *	command: the start of the command
+ *	commandEnd: where the command ends
+ *	bodies: where the first body starts, the line after the command's
+ *	awaitedWord: when the text ends first, assigned the WORD of the unfinished body (newly allocated);
+ *	may be NULL
  */
-void parseArgs(
-	char *inputBuffer, char **inputArgs, int *redirectInput, int *redirectOutput,
-	char *inputRedirect, char *outputRedirect, int *backgroundProcess);
+const char * skipHereDocuments(const char *command, const char *commandEnd, const char *bodies,
+	char **awaitedWord);
 /*
  * Function:  displayPrompt
  * --------------------------------
  * Utility function to display user prompt in terminal
  *
+ *	prompt: the prompt to display, PROMPT or CONTINUATION_PROMPT inside a block
  */
-void displayPrompt();
+void displayPrompt(const char *prompt);
 
 
 #endif /* CLI_H_ */
@@ -0,0 +1,511 @@
+/***********************************************************************************************************
+ * Filename: complete.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements tab completion. Command names come from an in-memory index holding the sorted
+ * executable names of every $PATH directory. Each directory is read once with getdents64 and then watched
+ * with inotify, so a completion only drains the pending events (one non-blocking read) and reads again just
+ * the directories that changed; a directory that can't be watched is compared by modification time instead.
+ * Paths are completed by reading the named directory with getdents64 each time, since it is usually small
+ * and may change between two presses of tab.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "complete.h"
+#include "pathcache.h"
+#include "shell.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+#define EXECUTABLE_WATCH_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | \
+	IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+#define INOTIFY_BUFFER_SIZE 4096
+
+struct executableDirectory
+{
+	char *path;
+	int watch;					// inotify watch descriptor or -1 to compare modification times instead
+	int stale;					// 1 = the names have to be read again
+	struct timespec modified;
+	char **names;				// sorted
+	int numberOfNames;
+};
+
+static struct executableDirectory *directories = NULL;
+static int numberOfDirectories = 0;
+static char *indexedPathVariable = NULL;
+static int inotifyFd = -1;
+
+/**
+* Function: compareNames
+* -------------------------------------------
+* Orders two names for qsort
+*
+* first - points to the first name
+* second - points to the second name
+*/
+static int compareNames(const void *first, const void *second)
+{
+	return strcmp(*(char * const *) first, *(char * const *) second);
+}
+
+/**
+* Function: freeDirectoryNames
+* -------------------------------------------
+* Releases the names read from one directory
+*
+* directory - the directory whose names to release
+*/
+static void freeDirectoryNames(struct executableDirectory *directory)
+{
+	int i;
+	for (i = 0; i < directory->numberOfNames; i++)
+		free(directory->names[i]);
+	free(directory->names);
+	directory->names = NULL;
+	directory->numberOfNames = 0;
+}
+
+/**
+* Function: freeExecutableIndex
+* -------------------------------------------
+* Drops the index of executables and stops watching the $PATH directories
+*/
+void freeExecutableIndex()
+{
+	int i;
+	for (i = 0; i < numberOfDirectories; i++)
+	{
+		freeDirectoryNames(&directories[i]);
+		free(directories[i].path);
+	}
+	free(directories);
+	directories = NULL;
+	numberOfDirectories = 0;
+	free(indexedPathVariable);
+	indexedPathVariable = NULL;
+	// Closing the descriptor removes every watch at once
+	if (inotifyFd >= 0)
+		close(inotifyFd);
+	inotifyFd = -1;
+}
+
+/**
+* Function: isExecutableEntry
+* -------------------------------------------
+* Returns 1 if a directory entry is a regular file the user may execute; 0 otherwise. Only entries whose
+* type getdents64 couldn't tell (or symbolic links) cost a stat
+*
+* directoryFd - the open directory
+* entry - the entry to check
+*/
+static int isExecutableEntry(int directoryFd, struct dirent64 *entry)
+{
+	struct stat fileInfo;
+	if (entry->d_type == DT_DIR)
+		return 0;
+	if (entry->d_type != DT_REG &&
+		(fstatat(directoryFd, entry->d_name, &fileInfo, 0) != 0 || !S_ISREG(fileInfo.st_mode)))
+		return 0;
+	return faccessat(directoryFd, entry->d_name, X_OK, 0) == 0;
+}
+
+/**
+* Function: readExecutableDirectory
+* -------------------------------------------
+* Replaces the names of a $PATH directory with the executables it holds now and watches it if it isn't
+* watched yet. A directory that doesn't exist simply has no names
+*
+* directory - the directory to read
+*/
+static void readExecutableDirectory(struct executableDirectory *directory)
+{
+	char buffer[COMPLETION_DIRECTORY_BUFFER_SIZE];
+	struct dirent64 *entry;
+	struct stat directoryInfo;
+	ssize_t bytesRead;
+	ssize_t offset;
+	int capacity = 0;
+	int directoryFd;
+
+	freeDirectoryNames(directory);
+	directory->stale = 0;
+	memset(&directory->modified, 0, sizeof(directory->modified));
+
+	directoryFd = open(*directory->path ? directory->path : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (directoryFd < 0)
+		return;
+	// Watch before reading so nothing changed in between goes unnoticed; relative directories change with
+	// the working directory, so only their modification time is compared
+	if (directory->watch < 0 && inotifyFd >= 0 && directory->path[0] == '/')
+		directory->watch = inotify_add_watch(inotifyFd, directory->path, EXECUTABLE_WATCH_EVENTS);
+	if (fstat(directoryFd, &directoryInfo) == 0)
+		directory->modified = directoryInfo.st_mtim;
+
+	while ((bytesRead = getdents64(directoryFd, buffer, sizeof(buffer))) > 0)
+	{
+		for (offset = 0; offset < bytesRead; offset += entry->d_reclen)
+		{
+			entry = (struct dirent64 *) (buffer + offset);
+			if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0 ||
+				!isExecutableEntry(directoryFd, entry))
+				continue;
+			if (directory->numberOfNames == capacity)
+			{
+				capacity = capacity ? capacity * 2 : COMPLETION_STARTING_SIZE;
+				directory->names = realloc(directory->names, capacity * sizeof(char *));
+			}
+			directory->names[directory->numberOfNames++] = strdup(entry->d_name);
+		}
+	}
+	close(directoryFd);
+	qsort(directory->names, directory->numberOfNames, sizeof(char *), compareNames);
+}
+
+/**
+* Function: splitPathVariable
+* -------------------------------------------
+* Starts a new index with one stale, unwatched directory per $PATH component
+*
+* pathVariable - the value of $PATH
+*/
+static void splitPathVariable(const char *pathVariable)
+{
+	const char *directory = pathVariable;
+	const char *end;
+	size_t directoryLength;
+
+	indexedPathVariable = strdup(pathVariable);
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	while (1)
+	{
+		end = strchr(directory, ':');
+		directoryLength = end ? (size_t) (end - directory) : strlen(directory);
+		directories = realloc(directories, (numberOfDirectories + 1) * sizeof(struct executableDirectory));
+		memset(&directories[numberOfDirectories], 0, sizeof(struct executableDirectory));
+		// An empty PATH component means the current directory
+		directories[numberOfDirectories].path = strndup(directory, directoryLength);
+		directories[numberOfDirectories].watch = -1;
+		directories[numberOfDirectories].stale = 1;
+		numberOfDirectories++;
+		if (end == NULL)
+			break;
+		directory = end + 1;
+	}
+}
+
+/**
+* Function: drainWatchEvents
+* -------------------------------------------
+* Marks every directory inotify has reported a change in as stale; a directory that was removed or moved
+* loses its watch and is compared by modification time until it is read again
+*/
+static void drainWatchEvents()
+{
+	char buffer[INOTIFY_BUFFER_SIZE] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	struct inotify_event *event;
+	ssize_t bytesRead;
+	ssize_t offset;
+	int i;
+
+	if (inotifyFd < 0)
+		return;
+	while ((bytesRead = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+	{
+		for (offset = 0; offset < bytesRead; offset += sizeof(struct inotify_event) + event->len)
+		{
+			event = (struct inotify_event *) (buffer + offset);
+			// The same directory may appear in $PATH more than once and share a watch
+			for (i = 0; i < numberOfDirectories; i++)
+			{
+				if (directories[i].watch != event->wd)
+					continue;
+				directories[i].stale = 1;
+				if (event->mask & IN_IGNORED)
+					directories[i].watch = -1;
+			}
+		}
+	}
+	// The queue overflowed: there's no telling what changed
+	if (bytesRead < 0 && errno != EAGAIN && errno != EINTR)
+		for (i = 0; i < numberOfDirectories; i++)
+			directories[i].stale = 1;
+}
+
+/**
+* Function: refreshExecutableIndex
+* -------------------------------------------
+* Brings the index of executables on $PATH up to date and returns the number of names in it. The index is
+* built once; after that a directory is only read again once inotify reports a change to it (or, where it
+* can't be watched, once its modification time changes), and everything is rebuilt if $PATH changes
+*/
+int refreshExecutableIndex()
+{
+	const char *pathVariable = currentPathVariable();
+	struct stat directoryInfo;
+	int numberOfNames = 0;
+	int i;
+
+	if (indexedPathVariable == NULL || strcmp(indexedPathVariable, pathVariable) != 0)
+	{
+		freeExecutableIndex();
+		splitPathVariable(pathVariable);
+	}
+	drainWatchEvents();
+
+	for (i = 0; i < numberOfDirectories; i++)
+	{
+		if (!directories[i].stale && directories[i].watch < 0)
+		{
+			if (stat(*directories[i].path ? directories[i].path : ".", &directoryInfo) != 0)
+				memset(&directoryInfo.st_mtim, 0, sizeof(directoryInfo.st_mtim));
+			directories[i].stale = directoryInfo.st_mtim.tv_sec != directories[i].modified.tv_sec ||
+				directoryInfo.st_mtim.tv_nsec != directories[i].modified.tv_nsec;
+		}
+		if (directories[i].stale)
+			readExecutableDirectory(&directories[i]);
+		numberOfNames += directories[i].numberOfNames;
+	}
+	return numberOfNames;
+}
+
+/**
+* Function: addCompletion
+* -------------------------------------------
+* Appends a candidate
+*
+* completions - the candidates so far
+* name - the candidate
+* isDirectory - 1 = end the candidate with '/'
+*/
+static void addCompletion(struct completions *completions, const char *name, int isDirectory)
+{
+	size_t length = strlen(name);
+	char *candidate = malloc(length + 2);
+
+	memcpy(candidate, name, length);
+	if (isDirectory)
+		candidate[length++] = '/';
+	candidate[length] = 0;
+
+	if (completions->numberOfNames == completions->capacity)
+	{
+		completions->capacity = completions->capacity ? completions->capacity * 2 : COMPLETION_STARTING_SIZE;
+		completions->names = realloc(completions->names, completions->capacity * sizeof(char *));
+	}
+	completions->names[completions->numberOfNames++] = candidate;
+}
+
+/**
+* Function: completeCommand
+* -------------------------------------------
+* Adds every builtin and indexed executable starting with the typed text
+*
+* completions - the candidates so far
+* text - what was typed of the command name
+* length - the length of text
+*/
+static void completeCommand(struct completions *completions, const char *text, size_t length)
+{
+	const char *name;
+	int low;
+	int high;
+	int middle;
+	int i;
+
+	for (i = 0; (name = builtinNameAt(i)) != NULL; i++)
+		if (strncmp(name, text, length) == 0)
+			addCompletion(completions, name, 0);
+
+	refreshExecutableIndex();
+	for (i = 0; i < numberOfDirectories; i++)
+	{
+		// The names are sorted, so the matches start at the first name not below the text
+		low = 0;
+		high = directories[i].numberOfNames;
+		while (low < high)
+		{
+			middle = (low + high) / 2;
+			if (strncmp(directories[i].names[middle], text, length) < 0)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		for (; low < directories[i].numberOfNames && strncmp(directories[i].names[low], text, length) == 0; low++)
+			addCompletion(completions, directories[i].names[low], 0);
+	}
+}
+
+/**
+* Function: completePath
+* -------------------------------------------
+* Adds every entry of a directory starting with the typed text; entries starting with '.' only when the
+* text does
+*
+* completions - the candidates so far
+* directoryName - the directory to read, "" for the current one
+* text - what was typed of the entry name
+* length - the length of text
+*/
+static void completePath(struct completions *completions, const char *directoryName, const char *text,
+	size_t length)
+{
+	char buffer[COMPLETION_DIRECTORY_BUFFER_SIZE];
+	struct dirent64 *entry;
+	struct stat fileInfo;
+	ssize_t bytesRead;
+	ssize_t offset;
+	int isDirectory;
+	int directoryFd = open(*directoryName ? directoryName : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+	if (directoryFd < 0)
+		return;
+	while ((bytesRead = getdents64(directoryFd, buffer, sizeof(buffer))) > 0)
+	{
+		for (offset = 0; offset < bytesRead; offset += entry->d_reclen)
+		{
+			entry = (struct dirent64 *) (buffer + offset);
+			if (strncmp(entry->d_name, text, length) != 0 || (entry->d_name[0] == '.' && text[0] != '.') ||
+				strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+				continue;
+			// Symbolic links to directories complete like directories
+			isDirectory = entry->d_type == DT_DIR;
+			if ((entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) &&
+				fstatat(directoryFd, entry->d_name, &fileInfo, 0) == 0)
+				isDirectory = S_ISDIR(fileInfo.st_mode);
+			addCompletion(completions, entry->d_name, isDirectory);
+		}
+	}
+	close(directoryFd);
+}
+
+/**
+* Function: findCompletions
+* -------------------------------------------
+* Collects the candidates for the word in front of the cursor, sorted and without duplicates. The first
+* word of a command (or of a pipeline stage) completes to builtins and executables on $PATH unless it
+* contains a '/'; any other word completes to the entries of the directory it names
+*
+* line - the line being edited
+* cursor - the offset of the cursor in line
+* completions - assigned the candidates; release them with freeCompletions
+*/
+void findCompletions(const char *line, size_t cursor, struct completions *completions)
+{
+	char *word = malloc(cursor + 1);
+	size_t wordLength = 0;
+	size_t componentStart = 0;
+	int inWord = 0;
+	int wordsInStage = 0;
+	int afterRedirect = 0;
+	char quote = 0;
+	char quoteAtStart = 0;
+	char *directoryName;
+	size_t i;
+	int j;
+
+	memset(completions, 0, sizeof(*completions));
+	// Follow the parser's quoting up to the cursor to find where the word starts and what it says
+	for (i = 0; i < cursor; i++)
+	{
+		if (quote == 0 && strchr(" \t|<>&", line[i]) != NULL)
+		{
+			if (inWord && !afterRedirect)
+				wordsInStage++;
+			else if (inWord)
+				afterRedirect = 0;
+			inWord = 0;
+			if (line[i] == '|')
+				wordsInStage = 0;
+			else if (line[i] == '<' || line[i] == '>')
+				afterRedirect = 1;
+			continue;
+		}
+		if (!inWord)
+		{
+			inWord = 1;
+			wordLength = 0;
+			componentStart = 0;
+			completions->replaceFrom = i;
+		}
+		if (quote == 0 && (line[i] == '\'' || line[i] == '"'))
+		{
+			quote = line[i];
+			// A quote opening the part being completed is kept; the candidate goes inside it
+			if (wordLength == componentStart)
+			{
+				completions->replaceFrom = i + 1;
+				quoteAtStart = quote;
+			}
+		}
+		else if (quote != 0 && line[i] == quote)
+			quote = 0;
+		else if (line[i] == '\\' && quote != '\'' && i + 1 < cursor)
+			word[wordLength++] = line[++i];
+		else
+		{
+			word[wordLength++] = line[i];
+			// Only the part after the last '/' is replaced
+			if (line[i] == '/')
+			{
+				componentStart = wordLength;
+				completions->replaceFrom = i + 1;
+				quoteAtStart = quote;
+			}
+		}
+	}
+	if (!inWord)
+	{
+		wordLength = 0;
+		completions->replaceFrom = cursor;
+	}
+	word[wordLength] = 0;
+	completions->quote = quoteAtStart;
+
+	if (wordsInStage == 0 && !afterRedirect && strchr(word, '/') == NULL)
+		completeCommand(completions, word, wordLength);
+	else
+	{
+		directoryName = strndup(word, componentStart);
+		completePath(completions, directoryName, word + componentStart, wordLength - componentStart);
+		free(directoryName);
+	}
+	completions->typedLength = wordLength - componentStart;
+	free(word);
+
+	// A command may be both a builtin and a program, or sit in several $PATH directories
+	qsort(completions->names, completions->numberOfNames, sizeof(char *), compareNames);
+	for (i = 0, j = 0; (int) i < completions->numberOfNames; i++)
+	{
+		if (j > 0 && strcmp(completions->names[j - 1], completions->names[i]) == 0)
+			free(completions->names[i]);
+		else
+			completions->names[j++] = completions->names[i];
+	}
+	completions->numberOfNames = j;
+}
+
+/**
+* Function: freeCompletions
+* -------------------------------------------
+* Releases the candidates found by findCompletions
+*
+* completions - the candidates to release
+*/
+void freeCompletions(struct completions *completions)
+{
+	int i;
+	for (i = 0; i < completions->numberOfNames; i++)
+		free(completions->names[i]);
+	free(completions->names);
+	memset(completions, 0, sizeof(*completions));
+}
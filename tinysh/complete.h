@@ -0,0 +1,65 @@
+/***********************************************************************************************************
+ * Filename: complete.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for tab completion of command names (from an index of the
+ * executables on $PATH) and of paths
+ **********************************************************************************************************/
+
+#ifndef COMPLETE_H_
+#define COMPLETE_H_
+
+#include <stddef.h>
+
+#define COMPLETION_STARTING_SIZE 64
+#define COMPLETION_DIRECTORY_BUFFER_SIZE 32768
+
+// The candidates for the word at the cursor. Each one replaces the line from replaceFrom to the cursor,
+// inside the quote that was open at replaceFrom if any; directories end with '/'
+struct completions
+{
+	char **names;
+	int numberOfNames;
+	int capacity;
+	size_t replaceFrom;
+	size_t typedLength;			// length of what was typed of the word (unescaped) after replaceFrom
+	char quote;					// ' or " when replaceFrom is inside quotes; 0 otherwise
+};
+
+/**
+* Function: findCompletions
+* -------------------------------------------
+* Collects the candidates for the word in front of the cursor, sorted and without duplicates. The first
+* word of a command (or of a pipeline stage) completes to builtins and executables on $PATH unless it
+* contains a '/'; any other word completes to the entries of the directory it names
+*
+* line - the line being edited
+* cursor - the offset of the cursor in line
+* completions - assigned the candidates; release them with freeCompletions
+*/
+void findCompletions(const char *line, size_t cursor, struct completions *completions);
+/**
+* Function: freeCompletions
+* -------------------------------------------
+* Releases the candidates found by findCompletions
+*
+* completions - the candidates to release
+*/
+void freeCompletions(struct completions *completions);
+/**
+* Function: refreshExecutableIndex
+* -------------------------------------------
+* Brings the index of executables on $PATH up to date and returns the number of names in it. The index is
+* built once; after that a directory is only read again once inotify reports a change to it (or, where it
+* can't be watched, once its modification time changes), and everything is rebuilt if $PATH changes
+*/
+int refreshExecutableIndex();
+/**
+* Function: freeExecutableIndex
+* -------------------------------------------
+* Drops the index of executables and stops watching the $PATH directories
+*/
+void freeExecutableIndex();
+
+#endif /* COMPLETE_H_ */
@@ -0,0 +1,1303 @@
+/***********************************************************************************************************
+ * Filename: control.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements if, while, until, for and case blocks, { } groups and function definitions,
+ * compiled once into a flat array of instructions and run by an interpreter loop on top of processCommand
+ **********************************************************************************************************/
+
+#include "control.h"
+#include "events.h"
+#include "functions.h"
+#include "trace.h"
+#include "util.h"
+#include "variables.h"
+#include "wildcard.h"
+
+#include <ctype.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Words that open or close a block wherever a command could start
+static const char *reservedWords[] = {
+	"if", "then", "elif", "else", "fi", "while", "until", "do", "done", "for", "case", "esac", "{", "}", NULL
+};
+
+// Set once by configureBlocks for every block run
+static const int *foregroundOnlyFlag = NULL;
+static int stopBlocksOnError = 0;
+
+// The innermost loop being compiled, for break and continue
+struct loopContext
+{
+	int continueTarget;			// the instruction continue jumps to
+	int breakJumps;				// chain of the jumps break emitted, patched once the loop ends
+	struct loopContext *outer;
+};
+
+struct compiler
+{
+	const char *position;		// the next character to compile
+	struct compiledBlock *block;
+	struct loopContext *loop;
+	int condition;				// > 0 while compiling the condition of an if, while or until
+	int prepare;				// 1 = parse commands and patterns and report errors; 0 = only check nesting
+	int status;					// 0, -1 after a syntax error, BLOCK_INCOMPLETE at the end of unfinished text
+	const char *hereDocumentsEnd;	// past the here-document bodies after the current line, or NULL
+	char *awaitedWord;			// the WORD of a here-document body the text ends inside, or NULL
+};
+
+// What a for loop or case needs while the block runs: its expanded words and the next one to use
+struct blockSlot
+{
+	char **words;				// the words, followed by their text, in one allocation
+	int numberOfWords;
+	int next;
+};
+
+/**
+* Function: endsCommandWord
+* -------------------------------------------
+* Returns 1 if an unquoted character ends a reserved word or a command and 0 otherwise
+*
+* c - the character to check
+*/
+static int endsCommandWord(char c)
+{
+	return c == 0 || c == ' ' || c == '\t' || c == '\n' || c == ';';
+}
+
+/**
+* Function: startsWithWord
+* -------------------------------------------
+* Returns 1 if text starts with a given word standing on its own and 0 otherwise
+*
+* text - the text to check
+* word - the word to look for
+*/
+static int startsWithWord(const char *text, const char *word)
+{
+	size_t length = strlen(word);
+	return strncmp(text, word, length) == 0 && endsCommandWord(text[length]);
+}
+
+/**
+* Function: reservedWordAt
+* -------------------------------------------
+* Returns the reserved word text starts with, or NULL if it starts with any other word
+*
+* text - the text to check
+*/
+static const char * reservedWordAt(const char *text)
+{
+	int i;
+	for (i = 0; reservedWords[i] != NULL; i++)
+		if (startsWithWord(text, reservedWords[i]))
+			return reservedWords[i];
+	return NULL;
+}
+
+/**
+* Function: skipQuoted
+* -------------------------------------------
+* Returns the character after the quote, escape, command substitution or plain character at text. Quotes
+* end at the end of the line at the latest; parseArgs reports the ones left open
+*
+* text - points at the character to skip
+*/
+static const char * skipQuoted(const char *text)
+{
+	char quote = *text;
+	const char *end;
+
+	// A ; or a quote inside $(COMMAND) or `COMMAND` belongs to the substituted command
+	if (quote == '`' || (quote == '$' && text[1] == '('))
+	{
+		end = commandSubstitutionEnd(text);
+		return end != NULL ? end : text + 1;
+	}
+
+	if (quote == '\\')
+		return text[1] != 0 && text[1] != '\n' ? text + 2 : text + 1;
+	if (quote != '\'' && quote != '"')
+		return text + 1;
+	// Between double quotes escapes and command substitutions still count
+	for (text++; *text != 0 && *text != '\n' && *text != quote;)
+		text = quote == '"' && strchr("\\`$", *text) != NULL ? skipQuoted(text) : text + 1;
+	return *text == quote ? text + 1 : text;
+}
+
+/**
+* Function: commandEnd
+* -------------------------------------------
+* Returns where the command starting at text ends: at an unquoted ; or newline, a # starting a word, or
+* the end of the text
+*
+* text - the start of the command
+*/
+static const char * commandEnd(const char *text)
+{
+	const char *start = text;
+
+	while (*text != 0 && *text != '\n' && *text != ';')
+	{
+		if (*text == '#' && (text == start || text[-1] == ' ' || text[-1] == '\t'))
+			break;
+		text = skipQuoted(text);
+	}
+	return text;
+}
+
+/**
+* Function: functionBodyStart
+* -------------------------------------------
+* Returns where the body starts if text begins a function definition, NAME() or NAME (), and NULL
+* otherwise
+*
+* text - the text to check
+* nameEnd - assigned the end of the function's name
+*/
+static const char * functionBodyStart(const char *text, const char **nameEnd)
+{
+	const char *end = text;
+
+	if (!isalpha((unsigned char) *end) && *end != '_')
+		return NULL;
+	while (isalnum((unsigned char) *end) || *end == '_' || *end == '-' || *end == '.')
+		end++;
+	*nameEnd = end;
+	while (*end == ' ' || *end == '\t')
+		end++;
+	return end[0] == '(' && end[1] == ')' ? end + 2 : NULL;
+}
+
+/**
+* Function: startsBlock
+* -------------------------------------------
+* Returns 1 if a line has to be compiled as a block rather than parsed as one command: its first word is a
+* reserved word (if, while, until, for, case, { or one that closes them), it defines a function, it has
+* an unquoted ; or it opens a here-document, whose body is on the lines that follow
+*
+* line - the line to check
+*/
+int startsBlock(const char *line)
+{
+	const char *nameEnd;
+	const char *end;
+
+	while (*line == ' ' || *line == '\t')
+		line++;
+	end = commandEnd(line);
+	return reservedWordAt(line) != NULL || functionBodyStart(line, &nameEnd) != NULL || *end == ';' ||
+		opensHereDocument(line, end);
+}
+
+/**
+* Function: compileError
+* -------------------------------------------
+* Records a syntax error at the word text starts with, reporting it unless only nesting is being checked
+*
+* compiler - the compiler that found the error
+* text - the text that could not be compiled
+*/
+static void compileError(struct compiler *compiler, const char *text)
+{
+	int length = 0;
+
+	if (compiler->status != 0)
+		return;
+	compiler->status = -1;
+	if (!compiler->prepare)
+		return;
+	if (*text == ';')
+		length = text[1] == ';' ? 2 : 1;
+	else
+		while (!endsCommandWord(text[length]))
+			length++;
+	fprintf(stderr, "syntax error near unexpected token `%.*s'\n", length, text);
+}
+
+/**
+* Function: endOfText
+* -------------------------------------------
+* Records that the text ended inside a block; an error once the whole block has been read
+*
+* compiler - the compiler that reached the end
+*/
+static void endOfText(struct compiler *compiler)
+{
+	if (compiler->status != 0)
+		return;
+	compiler->status = BLOCK_INCOMPLETE;
+	if (compiler->prepare)
+	{
+		compiler->status = -1;
+		fprintf(stderr, "syntax error: unexpected end of file\n");
+	}
+}
+
+/**
+* Function: copyText
+* -------------------------------------------
+* Returns a terminated copy of a piece of text, without the blanks at its end, in the block's arena
+*
+* compiler - the compiler whose block keeps the copy
+* start - the first character
+* end - one past the last character
+*/
+static char * copyText(struct compiler *compiler, const char *start, const char *end)
+{
+	char *copy;
+
+	while (end > start && (end[-1] == ' ' || end[-1] == '\t'))
+		end--;
+	copy = arenaAllocate(&compiler->block->arena, end - start + 1);
+	memcpy(copy, start, end - start);
+	copy[end - start] = 0;
+	return copy;
+}
+
+/**
+* Function: emit
+* -------------------------------------------
+* Appends an instruction to the block and returns its index
+*
+* compiler - the compiler building the block
+* opcode - what the instruction does
+* text - the text it works on, or NULL
+*/
+static int emit(struct compiler *compiler, enum blockOpcode opcode, char *text)
+{
+	struct compiledBlock *block = compiler->block;
+	struct instruction *instruction;
+
+	if (block->numberOfInstructions == block->capacity)
+	{
+		block->capacity *= 2;
+		block->instructions = realloc(block->instructions, sizeof(struct instruction) * block->capacity);
+	}
+	instruction = &block->instructions[block->numberOfInstructions];
+	memset(instruction, 0, sizeof(struct instruction));
+	instruction->opcode = opcode;
+	instruction->target = -1;
+	instruction->condition = compiler->condition > 0;
+	instruction->text = text;
+	return block->numberOfInstructions++;
+}
+
+/**
+* Function: chainJump
+* -------------------------------------------
+* Emits a jump whose target isn't known yet, adding it to a chain patched later by patchJumps
+*
+* compiler - the compiler building the block
+* opcode - the kind of jump
+* chain - the chain to add the jump to; -1 when empty
+*/
+static int chainJump(struct compiler *compiler, enum blockOpcode opcode, int chain)
+{
+	int jump = emit(compiler, opcode, NULL);
+	compiler->block->instructions[jump].target = chain;
+	return jump;
+}
+
+/**
+* Function: patchJumps
+* -------------------------------------------
+* Points every jump of a chain at the next instruction to be emitted
+*
+* compiler - the compiler building the block
+* chain - the last jump of the chain; -1 when empty
+*/
+static void patchJumps(struct compiler *compiler, int chain)
+{
+	struct instruction *instructions = compiler->block->instructions;
+	int next;
+
+	while (chain >= 0)
+	{
+		next = instructions[chain].target;
+		instructions[chain].target = compiler->block->numberOfInstructions;
+		chain = next;
+	}
+}
+
+/**
+* Function: skipSeparators
+* -------------------------------------------
+* Moves past blanks, newlines, comments and single ; between commands; a ;; is left to end a case item.
+* The newline ending a line whose commands opened here-documents also moves past their bodies
+*
+* compiler - the compiler to advance
+*/
+static void skipSeparators(struct compiler *compiler)
+{
+	const char *position = compiler->position;
+
+	while (1)
+	{
+		if (*position == '\n' && compiler->hereDocumentsEnd != NULL)
+		{
+			position = compiler->hereDocumentsEnd;
+			compiler->hereDocumentsEnd = NULL;
+		}
+		else if (*position == ' ' || *position == '\t' || *position == '\n' || (*position == ';' && position[1] != ';'))
+			position++;
+		else if (*position == '#')
+			while (*position != 0 && *position != '\n')
+				position++;
+		else
+			break;
+	}
+	compiler->position = position;
+}
+
+/**
+* Function: expectCommandEnd
+* -------------------------------------------
+* Checks that nothing but a separator or comment follows the word closing a block
+*
+* compiler - the compiler to check
+*/
+static void expectCommandEnd(struct compiler *compiler)
+{
+	while (*compiler->position == ' ' || *compiler->position == '\t')
+		compiler->position++;
+	if (*compiler->position != 0 && *compiler->position != '\n' && *compiler->position != ';' &&
+		*compiler->position != '#')
+		compileError(compiler, compiler->position);
+}
+
+/**
+* Function: expectWord
+* -------------------------------------------
+* Moves past a reserved word that must come next, after any separators; returns 0 if it was there and -1
+* otherwise
+*
+* compiler - the compiler to advance
+* word - the word expected
+*/
+static int expectWord(struct compiler *compiler, const char *word)
+{
+	skipSeparators(compiler);
+	if (*compiler->position == 0)
+	{
+		endOfText(compiler);
+		return -1;
+	}
+	if (!startsWithWord(compiler->position, word))
+	{
+		compileError(compiler, compiler->position);
+		return -1;
+	}
+	compiler->position += strlen(word);
+	return 0;
+}
+
+static int compileList(struct compiler *compiler, const char *const *terminators, int allowEmpty);
+
+/**
+* Function: copyCommandText
+* -------------------------------------------
+* Returns a terminated copy of a command, without the blanks at its end, followed on the next lines by the
+* bodies of the here-documents it opens, in the block's arena
+*
+* compiler - the compiler whose block keeps the copy
+* start - the first character of the command
+* end - where the command ends
+* bodies - where the bodies start
+* bodiesEnd - where the bodies end; bodies when the command opens none
+*/
+static char * copyCommandText(struct compiler *compiler, const char *start, const char *end, const char *bodies,
+	const char *bodiesEnd)
+{
+	char *copy;
+	size_t length;
+
+	if (bodiesEnd == bodies)
+		return copyText(compiler, start, end);
+	while (end > start && (end[-1] == ' ' || end[-1] == '\t'))
+		end--;
+	length = end - start;
+	copy = arenaAllocate(&compiler->block->arena, length + 1 + (bodiesEnd - bodies) + 1);
+	memcpy(copy, start, length);
+	copy[length++] = '\n';
+	memcpy(copy + length, bodies, bodiesEnd - bodies);
+	copy[length + (bodiesEnd - bodies)] = 0;
+	return copy;
+}
+
+/**
+* Function: compileSimpleCommand
+* -------------------------------------------
+* Compiles a command up to the next separator, taking the bodies of the here-documents it opens from the
+* lines after its own. Unless it expands variables or file names it is parsed now, so running it again
+* only copies its argument array. Otherwise its words are tokenized into a template, so running it only
+* redoes the expansions; a command substitution would run if it were parsed now, so a command with one is
+* only checked for syntax as it runs
+*
+* compiler - the compiler building the block
+*/
+static void compileSimpleCommand(struct compiler *compiler)
+{
+	const char *end = commandEnd(compiler->position);
+	const char *bodies = compiler->hereDocumentsEnd;
+	const char *bodiesEnd = bodies;
+	char *text;
+	char *parsedText;
+	struct parsedCommand *command;
+	int run;
+
+	// Bodies follow the line in the order their commands come, after those of earlier commands on it
+	if (opensHereDocument(compiler->position, end))
+	{
+		if (bodies == NULL && (bodies = strchr(end, '\n')) != NULL)
+			bodies++;
+		bodiesEnd = skipHereDocuments(compiler->position, end, bodies, &compiler->awaitedWord);
+		if (bodiesEnd == NULL)
+		{
+			compiler->position = end;
+			endOfText(compiler);
+			return;
+		}
+		compiler->hereDocumentsEnd = bodiesEnd;
+	}
+	text = copyCommandText(compiler, compiler->position, end, bodies, bodiesEnd);
+	run = emit(compiler, OP_RUN, text);
+
+	compiler->position = end;
+	if (!compiler->prepare)
+		return;
+	if (!hasCommandSubstitution(text))
+	{
+		// Parsing also checks the syntax, so mistakes show up before anything in the block runs
+		parsedText = copyText(compiler, text, text + strlen(text));
+		command = arenaAllocate(&compiler->block->arena, sizeof(struct parsedCommand));
+		if (parseArgs(parsedText, command, &compiler->block->arena) != 0)
+		{
+			compiler->status = -1;
+			return;
+		}
+		if (!command->expanded)
+		{
+			compiler->block->instructions[run].command = command;
+			return;
+		}
+	}
+	compiler->block->instructions[run].template = compileTemplate(text, &compiler->block->arena);
+}
+
+/**
+* Function: compileIf
+* -------------------------------------------
+* Compiles if CONDITION; then COMMANDS [elif CONDITION; then COMMANDS]... [else COMMANDS] fi. A failed
+* condition jumps past its branch; the end of each branch jumps past the rest
+*
+* compiler - the compiler, positioned after the if
+*/
+static void compileIf(struct compiler *compiler)
+{
+	static const char *const afterCondition[] = { "then", NULL };
+	static const char *const afterBranch[] = { "elif", "else", "fi", NULL };
+	static const char *const afterElse[] = { "fi", NULL };
+	int skipBranch;
+	int endJumps = -1;
+	int found;
+
+	do
+	{
+		compiler->condition++;
+		found = compileList(compiler, afterCondition, 0);
+		compiler->condition--;
+		if (found < 0)
+			return;
+		skipBranch = emit(compiler, OP_JUMP_IF_FAILED, NULL);
+		found = compileList(compiler, afterBranch, 0);
+		if (found < 0)
+			return;
+		endJumps = chainJump(compiler, OP_JUMP, endJumps);
+		patchJumps(compiler, skipBranch);
+	}
+	while (found == 0);
+
+	if (found == 1)
+	{
+		if (compileList(compiler, afterElse, 0) < 0)
+			return;
+	}
+	// Without an else, an if whose conditions all failed still succeeds
+	else
+		emit(compiler, OP_SUCCEED, NULL);
+	patchJumps(compiler, endJumps);
+	expectCommandEnd(compiler);
+}
+
+/**
+* Function: compileLoopBody
+* -------------------------------------------
+* Compiles the COMMANDS done of a loop, with break jumping past the loop and continue to a given
+* instruction, and returns the chain of jumps break emitted
+*
+* compiler - the compiler, positioned after the do
+* continueTarget - where the next iteration starts
+*/
+static int compileLoopBody(struct compiler *compiler, int continueTarget)
+{
+	static const char *const afterBody[] = { "done", NULL };
+	struct loopContext loop;
+	int found;
+
+	loop.continueTarget = continueTarget;
+	loop.breakJumps = -1;
+	loop.outer = compiler->loop;
+	compiler->loop = &loop;
+	found = compileList(compiler, afterBody, 0);
+	compiler->loop = loop.outer;
+	if (found < 0)
+		return -1;
+
+	emit(compiler, OP_JUMP, NULL);
+	compiler->block->instructions[compiler->block->numberOfInstructions - 1].target = continueTarget;
+	return loop.breakJumps;
+}
+
+/**
+* Function: compileWhile
+* -------------------------------------------
+* Compiles while CONDITION; do COMMANDS done, or until, which loops while the condition fails
+*
+* compiler - the compiler, positioned after the while or until
+* until - 1 = until; 0 = while
+*/
+static void compileWhile(struct compiler *compiler, int until)
+{
+	static const char *const afterCondition[] = { "do", NULL };
+	int top = compiler->block->numberOfInstructions;
+	int exitJump;
+	int breakJumps;
+
+	int found;
+
+	compiler->condition++;
+	found = compileList(compiler, afterCondition, 0);
+	compiler->condition--;
+	if (found < 0)
+		return;
+	exitJump = emit(compiler, until ? OP_JUMP_IF_SUCCEEDED : OP_JUMP_IF_FAILED, NULL);
+	breakJumps = compileLoopBody(compiler, top);
+	if (compiler->status != 0)
+		return;
+	patchJumps(compiler, exitJump);
+	patchJumps(compiler, breakJumps);
+	// Leaving through the condition isn't a failure of the loop
+	emit(compiler, OP_SUCCEED, NULL);
+	expectCommandEnd(compiler);
+}
+
+/**
+* Function: compileFor
+* -------------------------------------------
+* Compiles for NAME in WORDS; do COMMANDS done, or for NAME; do COMMANDS done over the positional
+* parameters. The words are expanded once when the loop starts and each iteration only assigns the next one
+*
+* compiler - the compiler, positioned after the for
+*/
+static void compileFor(struct compiler *compiler)
+{
+	static const char allParameters[] = "\"$@\"";
+	const char *name;
+	const char *nameEnd;
+	const char *end;
+	char *words;
+	int slot = compiler->block->numberOfSlots++;
+	int next;
+	int breakJumps;
+
+	while (*compiler->position == ' ' || *compiler->position == '\t')
+		compiler->position++;
+	name = compiler->position;
+	for (end = name; isalnum((unsigned char) *end) || *end == '_'; end++)
+		;
+	if (end == name || isdigit((unsigned char) *name) || !endsCommandWord(*end))
+	{
+		if (*name == 0)
+			endOfText(compiler);
+		else
+			compileError(compiler, name);
+		return;
+	}
+	nameEnd = end;
+	compiler->position = end;
+	while (*compiler->position == ' ' || *compiler->position == '\t')
+		compiler->position++;
+	if (startsWithWord(compiler->position, "in"))
+	{
+		compiler->position += strlen("in");
+		end = commandEnd(compiler->position);
+		words = copyText(compiler, compiler->position, end);
+		compiler->position = end;
+	}
+	else
+		words = copyText(compiler, allParameters, allParameters + strlen(allParameters));
+
+	emit(compiler, OP_FOR_START, words);
+	compiler->block->instructions[compiler->block->numberOfInstructions - 1].slot = slot;
+	next = emit(compiler, OP_FOR_NEXT, copyText(compiler, name, nameEnd));
+	compiler->block->instructions[next].slot = slot;
+	if (expectWord(compiler, "do") < 0)
+		return;
+	breakJumps = compileLoopBody(compiler, next);
+	if (compiler->status != 0)
+		return;
+	patchJumps(compiler, next);
+	patchJumps(compiler, breakJumps);
+	expectCommandEnd(compiler);
+}
+
+/**
+* Function: compileCasePattern
+* -------------------------------------------
+* Compiles the patterns of one case item, up to its ), as matches jumping to the item's commands; returns
+* the chain of those jumps (-1 after an error)
+*
+* compiler - the compiler, positioned at the item
+* slot - the case's slot
+*/
+static int compileCasePattern(struct compiler *compiler, int slot)
+{
+	const char *start;
+	const char *end;
+	char *pattern;
+	int matchJumps = -1;
+	int match;
+
+	if (*compiler->position == '(')
+		compiler->position++;
+	while (1)
+	{
+		while (*compiler->position == ' ' || *compiler->position == '\t')
+			compiler->position++;
+		start = end = compiler->position;
+		while (*end != 0 && *end != '\n' && *end != ';' && *end != '|' && *end != ')')
+			end = skipQuoted(end);
+		if (end == start || (*end != '|' && *end != ')'))
+		{
+			compileError(compiler, end == start ? start : end);
+			return -1;
+		}
+
+		match = chainJump(compiler, OP_CASE_MATCH, matchJumps);
+		matchJumps = match;
+		compiler->block->instructions[match].text = copyText(compiler, start, end);
+		compiler->block->instructions[match].slot = slot;
+		// Patterns without $ references are the same every time, so they are prepared once
+		if (compiler->prepare && strchr(compiler->block->instructions[match].text, '$') == NULL)
+		{
+			pattern = buildPattern(compiler->block->instructions[match].text);
+			compiler->block->instructions[match].pattern = copyText(compiler, pattern, pattern + strlen(pattern));
+			free(pattern);
+		}
+		compiler->position = end + 1;
+		if (*end == ')')
+			return matchJumps;
+	}
+}
+
+/**
+* Function: compileCase
+* -------------------------------------------
+* Compiles case WORD in [(]PATTERN[|PATTERN]...) COMMANDS ;; ... esac. Each item tries its patterns in
+* turn and jumps to the next item when none match; its commands end by jumping past the case
+*
+* compiler - the compiler, positioned after the case
+*/
+static void compileCase(struct compiler *compiler)
+{
+	static const char *const afterItem[] = { ";;", "esac", NULL };
+	const char *word;
+	const char *end;
+	int slot = compiler->block->numberOfSlots++;
+	int matchJumps;
+	int nextItem;
+	int endJumps = -1;
+	int found = 0;
+
+	while (*compiler->position == ' ' || *compiler->position == '\t')
+		compiler->position++;
+	word = end = compiler->position;
+	while (!endsCommandWord(*end))
+		end = skipQuoted(end);
+	if (end == word)
+	{
+		if (*word == 0)
+			endOfText(compiler);
+		else
+			compileError(compiler, word);
+		return;
+	}
+	emit(compiler, OP_CASE_START, copyText(compiler, word, end));
+	compiler->block->instructions[compiler->block->numberOfInstructions - 1].slot = slot;
+	compiler->position = end;
+	if (expectWord(compiler, "in") < 0)
+		return;
+
+	while (found == 0)
+	{
+		skipSeparators(compiler);
+		if (*compiler->position == 0)
+		{
+			endOfText(compiler);
+			return;
+		}
+		if (startsWithWord(compiler->position, "esac"))
+		{
+			compiler->position += strlen("esac");
+			break;
+		}
+		matchJumps = compileCasePattern(compiler, slot);
+		if (matchJumps < 0)
+			return;
+		nextItem = emit(compiler, OP_JUMP, NULL);
+		patchJumps(compiler, matchJumps);
+		// An item may have no commands at all
+		found = compileList(compiler, afterItem, 1);
+		if (found < 0)
+			return;
+		endJumps = chainJump(compiler, OP_JUMP, endJumps);
+		patchJumps(compiler, nextItem);
+	}
+	// A case where no pattern matched still succeeds
+	emit(compiler, OP_SUCCEED, NULL);
+	patchJumps(compiler, endJumps);
+	expectCommandEnd(compiler);
+}
+
+/**
+* Function: compileBreak
+* -------------------------------------------
+* Compiles break, a jump past the innermost loop, or continue, a jump to its next iteration
+*
+* compiler - the compiler, positioned at the break or continue
+* isContinue - 1 = continue; 0 = break
+*/
+static void compileBreak(struct compiler *compiler, int isContinue)
+{
+	int jump;
+
+	compiler->position += strlen(isContinue ? "continue" : "break");
+	if (compiler->loop == NULL)
+	{
+		if (compiler->prepare && compiler->status == 0)
+			fprintf(stderr, "%s: only meaningful in a loop\n", isContinue ? "continue" : "break");
+		compiler->status = compiler->status == 0 ? -1 : compiler->status;
+		return;
+	}
+	if (isContinue)
+	{
+		jump = emit(compiler, OP_JUMP, NULL);
+		compiler->block->instructions[jump].target = compiler->loop->continueTarget;
+	}
+	else
+		compiler->loop->breakJumps = chainJump(compiler, OP_JUMP, compiler->loop->breakJumps);
+	expectCommandEnd(compiler);
+}
+
+/**
+* Function: compileGroup
+* -------------------------------------------
+* Compiles { COMMANDS }, which run in the shell like the commands on their own
+*
+* compiler - the compiler, positioned after the {
+*/
+static void compileGroup(struct compiler *compiler)
+{
+	static const char *const afterGroup[] = { "}", NULL };
+
+	if (compileList(compiler, afterGroup, 0) >= 0)
+		expectCommandEnd(compiler);
+}
+
+/**
+* Function: initializeBlock
+* -------------------------------------------
+* Prepares an empty block to compile into
+*
+* block - the block to initialize
+*/
+static void initializeBlock(struct compiledBlock *block)
+{
+	block->capacity = BLOCK_STARTING_INSTRUCTIONS;
+	block->numberOfInstructions = 0;
+	block->numberOfSlots = 0;
+	block->references = 1;
+	block->instructions = malloc(sizeof(struct instruction) * block->capacity);
+	initializeArena(&block->arena);
+}
+
+/**
+* Function: compileFunction
+* -------------------------------------------
+* Compiles NAME() { COMMANDS } into a block of its own, which an OP_DEFINE instruction hands to the
+* function table when the definition runs
+*
+* compiler - the compiler, positioned after the ()
+* name - the start of the function's name
+* nameEnd - the end of the function's name
+*/
+static void compileFunction(struct compiler *compiler, const char *name, const char *nameEnd)
+{
+	static const char *const afterBody[] = { "}", NULL };
+	struct compiledBlock *outer = compiler->block;
+	struct loopContext *loop = compiler->loop;
+	int condition = compiler->condition;
+	int define;
+
+	// The { may be on the next line
+	if (expectWord(compiler, "{") < 0)
+		return;
+	define = emit(compiler, OP_DEFINE, copyText(compiler, name, nameEnd));
+	outer->instructions[define].function = malloc(sizeof(struct compiledBlock));
+	initializeBlock(outer->instructions[define].function);
+
+	// break, continue and conditions don't reach into the body from around the definition
+	compiler->block = outer->instructions[define].function;
+	compiler->loop = NULL;
+	compiler->condition = 0;
+	compileList(compiler, afterBody, 0);
+	compiler->block = outer;
+	compiler->loop = loop;
+	compiler->condition = condition;
+	if (compiler->status == 0)
+		expectCommandEnd(compiler);
+}
+
+/**
+* Function: compileCommand
+* -------------------------------------------
+* Compiles the block or simple command at the compiler's position
+*
+* compiler - the compiler building the block
+*/
+static void compileCommand(struct compiler *compiler)
+{
+	const char *word = reservedWordAt(compiler->position);
+	const char *start = compiler->position;
+	const char *nameEnd;
+	const char *body;
+
+	if (word == NULL)
+	{
+		if ((body = functionBodyStart(start, &nameEnd)) != NULL)
+		{
+			compiler->position = body;
+			compileFunction(compiler, start, nameEnd);
+		}
+		else if (startsWithWord(start, "break") || startsWithWord(start, "continue"))
+			compileBreak(compiler, *start == 'c');
+		else if (*start == ';')
+			compileError(compiler, start);
+		else
+			compileSimpleCommand(compiler);
+		return;
+	}
+	compiler->position += strlen(word);
+	if (strcmp(word, "if") == 0)
+		compileIf(compiler);
+	else if (strcmp(word, "while") == 0 || strcmp(word, "until") == 0)
+		compileWhile(compiler, *word == 'u');
+	else if (strcmp(word, "for") == 0)
+		compileFor(compiler);
+	else if (strcmp(word, "case") == 0)
+		compileCase(compiler);
+	else if (strcmp(word, "{") == 0)
+		compileGroup(compiler);
+	// A word that closes a block can't start a command
+	else
+		compileError(compiler, start);
+}
+
+/**
+* Function: compileList
+* -------------------------------------------
+* Compiles commands until one of the given reserved words and returns which one ended the list (-1 after
+* an error). Without terminators the list runs to the end of the text
+*
+* compiler - the compiler building the block
+* terminators - the words that end the list, ending with NULL; NULL at the top of the block
+* allowEmpty - 1 = the list may have no commands
+*/
+static int compileList(struct compiler *compiler, const char *const *terminators, int allowEmpty)
+{
+	int numberOfCommands = 0;
+	int i;
+
+	while (compiler->status == 0)
+	{
+		skipSeparators(compiler);
+		if (*compiler->position == 0)
+		{
+			if (terminators == NULL)
+				return 0;
+			endOfText(compiler);
+			return -1;
+		}
+		for (i = 0; terminators != NULL && terminators[i] != NULL; i++)
+		{
+			// ;; needs nothing after it, unlike the reserved words
+			if (*terminators[i] == ';' ? strncmp(compiler->position, terminators[i], 2) == 0 :
+				startsWithWord(compiler->position, terminators[i]))
+			{
+				if (numberOfCommands == 0 && !allowEmpty)
+				{
+					compileError(compiler, compiler->position);
+					return -1;
+				}
+				compiler->position += strlen(terminators[i]);
+				return i;
+			}
+		}
+		compileCommand(compiler);
+		numberOfCommands++;
+	}
+	return -1;
+}
+
+/**
+* Function: compile
+* -------------------------------------------
+* Compiles text into a block and returns 0, -1 after a syntax error or BLOCK_INCOMPLETE
+*
+* text - the lines of the block, separated by newlines
+* block - assigned the compiled block; freed by the caller whatever the result
+* prepare - 1 = parse commands and patterns and report errors; 0 = only check nesting
+* awaitedWord - if not NULL, assigned the WORD of the here-document body the text ends inside (newly
+* allocated), or NULL
+*/
+static int compile(const char *text, struct compiledBlock *block, int prepare, char **awaitedWord)
+{
+	struct compiler compiler;
+
+	initializeBlock(block);
+	compiler.position = text;
+	compiler.block = block;
+	compiler.loop = NULL;
+	compiler.condition = 0;
+	compiler.prepare = prepare;
+	compiler.status = 0;
+	compiler.hereDocumentsEnd = NULL;
+	compiler.awaitedWord = NULL;
+	compileList(&compiler, NULL, 1);
+	if (awaitedWord != NULL)
+		*awaitedWord = compiler.awaitedWord;
+	else
+		free(compiler.awaitedWord);
+	return compiler.status;
+}
+
+/**
+* Function: checkBlock
+* -------------------------------------------
+* Returns BLOCK_INCOMPLETE if text ends inside an if, loop, case or here-document and 0 otherwise, without
+* reporting errors or preparing commands, so lines can be gathered until the block is whole
+*
+* text - the lines of the block so far, separated by newlines
+* awaitedWord - assigned the WORD of the here-document body the text ends inside (newly allocated), or
+* NULL; no line before the one holding it can complete the block
+*/
+int checkBlock(const char *text, char **awaitedWord)
+{
+	struct compiledBlock block;
+	int result = compile(text, &block, 0, awaitedWord);
+
+	freeBlock(&block);
+	return result == BLOCK_INCOMPLETE ? BLOCK_INCOMPLETE : 0;
+}
+
+/**
+* Function: compileBlock
+* -------------------------------------------
+* Compiles text into instructions; returns 0 on success and -1 after reporting a syntax error. Commands
+* and case patterns without expansions are parsed here once, however many times they run
+*
+* text - the lines of the block, separated by newlines
+* block - assigned the compiled block; freed with freeBlock on success
+*/
+int compileBlock(const char *text, struct compiledBlock *block)
+{
+	if (compile(text, block, 1, NULL) == 0)
+		return 0;
+	freeBlock(block);
+	return -1;
+}
+
+/**
+* Function: commandFailed
+* -------------------------------------------
+* Returns 1 if the last command failed or was killed by a signal and 0 otherwise
+*
+* status - the shell's status
+*/
+static int commandFailed(struct shellStatus *status)
+{
+	return status->terminationStatus != 0 || status->signalOrTerminated != 0;
+}
+
+/**
+* Function: expandWords
+* -------------------------------------------
+* Expands a word list as arguments are expanded and keeps the words in a slot for the rest of the loop
+*
+* text - the words as typed
+* slot - assigned the words; its previous words are released
+* arena - provides the parse, released before returning
+*/
+static void expandWords(const char *text, struct blockSlot *slot, struct arena *arena)
+{
+	struct arenaMark mark = markArena(arena);
+	struct parsedCommand words;
+	size_t length = strlen(text);
+	size_t size = 0;
+	char *copy = arenaAllocate(arena, length + 1);
+	char *storage;
+	int numberOfWords = 0;
+	int i;
+
+	memcpy(copy, text, length + 1);
+	free(slot->words);
+	slot->words = NULL;
+	slot->numberOfWords = 0;
+	slot->next = 0;
+	if (parseArgs(copy, &words, arena) == 0)
+	{
+		for (i = 0; i < words.numberOfArgs; i++)
+			if (words.args[i] != NULL)
+			{
+				size += strlen(words.args[i]) + 1;
+				numberOfWords++;
+			}
+		slot->words = malloc(sizeof(char *) * numberOfWords + size + 1);
+		storage = (char *) (slot->words + numberOfWords);
+		for (i = 0; i < words.numberOfArgs; i++)
+		{
+			if (words.args[i] == NULL)
+				continue;
+			length = strlen(words.args[i]) + 1;
+			memcpy(storage, words.args[i], length);
+			slot->words[slot->numberOfWords++] = storage;
+			storage += length;
+		}
+	}
+	rewindArena(arena, mark);
+}
+
+/**
+* Function: matchesCase
+* -------------------------------------------
+* Returns 1 if the word of a case matches the pattern of a case item and 0 otherwise
+*
+* instruction - the OP_CASE_MATCH instruction
+* slot - the case's slot
+*/
+static int matchesCase(struct instruction *instruction, struct blockSlot *slot)
+{
+	const char *word = slot->numberOfWords > 0 ? slot->words[0] : "";
+	char *pattern;
+	int matched;
+
+	if (instruction->pattern != NULL)
+		return matchPattern(instruction->pattern, word);
+	pattern = buildPattern(instruction->text);
+	matched = matchPattern(pattern, word);
+	free(pattern);
+	return matched;
+}
+
+/**
+* Function: runCommandInstruction
+* -------------------------------------------
+* Runs the command of an OP_RUN instruction through processCommand, parsing it first unless it was parsed
+* or tokenized into a template when the block was compiled, then reports background processes that
+* finished
+*
+* instruction - the OP_RUN instruction
+* status - the shell's status
+* arena - provides the command's arguments, released once it is done
+*/
+static void runCommandInstruction(struct instruction *instruction, struct shellStatus *status, struct arena *arena)
+{
+	struct arenaMark mark = markArena(arena);
+	struct parsedCommand command;
+	size_t length;
+	char *text;
+	int parseStatus = 0;
+
+	markParseStart();
+	if (instruction->command != NULL)
+	{
+		// processCommand may adjust the command, so each run gets its own copy of the argument array
+		command = *instruction->command;
+		command.args = arenaAllocate(arena, sizeof(char *) * command.numberOfArgs);
+		memcpy(command.args, instruction->command->args, sizeof(char *) * command.numberOfArgs);
+	}
+	else if (instruction->template != NULL)
+		parseStatus = instantiateTemplate(instruction->template, &command, arena);
+	else
+	{
+		length = strlen(instruction->text);
+		text = arenaAllocate(arena, length + 1);
+		memcpy(text, instruction->text, length + 1);
+		parseStatus = parseArgs(text, &command, arena);
+	}
+
+	if (parseStatus != 0)
+	{
+		status->terminationStatus = 2;
+		status->signalOrTerminated = 0;
+	}
+	else if (command.args[0] != NULL)
+	{
+		command.runInBackground = resolveBackgroundRun(
+			foregroundOnlyFlag != NULL && *foregroundOnlyFlag, command.runInBackground);
+		processCommand(&command, status);
+	}
+	rewindArena(arena, mark);
+	processPendingEvents();
+}
+
+/**
+* Function: configureBlocks
+* -------------------------------------------
+* Sets how every block runs, functions included
+*
+* foregroundOnly - the foreground-only flag, read before each command since ^Z may change it
+* stopOnError - 1 = stop at the first command with a non-zero status (smallsh -e)
+*/
+void configureBlocks(const int *foregroundOnly, int stopOnError)
+{
+	foregroundOnlyFlag = foregroundOnly;
+	stopBlocksOnError = stopOnError;
+}
+
+/**
+* Function: runBlock
+* -------------------------------------------
+* Runs a compiled block and returns 0, or -1 if it was cut short: by a failing command under smallsh -e
+* (conditions excepted) or by a command interrupted with ^C. 'exit' and 'return' also end it. Each command
+* goes through processCommand and its parse is released from the arena once it is done
+*
+* block - the block to run
+* status - the exit and return indicators and the last known termination status
+* arena - provides each command's arguments
+*/
+int runBlock(struct compiledBlock *block, struct shellStatus *status, struct arena *arena)
+{
+	struct blockSlot *slots = NULL;
+	struct instruction *instruction;
+	struct blockSlot *slot;
+	int next = 0;
+	int result = 0;
+	int i;
+
+	// Blocks without loops or cases, like most function bodies, run without allocating anything
+	if (block->numberOfSlots > 0)
+		slots = calloc(block->numberOfSlots, sizeof(struct blockSlot));
+	while (next < block->numberOfInstructions && !status->exitIndicator && !status->returnIndicator)
+	{
+		instruction = &block->instructions[next++];
+		slot = slots != NULL ? &slots[instruction->slot] : NULL;
+		switch (instruction->opcode)
+		{
+			case OP_RUN:
+				runCommandInstruction(instruction, status, arena);
+				// The shell ignores ^C, so a command it killed is what stops a loop
+				if ((status->signalOrTerminated && status->terminationStatus == SIGINT) ||
+					(stopBlocksOnError && !instruction->condition && commandFailed(status)))
+				{
+					result = -1;
+					next = block->numberOfInstructions;
+				}
+				break;
+			case OP_JUMP:
+				next = instruction->target;
+				break;
+			case OP_JUMP_IF_FAILED:
+				if (commandFailed(status))
+					next = instruction->target;
+				break;
+			case OP_JUMP_IF_SUCCEEDED:
+				if (!commandFailed(status))
+					next = instruction->target;
+				break;
+			case OP_SUCCEED:
+				status->terminationStatus = 0;
+				status->signalOrTerminated = 0;
+				break;
+			case OP_FOR_START:
+				expandWords(instruction->text, slot, arena);
+				status->terminationStatus = 0;
+				status->signalOrTerminated = 0;
+				break;
+			case OP_FOR_NEXT:
+				if (slot->next < slot->numberOfWords)
+					setVariable(instruction->text, slot->words[slot->next++], VARIABLE_KEEP_EXPORT);
+				else
+					next = instruction->target;
+				break;
+			case OP_CASE_START:
+				expandWords(instruction->text, slot, arena);
+				break;
+			case OP_CASE_MATCH:
+				if (matchesCase(instruction, slot))
+					next = instruction->target;
+				break;
+			case OP_DEFINE:
+				defineFunction(instruction->text, instruction->function);
+				status->terminationStatus = 0;
+				status->signalOrTerminated = 0;
+				break;
+		}
+	}
+
+	for (i = 0; i < block->numberOfSlots; i++)
+		free(slots[i].words);
+	free(slots);
+	return result;
+}
+
+/**
+* Function: freeBlock
+* -------------------------------------------
+* Releases a compiled block, and the bodies of the functions it defines unless they are still defined
+*
+* block - the block to free
+*/
+void freeBlock(struct compiledBlock *block)
+{
+	int i;
+
+	for (i = 0; i < block->numberOfInstructions; i++)
+		if (block->instructions[i].opcode == OP_DEFINE && block->instructions[i].function != NULL)
+			releaseBlock(block->instructions[i].function);
+	free(block->instructions);
+	block->instructions = NULL;
+	block->numberOfInstructions = 0;
+	freeArena(&block->arena);
+}
+
+/**
+* Function: releaseBlock
+* -------------------------------------------
+* Drops one reference to a function body, freeing it once nothing holds it
+*
+* block - the body to release
+*/
+void releaseBlock(struct compiledBlock *block)
+{
+	if (--block->references > 0)
+		return;
+	freeBlock(block);
+	free(block);
+}
@@ -0,0 +1,130 @@
+/***********************************************************************************************************
+ * Filename: control.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for if, while, until, for and case blocks, { } groups and function
+ * definitions, compiled once into a flat array of instructions and run by an interpreter loop on top of
+ * processCommand
+ **********************************************************************************************************/
+
+#ifndef CONTROL_H_
+#define CONTROL_H_
+
+#include "arena.h"
+#include "cli.h"
+#include "shell.h"
+
+#define BLOCK_STARTING_INSTRUCTIONS 32
+// Returned by checkBlock when the text ends inside an if, loop or case that needs more lines
+#define BLOCK_INCOMPLETE 1
+
+enum blockOpcode
+{
+	OP_RUN,						// run the command in text
+	OP_JUMP,					// continue at target
+	OP_JUMP_IF_FAILED,			// continue at target when the last command failed
+	OP_JUMP_IF_SUCCEEDED,		// continue at target when the last command succeeded
+	OP_SUCCEED,					// set the status to 0
+	OP_FOR_START,				// expand the word list in text into the loop's slot
+	OP_FOR_NEXT,				// assign the next word to the variable named by text, or continue at target
+	OP_CASE_START,				// expand the word in text into the case's slot
+	OP_CASE_MATCH,				// continue at target when the case's word matches the pattern in text
+	OP_DEFINE					// define the function named by text with the compiled body in function
+};
+
+struct instruction
+{
+	enum blockOpcode opcode;
+	int target;					// where a jump continues; chains unpatched jumps while compiling
+	int slot;					// the loop or case the instruction belongs to
+	int condition;				// binary flag denoting a command whose failure only decides a branch
+	char *text;					// the command, word list, variable name or pattern as typed
+	char *pattern;				// OP_CASE_MATCH: the pattern prepared once when it has no $ references
+	struct parsedCommand *command;	// OP_RUN: the command parsed once when it has no expansions
+	struct commandTemplate *template;	// OP_RUN: otherwise its words tokenized once, expanded each run
+	struct compiledBlock *function;	// OP_DEFINE: the function's body
+};
+
+// One compiled block; instructions, text and prepared commands stay valid until freeBlock
+struct compiledBlock
+{
+	struct instruction *instructions;
+	int numberOfInstructions;
+	int capacity;
+	int numberOfSlots;			// for loops and case words, each with its own state while running
+	int references;				// function bodies: the definitions and running calls holding the body
+	struct arena arena;			// text, prepared commands, templates and patterns
+};
+
+/**
+* Function: startsBlock
+* -------------------------------------------
+* Returns 1 if a line has to be compiled as a block rather than parsed as one command: its first word is a
+* reserved word (if, while, until, for, case, { or one that closes them), it defines a function or it has
+* an unquoted ;
+*
+* line - the line to check
+*/
+int startsBlock(const char *line);
+/**
+* Function: checkBlock
+* -------------------------------------------
+* Returns BLOCK_INCOMPLETE if text ends inside an if, loop, case or here-document and 0 otherwise, without
+* reporting errors or preparing commands, so lines can be gathered until the block is whole
+*
+* text - the lines of the block so far, separated by newlines
+* awaitedWord - assigned the WORD of the here-document body the text ends inside (newly allocated), or
+* NULL; no line before the one holding it can complete the block
+*/
+int checkBlock(const char *text, char **awaitedWord);
+/**
+* Function: compileBlock
+* -------------------------------------------
+* Compiles text into instructions; returns 0 on success and -1 after reporting a syntax error. Commands
+* and case patterns without expansions are parsed here once, however many times they run; commands with
+* expansions are tokenized once into a template that only has its expansions redone
+*
+* text - the lines of the block, separated by newlines
+* block - assigned the compiled block; freed with freeBlock on success
+*/
+int compileBlock(const char *text, struct compiledBlock *block);
+/**
+* Function: configureBlocks
+* -------------------------------------------
+* Sets how every block runs, functions included
+*
+* foregroundOnly - the foreground-only flag, read before each command since ^Z may change it
+* stopOnError - 1 = stop at the first command with a non-zero status (smallsh -e)
+*/
+void configureBlocks(const int *foregroundOnly, int stopOnError);
+/**
+* Function: runBlock
+* -------------------------------------------
+* Runs a compiled block and returns 0, or -1 if it was cut short: by a failing command under smallsh -e
+* (conditions excepted) or by a command interrupted with ^C. 'exit' and 'return' also end it. Each command
+* goes through processCommand and its parse is released from the arena once it is done
+*
+* block - the block to run
+* status - the exit and return indicators and the last known termination status
+* arena - provides each command's arguments
+*/
+int runBlock(struct compiledBlock *block, struct shellStatus *status, struct arena *arena);
+/**
+* Function: freeBlock
+* -------------------------------------------
+* Releases a compiled block, and the bodies of the functions it defines unless they are still defined
+*
+* block - the block to free
+*/
+void freeBlock(struct compiledBlock *block);
+/**
+* Function: releaseBlock
+* -------------------------------------------
+* Drops one reference to a function body, freeing it once nothing holds it
+*
+* block - the body to release
+*/
+void releaseBlock(struct compiledBlock *block);
+
+#endif /* CONTROL_H_ */
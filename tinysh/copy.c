@@ -0,0 +1,337 @@
+/***********************************************************************************************************
+ * Filename: copy.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements copying between descriptors and the 'cat' and 'cp' builtins. The method is picked
+ * from the descriptor types so the bytes stay in the kernel: copy_file_range between regular files (which
+ * may share extents instead of copying on filesystems that support it), sendfile out of a regular file and
+ * splice through a pipe. When the kernel turns a method down for this pair of descriptors the copy carries
+ * on from the same offsets with the next one, ending with a read/write loop through one large buffer.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "copy.h"
+#include "util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+
+#define COPY_DONE 0
+#define COPY_FAILED -1
+#define COPY_UNSUPPORTED 1
+
+// The kernel call behind one copy method; returns bytes moved, 0 at end of file or -1
+typedef ssize_t (*copyCall)(int inputFd, int outputFd);
+
+/**
+* Function: copyFileRange
+* -------------------------------------------
+* Moves one chunk with copy_file_range; both descriptors have to be regular files
+*
+* inputFd - the descriptor to read
+* outputFd - the descriptor to write
+*/
+static ssize_t copyFileRange(int inputFd, int outputFd)
+{
+	return copy_file_range(inputFd, NULL, outputFd, NULL, COPY_CHUNK_SIZE, 0);
+}
+
+/**
+* Function: sendFile
+* -------------------------------------------
+* Moves one chunk with sendfile; the input has to be a regular file
+*
+* inputFd - the descriptor to read
+* outputFd - the descriptor to write
+*/
+static ssize_t sendFile(int inputFd, int outputFd)
+{
+	return sendfile(outputFd, inputFd, NULL, COPY_CHUNK_SIZE);
+}
+
+/**
+* Function: splicePipe
+* -------------------------------------------
+* Moves one chunk with splice; one of the descriptors has to be a pipe
+*
+* inputFd - the descriptor to read
+* outputFd - the descriptor to write
+*/
+static ssize_t splicePipe(int inputFd, int outputFd)
+{
+	return splice(inputFd, NULL, outputFd, NULL, COPY_CHUNK_SIZE, SPLICE_F_MOVE);
+}
+
+/**
+* Function: copyWith
+* -------------------------------------------
+* Copies until end of file with one method; returns COPY_DONE, COPY_FAILED, or COPY_UNSUPPORTED when the
+* kernel can't use the method for these descriptors (the offsets then still point at what is left)
+*
+* call - the method
+* inputFd - the descriptor to read
+* outputFd - the descriptor to write
+* copied - increased by the number of bytes moved
+*/
+static int copyWith(copyCall call, int inputFd, int outputFd, off_t *copied)
+{
+	ssize_t result;
+
+	while (1)
+	{
+		result = call(inputFd, outputFd);
+		if (result > 0)
+		{
+			*copied += result;
+			continue;
+		}
+		if (result == 0)
+			return COPY_DONE;
+		if (errno == EINTR)
+			continue;
+		// EXDEV: different filesystems (older kernels); EINVAL: O_APPEND output or a type the call can't use
+		if (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF)
+			return COPY_UNSUPPORTED;
+		return COPY_FAILED;
+	}
+}
+
+/**
+* Function: copyThroughBuffer
+* -------------------------------------------
+* Copies until end of file with read and write; returns COPY_DONE or COPY_FAILED
+*
+* inputFd - the descriptor to read
+* outputFd - the descriptor to write
+* copied - increased by the number of bytes moved
+*/
+static int copyThroughBuffer(int inputFd, int outputFd, off_t *copied)
+{
+	static char *buffer = NULL;
+	ssize_t bytesRead;
+
+	if (buffer == NULL && (buffer = malloc(COPY_BUFFER_SIZE)) == NULL)
+		return COPY_FAILED;
+	while (1)
+	{
+		bytesRead = read(inputFd, buffer, COPY_BUFFER_SIZE);
+		if (bytesRead == 0)
+			return COPY_DONE;
+		if (bytesRead < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return COPY_FAILED;
+		}
+		if (writeAll(outputFd, buffer, bytesRead) < 0)
+			return COPY_FAILED;
+		*copied += bytesRead;
+	}
+}
+
+/**
+* Function: copyFileData
+* -------------------------------------------
+* Copies everything from one descriptor to another, starting at their current offsets, and returns the
+* number of bytes copied or -1 on error (errno set). The kernel moves the bytes whenever it can:
+* copy_file_range between two regular files, sendfile from a regular file, splice when either side is a
+* pipe; anything else goes through a read/write loop
+*
+* inputFd - the descriptor to read until end of file
+* outputFd - the descriptor to write to
+*/
+off_t copyFileData(int inputFd, int outputFd)
+{
+	int result = COPY_UNSUPPORTED;
+	off_t copied = 0;
+	struct stat inputStat;
+	struct stat outputStat;
+
+	if (fstat(inputFd, &inputStat) < 0 || fstat(outputFd, &outputStat) < 0)
+		return -1;
+
+	if (S_ISREG(inputStat.st_mode) && S_ISREG(outputStat.st_mode))
+		result = copyWith(copyFileRange, inputFd, outputFd, &copied);
+	if (result == COPY_UNSUPPORTED && S_ISREG(inputStat.st_mode))
+		result = copyWith(sendFile, inputFd, outputFd, &copied);
+	if (result == COPY_UNSUPPORTED && (S_ISFIFO(inputStat.st_mode) || S_ISFIFO(outputStat.st_mode)))
+		result = copyWith(splicePipe, inputFd, outputFd, &copied);
+	if (result == COPY_UNSUPPORTED)
+		result = copyThroughBuffer(inputFd, outputFd, &copied);
+
+	return result == COPY_DONE ? copied : -1;
+}
+
+/**
+* Function: executeCatCommand
+* -------------------------------------------
+* Defines logic for the 'cat' shell command, which writes each file in turn to standard out
+*	cat [-u] [file...] - '-' or no file at all stands for standard in; -u is accepted and ignored
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - standard in for the command
+* outputFd - standard out for the command
+* status - unused
+*/
+int executeCatCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int i = 1;
+	int fileFd;
+	int result = 0;
+
+	while (inputArgs[i] != NULL && strcmp(inputArgs[i], "-u") == 0)
+		i++;
+	if (inputArgs[i] != NULL && strcmp(inputArgs[i], "--") == 0)
+		i++;
+
+	if (inputArgs[i] == NULL)
+	{
+		if (copyFileData(inputFd, outputFd) < 0)
+		{
+			perror("cat");
+			return 1;
+		}
+		return 0;
+	}
+
+	for (; inputArgs[i] != NULL; i++)
+	{
+		if (strcmp(inputArgs[i], "-") == 0)
+			fileFd = inputFd;
+		else if ((fileFd = open(inputArgs[i], O_RDONLY | O_CLOEXEC)) < 0)
+		{
+			fprintf(stderr, "cat: %s: %s\n", inputArgs[i], strerror(errno));
+			result = 1;
+			continue;
+		}
+		if (copyFileData(fileFd, outputFd) < 0)
+		{
+			fprintf(stderr, "cat: %s: %s\n", inputArgs[i], strerror(errno));
+			result = 1;
+		}
+		if (fileFd != inputFd)
+			close(fileFd);
+	}
+	return result;
+}
+
+/**
+* Function: copyOneFile
+* -------------------------------------------
+* Copies a regular file to a path, creating it with the source's permissions or truncating it; returns 0 on
+* success and 1 after printing an error
+*
+* source - the file to copy
+* destination - the path to copy it to
+*/
+static int copyOneFile(const char *source, const char *destination)
+{
+	int sourceFd;
+	int destinationFd;
+	int result = 0;
+	struct stat sourceStat;
+	struct stat destinationStat;
+
+	if ((sourceFd = open(source, O_RDONLY | O_CLOEXEC)) < 0 || fstat(sourceFd, &sourceStat) < 0)
+	{
+		fprintf(stderr, "cp: %s: %s\n", source, strerror(errno));
+		if (sourceFd >= 0)
+			close(sourceFd);
+		return 1;
+	}
+	if (S_ISDIR(sourceStat.st_mode))
+	{
+		fprintf(stderr, "cp: omitting directory %s\n", source);
+		close(sourceFd);
+		return 1;
+	}
+	// Truncating the destination first would destroy the source
+	if (stat(destination, &destinationStat) == 0 && destinationStat.st_dev == sourceStat.st_dev
+		&& destinationStat.st_ino == sourceStat.st_ino)
+	{
+		fprintf(stderr, "cp: %s and %s are the same file\n", source, destination);
+		close(sourceFd);
+		return 1;
+	}
+
+	destinationFd = open(destination, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, sourceStat.st_mode & 0777);
+	if (destinationFd < 0)
+	{
+		fprintf(stderr, "cp: %s: %s\n", destination, strerror(errno));
+		close(sourceFd);
+		return 1;
+	}
+	if (copyFileData(sourceFd, destinationFd) < 0)
+	{
+		fprintf(stderr, "cp: %s: %s\n", destination, strerror(errno));
+		result = 1;
+	}
+	close(sourceFd);
+	if (close(destinationFd) < 0 && result == 0)
+	{
+		fprintf(stderr, "cp: %s: %s\n", destination, strerror(errno));
+		result = 1;
+	}
+	return result;
+}
+
+/**
+* Function: executeCpCommand
+* -------------------------------------------
+* Defines logic for the 'cp' shell command, which copies regular files
+*	cp source destination     - copy source to destination, created with source's permissions
+*	cp source... directory    - copy each source into directory under its own name
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - unused
+* status - unused
+*/
+int executeCpCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int i;
+	int result = 0;
+	int numberOfArgs = 0;
+	int intoDirectory;
+	char *target;
+	char *destination;
+	const char *name;
+	struct stat targetStat;
+
+	while (inputArgs[numberOfArgs] != NULL)
+		numberOfArgs++;
+	if (numberOfArgs < 3)
+	{
+		fprintf(stderr, "cp: usage: cp source destination | cp source... directory\n");
+		return 1;
+	}
+
+	target = inputArgs[numberOfArgs - 1];
+	intoDirectory = stat(target, &targetStat) == 0 && S_ISDIR(targetStat.st_mode);
+	if (!intoDirectory && numberOfArgs > 3)
+	{
+		fprintf(stderr, "cp: %s: not a directory\n", target);
+		return 1;
+	}
+	if (!intoDirectory)
+		return copyOneFile(inputArgs[1], target);
+
+	for (i = 1; i < numberOfArgs - 1; i++)
+	{
+		name = strrchr(inputArgs[i], '/');
+		name = name != NULL ? name + 1 : inputArgs[i];
+		destination = malloc(strlen(target) + strlen(name) + 2);
+		sprintf(destination, "%s/%s", target, name);
+		result |= copyOneFile(inputArgs[i], destination);
+		free(destination);
+	}
+	return result;
+}
@@ -0,0 +1,60 @@
+/***********************************************************************************************************
+ * Filename: copy.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for copying between descriptors inside the kernel and for the 'cat'
+ * and 'cp' builtins built on it
+ **********************************************************************************************************/
+
+#ifndef COPY_H_
+#define COPY_H_
+
+#include "shell.h"
+
+#include <sys/types.h>
+
+// Most bytes asked of one copy_file_range, sendfile or splice call
+#define COPY_CHUNK_SIZE 0x40000000
+// Size of the buffer used when the kernel can't copy between the two descriptors itself
+#define COPY_BUFFER_SIZE 1048576
+
+/**
+* Function: copyFileData
+* -------------------------------------------
+* Copies everything from one descriptor to another, starting at their current offsets, and returns the
+* number of bytes copied or -1 on error (errno set). The kernel moves the bytes whenever it can:
+* copy_file_range between two regular files, sendfile from a regular file, splice when either side is a
+* pipe; anything else goes through a read/write loop
+*
+* inputFd - the descriptor to read until end of file
+* outputFd - the descriptor to write to
+*/
+off_t copyFileData(int inputFd, int outputFd);
+/**
+* Function: executeCatCommand
+* -------------------------------------------
+* Defines logic for the 'cat' shell command, which writes each file in turn to standard out
+*	cat [-u] [file...] - '-' or no file at all stands for standard in; -u is accepted and ignored
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - standard in for the command
+* outputFd - standard out for the command
+* status - unused
+*/
+int executeCatCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executeCpCommand
+* -------------------------------------------
+* Defines logic for the 'cp' shell command, which copies regular files
+*	cp source destination     - copy source to destination, created with source's permissions
+*	cp source... directory    - copy each source into directory under its own name
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - unused
+* status - unused
+*/
+int executeCpCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+
+#endif /* COPY_H_ */
@@ -0,0 +1,858 @@
+/***********************************************************************************************************
+ * Filename: editor.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the line editor. While a line is edited the terminal is in raw mode (no echo,
+ * no line buffering, no signals from ^C and ^Z) and the whole line is redrawn after each key with a single
+ * write; a line wider than the terminal scrolls sideways to keep the cursor in view. Cursor motion counts
+ * UTF-8 characters rather than bytes. Killed text is kept for yanking across lines, the history is walked
+ * and searched through the history module, and tab completion comes from the completion module.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "editor.h"
+#include "events.h"
+#include "complete.h"
+#include "history.h"
+#include "variables.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#define CONTROL(key) ((key) & 0x1f)
+#define KEY_ESCAPE 27
+#define KEY_BACKSPACE 127
+// Keys sent as escape sequences get codes outside the byte range
+#define KEY_NONE 1000
+#define KEY_UP 1001
+#define KEY_DOWN 1002
+#define KEY_LEFT 1003
+#define KEY_RIGHT 1004
+#define KEY_HOME 1005
+#define KEY_END 1006
+#define KEY_DELETE 1007
+#define KEY_WORD_LEFT 1008
+#define KEY_WORD_RIGHT 1009
+#define KEY_KILL_WORD 1010
+#define KEY_KILL_PREVIOUS_WORD 1011
+
+#define SEARCH_PROMPT_SIZE 512
+
+struct editorState
+{
+	const char *prompt;
+	char *line;					// always terminated
+	size_t length;
+	size_t capacity;
+	size_t cursor;
+	unsigned long historyPosition;	// the history entry shown; 0 = the line being typed
+	char *savedLine;			// the line being typed while the history is walked
+	size_t savedLength;
+	int lastKey;
+};
+
+static struct termios originalMode;
+static char *killBuffer = NULL;
+static size_t killLength = 0;
+
+/**
+* Function: editorAvailable
+* -------------------------------------------
+* Returns 1 if standard in and out are a terminal the editor can drive (one whose modes can be read and
+* whose $TERM isn't unset or "dumb"); 0 otherwise
+*/
+int editorAvailable()
+{
+	struct termios mode;
+	const char *terminal = getVariable("TERM");
+	if (terminal == NULL || strcmp(terminal, "dumb") == 0)
+		return 0;
+	return isatty(STDIN_FILENO) && isatty(STDOUT_FILENO) && tcgetattr(STDIN_FILENO, &mode) == 0;
+}
+
+/**
+* Function: enableRawMode
+* -------------------------------------------
+* Saves the terminal's mode and switches it to raw input; output processing stays on so '\n' still
+* starts a new line. Returns 0 on success and -1 otherwise
+*/
+static int enableRawMode()
+{
+	struct termios raw;
+	if (tcgetattr(STDIN_FILENO, &originalMode) != 0)
+		return -1;
+	raw = originalMode;
+	raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+	raw.c_cflag |= CS8;
+	raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+	raw.c_cc[VMIN] = 1;
+	raw.c_cc[VTIME] = 0;
+	// Drain rather than flush so whatever was typed ahead is still read
+	return tcsetattr(STDIN_FILENO, TCSADRAIN, &raw);
+}
+
+/**
+* Function: disableRawMode
+* -------------------------------------------
+* Puts the terminal back in the mode saved by enableRawMode
+*/
+static void disableRawMode()
+{
+	tcsetattr(STDIN_FILENO, TCSADRAIN, &originalMode);
+}
+
+/**
+* Function: writeText
+* -------------------------------------------
+* Writes text to the terminal, resuming after interruptions
+*
+* text - the bytes to write
+* length - the number of bytes
+*/
+static void writeText(const char *text, size_t length)
+{
+	ssize_t written;
+	while (length > 0)
+	{
+		written = write(STDOUT_FILENO, text, length);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return;
+		text += written;
+		length -= written;
+	}
+}
+
+/**
+* Function: terminalColumns
+* -------------------------------------------
+* Returns the width of the terminal, asked each time so a resize takes effect on the next key
+*/
+static size_t terminalColumns()
+{
+	struct winsize size;
+	if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_col == 0)
+		return EDITOR_DEFAULT_COLUMNS;
+	return size.ws_col;
+}
+
+/**
+* Function: readByte
+* -------------------------------------------
+* Returns the next byte typed or -1 once input ends
+*/
+static int readByte()
+{
+	unsigned char byte;
+	ssize_t bytesRead;
+	while ((bytesRead = read(STDIN_FILENO, &byte, 1)) < 0 && errno == EINTR)
+		;
+	return bytesRead == 1 ? byte : -1;
+}
+
+/**
+* Function: readKey
+* -------------------------------------------
+* Returns the next key, decoding the escape sequences of arrows, Home, End, Delete and Alt combinations,
+* or -1 once input ends. Sequences the editor doesn't use come back as KEY_NONE
+*/
+static int readKey()
+{
+	int key = readByte();
+	int next;
+	int parameter = 0;
+	int modifier = 0;
+
+	if (key != KEY_ESCAPE)
+		return key;
+	if ((next = readByte()) < 0)
+		return KEY_ESCAPE;
+	// Alt-key arrives as escape followed by the key
+	if (next != '[' && next != 'O')
+	{
+		switch (tolower(next))
+		{
+			case 'b': return KEY_WORD_LEFT;
+			case 'f': return KEY_WORD_RIGHT;
+			case 'd': return KEY_KILL_WORD;
+			case KEY_BACKSPACE: return KEY_KILL_PREVIOUS_WORD;
+			default: return KEY_NONE;
+		}
+	}
+	// ESC [ number ; modifier final, where both numbers are optional
+	while ((key = readByte()) >= '0' && key <= '9')
+		parameter = parameter * 10 + key - '0';
+	if (key == ';')
+		while ((key = readByte()) >= '0' && key <= '9')
+			modifier = modifier * 10 + key - '0';
+	switch (key)
+	{
+		case 'A': return KEY_UP;
+		case 'B': return KEY_DOWN;
+		// Ctrl-Left and Ctrl-Right move by a word
+		case 'C': return modifier >= 5 ? KEY_WORD_RIGHT : KEY_RIGHT;
+		case 'D': return modifier >= 5 ? KEY_WORD_LEFT : KEY_LEFT;
+		case 'H': return KEY_HOME;
+		case 'F': return KEY_END;
+		case '~':
+			if (parameter == 1 || parameter == 7)
+				return KEY_HOME;
+			if (parameter == 4 || parameter == 8)
+				return KEY_END;
+			if (parameter == 3)
+				return KEY_DELETE;
+			return KEY_NONE;
+		default:
+			return key < 0 ? -1 : KEY_NONE;
+	}
+}
+
+/**
+* Function: isContinuationByte
+* -------------------------------------------
+* Returns 1 if a byte continues a UTF-8 character rather than starting one
+*
+* byte - the byte to check
+*/
+static int isContinuationByte(char byte)
+{
+	return (byte & 0xc0) == 0x80;
+}
+
+/**
+* Function: previousCharacter
+* -------------------------------------------
+* Returns the offset of the character before an offset of the line
+*
+* state - the line being edited
+* offset - an offset at the start of a character
+*/
+static size_t previousCharacter(struct editorState *state, size_t offset)
+{
+	while (offset > 0 && isContinuationByte(state->line[--offset]))
+		;
+	return offset;
+}
+
+/**
+* Function: nextCharacter
+* -------------------------------------------
+* Returns the offset of the character after an offset of the line
+*
+* state - the line being edited
+* offset - an offset at the start of a character
+*/
+static size_t nextCharacter(struct editorState *state, size_t offset)
+{
+	while (offset < state->length && isContinuationByte(state->line[++offset]))
+		;
+	return offset;
+}
+
+/**
+* Function: isWordCharacter
+* -------------------------------------------
+* Returns 1 if a byte belongs to a word for Alt-B, Alt-F and Alt-D: letters, digits and any byte of a
+* multibyte character
+*
+* byte - the byte to check
+*/
+static int isWordCharacter(char byte)
+{
+	return isalnum((unsigned char) byte) || (byte & 0x80);
+}
+
+/**
+* Function: previousWord
+* -------------------------------------------
+* Returns the offset of the start of the word before the cursor
+*
+* state - the line being edited
+*/
+static size_t previousWord(struct editorState *state)
+{
+	size_t offset = state->cursor;
+	while (offset > 0 && !isWordCharacter(state->line[offset - 1]))
+		offset--;
+	while (offset > 0 && isWordCharacter(state->line[offset - 1]))
+		offset--;
+	return offset;
+}
+
+/**
+* Function: nextWord
+* -------------------------------------------
+* Returns the offset of the end of the word after the cursor
+*
+* state - the line being edited
+*/
+static size_t nextWord(struct editorState *state)
+{
+	size_t offset = state->cursor;
+	while (offset < state->length && !isWordCharacter(state->line[offset]))
+		offset++;
+	while (offset < state->length && isWordCharacter(state->line[offset]))
+		offset++;
+	return offset;
+}
+
+/**
+* Function: refreshLine
+* -------------------------------------------
+* Redraws the prompt and as much of the line around the cursor as fits on one row, with one write
+*
+* state - the line being edited
+*/
+static void refreshLine(struct editorState *state)
+{
+	size_t columns = terminalColumns();
+	size_t promptLength = strlen(state->prompt);
+	size_t position = 0;
+	size_t width = 0;
+	size_t start = 0;
+	size_t end;
+	size_t offset;
+	size_t outputLength = 0;
+	char *output = malloc(promptLength + state->length + 64);
+	char *line = state->line;
+
+	// The column of the cursor, then the first character that keeps it on screen
+	for (offset = 0; offset < state->cursor; offset++)
+		position += !isContinuationByte(line[offset]);
+	while (promptLength + position >= columns && start < state->cursor)
+	{
+		start = nextCharacter(state, start);
+		position--;
+	}
+	for (end = start; end < state->length && promptLength + width + 1 < columns; width++)
+		end = nextCharacter(state, end);
+
+	output[outputLength++] = '\r';
+	memcpy(output + outputLength, state->prompt, promptLength);
+	outputLength += promptLength;
+	memcpy(output + outputLength, line + start, end - start);
+	outputLength += end - start;
+	// Erase whatever the previous drawing left to the right, then put the cursor back
+	outputLength += sprintf(output + outputLength, "\x1b[0K\r");
+	if (promptLength + position > 0)
+		outputLength += sprintf(output + outputLength, "\x1b[%zuC", promptLength + position);
+	writeText(output, outputLength);
+	free(output);
+}
+
+/**
+* Function: reserveLine
+* -------------------------------------------
+* Makes room for a number of additional bytes (and the terminator) in the line
+*
+* state - the line being edited
+* additional - the number of bytes about to be added
+*/
+static void reserveLine(struct editorState *state, size_t additional)
+{
+	if (state->length + additional + 1 <= state->capacity)
+		return;
+	while (state->length + additional + 1 > state->capacity)
+		state->capacity = state->capacity ? state->capacity * 2 : EDITOR_STARTING_SIZE;
+	state->line = realloc(state->line, state->capacity);
+}
+
+/**
+* Function: insertText
+* -------------------------------------------
+* Inserts text at the cursor and moves the cursor past it
+*
+* state - the line being edited
+* text - the bytes to insert
+* length - the number of bytes
+*/
+static void insertText(struct editorState *state, const char *text, size_t length)
+{
+	reserveLine(state, length);
+	memmove(state->line + state->cursor + length, state->line + state->cursor, state->length - state->cursor + 1);
+	memcpy(state->line + state->cursor, text, length);
+	state->length += length;
+	state->cursor += length;
+}
+
+/**
+* Function: deleteText
+* -------------------------------------------
+* Removes part of the line, leaving the cursor at its start, and optionally keeps it for yanking
+*
+* state - the line being edited
+* from - the offset of the first byte to remove
+* to - the offset after the last byte to remove
+* kill - 1 = keep the removed text for Ctrl-Y
+*/
+static void deleteText(struct editorState *state, size_t from, size_t to, int kill)
+{
+	if (from >= to)
+		return;
+	if (kill)
+	{
+		killBuffer = realloc(killBuffer, to - from);
+		memcpy(killBuffer, state->line + from, to - from);
+		killLength = to - from;
+	}
+	memmove(state->line + from, state->line + to, state->length - to + 1);
+	state->length -= to - from;
+	state->cursor = from;
+}
+
+/**
+* Function: replaceLine
+* -------------------------------------------
+* Replaces the whole line and puts the cursor at its end
+*
+* state - the line being edited
+* text - the new line
+* length - the length of text
+*/
+static void replaceLine(struct editorState *state, const char *text, size_t length)
+{
+	state->length = 0;
+	state->cursor = 0;
+	state->line[0] = 0;
+	insertText(state, text, length);
+}
+
+/**
+* Function: showHistoryEntry
+* -------------------------------------------
+* Moves to another history entry; the line being typed is kept aside while entries are shown and comes
+* back when walking past the newest one
+*
+* state - the line being edited
+* position - the entry to show, 0 for the line being typed
+*/
+static void showHistoryEntry(struct editorState *state, unsigned long position)
+{
+	const char *entry;
+	size_t entryLength;
+
+	if (state->historyPosition == 0)
+	{
+		free(state->savedLine);
+		state->savedLine = strndup(state->line, state->length);
+		state->savedLength = state->length;
+	}
+	state->historyPosition = position;
+	if (position == 0)
+		replaceLine(state, state->savedLine, state->savedLength);
+	else if ((entry = historyEntry(position, &entryLength)) != NULL)
+		replaceLine(state, entry, entryLength);
+}
+
+/**
+* Function: searchHistoryInteractively
+* -------------------------------------------
+* Runs a Ctrl-R search: each key typed narrows the search to the newest entry containing the text so far,
+* Ctrl-R moves on to older matches and Ctrl-G or Ctrl-C gives up. Any other key accepts the match into the
+* line and is returned to be handled as usual (or KEY_NONE if it shouldn't be)
+*
+* state - the line being edited
+*/
+static int searchHistoryInteractively(struct editorState *state)
+{
+	char searchPrompt[SEARCH_PROMPT_SIZE];
+	char text[SEARCH_PROMPT_SIZE / 2];
+	size_t textLength = 0;
+	unsigned long match = 0;
+	unsigned long found;
+	int failed = 0;
+	int key;
+	const char *entry;
+	size_t entryLength;
+	char *position;
+	const char *savedPrompt = state->prompt;
+	char *original = strndup(state->line, state->length);
+	size_t originalLength = state->length;
+
+	state->prompt = searchPrompt;
+	while (1)
+	{
+		snprintf(searchPrompt, sizeof(searchPrompt), "(%sreverse-i-search)`%.*s': ",
+			failed ? "failed " : "", (int) textLength, text);
+		if (match != 0 && (entry = historyEntry(match, &entryLength)) != NULL)
+		{
+			replaceLine(state, entry, entryLength);
+			position = memmem(state->line, state->length, text, textLength);
+			state->cursor = position ? (size_t) (position - state->line) : 0;
+		}
+		refreshLine(state);
+
+		key = readKey();
+		found = 0;
+		if (key == CONTROL('r'))
+		{
+			if (match != 0)
+				found = searchHistory(text, textLength, 0, match);
+		}
+		else if (key == KEY_BACKSPACE || key == CONTROL('h'))
+		{
+			if (textLength > 0)
+				textLength--;
+			match = 0;
+			found = textLength ? searchHistory(text, textLength, 0, 0) : 0;
+		}
+		else if ((key >= ' ' && key < KEY_BACKSPACE) || (key > KEY_BACKSPACE && key < 256))
+		{
+			if (textLength < sizeof(text))
+				text[textLength++] = key;
+			// The current match may still contain the longer text
+			found = searchHistory(text, textLength, 0, match ? match + 1 : 0);
+		}
+		else
+			break;
+		failed = found == 0 && textLength > 0;
+		if (found != 0)
+			match = found;
+		else if (textLength == 0)
+			replaceLine(state, original, originalLength);
+	}
+
+	state->prompt = savedPrompt;
+	if (key == CONTROL('g') || key == CONTROL('c'))
+	{
+		replaceLine(state, original, originalLength);
+		key = KEY_NONE;
+	}
+	else if (key == KEY_ESCAPE)
+		key = KEY_NONE;
+	free(original);
+	return key;
+}
+
+/**
+* Function: insertCompletion
+* -------------------------------------------
+* Replaces what was typed of the word with a candidate, escaped for the quoting it is in. A complete name
+* that isn't a directory also gets its quote closed and a space after it
+*
+* state - the line being edited
+* completions - the candidates and where they go
+* name - the candidate
+* length - how much of the candidate to insert
+* complete - 1 = the whole candidate is being inserted as the only match
+*/
+static void insertCompletion(struct editorState *state, struct completions *completions, const char *name,
+	size_t length, int complete)
+{
+	char *escaped = malloc(length * 4 + 3);
+	size_t escapedLength = 0;
+	size_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		if (completions->quote == '\'' && name[i] == '\'')
+		{
+			memcpy(escaped + escapedLength, "'\\''", 4);
+			escapedLength += 4;
+			continue;
+		}
+		if ((completions->quote == 0 && strchr(" \t\\'\"|<>&;()$`*?[]{}!#~", name[i]) != NULL) ||
+			(completions->quote == '"' && strchr("\\\"$`", name[i]) != NULL))
+			escaped[escapedLength++] = '\\';
+		escaped[escapedLength++] = name[i];
+	}
+	if (complete && (length == 0 || name[length - 1] != '/'))
+	{
+		if (completions->quote != 0)
+			escaped[escapedLength++] = completions->quote;
+		escaped[escapedLength++] = ' ';
+	}
+
+	deleteText(state, completions->replaceFrom, state->cursor, 0);
+	insertText(state, escaped, escapedLength);
+	free(escaped);
+}
+
+/**
+* Function: listCompletions
+* -------------------------------------------
+* Prints the candidates in columns below the line, sorted down each column, then redraws the line.
+* Beyond EDITOR_LIST_LIMIT candidates the user is asked first
+*
+* state - the line being edited
+* completions - the candidates
+*/
+static void listCompletions(struct editorState *state, struct completions *completions)
+{
+	char question[64];
+	size_t columns = terminalColumns();
+	size_t width = 0;
+	size_t perRow;
+	size_t rows;
+	size_t row;
+	size_t column;
+	size_t index;
+	size_t nameLength;
+	int i;
+	int key;
+
+	writeText("\r\n", 2);
+	if (completions->numberOfNames > EDITOR_LIST_LIMIT)
+	{
+		snprintf(question, sizeof(question), "Display all %d possibilities? (y or n)", completions->numberOfNames);
+		writeText(question, strlen(question));
+		key = readKey();
+		writeText("\r\n", 2);
+		if (key != 'y' && key != 'Y')
+		{
+			refreshLine(state);
+			return;
+		}
+	}
+
+	for (i = 0; i < completions->numberOfNames; i++)
+		if (strlen(completions->names[i]) + 2 > width)
+			width = strlen(completions->names[i]) + 2;
+	perRow = columns / width ? columns / width : 1;
+	rows = (completions->numberOfNames + perRow - 1) / perRow;
+	for (row = 0; row < rows; row++)
+	{
+		for (column = 0; column < perRow; column++)
+		{
+			index = column * rows + row;
+			if (index >= (size_t) completions->numberOfNames)
+				break;
+			nameLength = strlen(completions->names[index]);
+			writeText(completions->names[index], nameLength);
+			// Pad all but the last name of the row
+			if ((column + 1) * rows + row < (size_t) completions->numberOfNames)
+				writeText("                                                                ",
+					width - nameLength < 64 ? width - nameLength : 64);
+		}
+		writeText("\r\n", 2);
+	}
+	refreshLine(state);
+}
+
+/**
+* Function: completeLine
+* -------------------------------------------
+* Handles Tab: a single candidate is inserted whole, several are completed as far as they agree, and when
+* they agree on no more than what was typed a second Tab lists them
+*
+* state - the line being edited
+*/
+static void completeLine(struct editorState *state)
+{
+	struct completions completions;
+	size_t common;
+	int i;
+
+	findCompletions(state->line, state->cursor, &completions);
+	if (completions.numberOfNames == 1)
+		insertCompletion(state, &completions, completions.names[0], strlen(completions.names[0]), 1);
+	else if (completions.numberOfNames > 1)
+	{
+		common = strlen(completions.names[0]);
+		for (i = 1; i < completions.numberOfNames; i++)
+			while (common > 0 && strncmp(completions.names[0], completions.names[i], common) != 0)
+				common--;
+		if (common > completions.typedLength)
+			insertCompletion(state, &completions, completions.names[0], common, 0);
+		else if (state->lastKey == '\t')
+			listCompletions(state, &completions);
+		else
+			writeText("\a", 1);
+	}
+	else
+		writeText("\a", 1);
+	freeCompletions(&completions);
+}
+
+/**
+* Function: reportEvents
+* -------------------------------------------
+* Prints the notices of jobs that changed state and of Ctrl-Z while a line is edited: the line is cleared,
+* the notices take its place and the line is drawn again below them
+*
+* state - the line being edited
+*/
+static void reportEvents(struct editorState *state)
+{
+	writeText("\r\x1b[K", 4);
+	processPendingEvents();
+	refreshLine(state);
+}
+
+/**
+* Function: editLine
+* -------------------------------------------
+* Displays the prompt and lets the user edit a line with the terminal in raw mode; returns the line
+* (terminated, without the newline; valid until the next call) or NULL once input ends. The terminal is
+* back in its own mode when this returns
+*
+* prompt - the prompt to display
+* length - assigned the length of the line
+*/
+char * editLine(const char *prompt, size_t *length)
+{
+	static struct editorState state;
+	int key;
+	int done = 0;
+	char byte;
+
+	state.prompt = prompt;
+	state.length = 0;
+	state.cursor = 0;
+	state.historyPosition = 0;
+	state.lastKey = 0;
+	reserveLine(&state, 0);
+	state.line[0] = 0;
+
+	if (enableRawMode() != 0)
+		return NULL;
+	refreshLine(&state);
+	while (!done)
+	{
+		while (waitForInput(STDIN_FILENO) == EVENTS_PENDING)
+			reportEvents(&state);
+		key = readKey();
+		if (key == CONTROL('r'))
+			key = searchHistoryInteractively(&state);
+
+		switch (key)
+		{
+			case -1:
+				// Input ended (the terminal went away); give up on the line
+				done = -1;
+				break;
+			case '\r':
+			case '\n':
+				// Show the end of a line that scrolled before leaving it
+				if (state.cursor != state.length)
+				{
+					state.cursor = state.length;
+					refreshLine(&state);
+				}
+				done = 1;
+				break;
+			case CONTROL('c'):
+				writeText("^C", 2);
+				state.length = 0;
+				state.line[0] = 0;
+				done = 1;
+				break;
+			case CONTROL('d'):
+				if (state.length == 0)
+					done = -1;
+				else
+					deleteText(&state, state.cursor, nextCharacter(&state, state.cursor), 0);
+				break;
+			case KEY_DELETE:
+				deleteText(&state, state.cursor, nextCharacter(&state, state.cursor), 0);
+				break;
+			case KEY_BACKSPACE:
+			case CONTROL('h'):
+				deleteText(&state, previousCharacter(&state, state.cursor), state.cursor, 0);
+				break;
+			case KEY_LEFT:
+			case CONTROL('b'):
+				state.cursor = previousCharacter(&state, state.cursor);
+				break;
+			case KEY_RIGHT:
+			case CONTROL('f'):
+				state.cursor = nextCharacter(&state, state.cursor);
+				break;
+			case KEY_WORD_LEFT:
+				state.cursor = previousWord(&state);
+				break;
+			case KEY_WORD_RIGHT:
+				state.cursor = nextWord(&state);
+				break;
+			case KEY_HOME:
+			case CONTROL('a'):
+				state.cursor = 0;
+				break;
+			case KEY_END:
+			case CONTROL('e'):
+				state.cursor = state.length;
+				break;
+			case CONTROL('k'):
+				deleteText(&state, state.cursor, state.length, 1);
+				break;
+			case CONTROL('u'):
+				deleteText(&state, 0, state.cursor, 1);
+				break;
+			case CONTROL('w'):
+				// Ctrl-W kills back to the previous blank, like the terminal's own word erase
+				{
+					size_t from = state.cursor;
+					while (from > 0 && isspace((unsigned char) state.line[from - 1]))
+						from--;
+					while (from > 0 && !isspace((unsigned char) state.line[from - 1]))
+						from--;
+					deleteText(&state, from, state.cursor, 1);
+				}
+				break;
+			case KEY_KILL_WORD:
+				deleteText(&state, state.cursor, nextWord(&state), 1);
+				break;
+			case KEY_KILL_PREVIOUS_WORD:
+				deleteText(&state, previousWord(&state), state.cursor, 1);
+				break;
+			case CONTROL('y'):
+				if (killLength > 0)
+					insertText(&state, killBuffer, killLength);
+				break;
+			case KEY_UP:
+			case CONTROL('p'):
+				if (state.historyPosition == 0 && historyLength() > 0)
+					showHistoryEntry(&state, historyLength());
+				else if (state.historyPosition > 1)
+					showHistoryEntry(&state, state.historyPosition - 1);
+				else
+					writeText("\a", 1);
+				break;
+			case KEY_DOWN:
+			case CONTROL('n'):
+				if (state.historyPosition == 0)
+					writeText("\a", 1);
+				else
+					showHistoryEntry(&state, state.historyPosition < historyLength() ? state.historyPosition + 1 : 0);
+				break;
+			case '\t':
+				completeLine(&state);
+				break;
+			case CONTROL('l'):
+				writeText("\x1b[H\x1b[2J", 7);
+				break;
+			case CONTROL('z'):
+				// Raw mode delivers Ctrl-Z as a key; the signal is read back before the next key
+				raise(SIGTSTP);
+				break;
+			default:
+				// Printable characters and the bytes of multibyte ones; other control keys are ignored
+				if ((key >= ' ' && key < KEY_BACKSPACE) || (key > KEY_BACKSPACE && key < 256))
+				{
+					byte = key;
+					insertText(&state, &byte, 1);
+				}
+				break;
+		}
+		if (!done)
+			refreshLine(&state);
+		state.lastKey = key;
+	}
+
+	writeText("\r\n", 2);
+	disableRawMode();
+	if (done < 0)
+		return NULL;
+	*length = state.length;
+	return state.line;
+}
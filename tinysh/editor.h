@@ -0,0 +1,47 @@
+/***********************************************************************************************************
+ * Filename: editor.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the line editor used when the shell reads from a terminal
+ **********************************************************************************************************/
+
+#ifndef EDITOR_H_
+#define EDITOR_H_
+
+#include <stddef.h>
+
+#define EDITOR_STARTING_SIZE 256
+#define EDITOR_DEFAULT_COLUMNS 80
+// More candidates than this are only listed after asking
+#define EDITOR_LIST_LIMIT 100
+
+/**
+* Function: editorAvailable
+* -------------------------------------------
+* Returns 1 if standard in and out are a terminal the editor can drive (one whose modes can be read and
+* whose $TERM isn't unset or "dumb"); 0 otherwise
+*/
+int editorAvailable();
+/**
+* Function: editLine
+* -------------------------------------------
+* Displays the prompt and lets the user edit a line with the terminal in raw mode; returns the line
+* (terminated, without the newline; valid until the next call) or NULL once input ends. The terminal is
+* back in its own mode when this returns
+*	Left / Right, Ctrl-B / Ctrl-F   - move by a character      Alt-B / Alt-F - move by a word
+*	Home / End, Ctrl-A / Ctrl-E     - go to the start / end    Ctrl-L        - clear the screen
+*	Ctrl-K / Ctrl-U                 - kill to the end / start  Ctrl-W        - kill the previous word
+*	Alt-D / Alt-Backspace           - kill the next / previous word
+*	Ctrl-Y                          - yank what was last killed
+*	Up / Down, Ctrl-P / Ctrl-N      - walk the history         Ctrl-R        - search the history
+*	Tab                             - complete the command or path; pressed again, list the candidates
+*	Ctrl-C                          - discard the line         Ctrl-D        - end input on an empty line
+*	Ctrl-Z                          - toggle foreground-only mode, as SIGTSTP does
+*
+* prompt - the prompt to display
+* length - assigned the length of the line
+*/
+char * editLine(const char *prompt, size_t *length);
+
+#endif /* EDITOR_H_ */
@@ -0,0 +1,226 @@
+/***********************************************************************************************************
+ * Filename: events.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the shell's event loop. Instead of running code in signal handlers, SIGCHLD,
+ * SIGINT and SIGTSTP stay blocked and queue on a signalfd. While the shell waits for a line, epoll watches
+ * the signalfd and the input together, so children are reaped and background jobs reported the moment they
+ * change state rather than after the next Enter, and every notice is printed from ordinary code.
+ **********************************************************************************************************/
+
+#include "events.h"
+#include "shell.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+
+static int signalFd = -1;
+static int epollFd = -1;
+static int watchedFd = -1;
+static int unwatchableFd = -1;
+static int *foregroundOnlyFlag = NULL;
+static int interrupts = 0;
+
+/**
+* Function: shellSignals
+* -------------------------------------------
+* Fills a set with the signals the shell reads through its signalfd
+*
+* signals - the set to fill
+*/
+static void shellSignals(sigset_t *signals)
+{
+	sigemptyset(signals);
+	sigaddset(signals, SIGCHLD);
+	sigaddset(signals, SIGINT);
+	sigaddset(signals, SIGTSTP);
+}
+
+/**
+* Function: initializeEvents
+* -------------------------------------------
+* Blocks SIGCHLD, SIGINT and SIGTSTP and opens the signalfd and epoll instance they are read through;
+* returns 0 on success and -1 otherwise, in which case the signals are left as they were
+*
+* foregroundOnly - the foreground-only flag, toggled when SIGTSTP is read
+*/
+int initializeEvents(int *foregroundOnly)
+{
+	sigset_t signals;
+	struct epoll_event event = { 0 };
+
+	shellSignals(&signals);
+	if (sigprocmask(SIG_BLOCK, &signals, NULL) < 0)
+		return -1;
+	signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	event.events = EPOLLIN;
+	event.data.fd = signalFd;
+	if (signalFd < 0 || epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event) < 0)
+	{
+		closeEvents();
+		return -1;
+	}
+	foregroundOnlyFlag = foregroundOnly;
+	return 0;
+}
+
+/**
+* Function: watchInput
+* -------------------------------------------
+* Adds a descriptor to the epoll instance in place of the one watched before; returns -1 if it can't be
+* watched
+*
+* fd - the descriptor lines are read from
+*/
+static int watchInput(int fd)
+{
+	struct epoll_event event = { 0 };
+
+	if (fd == watchedFd)
+		return 0;
+	if (fd == unwatchableFd)
+		return -1;
+	if (watchedFd >= 0)
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, watchedFd, NULL);
+	watchedFd = -1;
+	event.events = EPOLLIN;
+	event.data.fd = fd;
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+	{
+		unwatchableFd = fd;
+		return -1;
+	}
+	watchedFd = fd;
+	return 0;
+}
+
+/**
+* Function: waitForInput
+* -------------------------------------------
+* Waits until a descriptor has input to read or a signal is pending, and returns INPUT_READY or
+* EVENTS_PENDING, or WAIT_FAILED with errno set if the wait itself failed. Signals are left for
+* processPendingEvents, so the caller decides when the terminal can take a notice. Returns INPUT_READY at
+* once when events aren't initialized or the descriptor can't be watched (regular files never block)
+*
+* fd - the descriptor lines are read from
+*/
+int waitForInput(int fd)
+{
+	struct epoll_event events[2];
+	int count;
+	int i;
+
+	if (epollFd < 0 || fd < 0 || watchInput(fd) < 0)
+		return INPUT_READY;
+	while ((count = epoll_wait(epollFd, events, 2, -1)) < 0 && errno == EINTR)
+		;
+	if (count < 0)
+		return WAIT_FAILED;
+	// Signals come first so a job's notice is printed before the line that follows it is run
+	for (i = 0; i < count; i++)
+		if (events[i].data.fd == signalFd)
+			return EVENTS_PENDING;
+	return INPUT_READY;
+}
+
+/**
+* Function: toggleForegroundOnly
+* -------------------------------------------
+* Enters or exits foreground-only mode, in which & is ignored, and says so; returns the number of notices
+* printed, 0 when the shell has no such mode (a served session)
+*/
+static int toggleForegroundOnly()
+{
+	if (foregroundOnlyFlag == NULL)
+		return 0;
+	*foregroundOnlyFlag = !*foregroundOnlyFlag;
+	if (*foregroundOnlyFlag)
+		printf("Entering foreground-only mode (& is now ignored)\n");
+	else
+		printf("Exiting foreground-only mode\n");
+	return 1;
+}
+
+/**
+* Function: processPendingEvents
+* -------------------------------------------
+* Handles the signals read so far without waiting: SIGCHLD reaps every child that changed state and
+* reports background jobs, SIGTSTP toggles foreground-only mode and SIGINT is only counted for
+* takeInterrupts, as the shell ignores it. Without initialized events it reaps with monitorBackgroundPids.
+* Returns the number of notices printed
+*/
+int processPendingEvents()
+{
+	struct signalfd_siginfo information;
+	int notices = 0;
+	int childrenChanged = 0;
+
+	if (signalFd < 0)
+		return monitorBackgroundPids();
+
+	// Several SIGCHLDs may have merged into one, so one reaping pass covers them all
+	while (read(signalFd, &information, sizeof(information)) == sizeof(information))
+	{
+		if (information.ssi_signo == SIGCHLD)
+			childrenChanged = 1;
+		else if (information.ssi_signo == SIGTSTP)
+			notices += toggleForegroundOnly();
+		else if (information.ssi_signo == SIGINT)
+			interrupts++;
+	}
+	if (childrenChanged)
+		notices += monitorBackgroundPids();
+	fflush(stdout);
+	return notices;
+}
+
+/**
+* Function: takeInterrupts
+* -------------------------------------------
+* Returns the number of SIGINTs processPendingEvents has read since the last call, together with any still
+* queued, which are taken without handling the other signals so no child is reaped behind the caller's back
+*/
+int takeInterrupts()
+{
+	static const struct timespec noWait = { 0, 0 };
+	sigset_t interrupt;
+	int count = interrupts;
+
+	interrupts = 0;
+	if (signalFd < 0)
+		return count;
+	sigemptyset(&interrupt);
+	sigaddset(&interrupt, SIGINT);
+	while (sigtimedwait(&interrupt, NULL, &noWait) == SIGINT)
+		count++;
+	return count;
+}
+
+/**
+* Function: closeEvents
+* -------------------------------------------
+* Closes the signalfd and epoll instance and unblocks the signals again; used by children that keep
+* running shell code, which reap their own children by polling
+*/
+void closeEvents()
+{
+	sigset_t signals;
+
+	if (epollFd >= 0)
+		close(epollFd);
+	if (signalFd >= 0)
+		close(signalFd);
+	epollFd = -1;
+	signalFd = -1;
+	watchedFd = -1;
+	unwatchableFd = -1;
+	shellSignals(&signals);
+	sigprocmask(SIG_UNBLOCK, &signals, NULL);
+}
@@ -0,0 +1,62 @@
+/***********************************************************************************************************
+ * Filename: events.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the shell's event loop: SIGCHLD, SIGINT and SIGTSTP are blocked
+ * and read from a signalfd, which is watched with epoll alongside the input while the shell waits for a line
+ **********************************************************************************************************/
+
+#ifndef EVENTS_H_
+#define EVENTS_H_
+
+// Returned by waitForInput
+#define EVENTS_PENDING 0
+#define INPUT_READY 1
+#define WAIT_FAILED -1
+
+/**
+* Function: initializeEvents
+* -------------------------------------------
+* Blocks SIGCHLD, SIGINT and SIGTSTP and opens the signalfd and epoll instance they are read through;
+* returns 0 on success and -1 otherwise, in which case the signals are left as they were
+*
+* foregroundOnly - the foreground-only flag, toggled when SIGTSTP is read
+*/
+int initializeEvents(int *foregroundOnly);
+/**
+* Function: waitForInput
+* -------------------------------------------
+* Waits until a descriptor has input to read or a signal is pending, and returns INPUT_READY or
+* EVENTS_PENDING, or WAIT_FAILED with errno set if the wait itself failed. Signals are left for
+* processPendingEvents, so the caller decides when the terminal can take a notice. Returns INPUT_READY at
+* once when events aren't initialized or the descriptor can't be watched (regular files never block)
+*
+* fd - the descriptor lines are read from
+*/
+int waitForInput(int fd);
+/**
+* Function: processPendingEvents
+* -------------------------------------------
+* Handles the signals read so far without waiting: SIGCHLD reaps every child that changed state and
+* reports background jobs, SIGTSTP toggles foreground-only mode and SIGINT is only counted for
+* takeInterrupts, as the shell ignores it. Without initialized events it reaps with monitorBackgroundPids.
+* Returns the number of notices printed
+*/
+int processPendingEvents();
+/**
+* Function: takeInterrupts
+* -------------------------------------------
+* Returns the number of SIGINTs processPendingEvents has read since the last call, together with any still
+* queued, which are taken without handling the other signals so no child is reaped behind the caller's back
+*/
+int takeInterrupts();
+/**
+* Function: closeEvents
+* -------------------------------------------
+* Closes the signalfd and epoll instance and unblocks the signals again; used by children that keep
+* running shell code, which reap their own children by polling
+*/
+void closeEvents();
+
+#endif /* EVENTS_H_ */
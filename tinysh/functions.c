@@ -0,0 +1,233 @@
+/***********************************************************************************************************
+ * Filename: functions.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements shell functions, defined with NAME() { ... } and called inside the shell process
+ * with their arguments as positional parameters
+ **********************************************************************************************************/
+
+#include "functions.h"
+#include "variables.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static struct shellFunction *buckets[FUNCTION_BUCKETS];
+// Commands inside calls parse here; nested calls stack their parses and release them on return
+static struct arena callArena = { NULL, NULL };
+static int callDepth = 0;
+
+/**
+* Function: hashFunctionName
+* -------------------------------------------
+* Returns the FNV-1a hash of a function name
+*
+* name - the name to hash
+*/
+static unsigned int hashFunctionName(const char *name)
+{
+	unsigned int hash = 2166136261u;
+	while (*name != 0)
+	{
+		hash ^= (unsigned char) *name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* Function: findFunctionEntry
+* -------------------------------------------
+* Returns the link that points at the function with a given name, or at the NULL ending its bucket
+*
+* name - the name to look up
+* hash - the hash of the name
+*/
+static struct shellFunction ** findFunctionEntry(const char *name, unsigned int hash)
+{
+	struct shellFunction **entry = &buckets[hash % FUNCTION_BUCKETS];
+
+	while (*entry != NULL && ((*entry)->hash != hash || strcmp((*entry)->name, name) != 0))
+		entry = &(*entry)->next;
+	return entry;
+}
+
+/**
+* Function: defineFunction
+* -------------------------------------------
+* Defines a function, or redefines it; a call already running keeps the body it started with
+*
+* name - the function's name
+* body - the compiled body; the table holds a reference to it
+*/
+void defineFunction(const char *name, struct compiledBlock *body)
+{
+	unsigned int hash = hashFunctionName(name);
+	struct shellFunction **entry = findFunctionEntry(name, hash);
+
+	body->references++;
+	if (*entry != NULL)
+	{
+		releaseBlock((*entry)->body);
+		(*entry)->body = body;
+		return;
+	}
+	*entry = malloc(sizeof(struct shellFunction));
+	(*entry)->name = strdup(name);
+	(*entry)->hash = hash;
+	(*entry)->body = body;
+	(*entry)->next = NULL;
+}
+
+/**
+* Function: undefineFunction
+* -------------------------------------------
+* Removes a function; returns 0 if it was defined and -1 otherwise
+*
+* name - the function's name
+*/
+int undefineFunction(const char *name)
+{
+	struct shellFunction **entry = findFunctionEntry(name, hashFunctionName(name));
+	struct shellFunction *function = *entry;
+
+	if (function == NULL)
+		return -1;
+	*entry = function->next;
+	releaseBlock(function->body);
+	free(function->name);
+	free(function);
+	return 0;
+}
+
+/**
+* Function: findFunction
+* -------------------------------------------
+* Returns the function with a given name or NULL if there is none
+*
+* name - the name to look up
+*/
+struct shellFunction * findFunction(const char *name)
+{
+	return *findFunctionEntry(name, hashFunctionName(name));
+}
+
+/**
+* Function: redirectStandard
+* -------------------------------------------
+* Points a standard descriptor at another one for the length of a call and returns a copy of the original
+* to restore, or -1 when the descriptor already is the standard one
+*
+* standardFd - STDIN_FILENO or STDOUT_FILENO
+* fd - the descriptor to use instead
+*/
+static int redirectStandard(int standardFd, int fd)
+{
+	int saved;
+
+	if (fd == standardFd)
+		return -1;
+	saved = fcntl(standardFd, F_DUPFD_CLOEXEC, 10);
+	dup2(fd, standardFd);
+	return saved;
+}
+
+/**
+* Function: restoreStandard
+* -------------------------------------------
+* Points a standard descriptor back at the original saved by redirectStandard
+*
+* standardFd - STDIN_FILENO or STDOUT_FILENO
+* saved - the copy returned by redirectStandard, or -1 if nothing was redirected
+*/
+static void restoreStandard(int standardFd, int saved)
+{
+	if (saved < 0)
+		return;
+	dup2(saved, standardFd);
+	close(saved);
+}
+
+/**
+* Function: executeFunctionCommand
+* -------------------------------------------
+* Runs the function named by inputArgs[0] in the shell process and returns its status: the status of its
+* last command or the value given to 'return'. The arguments become $1 to $N for the call, and standard in
+* and out are pointed at the given descriptors for its duration
+*
+* inputArgs - the function's name and arguments
+* inputFd - the descriptor to use as standard in
+* outputFd - the descriptor to use as standard out
+* status - the shell's status
+*/
+int executeFunctionCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	struct shellFunction *function = findFunction(inputArgs[0]);
+	struct compiledBlock *body;
+	struct positionalParameters parameters;
+	struct arenaMark mark;
+	int savedInput;
+	int savedOutput;
+
+	if (function == NULL)
+		return 127;
+	if (callDepth >= FUNCTION_MAXIMUM_DEPTH)
+	{
+		printf("%s: maximum function nesting level exceeded\n", inputArgs[0]);
+		return 1;
+	}
+
+	// The call holds the body, so redefining the function from inside it is safe
+	body = function->body;
+	body->references++;
+	parameters.name = inputArgs[0];
+	parameters.args = inputArgs + 1;
+	for (parameters.count = 0; parameters.args[parameters.count] != NULL; parameters.count++)
+		;
+	swapPositionalParameters(&parameters);
+	fflush(stdout);
+	savedInput = redirectStandard(STDIN_FILENO, inputFd);
+	savedOutput = redirectStandard(STDOUT_FILENO, outputFd);
+	callDepth++;
+	mark = markArena(&callArena);
+
+	runBlock(body, status, &callArena);
+
+	rewindArena(&callArena, mark);
+	callDepth--;
+	status->returnIndicator = 0;
+	fflush(stdout);
+	restoreStandard(STDOUT_FILENO, savedOutput);
+	restoreStandard(STDIN_FILENO, savedInput);
+	swapPositionalParameters(&parameters);
+	releaseBlock(body);
+	return status->signalOrTerminated ? 128 + status->terminationStatus : status->terminationStatus;
+}
+
+/**
+* Function: executeReturnCommand
+* -------------------------------------------
+* Defines logic for the 'return' shell command, which leaves the running function with a status (the last
+* command's by default)
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - unused
+* status - assigned the return indicator
+*/
+int executeReturnCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	if (callDepth == 0)
+	{
+		printf("return: can only be used in a function\n");
+		return 1;
+	}
+	status->returnIndicator = 1;
+	if (inputArgs[1] != NULL)
+		return atoi(inputArgs[1]) & 0xff;
+	return status->signalOrTerminated ? 128 + status->terminationStatus : status->terminationStatus;
+}
@@ -0,0 +1,79 @@
+/***********************************************************************************************************
+ * Filename: functions.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for shell functions, defined with NAME() { ... } and called inside the
+ * shell process with their arguments as positional parameters
+ **********************************************************************************************************/
+
+#ifndef FUNCTIONS_H_
+#define FUNCTIONS_H_
+
+#include "control.h"
+#include "shell.h"
+
+#define FUNCTION_BUCKETS 64
+// Calls nested deeper than this fail instead of exhausting the stack
+#define FUNCTION_MAXIMUM_DEPTH 1000
+
+struct shellFunction
+{
+	char *name;
+	unsigned int hash;
+	struct compiledBlock *body;
+	struct shellFunction *next;	// next function in the same bucket
+};
+
+/**
+* Function: defineFunction
+* -------------------------------------------
+* Defines a function, or redefines it; a call already running keeps the body it started with
+*
+* name - the function's name
+* body - the compiled body; the table holds a reference to it
+*/
+void defineFunction(const char *name, struct compiledBlock *body);
+/**
+* Function: undefineFunction
+* -------------------------------------------
+* Removes a function; returns 0 if it was defined and -1 otherwise
+*
+* name - the function's name
+*/
+int undefineFunction(const char *name);
+/**
+* Function: findFunction
+* -------------------------------------------
+* Returns the function with a given name or NULL if there is none
+*
+* name - the name to look up
+*/
+struct shellFunction * findFunction(const char *name);
+/**
+* Function: executeFunctionCommand
+* -------------------------------------------
+* Runs the function named by inputArgs[0] in the shell process and returns its status: the status of its
+* last command or the value given to 'return'. The arguments become $1 to $N for the call, and standard in
+* and out are pointed at the given descriptors for its duration
+*
+* inputArgs - the function's name and arguments
+* inputFd - the descriptor to use as standard in
+* outputFd - the descriptor to use as standard out
+* status - the shell's status
+*/
+int executeFunctionCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executeReturnCommand
+* -------------------------------------------
+* Defines logic for the 'return' shell command, which leaves the running function with a status (the last
+* command's by default)
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - unused
+* status - assigned the return indicator
+*/
+int executeReturnCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+
+#endif /* FUNCTIONS_H_ */
@@ -0,0 +1,289 @@
+/***********************************************************************************************************
+ * Filename: heredoc.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements here-documents, here-strings and process substitution without touching the
+ * disk. A body the pipe buffer holds is written into a pipe before the command starts; a longer one is fed
+ * by a forked writer while the command reads it, so the shell never blocks on a full pipe. Each <(COMMAND)
+ * and >(COMMAND) runs in a forked shell at the other end of a pipe, and the command sees its own end as
+ * /dev/fd/N. The shell's copy stays close-on-exec; only the child given /dev/fd/N as an argument keeps it
+ * open across exec, so the other stages of a pipeline never hold the pipe open.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "heredoc.h"
+#include "control.h"
+#include "events.h"
+#include "util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// The sets of the commands running now, innermost first
+static struct substitutionSet *runningSets = NULL;
+
+/**
+* Function: writeBody
+* -------------------------------------------
+* Writes a here-document's body, and the newline that ends a here-string, into its pipe
+*
+* fd - the write end of the pipe
+* command - the command, whose hereDocument is set
+*/
+static void writeBody(int fd, const struct parsedCommand *command)
+{
+	writeAll(fd, command->hereDocument, strlen(command->hereDocument));
+	if (command->redirectInput == REDIRECT_HERE_STRING)
+		writeAll(fd, "\n", 1);
+}
+
+/**
+* Function: openHereDocument
+* -------------------------------------------
+* Returns the read end of a close-on-exec pipe that delivers a command's here-document or here-string,
+* or -1 after reporting why it couldn't be created. A body the pipe holds whole is written before
+* returning; a longer one is fed by a forked writer while the command reads, so neither waits on the other
+*
+* command - the command, whose hereDocument is set
+*/
+int openHereDocument(const struct parsedCommand *command)
+{
+	size_t length = strlen(command->hereDocument) + (command->redirectInput == REDIRECT_HERE_STRING);
+	int pipeFds[2];
+	int capacity;
+
+	if (pipe2(pipeFds, O_CLOEXEC) < 0)
+	{
+		perror("here-document");
+		return -1;
+	}
+	capacity = fcntl(pipeFds[1], F_GETPIPE_SZ);
+	if (capacity > 0 && length <= (size_t) capacity)
+	{
+		writeBody(pipeFds[1], command);
+		close(pipeFds[1]);
+		return pipeFds[0];
+	}
+
+	fflush(stdout);
+	switch (fork())
+	{
+		case -1:
+			perror("fork");
+			close(pipeFds[0]);
+			close(pipeFds[1]);
+			return -1;
+		case 0:
+			// A reader that stops early ends the writer with SIGPIPE
+			closeEvents();
+			dup2(pipeFds[1], STDOUT_FILENO);
+			close_range(3, ~0U, 0);
+			writeBody(STDOUT_FILENO, command);
+			_exit(0);
+	}
+	// The writer is reaped like any other child once it is done
+	close(pipeFds[1]);
+	return pipeFds[0];
+}
+
+/**
+* Function: runSubstitution
+* -------------------------------------------
+* Runs in the forked shell of a process substitution: compiles and runs its command with standard in or
+* out on the pipe, then exits with the command's status
+*
+* substitution - the substitution to run
+* fd - the substitution's end of the pipe
+* runInBackground - 1 = the command it belongs to runs in the background, so SIGINT stays ignored
+* status - the shell's status, as the substitution starts with it
+*/
+static void runSubstitution(struct processSubstitution *substitution, int fd, int runInBackground,
+	struct shellStatus *status)
+{
+	struct compiledBlock block;
+	struct arena arena;
+
+	signal(SIGTSTP, SIG_DFL);
+	if (!runInBackground)
+		signal(SIGINT, SIG_DFL);
+	closeEvents();
+	dup2(fd, substitution->output ? STDIN_FILENO : STDOUT_FILENO);
+	// Nothing gets exec'd, so every pipe end the shell holds would otherwise stay open here
+	close_range(3, ~0U, 0);
+	runningSets = NULL;
+
+	if (compileBlock(substitution->text, &block) < 0)
+		_exit(2);
+	initializeArena(&arena);
+	runBlock(&block, status, &arena);
+	fflush(stdout);
+	_exit(status->signalOrTerminated ? 128 + status->terminationStatus : status->terminationStatus);
+}
+
+/**
+* Function: startProcessSubstitutions
+* -------------------------------------------
+* Starts the command of each <(COMMAND) and >(COMMAND) word in a forked shell, connected by a pipe, and
+* replaces the word by /dev/fd/N, the end of the pipe the command is given; returns 0, or -1 if a pipe or
+* process couldn't be created. finishProcessSubstitutions is called afterwards either way
+*
+* command - the parsed command; its arguments and redirections are assigned the /dev/fd/N names
+* status - the shell's status, as the substitutions start with it
+* set - assigned the processes started and their pipe ends
+*/
+int startProcessSubstitutions(struct parsedCommand *command, struct shellStatus *status,
+	struct substitutionSet *set)
+{
+	struct processSubstitution *substitution;
+	int numberOfSubstitutions = 0;
+	int pipeFds[2];
+	int commandFd;
+	int substitutionFd;
+	char *path;
+	pid_t pid;
+
+	for (substitution = command->substitutions; substitution != NULL; substitution = substitution->next)
+		numberOfSubstitutions++;
+	set->numberOfSubstitutions = 0;
+	set->pids = NULL;
+	set->fds = NULL;
+	set->paths = NULL;
+	set->outer = runningSets;
+	if (numberOfSubstitutions == 0)
+		return 0;
+	set->pids = malloc(sizeof(pid_t) * numberOfSubstitutions);
+	set->fds = malloc(sizeof(int) * numberOfSubstitutions);
+	set->paths = malloc(SUBSTITUTION_PATH_SIZE * numberOfSubstitutions);
+	runningSets = set;
+
+	fflush(stdout);
+	for (substitution = command->substitutions; substitution != NULL; substitution = substitution->next)
+	{
+		if (pipe2(pipeFds, O_CLOEXEC) < 0)
+		{
+			perror("pipe");
+			return -1;
+		}
+		commandFd = pipeFds[substitution->output ? 1 : 0];
+		substitutionFd = pipeFds[substitution->output ? 0 : 1];
+		pid = fork();
+		if (pid == 0)
+			runSubstitution(substitution, substitutionFd, command->runInBackground, status);
+		close(substitutionFd);
+		if (pid < 0)
+		{
+			perror("fork");
+			close(commandFd);
+			return -1;
+		}
+
+		set->pids[set->numberOfSubstitutions] = pid;
+		set->fds[set->numberOfSubstitutions] = commandFd;
+		path = set->paths[set->numberOfSubstitutions++];
+		snprintf(path, SUBSTITUTION_PATH_SIZE, "/dev/fd/%d", commandFd);
+		if (substitution->target == SUBSTITUTE_INPUT_REDIRECT)
+			command->inputRedirect = path;
+		else if (substitution->target == SUBSTITUTE_OUTPUT_REDIRECT)
+			command->outputRedirect = path;
+		else
+			command->args[substitution->target] = path;
+	}
+	return 0;
+}
+
+/**
+* Function: finishProcessSubstitutions
+* -------------------------------------------
+* Closes the shell's copies of a set's pipe ends once its command has started or finished, so the
+* substitutions see end of file or a closed pipe, then waits for their processes when asked
+*
+* set - the set startProcessSubstitutions filled
+* waitForExit - 1 = wait for every process of the set; 0 = leave them to be reaped like any other child
+*/
+void finishProcessSubstitutions(struct substitutionSet *set, int waitForExit)
+{
+	int i;
+
+	for (i = 0; i < set->numberOfSubstitutions; i++)
+		close(set->fds[i]);
+	for (i = 0; waitForExit && i < set->numberOfSubstitutions; i++)
+		while (waitpid(set->pids[i], NULL, 0) < 0 && errno == EINTR)
+			;
+	runningSets = set->outer;
+	free(set->pids);
+	free(set->fds);
+	free(set->paths);
+}
+
+/**
+* Function: inheritSubstitutionDescriptors
+* -------------------------------------------
+* Keeps open across exec the pipe ends of running process substitutions that a command's arguments name
+* as /dev/fd/N, either through file actions for posix_spawn or, in a forked child, by clearing their
+* close-on-exec flag; the shell's copies stay close-on-exec so no other child inherits them
+*
+* inputArgs - the command and its arguments
+* fileActions - the file actions of the spawn, or NULL when called in the child itself
+*/
+void inheritSubstitutionDescriptors(char **inputArgs, posix_spawn_file_actions_t *fileActions)
+{
+	struct substitutionSet *set;
+	char **arg;
+	int i;
+
+	// Arguments are compared by text, as a function may pass its /dev/fd/N on to another command
+	for (set = runningSets; set != NULL; set = set->outer)
+		for (i = 0; i < set->numberOfSubstitutions; i++)
+			for (arg = inputArgs; *arg != NULL; arg++)
+			{
+				if (strcmp(*arg, set->paths[i]) != 0)
+					continue;
+				// A dup2 action onto the descriptor itself only clears its close-on-exec flag
+				if (fileActions != NULL)
+					posix_spawn_file_actions_adddup2(fileActions, set->fds[i], set->fds[i]);
+				else
+					fcntl(set->fds[i], F_SETFD, 0);
+				break;
+			}
+}
+
+/**
+* Function: closeInheritedDescriptors
+* -------------------------------------------
+* Closes every descriptor from 3 up except the pipe ends given to commands still running with process
+* substitutions; used by forked children that keep running shell code and exec nothing
+*/
+void closeInheritedDescriptors()
+{
+	struct substitutionSet *set;
+	unsigned int fd = 3;
+	unsigned int kept;
+	int i;
+
+	// Close the gaps between the kept descriptors, lowest first
+	while (1)
+	{
+		kept = UINT_MAX;
+		for (set = runningSets; set != NULL; set = set->outer)
+			for (i = 0; i < set->numberOfSubstitutions; i++)
+				if ((unsigned int) set->fds[i] >= fd && (unsigned int) set->fds[i] < kept)
+					kept = set->fds[i];
+		if (kept == UINT_MAX)
+		{
+			close_range(fd, ~0U, 0);
+			return;
+		}
+		if (kept > fd)
+			close_range(fd, kept - 1, 0);
+		fd = kept + 1;
+	}
+}
@@ -0,0 +1,83 @@
+/***********************************************************************************************************
+ * Filename: heredoc.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for delivering here-documents and here-strings to standard in and
+ * for starting process substitutions, all through pipes rather than files
+ **********************************************************************************************************/
+
+#ifndef HEREDOC_H_
+#define HEREDOC_H_
+
+#include "cli.h"
+#include "shell.h"
+
+#include <spawn.h>
+#include <sys/types.h>
+
+#define SUBSTITUTION_PATH_SIZE 24
+
+// The processes started for a command's <(COMMAND) and >(COMMAND) words, while the command runs
+struct substitutionSet
+{
+	int numberOfSubstitutions;
+	pid_t *pids;
+	int *fds;					// the shell's copies of the pipe ends the command is given, close-on-exec
+	char (*paths)[SUBSTITUTION_PATH_SIZE];	// /dev/fd/N for each of them
+	struct substitutionSet *outer;			// the set of a command still running around this one
+};
+
+/**
+* Function: openHereDocument
+* -------------------------------------------
+* Returns the read end of a close-on-exec pipe that delivers a command's here-document or here-string,
+* or -1 after reporting why it couldn't be created. A body the pipe holds whole is written before
+* returning; a longer one is fed by a forked writer while the command reads, so neither waits on the other
+*
+* command - the command, whose hereDocument is set
+*/
+int openHereDocument(const struct parsedCommand *command);
+/**
+* Function: startProcessSubstitutions
+* -------------------------------------------
+* Starts the command of each <(COMMAND) and >(COMMAND) word in a forked shell, connected by a pipe, and
+* replaces the word by /dev/fd/N, the end of the pipe the command is given; returns 0, or -1 if a pipe or
+* process couldn't be created. finishProcessSubstitutions is called afterwards either way
+*
+* command - the parsed command; its arguments and redirections are assigned the /dev/fd/N names
+* status - the shell's status, as the substitutions start with it
+* set - assigned the processes started and their pipe ends
+*/
+int startProcessSubstitutions(struct parsedCommand *command, struct shellStatus *status,
+	struct substitutionSet *set);
+/**
+* Function: finishProcessSubstitutions
+* -------------------------------------------
+* Closes the shell's copies of a set's pipe ends once its command has started or finished, so the
+* substitutions see end of file or a closed pipe, then waits for their processes when asked
+*
+* set - the set startProcessSubstitutions filled
+* waitForExit - 1 = wait for every process of the set; 0 = leave them to be reaped like any other child
+*/
+void finishProcessSubstitutions(struct substitutionSet *set, int waitForExit);
+/**
+* Function: inheritSubstitutionDescriptors
+* -------------------------------------------
+* Keeps open across exec the pipe ends of running process substitutions that a command's arguments name
+* as /dev/fd/N, either through file actions for posix_spawn or, in a forked child, by clearing their
+* close-on-exec flag; the shell's copies stay close-on-exec so no other child inherits them
+*
+* inputArgs - the command and its arguments
+* fileActions - the file actions of the spawn, or NULL when called in the child itself
+*/
+void inheritSubstitutionDescriptors(char **inputArgs, posix_spawn_file_actions_t *fileActions);
+/**
+* Function: closeInheritedDescriptors
+* -------------------------------------------
+* Closes every descriptor from 3 up except the pipe ends given to commands still running with process
+* substitutions; used by forked children that keep running shell code and exec nothing
+*/
+void closeInheritedDescriptors();
+
+#endif /* HEREDOC_H_ */
@@ -0,0 +1,596 @@
+/***********************************************************************************************************
+ * Filename: history.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the command history. Lines are kept in an append-only file that every shell
+ * writes with single O_APPEND writes, so concurrent shells share it without locks; a line that is still
+ * being written has no newline yet and is simply not seen until it does. The file is mmap'd when history
+ * is enabled and only read when it is first searched or listed: an index of entry offsets is then built by
+ * one memchr sweep and extended with whatever was appended since, each time it is used. Every block of 16
+ * entries also gets a 1024-bit signature of the character trigrams its entries contain (with a newline in
+ * front, so prefixes have a trigram of their own). A search skips every block whose signature lacks one of
+ * the trigrams of the text, which keeps lookups of rare text from reading most of the file.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "history.h"
+#include "cli.h"
+#include "util.h"
+#include "variables.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#define HISTORY_INDEX_STARTING_SIZE 1024
+#define HISTORY_LIST_BUFFER_SIZE 65536
+
+struct historySignature
+{
+	unsigned char bits[HISTORY_SIGNATURE_BITS / 8];
+};
+
+static int historyFd = -1;
+static char *mapping = NULL;
+static size_t mappedSize = 0;
+static size_t indexedBytes = 0;			// the index covers the file up to here, just past a newline
+static size_t *entryOffsets = NULL;
+static unsigned long numberOfEntries = 0;
+static unsigned long entryCapacity = 0;
+static struct historySignature *signatures = NULL;	// one per HISTORY_BLOCK_ENTRIES entries
+static char *expansion = NULL;
+static size_t expansionLength = 0;
+static size_t expansionCapacity = 0;
+
+/**
+* Function: addTrigrams
+* -------------------------------------------
+* Sets the signature bit of every trigram in a text
+*
+* signature - the signature to add to
+* text - the text
+* length - the number of bytes of text
+* fromLineStart - 1 = the text starts a line, so the newline before it makes trigrams too
+*/
+static void addTrigrams(struct historySignature *signature, const char *text, size_t length, int fromLineStart)
+{
+	size_t i;
+	unsigned int bit;
+	unsigned char previous[2] = { 0, '\n' };
+	int known = fromLineStart ? 1 : 0;
+
+	for (i = 0; i < length; i++)
+	{
+		if (known == 2)
+		{
+			// Multiplicative hash of the three bytes; the top 10 bits pick one of the 1024
+			bit = ((unsigned int) previous[0] << 16 | (unsigned int) previous[1] << 8 | (unsigned char) text[i])
+				* 2654435761u >> 22;
+			signature->bits[bit / 8] |= 1 << (bit % 8);
+		}
+		else
+			known++;
+		previous[0] = previous[1];
+		previous[1] = text[i];
+	}
+}
+
+/**
+* Function: signatureContains
+* -------------------------------------------
+* Returns 1 if a block signature has every one of a list of bits set and 0 otherwise
+*
+* block - the signature of a block of entries
+* bits - the bits of the trigrams of the text searched for
+* numberOfBits - the number of bits
+*/
+static int signatureContains(const struct historySignature *block, const unsigned short *bits, int numberOfBits)
+{
+	int i;
+	for (i = 0; i < numberOfBits; i++)
+		if (!(block->bits[bits[i] / 8] & (1 << (bits[i] % 8))))
+			return 0;
+	return 1;
+}
+
+/**
+* Function: resetIndex
+* -------------------------------------------
+* Forgets the entries indexed so far
+*/
+static void resetIndex()
+{
+	free(entryOffsets);
+	free(signatures);
+	entryOffsets = NULL;
+	signatures = NULL;
+	numberOfEntries = 0;
+	entryCapacity = 0;
+	indexedBytes = 0;
+}
+
+/**
+* Function: mapHistory
+* -------------------------------------------
+* Maps the history file again if it grew since it was last mapped; the old mapping stays if it can't be
+*/
+static void mapHistory()
+{
+	char *newMapping;
+	struct stat fileStat;
+
+	if (historyFd < 0 || fstat(historyFd, &fileStat) < 0 || (size_t) fileStat.st_size == mappedSize)
+		return;
+	// The file was cut short or replaced rather than appended to
+	if ((size_t) fileStat.st_size < indexedBytes)
+		resetIndex();
+	newMapping = fileStat.st_size > 0
+		? mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, historyFd, 0) : NULL;
+	if (newMapping == MAP_FAILED)
+		return;
+	if (mapping != NULL)
+		munmap(mapping, mappedSize);
+	mapping = newMapping;
+	mappedSize = fileStat.st_size;
+}
+
+/**
+* Function: indexHistory
+* -------------------------------------------
+* Brings the index up to date with the file: every complete line appended since the last call gets its
+* offset recorded and its trigrams added to its block's signature
+*/
+static void indexHistory()
+{
+	const char *newline;
+	size_t start;
+
+	mapHistory();
+	while (indexedBytes < mappedSize
+		&& (newline = memchr(mapping + indexedBytes, '\n', mappedSize - indexedBytes)) != NULL)
+	{
+		if (numberOfEntries == entryCapacity)
+		{
+			entryCapacity = entryCapacity ? entryCapacity * 2 : HISTORY_INDEX_STARTING_SIZE;
+			entryOffsets = realloc(entryOffsets, sizeof(size_t) * entryCapacity);
+			signatures = realloc(signatures,
+				sizeof(struct historySignature) * (entryCapacity / HISTORY_BLOCK_ENTRIES));
+		}
+		if (numberOfEntries % HISTORY_BLOCK_ENTRIES == 0)
+			memset(&signatures[numberOfEntries / HISTORY_BLOCK_ENTRIES], 0, sizeof(struct historySignature));
+
+		start = indexedBytes;
+		entryOffsets[numberOfEntries] = start;
+		addTrigrams(&signatures[numberOfEntries / HISTORY_BLOCK_ENTRIES], mapping + start,
+			newline - (mapping + start), 1);
+		numberOfEntries++;
+		indexedBytes = newline - mapping + 1;
+	}
+}
+
+/**
+* Function: enableHistory
+* -------------------------------------------
+* Opens the history file ($TINYSH_HISTORY, or ~/.tinysh_history) and maps it; nothing is read until the
+* history is first searched or listed, so this takes the same time however long the file is. Returns 0 on
+* success (or if already enabled) and -1 if the file can't be opened
+*/
+int enableHistory()
+{
+	char defaultPath[PATH_MAXIMUM];
+	const char *path = getVariable("TINYSH_HISTORY");
+
+	if (historyFd >= 0)
+		return 0;
+	if (path == NULL || *path == 0)
+	{
+		assignHomeDirectory(defaultPath);
+		if (strlen(defaultPath) + strlen(HISTORY_FILE_NAME) + 2 > sizeof(defaultPath))
+		{
+			errno = ENAMETOOLONG;
+			return -1;
+		}
+		strcat(strcat(defaultPath, "/"), HISTORY_FILE_NAME);
+		path = defaultPath;
+	}
+
+	historyFd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+	if (historyFd < 0)
+		return -1;
+	mapHistory();
+	return 0;
+}
+
+/**
+* Function: disableHistory
+* -------------------------------------------
+* Stops recording and expanding history and releases the mapping and index
+*/
+void disableHistory()
+{
+	if (historyFd < 0)
+		return;
+	close(historyFd);
+	historyFd = -1;
+	if (mapping != NULL)
+		munmap(mapping, mappedSize);
+	mapping = NULL;
+	mappedSize = 0;
+	resetIndex();
+}
+
+/**
+* Function: historyEnabled
+* -------------------------------------------
+* Returns 1 if lines are recorded and expanded and 0 otherwise
+*/
+int historyEnabled()
+{
+	return historyFd >= 0;
+}
+
+/**
+* Function: addHistory
+* -------------------------------------------
+* Appends a line to the history file with a single O_APPEND write, so shells sharing the file never
+* interleave their entries. Empty lines and lines starting with a space are not recorded
+*
+* line - the line as it will be run
+* length - the number of bytes of line
+*/
+void addHistory(const char *line, size_t length)
+{
+	struct iovec parts[2];
+
+	if (historyFd < 0 || length == 0 || line[0] == ' ')
+		return;
+	parts[0].iov_base = (void *) line;
+	parts[0].iov_len = length;
+	parts[1].iov_base = "\n";
+	parts[1].iov_len = 1;
+	writev(historyFd, parts, 2);
+}
+
+/**
+* Function: historyLength
+* -------------------------------------------
+* Returns the number of entries in the history file, including those other shells appended
+*/
+unsigned long historyLength()
+{
+	indexHistory();
+	return numberOfEntries;
+}
+
+/**
+* Function: historyEntry
+* -------------------------------------------
+* Returns the text of an entry (not terminated; valid until the history is next read) or NULL if there is
+* no such entry
+*
+* number - the entry number, 1 being the oldest
+* length - assigned the length of the entry
+*/
+const char * historyEntry(unsigned long number, size_t *length)
+{
+	size_t end;
+
+	if (number == 0 || number > numberOfEntries)
+		return NULL;
+	end = number < numberOfEntries ? entryOffsets[number] : indexedBytes;
+	*length = end - 1 - entryOffsets[number - 1];
+	return mapping + entryOffsets[number - 1];
+}
+
+/**
+* Function: searchHistory
+* -------------------------------------------
+* Returns the number of the newest entry before a given one that contains the text (or starts with it), or
+* 0 if there is none. Blocks of entries whose trigram signature lacks one of the text's trigrams are skipped
+* without being read, so rare text is found without touching most of the file
+*
+* text - the text to look for
+* length - the number of bytes of text
+* prefix - 1 = the entry has to start with the text; 0 = contain it anywhere
+* before - only entries numbered below this are searched; 0 searches them all
+*/
+unsigned long searchHistory(const char *text, size_t length, int prefix, unsigned long before)
+{
+	int bit;
+	int numberOfBits = 0;
+	unsigned short bits[HISTORY_SIGNATURE_BITS];
+	unsigned long number;
+	unsigned long block;
+	size_t entryLength;
+	const char *entry;
+	struct historySignature query;
+
+	indexHistory();
+	if (before == 0 || before > numberOfEntries)
+		before = numberOfEntries + 1;
+	// Blocks are tested against the list of the text's bits, which is short, rather than whole signatures
+	memset(&query, 0, sizeof(query));
+	addTrigrams(&query, text, length, prefix);
+	for (bit = 0; bit < HISTORY_SIGNATURE_BITS; bit++)
+		if (query.bits[bit / 8] & (1 << (bit % 8)))
+			bits[numberOfBits++] = bit;
+
+	for (number = before - 1; number >= 1; number--)
+	{
+		block = (number - 1) / HISTORY_BLOCK_ENTRIES;
+		// No entry of this block has every trigram: carry on from the last entry of the block before
+		if (!signatureContains(&signatures[block], bits, numberOfBits))
+		{
+			number = block * HISTORY_BLOCK_ENTRIES + 1;
+			continue;
+		}
+		entry = historyEntry(number, &entryLength);
+		if (prefix ? entryLength >= length && memcmp(entry, text, length) == 0
+			: memmem(entry, entryLength, text, length) != NULL)
+			return number;
+	}
+	return 0;
+}
+
+/**
+* Function: appendExpansion
+* -------------------------------------------
+* Appends bytes to the line being expanded, doubling its buffer as needed
+*
+* data - the bytes to append
+* length - the number of bytes
+*/
+static void appendExpansion(const char *data, size_t length)
+{
+	if (expansionLength + length > expansionCapacity)
+	{
+		expansionCapacity = expansionCapacity ? expansionCapacity : 256;
+		while (expansionCapacity < expansionLength + length)
+			expansionCapacity *= 2;
+		expansion = realloc(expansion, expansionCapacity);
+	}
+	memcpy(expansion + expansionLength, data, length);
+	expansionLength += length;
+}
+
+/**
+* Function: findReference
+* -------------------------------------------
+* Reads one history reference (the text after '!') and returns the number of the entry it names, or 0 if
+* none matches
+*
+* line - the line being expanded
+* length - the number of bytes of line
+* position - the index just past the '!'; assigned the index just past the reference
+* count - the number of entries in the history
+*/
+static unsigned long findReference(const char *line, size_t length, size_t *position, unsigned long count)
+{
+	size_t i = *position;
+	size_t start;
+	unsigned long value = 0;
+	int negative;
+
+	if (line[i] == '!')
+	{
+		*position = i + 1;
+		return count;
+	}
+	if (isdigit((unsigned char) line[i])
+		|| (line[i] == '-' && i + 1 < length && isdigit((unsigned char) line[i + 1])))
+	{
+		negative = line[i] == '-';
+		if (negative)
+			i++;
+		for (; i < length && isdigit((unsigned char) line[i]); i++)
+			if (value <= count)
+				value = value * 10 + (line[i] - '0');
+		*position = i;
+		if (value == 0 || value > count)
+			return 0;
+		return negative ? count + 1 - value : value;
+	}
+	if (line[i] == '?')
+	{
+		start = ++i;
+		while (i < length && line[i] != '?')
+			i++;
+		*position = i < length ? i + 1 : i;
+		return i > start ? searchHistory(line + start, i - start, 0, 0) : 0;
+	}
+
+	// A prefix runs to the next blank or operator
+	start = i;
+	while (i < length && line[i] != ' ' && line[i] != '\t' && line[i] != '|' && line[i] != '<'
+		&& line[i] != '>' && line[i] != '&')
+		i++;
+	*position = i;
+	return searchHistory(line + start, i - start, 1, 0);
+}
+
+/**
+* Function: expandHistory
+* -------------------------------------------
+* Replaces history references in a line before it is parsed; returns 1 if anything was replaced, 0 if the
+* line is unchanged and -1 (after printing an error) if a reference matches no entry. Nothing is expanded
+* inside single quotes, after a backslash, or when '!' is followed by a blank, '=' or '(' or ends the line
+*	!!        - the previous line
+*	!n / !-n  - entry n / the nth previous line
+*	!prefix   - the newest line starting with prefix
+*	!?text?   - the newest line containing text (the closing ? may be left off at the end of the line)
+*
+* line - the line as read
+* length - the number of bytes of line
+* expanded - assigned the expanded line (in the arena) when anything was replaced
+* expandedLength - assigned the length of the expanded line
+* arena - provides the expanded line
+*/
+int expandHistory(
+	const char *line, size_t length, char **expanded, size_t *expandedLength, struct arena *arena)
+{
+	size_t i;
+	size_t start;
+	size_t copied = 0;
+	int inSingleQuotes = 0;
+	int inDoubleQuotes = 0;
+	unsigned long number;
+	unsigned long count;
+	const char *entry;
+	size_t entryLength;
+
+	// Most lines have no '!' at all
+	if (historyFd < 0 || memchr(line, '!', length) == NULL)
+		return 0;
+
+	count = historyLength();
+	expansionLength = 0;
+	for (i = 0; i < length; i++)
+	{
+		if (line[i] == '\'' && !inDoubleQuotes)
+			inSingleQuotes = !inSingleQuotes;
+		else if (line[i] == '"' && !inSingleQuotes)
+			inDoubleQuotes = !inDoubleQuotes;
+		if (inSingleQuotes)
+			continue;
+		if (line[i] == '\\')
+		{
+			i++;
+			continue;
+		}
+		if (line[i] != '!' || i + 1 >= length || strchr(" \t=(", line[i + 1]) != NULL)
+			continue;
+
+		start = i++;
+		number = findReference(line, length, &i, count);
+		if (number == 0)
+		{
+			fprintf(stderr, "%.*s: event not found\n", (int) (i - start), line + start);
+			return -1;
+		}
+		appendExpansion(line + copied, start - copied);
+		entry = historyEntry(number, &entryLength);
+		appendExpansion(entry, entryLength);
+		copied = i;
+		// The loop moves past the reference
+		i--;
+	}
+	if (copied == 0)
+		return 0;
+
+	appendExpansion(line + copied, length - copied);
+	*expanded = arenaAllocate(arena, expansionLength + 1);
+	memcpy(*expanded, expansion, expansionLength);
+	(*expanded)[expansionLength] = 0;
+	*expandedLength = expansionLength;
+	return 1;
+}
+
+/**
+* Function: listEntry
+* -------------------------------------------
+* Adds one numbered entry to the listing buffer, writing the buffer out when it fills
+*
+* outputFd - where the listing goes
+* buffer - the listing buffer of HISTORY_LIST_BUFFER_SIZE bytes
+* used - the number of bytes in the buffer
+* number - the entry to list
+*/
+static void listEntry(int outputFd, char *buffer, size_t *used, unsigned long number)
+{
+	size_t length;
+	const char *entry = historyEntry(number, &length);
+
+	if (*used + length + 32 > HISTORY_LIST_BUFFER_SIZE)
+	{
+		writeAll(outputFd, buffer, *used);
+		*used = 0;
+	}
+	*used += sprintf(buffer + *used, "%5lu  ", number);
+	// An entry longer than the whole buffer goes out on its own
+	if (length + 1 > HISTORY_LIST_BUFFER_SIZE - *used)
+	{
+		writeAll(outputFd, buffer, *used);
+		writeAll(outputFd, entry, length);
+		*used = 0;
+	}
+	else
+	{
+		memcpy(buffer + *used, entry, length);
+		*used += length;
+	}
+	buffer[(*used)++] = '\n';
+}
+
+/**
+* Function: executeHistoryCommand
+* -------------------------------------------
+* Defines logic for the 'history' shell command
+*	history           - list every entry with its number
+*	history N         - list the last N entries
+*	history -s TEXT   - list the entries containing TEXT
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - the file descriptor to list entries on
+* status - unused
+*/
+int executeHistoryCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	static char buffer[HISTORY_LIST_BUFFER_SIZE];
+	size_t used = 0;
+	unsigned long count = historyLength();
+	unsigned long first = 1;
+	unsigned long number;
+	unsigned long *matches = NULL;
+	unsigned long numberOfMatches = 0;
+	unsigned long matchCapacity = 0;
+	char *end;
+
+	if (inputArgs[1] != NULL && strcmp(inputArgs[1], "-s") == 0)
+	{
+		if (inputArgs[2] == NULL)
+		{
+			fprintf(stderr, "history: usage: history [N] | history -s text\n");
+			return 1;
+		}
+		// Found newest first, listed oldest first
+		for (number = count + 1; (number = searchHistory(inputArgs[2], strlen(inputArgs[2]), 0, number)) != 0;)
+		{
+			if (numberOfMatches == matchCapacity)
+			{
+				matchCapacity = matchCapacity ? matchCapacity * 2 : 64;
+				matches = realloc(matches, sizeof(unsigned long) * matchCapacity);
+			}
+			matches[numberOfMatches++] = number;
+		}
+		while (numberOfMatches > 0)
+			listEntry(outputFd, buffer, &used, matches[--numberOfMatches]);
+		free(matches);
+	}
+	else
+	{
+		if (inputArgs[1] != NULL)
+		{
+			number = strtoul(inputArgs[1], &end, 10);
+			if (*end != 0 || !isdigit((unsigned char) inputArgs[1][0]))
+			{
+				fprintf(stderr, "history: %s: numeric argument required\n", inputArgs[1]);
+				return 1;
+			}
+			first = number < count ? count - number + 1 : 1;
+		}
+		for (number = first; number <= count; number++)
+			listEntry(outputFd, buffer, &used, number);
+	}
+	writeAll(outputFd, buffer, used);
+	return 0;
+}
@@ -0,0 +1,116 @@
+/***********************************************************************************************************
+ * Filename: history.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the persistent command history, its search index, history
+ * expansion and the 'history' builtin
+ **********************************************************************************************************/
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include "shell.h"
+#include "arena.h"
+
+#include <stddef.h>
+
+#define HISTORY_FILE_NAME ".tinysh_history"
+// Entries per search block and the size of each block's trigram signature
+#define HISTORY_BLOCK_ENTRIES 16
+#define HISTORY_SIGNATURE_BITS 1024
+
+/**
+* Function: enableHistory
+* -------------------------------------------
+* Opens the history file ($TINYSH_HISTORY, or ~/.tinysh_history) and maps it; nothing is read until the
+* history is first searched or listed, so this takes the same time however long the file is. Returns 0 on
+* success (or if already enabled) and -1 if the file can't be opened
+*/
+int enableHistory();
+/**
+* Function: disableHistory
+* -------------------------------------------
+* Stops recording and expanding history and releases the mapping and index
+*/
+void disableHistory();
+/**
+* Function: historyEnabled
+* -------------------------------------------
+* Returns 1 if lines are recorded and expanded and 0 otherwise
+*/
+int historyEnabled();
+/**
+* Function: addHistory
+* -------------------------------------------
+* Appends a line to the history file with a single O_APPEND write, so shells sharing the file never
+* interleave their entries. Empty lines and lines starting with a space are not recorded
+*
+* line - the line as it will be run
+* length - the number of bytes of line
+*/
+void addHistory(const char *line, size_t length);
+/**
+* Function: historyLength
+* -------------------------------------------
+* Returns the number of entries in the history file, including those other shells appended
+*/
+unsigned long historyLength();
+/**
+* Function: historyEntry
+* -------------------------------------------
+* Returns the text of an entry (not terminated; valid until the history is next read) or NULL if there is
+* no such entry
+*
+* number - the entry number, 1 being the oldest
+* length - assigned the length of the entry
+*/
+const char * historyEntry(unsigned long number, size_t *length);
+/**
+* Function: searchHistory
+* -------------------------------------------
+* Returns the number of the newest entry before a given one that contains the text (or starts with it), or
+* 0 if there is none. Blocks of entries whose trigram signature lacks one of the text's trigrams are skipped
+* without being read, so rare text is found without touching most of the file
+*
+* text - the text to look for
+* length - the number of bytes of text
+* prefix - 1 = the entry has to start with the text; 0 = contain it anywhere
+* before - only entries numbered below this are searched; 0 searches them all
+*/
+unsigned long searchHistory(const char *text, size_t length, int prefix, unsigned long before);
+/**
+* Function: expandHistory
+* -------------------------------------------
+* Replaces history references in a line before it is parsed; returns 1 if anything was replaced, 0 if the
+* line is unchanged and -1 (after printing an error) if a reference matches no entry. Nothing is expanded
+* inside single quotes, after a backslash, or when '!' is followed by a blank, '=' or '(' or ends the line
+*	!!        - the previous line
+*	!n / !-n  - entry n / the nth previous line
+*	!prefix   - the newest line starting with prefix
+*	!?text?   - the newest line containing text (the closing ? may be left off at the end of the line)
+*
+* line - the line as read
+* length - the number of bytes of line
+* expanded - assigned the expanded line (in the arena) when anything was replaced
+* expandedLength - assigned the length of the expanded line
+* arena - provides the expanded line
+*/
+int expandHistory(
+	const char *line, size_t length, char **expanded, size_t *expandedLength, struct arena *arena);
+/**
+* Function: executeHistoryCommand
+* -------------------------------------------
+* Defines logic for the 'history' shell command
+*	history           - list every entry with its number
+*	history N         - list the last N entries
+*	history -s TEXT   - list the entries containing TEXT
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - the file descriptor to list entries on
+* status - unused
+*/
+int executeHistoryCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+
+#endif /* HISTORY_H_ */
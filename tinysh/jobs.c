@@ -0,0 +1,331 @@
+/***********************************************************************************************************
+ * Filename: jobs.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the job table. Jobs live in slots indexed by job number with a stack of freed
+ * slots, so insert and remove are constant time; a separate open-addressing hash (linear probing with
+ * backward-shift deletion) maps every live pid to its job's slot for constant time lookup when reaping.
+ **********************************************************************************************************/
+
+#include "jobs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static struct job **slots = NULL;
+static int numberOfSlots = 0;		// slots handed out so far (highest job number)
+static int maxNumberOfSlots = 0;
+static int *freeSlots = NULL;		// stack of slot indices released by removeJob
+static int numberOfFreeSlots = 0;
+static int jobCount = 0;
+static unsigned long jobSequence = 0;
+
+// pid -> slot index; a key of 0 marks an empty bucket
+static pid_t *pidKeys = NULL;
+static int *pidValues = NULL;
+static int pidCapacity = 0;
+static int numberOfIndexedPids = 0;
+
+/**
+* Function: pidBucket
+* -------------------------------------------
+* Returns the home bucket of a pid in the pid index
+*
+* pid - the pid to hash
+*/
+static int pidBucket(pid_t pid)
+{
+	return (int) (((unsigned int) pid * 2654435761u) & (unsigned int) (pidCapacity - 1));
+}
+
+/**
+* Function: insertPid
+* -------------------------------------------
+* Adds a pid -> slot mapping to the pid index, doubling the index when it gets half full
+*
+* pid - the pid to index
+* slot - the slot index of the job owning the pid
+*/
+static void insertPid(pid_t pid, int slot)
+{
+	int i;
+	int bucket;
+
+	if ((numberOfIndexedPids + 1) * 2 > pidCapacity)
+	{
+		pid_t *oldKeys = pidKeys;
+		int *oldValues = pidValues;
+		int oldCapacity = pidCapacity;
+
+		pidCapacity = pidCapacity ? pidCapacity * 2 : JOBS_STARTING_SLOTS * 2;
+		pidKeys = calloc(pidCapacity, sizeof(pid_t));
+		pidValues = calloc(pidCapacity, sizeof(int));
+		numberOfIndexedPids = 0;
+		for (i = 0; i < oldCapacity; i++)
+			if (oldKeys[i] != 0)
+				insertPid(oldKeys[i], oldValues[i]);
+		free(oldKeys);
+		free(oldValues);
+	}
+
+	bucket = pidBucket(pid);
+	while (pidKeys[bucket] != 0 && pidKeys[bucket] != pid)
+		bucket = (bucket + 1) & (pidCapacity - 1);
+	if (pidKeys[bucket] == 0)
+		numberOfIndexedPids++;
+	pidKeys[bucket] = pid;
+	pidValues[bucket] = slot;
+}
+
+/**
+* Function: findPidBucket
+* -------------------------------------------
+* Returns the bucket holding a pid in the pid index or -1 if the pid isn't indexed
+*
+* pid - the pid to find
+*/
+static int findPidBucket(pid_t pid)
+{
+	int bucket;
+	if (pidCapacity == 0 || pid <= 0)
+		return -1;
+	bucket = pidBucket(pid);
+	while (pidKeys[bucket] != 0)
+	{
+		if (pidKeys[bucket] == pid)
+			return bucket;
+		bucket = (bucket + 1) & (pidCapacity - 1);
+	}
+	return -1;
+}
+
+/**
+* Function: deletePid
+* -------------------------------------------
+* Removes a pid from the pid index, shifting later entries of its probe run back so lookups never need
+* tombstones
+*
+* pid - the pid to remove
+*/
+static void deletePid(pid_t pid)
+{
+	int hole = findPidBucket(pid);
+	int bucket;
+	int home;
+
+	if (hole < 0)
+		return;
+	pidKeys[hole] = 0;
+	numberOfIndexedPids--;
+
+	bucket = (hole + 1) & (pidCapacity - 1);
+	while (pidKeys[bucket] != 0)
+	{
+		home = pidBucket(pidKeys[bucket]);
+		// Move the entry into the hole unless its home lies cyclically between the hole and its bucket
+		if ((bucket > hole && (home <= hole || home > bucket)) || (bucket < hole && home <= hole && home > bucket))
+		{
+			pidKeys[hole] = pidKeys[bucket];
+			pidValues[hole] = pidValues[bucket];
+			pidKeys[bucket] = 0;
+			hole = bucket;
+		}
+		bucket = (bucket + 1) & (pidCapacity - 1);
+	}
+}
+
+/**
+* Function: takeFreeSlot
+* -------------------------------------------
+* Returns the index of an unused slot, reusing a freed one when possible and growing the slot array
+* (by element count) otherwise
+*/
+static int takeFreeSlot()
+{
+	if (numberOfFreeSlots > 0)
+		return freeSlots[--numberOfFreeSlots];
+
+	if (numberOfSlots == maxNumberOfSlots)
+	{
+		int newMaxNumberOfSlots = maxNumberOfSlots ? maxNumberOfSlots * 2 : JOBS_STARTING_SLOTS;
+		struct job **newSlots = realloc(slots, sizeof(struct job *) * newMaxNumberOfSlots);
+		int *newFreeSlots = realloc(freeSlots, sizeof(int) * newMaxNumberOfSlots);
+		if (newSlots == NULL || newFreeSlots == NULL)
+			abort();
+		slots = newSlots;
+		freeSlots = newFreeSlots;
+		maxNumberOfSlots = newMaxNumberOfSlots;
+	}
+	slots[numberOfSlots] = NULL;
+	return numberOfSlots++;
+}
+
+/**
+* Function: addJob
+* -------------------------------------------
+* Inserts a job into the table in constant time and returns it; the job number reuses the most recently
+* freed slot or takes the next new one
+*
+* pids - the pids of every process in the job (pipeline stages in order)
+* numberOfPids - the length of the pids array
+* commandLine - the text of the command, copied into the job
+* state - JOB_RUNNING or JOB_STOPPED
+*/
+struct job * addJob(pid_t *pids, int numberOfPids, const char *commandLine, int state)
+{
+	int i;
+	int slot = takeFreeSlot();
+	struct job *job = calloc(1, sizeof(struct job));
+
+	job->jobNumber = slot + 1;
+	job->state = state;
+	job->pids = malloc(sizeof(pid_t) * numberOfPids);
+	memcpy(job->pids, pids, sizeof(pid_t) * numberOfPids);
+	job->numberOfPids = numberOfPids;
+	job->lastPid = pids[numberOfPids - 1];
+	job->commandLine = strdup(commandLine);
+	job->sequence = ++jobSequence;
+	clock_gettime(CLOCK_MONOTONIC, &job->startTime);
+
+	for (i = 0; i < numberOfPids; i++)
+	{
+		if (pids[i] > 0)
+		{
+			insertPid(pids[i], slot);
+			job->numberOfLivePids++;
+		}
+	}
+	slots[slot] = job;
+	jobCount++;
+	return job;
+}
+
+/**
+* Function: removeJob
+* -------------------------------------------
+* Removes a job from the table in constant time (per process in the job) and frees it
+*
+* job - the job to remove
+*/
+void removeJob(struct job *job)
+{
+	int i;
+	int slot = job->jobNumber - 1;
+
+	for (i = 0; i < job->numberOfPids; i++)
+		if (job->pids[i] > 0)
+			deletePid(job->pids[i]);
+
+	slots[slot] = NULL;
+	freeSlots[numberOfFreeSlots++] = slot;
+	jobCount--;
+
+	free(job->pids);
+	free(job->commandLine);
+	free(job);
+}
+
+/**
+* Function: findJobByPid
+* -------------------------------------------
+* Returns the job one of whose live processes has the given pid or NULL if there is none
+*
+* pid - the pid to look up
+*/
+struct job * findJobByPid(pid_t pid)
+{
+	int bucket = findPidBucket(pid);
+	return bucket < 0 ? NULL : slots[pidValues[bucket]];
+}
+
+/**
+* Function: findJobByNumber
+* -------------------------------------------
+* Returns the job with the given job number or NULL if there is none
+*
+* jobNumber - the job number as shown by 'jobs'
+*/
+struct job * findJobByNumber(int jobNumber)
+{
+	if (jobNumber < 1 || jobNumber > numberOfSlots)
+		return NULL;
+	return slots[jobNumber - 1];
+}
+
+/**
+* Function: currentJob
+* -------------------------------------------
+* Returns the job most recently started or stopped (the default for 'fg' and 'bg') or NULL if there are no jobs
+*/
+struct job * currentJob()
+{
+	struct job *job = NULL;
+	struct job *candidate = NULL;
+	while ((candidate = nextJob(candidate)) != NULL)
+		if (job == NULL || candidate->sequence > job->sequence)
+			job = candidate;
+	return job;
+}
+
+/**
+* Function: nextJob
+* -------------------------------------------
+* Iterates over the jobs in job number order; pass NULL to get the first job. Returns NULL after the last one
+*
+* job - the job returned by the previous call or NULL
+*/
+struct job * nextJob(struct job *job)
+{
+	int slot = job == NULL ? 0 : job->jobNumber;
+	for (; slot < numberOfSlots; slot++)
+		if (slots[slot] != NULL)
+			return slots[slot];
+	return NULL;
+}
+
+/**
+* Function: markJobPidReaped
+* -------------------------------------------
+* Records that one process of a job has been waited for and returns the number of its processes still alive
+*
+* job - the job the process belongs to
+* pid - the pid that was reaped
+*/
+int markJobPidReaped(struct job *job, pid_t pid)
+{
+	int i;
+	for (i = 0; i < job->numberOfPids; i++)
+	{
+		if (job->pids[i] == pid)
+		{
+			deletePid(pid);
+			job->pids[i] = 0;
+			job->numberOfLivePids--;
+			break;
+		}
+	}
+	return job->numberOfLivePids;
+}
+
+/**
+* Function: touchJob
+* -------------------------------------------
+* Makes a job the current job, as when it is stopped or resumed
+*
+* job - the job to promote
+*/
+void touchJob(struct job *job)
+{
+	job->sequence = ++jobSequence;
+}
+
+/**
+* Function: numberOfJobs
+* -------------------------------------------
+* Returns how many jobs are in the table
+*/
+int numberOfJobs()
+{
+	return jobCount;
+}
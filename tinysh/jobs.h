@@ -0,0 +1,115 @@
+/***********************************************************************************************************
+ * Filename: jobs.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the job table tracking background and stopped commands
+ **********************************************************************************************************/
+
+#ifndef JOBS_H_
+#define JOBS_H_
+
+#include "trace.h"
+
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define JOB_RUNNING 0
+#define JOB_STOPPED 1
+
+#define JOBS_STARTING_SLOTS 16
+
+struct job
+{
+	int jobNumber;
+	int state;						// JOB_RUNNING or JOB_STOPPED
+	pid_t *pids;					// one pid per pipeline stage; 0 once that stage has been reaped
+	int numberOfPids;
+	int numberOfLivePids;
+	pid_t lastPid;					// pid of the last stage, reported when the job is done
+	int terminationStatus;			// exit value or signal of the last stage once it finished
+	int signalOrTerminated;			// 0 = normal exit, 1 = signal terminated
+	char *commandLine;
+	struct timespec startTime;		// CLOCK_MONOTONIC time the job was started
+	struct rusage usage;			// resources used by the job's processes reaped so far
+	int timed;						// 1 = started with 'time'; report the usage once the job is done
+	struct commandTrace trace;		// parse, spawn and exec times for the execution trace
+	unsigned long sequence;			// order jobs were added or last stopped, for picking the current job
+};
+
+/**
+* Function: addJob
+* -------------------------------------------
+* Inserts a job into the table in constant time and returns it; the job number reuses the most recently
+* freed slot or takes the next new one
+*
+* pids - the pids of every process in the job (pipeline stages in order)
+* numberOfPids - the length of the pids array
+* commandLine - the text of the command, copied into the job
+* state - JOB_RUNNING or JOB_STOPPED
+*/
+struct job * addJob(pid_t *pids, int numberOfPids, const char *commandLine, int state);
+/**
+* Function: removeJob
+* -------------------------------------------
+* Removes a job from the table in constant time (per process in the job) and frees it
+*
+* job - the job to remove
+*/
+void removeJob(struct job *job);
+/**
+* Function: findJobByPid
+* -------------------------------------------
+* Returns the job one of whose live processes has the given pid or NULL if there is none
+*
+* pid - the pid to look up
+*/
+struct job * findJobByPid(pid_t pid);
+/**
+* Function: findJobByNumber
+* -------------------------------------------
+* Returns the job with the given job number or NULL if there is none
+*
+* jobNumber - the job number as shown by 'jobs'
+*/
+struct job * findJobByNumber(int jobNumber);
+/**
+* Function: currentJob
+* -------------------------------------------
+* Returns the job most recently started or stopped (the default for 'fg' and 'bg') or NULL if there are no jobs
+*/
+struct job * currentJob();
+/**
+* Function: nextJob
+* -------------------------------------------
+* Iterates over the jobs in job number order; pass NULL to get the first job. Returns NULL after the last one
+*
+* job - the job returned by the previous call or NULL
+*/
+struct job * nextJob(struct job *job);
+/**
+* Function: markJobPidReaped
+* -------------------------------------------
+* Records that one process of a job has been waited for and returns the number of its processes still alive
+*
+* job - the job the process belongs to
+* pid - the pid that was reaped
+*/
+int markJobPidReaped(struct job *job, pid_t pid);
+/**
+* Function: touchJob
+* -------------------------------------------
+* Makes a job the current job, as when it is stopped or resumed
+*
+* job - the job to promote
+*/
+void touchJob(struct job *job);
+/**
+* Function: numberOfJobs
+* -------------------------------------------
+* Returns how many jobs are in the table
+*/
+int numberOfJobs();
+
+#endif /* JOBS_H_ */
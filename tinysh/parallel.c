@@ -0,0 +1,420 @@
+/***********************************************************************************************************
+ * Filename: parallel.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the 'parallel' builtin. A command template is expanded once per argument and
+ * every expansion is started through the same pipeline launch path as a typed command, keeping at most N
+ * of them in flight. Each job writes into its own memory files, one for standard out and one for standard
+ * error, so outputs come out whole, one job at a time, in the order the jobs finish. Children that belong
+ * to background jobs and happen to exit meanwhile are handed to the job table like at the prompt.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "parallel.h"
+#include "copy.h"
+#include "cli.h"
+#include "arena.h"
+#include "events.h"
+#include "reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+struct parallelJob
+{
+	pid_t *pids;				// one per stage, 0 once reaped; NULL when the slot is free
+	int numberOfStages;
+	int numberOfLivePids;
+	pid_t lastPid;
+	int outputFd;				// memory file holding the job's output or -1 when it writes straight through
+	int errorFd;				// memory file holding what the job writes to standard error, or -1
+	int failed;
+};
+
+struct argumentSource
+{
+	char **args;				// the arguments after ::: or NULL to read lines
+	struct lineReader *reader;
+};
+
+/**
+* Function: nextArgument
+* -------------------------------------------
+* Returns the next argument to run the template with, or NULL once there are no more. Empty input lines
+* are skipped
+*
+* source - the arguments after ::: or the reader of standard in
+*/
+static char * nextArgument(struct argumentSource *source)
+{
+	char *line;
+	size_t length;
+
+	if (source->args != NULL)
+		return *source->args != NULL ? *source->args++ : NULL;
+
+	while ((line = readLine(source->reader, &length)) != NULL)
+		if (length > 0)
+			return line;
+	return NULL;
+}
+
+/**
+* Function: appendQuoted
+* -------------------------------------------
+* Copies text in single quotes ('\'' standing for a quote inside) so the parser reads it back unchanged;
+* returns the end of what was written. Needs at most 4 * length + 2 bytes
+*
+* destination - where to write
+* text - the text to quote
+* length - the number of bytes of text
+*/
+static char * appendQuoted(char *destination, const char *text, size_t length)
+{
+	*destination++ = '\'';
+	for (; length > 0; length--, text++)
+	{
+		if (*text == '\'')
+		{
+			memcpy(destination, "'\\''", 4);
+			destination += 4;
+		}
+		else
+			*destination++ = *text;
+	}
+	*destination++ = '\'';
+	return destination;
+}
+
+/**
+* Function: buildJobLine
+* -------------------------------------------
+* Returns the command line for one job, with every '{}' in the template replaced by the quoted argument or
+* the argument appended when the template has no '{}'. A template given as one word is a command line of
+* its own (pipes and redirections work); the words of a longer template are quoted and stay single words
+*
+* templateArgs - the words of the template
+* numberOfTemplateArgs - the number of template words
+* argument - the argument for this job
+* arena - provides the line
+*/
+static char * buildJobLine(
+	char **templateArgs, int numberOfTemplateArgs, const char *argument, struct arena *arena)
+{
+	int i;
+	int placeholders = 0;
+	int literalWords = numberOfTemplateArgs > 1;
+	size_t argumentLength = strlen(argument);
+	size_t length = 1;
+	const char *text;
+	const char *placeholder;
+	char *line;
+	char *destination;
+
+	for (i = 0; i < numberOfTemplateArgs; i++)
+	{
+		length += 4 * strlen(templateArgs[i]) + 3;
+		for (text = strstr(templateArgs[i], "{}"); text != NULL; text = strstr(text + 2, "{}"))
+		{
+			placeholders++;
+			length += 2;
+		}
+	}
+	length += (placeholders + 1) * (4 * argumentLength + 3);
+
+	line = destination = arenaAllocate(arena, length);
+	for (i = 0; i < numberOfTemplateArgs; i++)
+	{
+		if (i > 0)
+			*destination++ = ' ';
+		text = templateArgs[i];
+		// An empty word still has to come back as an argument
+		if (literalWords && *text == 0)
+			destination = appendQuoted(destination, text, 0);
+		while (*text != 0)
+		{
+			placeholder = strstr(text, "{}");
+			length = placeholder != NULL ? (size_t) (placeholder - text) : strlen(text);
+			if (literalWords && length > 0)
+				destination = appendQuoted(destination, text, length);
+			else
+			{
+				memcpy(destination, text, length);
+				destination += length;
+			}
+			text += length;
+			if (placeholder != NULL)
+			{
+				destination = appendQuoted(destination, argument, argumentLength);
+				text += 2;
+			}
+		}
+	}
+	if (placeholders == 0)
+	{
+		*destination++ = ' ';
+		destination = appendQuoted(destination, argument, argumentLength);
+	}
+	*destination = 0;
+	return line;
+}
+
+/**
+* Function: startJob
+* -------------------------------------------
+* Parses one job's command line and starts it; returns the number of its processes running (0 if nothing
+* could be started, in which case the job is marked failed). Standard error is pointed at the job's error
+* file while its processes start, so they inherit it
+*
+* job - the free slot to start the job in
+* line - the job's command line
+* inputFd - standard in for the job or -1 to inherit the shell's
+* outputFd - where the job writes when its output can't be held in a memory file
+* arena - provides the parsed arguments
+* status - the shell's status, handed to builtins run as jobs
+*/
+static int startJob(
+	struct parallelJob *job, char *line, int inputFd, int outputFd,
+	struct arena *arena, struct shellStatus *status)
+{
+	int stage;
+	int savedError = -1;
+	struct parsedCommand command;
+
+	job->numberOfStages = 0;
+	job->numberOfLivePids = 0;
+	job->lastPid = -1;
+	job->failed = 1;
+	job->outputFd = -1;
+	job->errorFd = -1;
+	if (parseArgs(line, &command, arena) != 0 || command.args[0] == NULL)
+	{
+		job->pids = malloc(sizeof(pid_t));
+		return 0;
+	}
+
+	command.runInBackground = 0;
+	job->pids = malloc(sizeof(pid_t) * command.numberOfStages);
+	job->outputFd = memfd_create("parallel", MFD_CLOEXEC);
+	job->errorFd = memfd_create("parallel-errors", MFD_CLOEXEC);
+	if (job->errorFd >= 0)
+	{
+		fflush(stderr);
+		savedError = fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 10);
+		dup2(job->errorFd, STDERR_FILENO);
+	}
+	job->numberOfStages = launchPipeline(&command, inputFd, job->outputFd >= 0 ? job->outputFd : outputFd,
+		job->pids, status);
+	if (savedError >= 0)
+	{
+		fflush(stderr);
+		dup2(savedError, STDERR_FILENO);
+		close(savedError);
+	}
+
+	for (stage = 0; stage < job->numberOfStages; stage++)
+		if (job->pids[stage] > 0)
+			job->numberOfLivePids++;
+	if (job->numberOfStages > 0 && job->pids[job->numberOfStages - 1] > 0)
+	{
+		job->lastPid = job->pids[job->numberOfStages - 1];
+		job->failed = 0;
+	}
+	return job->numberOfLivePids;
+}
+
+/**
+* Function: finishJob
+* -------------------------------------------
+* Writes a finished job's held output in one piece, followed by what it wrote to standard error, and frees
+* its slot; returns 1 if the job failed and 0 otherwise
+*
+* job - the finished job
+* outputFd - where the output goes
+*/
+static int finishJob(struct parallelJob *job, int outputFd)
+{
+	if (job->outputFd >= 0)
+	{
+		lseek(job->outputFd, 0, SEEK_SET);
+		copyFileData(job->outputFd, outputFd);
+		close(job->outputFd);
+	}
+	if (job->errorFd >= 0)
+	{
+		lseek(job->errorFd, 0, SEEK_SET);
+		copyFileData(job->errorFd, STDERR_FILENO);
+		close(job->errorFd);
+	}
+	free(job->pids);
+	job->pids = NULL;
+	return job->failed;
+}
+
+/**
+* Function: findJobStage
+* -------------------------------------------
+* Returns the running job a pid belongs to, or NULL if it isn't one of the parallel jobs
+*
+* jobs - the job slots
+* numberOfSlots - the number of slots
+* pid - the pid reaped
+* stage - assigned the stage the pid runs
+*/
+static struct parallelJob * findJobStage(struct parallelJob *jobs, int numberOfSlots, pid_t pid, int *stage)
+{
+	int i;
+	for (i = 0; i < numberOfSlots; i++)
+	{
+		if (jobs[i].pids == NULL)
+			continue;
+		for (*stage = 0; *stage < jobs[i].numberOfStages; (*stage)++)
+			if (jobs[i].pids[*stage] == pid)
+				return &jobs[i];
+	}
+	return NULL;
+}
+
+/**
+* Function: executeParallelCommand
+* -------------------------------------------
+* Defines logic for the 'parallel' shell command, which runs a command template once per argument with at
+* most N commands in flight, starting the next one as soon as one finishes
+*	parallel [-j N] command [{}]... ::: argument... - run the template for each argument after :::
+*	parallel [-j N] command [{}]...                 - run the template for each line of standard in
+* '{}' in the template is replaced by the argument (appended when there is no '{}'); a template given as
+* one quoted word is parsed as a command line, so pipes and redirections work. Each job's output and
+* errors are held until it finishes and then written in one piece each, standard out first. N defaults
+* to the number of online CPUs; the exit value is the number of jobs that failed, capped at 101. ^C stops
+* new jobs from starting; the running ones are waited for and the exit value is 130
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - where argument lines are read from when there is no :::
+* outputFd - where the output of each job is written
+* status - the shell's status, handed to builtins run as jobs
+*/
+int executeParallelCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int i = 1;
+	int stage;
+	int childStatus;
+	int running = 0;
+	int failures = 0;
+	int interrupted = 0;
+	int numberOfTemplateArgs = 0;
+	int maximumJobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	int childInput = -1;
+	char *argument;
+	char **templateArgs;
+	pid_t pid;
+	struct rusage usage;
+	struct parallelJob *jobs;
+	struct parallelJob *job;
+	struct argumentSource source = { NULL, NULL };
+	struct lineReader reader;
+	struct arena arena;
+
+	if (inputArgs[i] != NULL && strcmp(inputArgs[i], "-j") == 0 && inputArgs[i + 1] != NULL)
+	{
+		maximumJobs = atoi(inputArgs[i + 1]);
+		i += 2;
+	}
+	else if (inputArgs[i] != NULL && strncmp(inputArgs[i], "-j", 2) == 0)
+		maximumJobs = atoi(inputArgs[i++] + 2);
+
+	templateArgs = inputArgs + i;
+	while (templateArgs[numberOfTemplateArgs] != NULL && strcmp(templateArgs[numberOfTemplateArgs], ":::") != 0)
+		numberOfTemplateArgs++;
+	if (maximumJobs < 1 || numberOfTemplateArgs == 0)
+	{
+		fprintf(stderr, "parallel: usage: parallel [-j N] command [{}]... [::: argument...]\n");
+		return 2;
+	}
+
+	// Arguments come after ::: or, without it, one per line of standard in, which the jobs then don't share
+	if (templateArgs[numberOfTemplateArgs] != NULL)
+		source.args = templateArgs + numberOfTemplateArgs + 1;
+	else
+	{
+		initializeFileReader(&reader, inputFd);
+		source.reader = &reader;
+		childInput = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	}
+
+	jobs = calloc(maximumJobs, sizeof(struct parallelJob));
+	initializeArena(&arena);
+	// A ^C typed before the command started isn't meant for it
+	takeInterrupts();
+	while (1)
+	{
+		if (takeInterrupts() > 0)
+			interrupted = 1;
+		// Fill every free slot before waiting; after ^C only the running jobs are waited for
+		while (!interrupted && running < maximumJobs && (argument = nextArgument(&source)) != NULL)
+		{
+			for (job = jobs; job->pids != NULL; job++)
+				;
+			if (startJob(job, buildJobLine(templateArgs, numberOfTemplateArgs, argument, &arena),
+				childInput, outputFd, &arena, status) > 0)
+				running++;
+			else
+				failures += finishJob(job, outputFd);
+			resetArena(&arena);
+		}
+		if (running == 0)
+			break;
+
+		pid = wait4(-1, &childStatus, 0, &usage);
+		if (pid < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			perror("parallel");
+			break;
+		}
+		job = findJobStage(jobs, maximumJobs, pid, &stage);
+		// A background job finished meanwhile
+		if (job == NULL)
+		{
+			recordChildStateChange(pid, childStatus, &usage);
+			continue;
+		}
+
+		// The shell ignores ^C, so a job it killed is another sign of one
+		if (WIFSIGNALED(childStatus) && WTERMSIG(childStatus) == SIGINT)
+			interrupted = 1;
+		job->pids[stage] = 0;
+		job->numberOfLivePids--;
+		// A job's status is its last stage's, as for a pipeline typed at the prompt
+		if (pid == job->lastPid)
+			job->failed = !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0;
+		if (job->numberOfLivePids == 0)
+		{
+			failures += finishJob(job, outputFd);
+			running--;
+		}
+	}
+
+	for (i = 0; i < maximumJobs; i++)
+		if (jobs[i].pids != NULL)
+			failures += finishJob(&jobs[i], outputFd);
+	freeArena(&arena);
+	free(jobs);
+	if (source.reader != NULL)
+	{
+		freeLineReader(&reader);
+		close(childInput);
+	}
+	if (interrupted)
+		return 128 + SIGINT;
+	return failures < PARALLEL_MAXIMUM_FAILURES ? failures : PARALLEL_MAXIMUM_FAILURES;
+}
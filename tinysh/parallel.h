@@ -0,0 +1,38 @@
+/***********************************************************************************************************
+ * Filename: parallel.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the 'parallel' builtin running a command template over many
+ * arguments with bounded concurrency
+ **********************************************************************************************************/
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include "shell.h"
+
+// Exit status once more than this many jobs failed, as with GNU parallel
+#define PARALLEL_MAXIMUM_FAILURES 101
+
+/**
+* Function: executeParallelCommand
+* -------------------------------------------
+* Defines logic for the 'parallel' shell command, which runs a command template once per argument with at
+* most N commands in flight, starting the next one as soon as one finishes
+*	parallel [-j N] command [{}]... ::: argument... - run the template for each argument after :::
+*	parallel [-j N] command [{}]...                 - run the template for each line of standard in
+* '{}' in the template is replaced by the argument (appended when there is no '{}'); a template given as
+* one quoted word is parsed as a command line, so pipes and redirections work. Each job's output and
+* errors are held until it finishes and then written in one piece each, standard out first. N defaults
+* to the number of online CPUs; the exit value is the number of jobs that failed, capped at 101. ^C stops
+* new jobs from starting; the running ones are waited for and the exit value is 130
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - where argument lines are read from when there is no :::
+* outputFd - where the output of each job is written
+* status - the shell's status, handed to builtins run as jobs
+*/
+int executeParallelCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+
+#endif /* PARALLEL_H_ */
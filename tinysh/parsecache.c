@@ -0,0 +1,309 @@
+/***********************************************************************************************************
+ * Filename: parsecache.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements a bounded cache of parsed command lines keyed by the raw text. Scripts and loops
+ * run the same lines over and over; a hit replaces tokenizing with one copy of the stored argument layout,
+ * or, for a line whose words are expanded, with expanding the words of its stored template.
+ * Entries sit in a hash table for lookup and on a doubly linked list in use order, so the least recently
+ * used line is evicted in constant time once PARSE_CACHE_CAPACITY lines are held.
+ **********************************************************************************************************/
+
+#include "parsecache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct parseCacheEntry
+{
+	struct parseCacheEntry *next;		// next entry in the same bucket
+	struct parseCacheEntry *newer;		// neighbours in use order
+	struct parseCacheEntry *older;
+	unsigned int hash;
+	size_t lineLength;
+	char *line;							// the raw text, used as the key
+	char *text;							// the line after parsing; the arguments point into it
+	struct parsedCommand command;
+	struct commandTemplate *template;	// the line's words when they are expanded, or NULL
+};
+
+static struct parseCacheEntry *buckets[PARSE_CACHE_BUCKETS];
+static struct parseCacheEntry *newest = NULL;
+static struct parseCacheEntry *oldest = NULL;
+static int numberOfEntries = 0;
+static unsigned long hits = 0;
+static unsigned long misses = 0;
+
+/**
+* Function: hashLine
+* -------------------------------------------
+* Returns the FNV-1a hash of a line
+*
+* line - the text to hash
+* length - the length of the text
+*/
+static unsigned int hashLine(const char *line, size_t length)
+{
+	unsigned int hash = 2166136261u;
+	while (length-- > 0)
+	{
+		hash ^= (unsigned char) *line++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* Function: unlinkEntry
+* -------------------------------------------
+* Takes an entry off the use-order list
+*
+* entry - the entry to unlink
+*/
+static void unlinkEntry(struct parseCacheEntry *entry)
+{
+	if (entry->newer != NULL)
+		entry->newer->older = entry->older;
+	else
+		newest = entry->older;
+	if (entry->older != NULL)
+		entry->older->newer = entry->newer;
+	else
+		oldest = entry->newer;
+}
+
+/**
+* Function: markNewest
+* -------------------------------------------
+* Puts an entry at the most recently used end of the use-order list
+*
+* entry - the entry just used
+*/
+static void markNewest(struct parseCacheEntry *entry)
+{
+	entry->newer = NULL;
+	entry->older = newest;
+	if (newest != NULL)
+		newest->newer = entry;
+	newest = entry;
+	if (oldest == NULL)
+		oldest = entry;
+}
+
+/**
+* Function: removeEntry
+* -------------------------------------------
+* Drops an entry from its bucket and the use-order list and frees it
+*
+* entry - the entry to remove
+*/
+static void removeEntry(struct parseCacheEntry *entry)
+{
+	struct parseCacheEntry **link = &buckets[entry->hash & (PARSE_CACHE_BUCKETS - 1)];
+	while (*link != entry)
+		link = &(*link)->next;
+	*link = entry->next;
+	unlinkEntry(entry);
+	free(entry);
+	numberOfEntries--;
+}
+
+/**
+* Function: findEntry
+* -------------------------------------------
+* Returns the entry holding exactly the given line or NULL if it is not cached
+*
+* line - the raw text to find
+* length - the length of the text
+* hash - the hash of the text
+*/
+static struct parseCacheEntry * findEntry(const char *line, size_t length, unsigned int hash)
+{
+	struct parseCacheEntry *entry = buckets[hash & (PARSE_CACHE_BUCKETS - 1)];
+	while (entry != NULL &&
+		(entry->hash != hash || entry->lineLength != length || memcmp(entry->line, line, length) != 0))
+		entry = entry->next;
+	return entry;
+}
+
+/**
+* Function: rebase
+* -------------------------------------------
+* Returns where a pointer into one copy of a parsed line lands in another copy (NULL stays NULL)
+*
+* pointer - the pointer into the original copy
+* from - the start of the original copy
+* to - the start of the new copy
+*/
+static char * rebase(char *pointer, char *from, char *to)
+{
+	return pointer == NULL ? NULL : to + (pointer - from);
+}
+
+/**
+* Function: copyParsedCommand
+* -------------------------------------------
+* Copies a parsed command, its argument array and the parsed text it points into, to new storage
+*
+* source - the command to copy; its arguments point into sourceText
+* sourceText - the parsed text
+* textLength - the number of bytes of parsed text, terminator included
+* destination - assigned the copy
+* args - room for source->numberOfArgs arguments
+* text - room for textLength bytes
+*/
+static void copyParsedCommand(
+	struct parsedCommand *source, char *sourceText, size_t textLength,
+	struct parsedCommand *destination, char **args, char *text)
+{
+	int i;
+
+	memcpy(text, sourceText, textLength);
+	*destination = *source;
+	destination->args = args;
+	for (i = 0; i < source->numberOfArgs; i++)
+		args[i] = rebase(source->args[i], sourceText, text);
+	destination->inputRedirect = rebase(source->inputRedirect, sourceText, text);
+	destination->outputRedirect = rebase(source->outputRedirect, sourceText, text);
+	destination->hereDocument = rebase(source->hereDocument, sourceText, text);
+}
+
+/**
+* Function: storeEntry
+* -------------------------------------------
+* Adds a freshly parsed line to the cache, evicting the least recently used line when it is full. The
+* entry, its argument array and both copies of the text share one allocation; a line with a template keeps
+* the template there instead of its parse
+*
+* line - the raw text
+* length - the length of the text
+* hash - the hash of the text
+* command - the parsed command; its arguments point into parsedText
+* parsedText - the line after parsing in place
+* template - the line's template when its words are expanded, or NULL
+*/
+static void storeEntry(const char *line, size_t length, unsigned int hash, struct parsedCommand *command,
+	char *parsedText, const struct commandTemplate *template)
+{
+	struct parseCacheEntry *entry;
+	char **args;
+	size_t size = sizeof(struct parseCacheEntry) + length + 1 +
+		(template != NULL ? template->size : sizeof(char *) * command->numberOfArgs + length + 1);
+
+	if (numberOfEntries >= PARSE_CACHE_CAPACITY)
+		removeEntry(oldest);
+
+	entry = malloc(size);
+	if (entry == NULL)
+		return;
+	if (template != NULL)
+	{
+		// A template only refers to itself, so it is copied as is
+		entry->template = (struct commandTemplate *) (entry + 1);
+		memcpy(entry->template, template, template->size);
+		entry->line = (char *) entry->template + template->size;
+		entry->text = NULL;
+	}
+	else
+	{
+		args = (char **) (entry + 1);
+		entry->template = NULL;
+		entry->line = (char *) (args + command->numberOfArgs);
+		entry->text = entry->line + length + 1;
+		copyParsedCommand(command, parsedText, length + 1, &entry->command, args, entry->text);
+	}
+	memcpy(entry->line, line, length);
+	entry->line[length] = 0;
+	entry->hash = hash;
+	entry->lineLength = length;
+
+	entry->next = buckets[hash & (PARSE_CACHE_BUCKETS - 1)];
+	buckets[hash & (PARSE_CACHE_BUCKETS - 1)] = entry;
+	markNewest(entry);
+	numberOfEntries++;
+}
+
+/**
+* Function: parseCommandCached
+* -------------------------------------------
+* Parses a line like parseArgs, reusing the stored parse when the same text was seen before; returns 0 on
+* success and -1 on a syntax error. A hit copies the cached arguments into the arena and leaves inputBuffer
+* untouched; a miss parses inputBuffer in place and stores the result, evicting the least recently used
+* line when the cache is full. A line with $ expansions, command substitutions or file name patterns is
+* stored as a template instead, so a hit only redoes the expansions. Lines with syntax errors, and expanded
+* lines with here-documents or process substitutions, are never cached
+*
+* inputBuffer - the line to parse
+* length - the length of the line
+* command - assigned the arguments, pipeline stages, redirections and background indicator
+* arena - provides the argument array and text; reset by the caller once the command has run
+*/
+int parseCommandCached(char *inputBuffer, size_t length, struct parsedCommand *command, struct arena *arena)
+{
+	unsigned int hash;
+	char *rawLine;
+	struct parseCacheEntry *entry;
+	struct commandTemplate *template;
+
+	if (length > PARSE_CACHE_MAXIMUM_LINE)
+		return parseArgs(inputBuffer, command, arena);
+
+	hash = hashLine(inputBuffer, length);
+	entry = findEntry(inputBuffer, length, hash);
+	if (entry != NULL)
+	{
+		hits++;
+		unlinkEntry(entry);
+		markNewest(entry);
+		// The template lives in the entry until it is evicted, which can't happen before the words are built
+		if (entry->template != NULL)
+			return instantiateTemplate(entry->template, command, arena);
+		// The command gets its own copy so an eviction while it runs can't pull the arguments from under it
+		copyParsedCommand(&entry->command, entry->text, length + 1, command,
+			arenaAllocate(arena, sizeof(char *) * entry->command.numberOfArgs),
+			arenaAllocate(arena, length + 1));
+		return 0;
+	}
+
+	misses++;
+	// Parsing happens in place, so keep the raw text to key the entry
+	rawLine = arenaAllocate(arena, length + 1);
+	memcpy(rawLine, inputBuffer, length + 1);
+	if (parseArgs(inputBuffer, command, arena) != 0)
+		return -1;
+	// Expansions change with variables and directories, so those lines keep a template to expand each time
+	if (!command->expanded)
+		storeEntry(rawLine, length, hash, command, inputBuffer, NULL);
+	else if ((template = compileTemplate(rawLine, arena)) != NULL)
+		storeEntry(rawLine, length, hash, command, inputBuffer, template);
+	return 0;
+}
+
+/**
+* Function: clearParseCache
+* -------------------------------------------
+* Forgets every cached line and zeroes the hit and miss counters
+*/
+void clearParseCache()
+{
+	while (oldest != NULL)
+		removeEntry(oldest);
+	hits = 0;
+	misses = 0;
+}
+
+/**
+* Function: printParseCache
+* -------------------------------------------
+* Prints the number of cached lines and the hit and miss counters
+*
+* outputFd - the file descriptor to print to
+*/
+void printParseCache(int outputFd)
+{
+	unsigned long lookups = hits + misses;
+	dprintf(outputFd, "entries\t%d/%d\nhits\t%lu\nmisses\t%lu\nhit rate\t%.1f%%\n",
+		numberOfEntries, PARSE_CACHE_CAPACITY, hits, misses, lookups ? 100.0 * hits / lookups : 0.0);
+}
@@ -0,0 +1,52 @@
+/***********************************************************************************************************
+ * Filename: parsecache.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the cache of parsed command lines
+ **********************************************************************************************************/
+
+#ifndef PARSECACHE_H_
+#define PARSECACHE_H_
+
+#include "cli.h"
+
+#include <stddef.h>
+
+#define PARSE_CACHE_CAPACITY 256
+#define PARSE_CACHE_BUCKETS 512
+// Longer lines are parsed every time rather than held in the cache
+#define PARSE_CACHE_MAXIMUM_LINE 4096
+
+/**
+* Function: parseCommandCached
+* -------------------------------------------
+* Parses a line like parseArgs, reusing the stored parse when the same text was seen before; returns 0 on
+* success and -1 on a syntax error. A hit copies the cached arguments into the arena and leaves inputBuffer
+* untouched; a miss parses inputBuffer in place and stores the result, evicting the least recently used
+* line when the cache is full. A line with $ expansions, command substitutions or file name patterns is
+* stored as a template instead, so a hit only redoes the expansions. Lines with syntax errors, and expanded
+* lines with here-documents or process substitutions, are never cached
+*
+* inputBuffer - the line to parse
+* length - the length of the line
+* command - assigned the arguments, pipeline stages, redirections and background indicator
+* arena - provides the argument array and text; reset by the caller once the command has run
+*/
+int parseCommandCached(char *inputBuffer, size_t length, struct parsedCommand *command, struct arena *arena);
+/**
+* Function: clearParseCache
+* -------------------------------------------
+* Forgets every cached line and zeroes the hit and miss counters
+*/
+void clearParseCache();
+/**
+* Function: printParseCache
+* -------------------------------------------
+* Prints the number of cached lines and the hit and miss counters
+*
+* outputFd - the file descriptor to print to
+*/
+void printParseCache(int outputFd);
+
+#endif /* PARSECACHE_H_ */
@@ -0,0 +1,362 @@
+/***********************************************************************************************************
+ * Filename: pathcache.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements a hash table mapping command names to the absolute path of the executable found
+ * on $PATH, so repeated commands are exec'd directly instead of walking every $PATH directory each time.
+ * Commands that could not be found are remembered for a short while as negative entries.
+ **********************************************************************************************************/
+
+#include "pathcache.h"
+#include "cli.h"
+#include "variables.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+struct pathCacheEntry
+{
+	char *commandName;
+	char *commandPath;		// NULL when the command was not found (negative entry)
+	unsigned int hits;
+	time_t cachedAt;
+	struct pathCacheEntry *next;
+};
+
+static struct pathCacheEntry **buckets = NULL;
+static int numberOfBuckets = 0;
+static int numberOfEntries = 0;
+static char *cachedPathVariable = NULL;
+
+/**
+* Function: hashCommandName
+* -------------------------------------------
+* Returns the FNV-1a hash of a command name
+*
+* commandName - the string to hash
+*/
+static unsigned int hashCommandName(const char *commandName)
+{
+	unsigned int hash = 2166136261u;
+	while (*commandName)
+	{
+		hash ^= (unsigned char) *commandName++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* Function: currentPathVariable
+* -------------------------------------------
+* Returns the value of $PATH, falling back to the same default execvp uses when it is unset
+*/
+const char * currentPathVariable()
+{
+	const char *pathVariable = getVariable("PATH");
+	if (pathVariable == NULL)
+		pathVariable = "/bin:/usr/bin";
+	return pathVariable;
+}
+
+/**
+* Function: freeEntry
+* -------------------------------------------
+* Deallocates a single cache entry
+*
+* entry - the entry to free
+*/
+static void freeEntry(struct pathCacheEntry *entry)
+{
+	free(entry->commandName);
+	free(entry->commandPath);
+	free(entry);
+}
+
+/**
+* Function: clearPathCache
+* -------------------------------------------
+* Forgets every cached command location
+*/
+void clearPathCache()
+{
+	int i;
+	struct pathCacheEntry *entry;
+	struct pathCacheEntry *next;
+	for (i = 0; i < numberOfBuckets; i++)
+	{
+		for (entry = buckets[i]; entry != NULL; entry = next)
+		{
+			next = entry->next;
+			freeEntry(entry);
+		}
+		buckets[i] = NULL;
+	}
+	numberOfEntries = 0;
+}
+
+/**
+* Function: validateCachedPathVariable
+* -------------------------------------------
+* Drops every cached entry if $PATH has changed since the entries were resolved
+*/
+static void validateCachedPathVariable()
+{
+	const char *pathVariable = currentPathVariable();
+	if (cachedPathVariable != NULL && strcmp(cachedPathVariable, pathVariable) == 0)
+		return;
+
+	clearPathCache();
+	free(cachedPathVariable);
+	cachedPathVariable = strdup(pathVariable);
+}
+
+/**
+* Function: resizeBuckets
+* -------------------------------------------
+* Doubles the number of hash buckets once the table gets crowded and rehashes existing entries
+*/
+static void resizeBuckets()
+{
+	int i;
+	int newNumberOfBuckets;
+	struct pathCacheEntry **newBuckets;
+	struct pathCacheEntry *entry;
+	struct pathCacheEntry *next;
+
+	if (buckets == NULL)
+	{
+		numberOfBuckets = PATH_CACHE_STARTING_BUCKETS;
+		buckets = calloc(numberOfBuckets, sizeof(struct pathCacheEntry *));
+		return;
+	}
+	if (numberOfEntries < numberOfBuckets)
+		return;
+
+	newNumberOfBuckets = numberOfBuckets * 2;
+	newBuckets = calloc(newNumberOfBuckets, sizeof(struct pathCacheEntry *));
+	if (newBuckets == NULL)
+		return;
+	for (i = 0; i < numberOfBuckets; i++)
+	{
+		for (entry = buckets[i]; entry != NULL; entry = next)
+		{
+			next = entry->next;
+			unsigned int index = hashCommandName(entry->commandName) & (newNumberOfBuckets - 1);
+			entry->next = newBuckets[index];
+			newBuckets[index] = entry;
+		}
+	}
+	free(buckets);
+	buckets = newBuckets;
+	numberOfBuckets = newNumberOfBuckets;
+}
+
+/**
+* Function: isExecutableFile
+* -------------------------------------------
+* Returns 1 if the given path names a regular file the user may execute; 0 otherwise
+*
+* path - the full path to check
+*/
+static int isExecutableFile(const char *path)
+{
+	struct stat fileInfo;
+	if (stat(path, &fileInfo) != 0 || !S_ISREG(fileInfo.st_mode))
+		return 0;
+	return access(path, X_OK) == 0;
+}
+
+/**
+* Function: searchPathVariable
+* -------------------------------------------
+* Walks each directory of $PATH in order and returns a newly allocated full path of the first executable
+* matching the command name, or NULL if there is none
+*
+* commandName - the name of the command to find
+*/
+static char * searchPathVariable(const char *commandName)
+{
+	char candidate[PATH_MAXIMUM];
+	const char *directory = currentPathVariable();
+	const char *end;
+	size_t directoryLength;
+
+	while (1)
+	{
+		end = strchr(directory, ':');
+		directoryLength = end ? (size_t) (end - directory) : strlen(directory);
+		// An empty PATH component means the current directory
+		if (directoryLength == 0)
+			snprintf(candidate, sizeof(candidate), "./%s", commandName);
+		else
+			snprintf(candidate, sizeof(candidate), "%.*s/%s", (int) directoryLength, directory, commandName);
+
+		if (isExecutableFile(candidate))
+			return strdup(candidate);
+		if (end == NULL)
+			return NULL;
+		directory = end + 1;
+	}
+}
+
+/**
+* Function: findEntry
+* -------------------------------------------
+* Returns the cache entry for a command name or NULL if it is not cached
+*
+* commandName - the name of the command to find
+*/
+static struct pathCacheEntry * findEntry(const char *commandName)
+{
+	struct pathCacheEntry *entry;
+	if (buckets == NULL)
+		return NULL;
+	entry = buckets[hashCommandName(commandName) & (numberOfBuckets - 1)];
+	while (entry != NULL && strcmp(entry->commandName, commandName) != 0)
+		entry = entry->next;
+	return entry;
+}
+
+/**
+* Function: storeEntry
+* -------------------------------------------
+* Resolves a command against $PATH and records the result, replacing any existing entry; returns the entry
+*
+* commandName - the name of the command to resolve
+*/
+static struct pathCacheEntry * storeEntry(const char *commandName)
+{
+	struct pathCacheEntry *entry = findEntry(commandName);
+	if (entry == NULL)
+	{
+		resizeBuckets();
+		entry = calloc(1, sizeof(struct pathCacheEntry));
+		entry->commandName = strdup(commandName);
+		unsigned int index = hashCommandName(commandName) & (numberOfBuckets - 1);
+		entry->next = buckets[index];
+		buckets[index] = entry;
+		numberOfEntries++;
+	}
+	else
+	{
+		free(entry->commandPath);
+		entry->hits = 0;
+	}
+	entry->commandPath = searchPathVariable(commandName);
+	entry->cachedAt = time(NULL);
+	return entry;
+}
+
+/**
+* Function: lookupCommandPath
+* -------------------------------------------
+* Returns the absolute path of an executable for the given command name, consulting the cache first and
+* searching $PATH only on a miss; returns NULL if the command can't be found. Names containing a slash are
+* returned unchanged and never cached
+*
+* commandName - the name of the command as typed by the user (inputArgs[0])
+*/
+char * lookupCommandPath(char *commandName)
+{
+	struct pathCacheEntry *entry;
+
+	if (strchr(commandName, '/') != NULL)
+		return commandName;
+
+	validateCachedPathVariable();
+	entry = findEntry(commandName);
+
+	// Re-resolve entries whose file disappeared and negative entries that are too old to trust
+	if (entry == NULL)
+		entry = storeEntry(commandName);
+	else if (entry->commandPath != NULL && access(entry->commandPath, X_OK) != 0)
+		entry = storeEntry(commandName);
+	else if (entry->commandPath == NULL && time(NULL) - entry->cachedAt >= PATH_CACHE_NEGATIVE_SECONDS)
+		entry = storeEntry(commandName);
+
+	entry->hits++;
+	return entry->commandPath;
+}
+
+/**
+* Function: addCommandPath
+* -------------------------------------------
+* Resolves a command against $PATH and stores the result in the cache regardless of any existing entry;
+* returns 1 if the command was found and 0 otherwise
+*
+* commandName - the name of the command to resolve
+*/
+int addCommandPath(char *commandName)
+{
+	if (strchr(commandName, '/') != NULL)
+		return isExecutableFile(commandName);
+
+	validateCachedPathVariable();
+	return storeEntry(commandName)->commandPath != NULL;
+}
+
+/**
+* Function: removeCommandPath
+* -------------------------------------------
+* Forgets the cached location of a single command; returns 1 if an entry was removed and 0 otherwise
+*
+* commandName - the name of the command to forget
+*/
+int removeCommandPath(char *commandName)
+{
+	struct pathCacheEntry **link;
+	struct pathCacheEntry *entry;
+	if (buckets == NULL)
+		return 0;
+
+	link = &buckets[hashCommandName(commandName) & (numberOfBuckets - 1)];
+	for (entry = *link; entry != NULL; link = &entry->next, entry = entry->next)
+	{
+		if (strcmp(entry->commandName, commandName) == 0)
+		{
+			*link = entry->next;
+			freeEntry(entry);
+			numberOfEntries--;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+* Function: printPathCache
+* -------------------------------------------
+* Prints the hit count and resolved path of every command currently cached (negative entries excluded)
+*
+* outputFd - the file descriptor to print to
+*/
+void printPathCache(int outputFd)
+{
+	int i;
+	int printedHeader = 0;
+	struct pathCacheEntry *entry;
+
+	validateCachedPathVariable();
+	for (i = 0; i < numberOfBuckets; i++)
+	{
+		for (entry = buckets[i]; entry != NULL; entry = entry->next)
+		{
+			if (entry->commandPath == NULL)
+				continue;
+			if (!printedHeader)
+			{
+				dprintf(outputFd, "hits\tcommand\n");
+				printedHeader = 1;
+			}
+			dprintf(outputFd, "%4u\t%s\n", entry->hits, entry->commandPath);
+		}
+	}
+	if (!printedHeader)
+		dprintf(outputFd, "hash: hash table empty\n");
+}
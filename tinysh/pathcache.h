@@ -0,0 +1,63 @@
+/***********************************************************************************************************
+ * Filename: pathcache.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the cache of command names resolved against $PATH
+ **********************************************************************************************************/
+
+#ifndef PATHCACHE_H_
+#define PATHCACHE_H_
+
+#define PATH_CACHE_STARTING_BUCKETS 64
+#define PATH_CACHE_NEGATIVE_SECONDS 2
+
+/**
+* Function: lookupCommandPath
+* -------------------------------------------
+* Returns the absolute path of an executable for the given command name, consulting the cache first and
+* searching $PATH only on a miss; returns NULL if the command can't be found. Names containing a slash are
+* returned unchanged and never cached
+*
+* commandName - the name of the command as typed by the user (inputArgs[0])
+*/
+char * lookupCommandPath(char *commandName);
+/**
+* Function: addCommandPath
+* -------------------------------------------
+* Resolves a command against $PATH and stores the result in the cache regardless of any existing entry;
+* returns 1 if the command was found and 0 otherwise
+*
+* commandName - the name of the command to resolve
+*/
+int addCommandPath(char *commandName);
+/**
+* Function: removeCommandPath
+* -------------------------------------------
+* Forgets the cached location of a single command; returns 1 if an entry was removed and 0 otherwise
+*
+* commandName - the name of the command to forget
+*/
+int removeCommandPath(char *commandName);
+/**
+* Function: clearPathCache
+* -------------------------------------------
+* Forgets every cached command location
+*/
+void clearPathCache();
+/**
+* Function: printPathCache
+* -------------------------------------------
+* Prints the hit count and resolved path of every command currently cached (negative entries excluded)
+*
+* outputFd - the file descriptor to print to
+*/
+void printPathCache(int outputFd);
+/**
+* Function: currentPathVariable
+* -------------------------------------------
+* Returns the value of $PATH, falling back to the same default execvp uses when it is unset
+*/
+const char * currentPathVariable();
+
+#endif /* PATHCACHE_H_ */
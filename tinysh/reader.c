@@ -0,0 +1,154 @@
+/***********************************************************************************************************
+ * Filename: reader.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements a block-buffered line reader. Input is pulled READER_BLOCK_SIZE bytes at a time
+ * and lines are handed out in place (newline replaced by a terminator), so scripts with tens of thousands
+ * of lines cost one read per block instead of one per line. The buffer doubles for lines longer than it.
+ **********************************************************************************************************/
+
+#include "reader.h"
+#include "events.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+* Function: initializeFileReader
+* -------------------------------------------
+* Prepares a reader that pulls input from a file descriptor in large blocks
+*
+* reader - the reader to initialize
+* fd - the file descriptor to read lines from
+*/
+void initializeFileReader(struct lineReader *reader, int fd)
+{
+	reader->fd = fd;
+	reader->capacity = READER_BLOCK_SIZE;
+	reader->buffer = malloc(reader->capacity);
+	reader->start = 0;
+	reader->end = 0;
+	reader->endOfInput = 0;
+	reader->numberOfLines = 0;
+}
+
+/**
+* Function: initializeStringReader
+* -------------------------------------------
+* Prepares a reader that returns the lines of a string (as given to 'smallsh -c')
+*
+* reader - the reader to initialize
+* text - the text to split into lines; copied into the reader
+*/
+void initializeStringReader(struct lineReader *reader, const char *text)
+{
+	size_t length = strlen(text);
+	reader->fd = -1;
+	reader->capacity = length + 1;
+	reader->buffer = malloc(reader->capacity);
+	memcpy(reader->buffer, text, length);
+	reader->start = 0;
+	reader->end = length;
+	reader->endOfInput = 1;
+	reader->numberOfLines = 0;
+}
+
+/**
+* Function: fillBuffer
+* -------------------------------------------
+* Reads the next block of input after the unread bytes, first moving them to the front of the buffer and
+* growing the buffer if a single line fills it; returns the number of bytes read (0 at end of input)
+*
+* reader - the reader to fill
+*/
+static ssize_t fillBuffer(struct lineReader *reader)
+{
+	ssize_t bytesRead;
+
+	if (reader->start > 0)
+	{
+		memmove(reader->buffer, reader->buffer + reader->start, reader->end - reader->start);
+		reader->end -= reader->start;
+		reader->start = 0;
+	}
+	// Always keep room for the terminator of a last line without a newline
+	if (reader->capacity - reader->end < READER_BLOCK_SIZE / 2)
+	{
+		reader->capacity *= 2;
+		reader->buffer = realloc(reader->buffer, reader->capacity);
+	}
+
+	// Jobs that finish while the shell waits for a line are reported right away instead of after it
+	while (waitForInput(reader->fd) == EVENTS_PENDING)
+		processPendingEvents();
+	do
+		bytesRead = read(reader->fd, reader->buffer + reader->end, reader->capacity - reader->end - 1);
+	while (bytesRead < 0 && errno == EINTR);
+
+	if (bytesRead <= 0)
+	{
+		reader->endOfInput = 1;
+		return 0;
+	}
+	reader->end += bytesRead;
+	return bytesRead;
+}
+
+/**
+* Function: readLine
+* -------------------------------------------
+* Returns the next line without its trailing newline, or NULL once the input is exhausted. Lines of any
+* length are supported; the returned text lives in the reader's buffer and stays valid (and may be modified
+* in place) until the next call
+*
+* reader - the reader to pull the line from
+* length - assigned the length of the line (may be NULL)
+*/
+char * readLine(struct lineReader *reader, size_t *length)
+{
+	char *line;
+	char *newline;
+	size_t searchFrom = reader->start;
+
+	while (1)
+	{
+		newline = memchr(reader->buffer + searchFrom, '\n', reader->end - searchFrom);
+		if (newline != NULL)
+			break;
+		if (reader->endOfInput)
+		{
+			// Hand out a final line that has no newline
+			if (reader->start == reader->end)
+				return NULL;
+			newline = reader->buffer + reader->end;
+			break;
+		}
+		// Only the bytes read by this call still need to be searched
+		searchFrom = reader->end - reader->start;
+		fillBuffer(reader);
+	}
+
+	line = reader->buffer + reader->start;
+	*newline = 0;
+	if (length != NULL)
+		*length = newline - line;
+	reader->start = newline - reader->buffer + (newline < reader->buffer + reader->end ? 1 : 0);
+	reader->numberOfLines++;
+	return line;
+}
+
+/**
+* Function: freeLineReader
+* -------------------------------------------
+* Releases the reader's buffer; the file descriptor is left open
+*
+* reader - the reader to free
+*/
+void freeLineReader(struct lineReader *reader)
+{
+	free(reader->buffer);
+	reader->buffer = NULL;
+}
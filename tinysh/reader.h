@@ -0,0 +1,65 @@
+/***********************************************************************************************************
+ * Filename: reader.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the block-buffered line reader that feeds commands to the shell
+ **********************************************************************************************************/
+
+#ifndef READER_H_
+#define READER_H_
+
+#include <stddef.h>
+
+#define READER_BLOCK_SIZE 65536
+
+struct lineReader
+{
+	int fd;						// -1 when reading from a string
+	char *buffer;
+	size_t capacity;
+	size_t start;				// first unread byte
+	size_t end;					// one past the last byte read so far
+	int endOfInput;
+	unsigned long numberOfLines;
+};
+
+/**
+* Function: initializeFileReader
+* -------------------------------------------
+* Prepares a reader that pulls input from a file descriptor in large blocks
+*
+* reader - the reader to initialize
+* fd - the file descriptor to read lines from
+*/
+void initializeFileReader(struct lineReader *reader, int fd);
+/**
+* Function: initializeStringReader
+* -------------------------------------------
+* Prepares a reader that returns the lines of a string (as given to 'smallsh -c')
+*
+* reader - the reader to initialize
+* text - the text to split into lines; copied into the reader
+*/
+void initializeStringReader(struct lineReader *reader, const char *text);
+/**
+* Function: readLine
+* -------------------------------------------
+* Returns the next line without its trailing newline, or NULL once the input is exhausted. Lines of any
+* length are supported; the returned text lives in the reader's buffer and stays valid (and may be modified
+* in place) until the next call
+*
+* reader - the reader to pull the line from
+* length - assigned the length of the line (may be NULL)
+*/
+char * readLine(struct lineReader *reader, size_t *length);
+/**
+* Function: freeLineReader
+* -------------------------------------------
+* Releases the reader's buffer; the file descriptor is left open
+*
+* reader - the reader to free
+*/
+void freeLineReader(struct lineReader *reader);
+
+#endif /* READER_H_ */
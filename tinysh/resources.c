@@ -0,0 +1,712 @@
+/***********************************************************************************************************
+ * Filename: resources.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the resource controls of spawned commands. The 'nice', 'taskset', 'ionice' and
+ * 'prlimit' prefixes of a pipeline stage are read by the shell rather than started as programs of their
+ * own, and what they ask for is set by the stage's child on itself between fork and exec: rlimits first,
+ * then CPU affinity, I/O priority and niceness. Background jobs can be given a default niceness and CPU
+ * list so they stay off the cores and out of the way of foreground work. 'ulimit' changes the shell's own
+ * limits, which every later command inherits.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "resources.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+struct limitName
+{
+	char option;				// the 'ulimit' option
+	const char *prlimitOption;
+	int resource;
+	rlim_t ulimitUnit;			// 'ulimit' shows and takes values in these units; 'prlimit' in plain ones
+	const char *description;
+};
+
+static const struct limitName limitNames[RESOURCE_MAXIMUM_LIMITS] = {
+	{ 't', "--cpu=", RLIMIT_CPU, 1, "cpu time (seconds, -t)" },
+	{ 'v', "--as=", RLIMIT_AS, 1024, "virtual memory (kbytes, -v)" },
+	{ 'n', "--nofile=", RLIMIT_NOFILE, 1, "open files (-n)" }
+};
+
+// Defaults for background jobs ('set -o bgnice=N' and 'set -o bgcpus=LIST'); 0 and NULL when off
+static int backgroundNice = 0;
+static char *backgroundCpuList = NULL;
+static cpu_set_t backgroundCpus;
+
+/**
+* Function: parseNumber
+* -------------------------------------------
+* Reads a whole decimal number; returns 0 on success and -1 if the text is anything else
+*
+* text - the text to read
+* value - assigned the number
+*/
+static int parseNumber(const char *text, int *value)
+{
+	char *end;
+	long number;
+
+	errno = 0;
+	number = strtol(text, &end, 10);
+	if (*text == 0 || *end != 0 || errno != 0 || number < -1000000 || number > 1000000)
+		return -1;
+	*value = (int) number;
+	return 0;
+}
+
+/**
+* Function: parseLimitValue
+* -------------------------------------------
+* Reads a limit: 'unlimited' (or 'infinity') or a whole number of units; returns 0 on success and -1 if the
+* text is anything else
+*
+* text - the text to read
+* length - the number of bytes of text to use
+* unit - the size of one unit
+* value - assigned the limit
+*/
+static int parseLimitValue(const char *text, size_t length, rlim_t unit, rlim_t *value)
+{
+	unsigned long long number = 0;
+	size_t i;
+
+	if ((length == 9 && strncmp(text, "unlimited", 9) == 0) || (length == 8 && strncmp(text, "infinity", 8) == 0))
+	{
+		*value = RLIM_INFINITY;
+		return 0;
+	}
+	if (length == 0 || length > 19)
+		return -1;
+	for (i = 0; i < length; i++)
+	{
+		if (!isdigit((unsigned char) text[i]))
+			return -1;
+		number = number * 10 + (text[i] - '0');
+	}
+	if (number > RLIM_INFINITY / unit)
+		return -1;
+	*value = number * unit;
+	return 0;
+}
+
+/**
+* Function: parseCpuList
+* -------------------------------------------
+* Reads a list of CPUs such as 0,2-3 into a set; returns 0 on success and -1 if the list is invalid or empty
+*
+* list - the text of the list
+* set - assigned the CPUs
+*/
+static int parseCpuList(const char *list, cpu_set_t *set)
+{
+	long first;
+	long last;
+	char *end;
+
+	CPU_ZERO(set);
+	while (*list != 0)
+	{
+		if (!isdigit((unsigned char) *list))
+			return -1;
+		first = last = strtol(list, &end, 10);
+		if (*end == '-')
+		{
+			if (!isdigit((unsigned char) end[1]))
+				return -1;
+			last = strtol(end + 1, &end, 10);
+		}
+		if (last < first || last >= CPU_SETSIZE || (*end != ',' && *end != 0))
+			return -1;
+		for (; first <= last; first++)
+			CPU_SET(first, set);
+		list = *end == ',' ? end + 1 : end;
+	}
+	return CPU_COUNT(set) > 0 ? 0 : -1;
+}
+
+/**
+* Function: parseCpuMask
+* -------------------------------------------
+* Reads a hexadecimal CPU mask such as 0x3 (CPUs 0 and 1) into a set; returns 0 on success and -1 if the
+* mask is invalid or empty
+*
+* mask - the text of the mask
+* set - assigned the CPUs
+*/
+static int parseCpuMask(const char *mask, cpu_set_t *set)
+{
+	int cpu = 0;
+	int bit;
+	int digit;
+	const char *text;
+
+	if (strncmp(mask, "0x", 2) == 0 || strncmp(mask, "0X", 2) == 0)
+		mask += 2;
+	CPU_ZERO(set);
+	if (*mask == 0)
+		return -1;
+	// The last digit holds CPUs 0 to 3
+	for (text = mask + strlen(mask) - 1; text >= mask; text--, cpu += 4)
+	{
+		if (!isxdigit((unsigned char) *text))
+			return -1;
+		digit = isdigit((unsigned char) *text) ? *text - '0' : tolower((unsigned char) *text) - 'a' + 10;
+		for (bit = 0; bit < 4; bit++)
+			if ((digit & (1 << bit)) && cpu + bit < CPU_SETSIZE)
+				CPU_SET(cpu + bit, set);
+	}
+	return CPU_COUNT(set) > 0 ? 0 : -1;
+}
+
+/**
+* Function: parseIoClass
+* -------------------------------------------
+* Returns the I/O scheduling class named by a number (0-3) or a name, or -1 if there is none
+*
+* name - the class as given to ionice
+*/
+static int parseIoClass(const char *name)
+{
+	static const char *classNames[] = { "none", "realtime", "best-effort", "idle" };
+	int i;
+
+	for (i = 0; i < 4; i++)
+		if (strcmp(name, classNames[i]) == 0 || (name[0] == '0' + i && name[1] == 0))
+			return i;
+	return -1;
+}
+
+/**
+* Function: parseNicePrefix
+* -------------------------------------------
+* Takes the options of a 'nice' prefix; returns where its command starts or NULL if they don't parse
+*	nice [-n N | -nN | --adjustment=N | -N] [--] command
+*
+* args - the words after 'nice'
+* controls - updated with the niceness
+*/
+static char ** parseNicePrefix(char **args, struct resourceControls *controls)
+{
+	int increment = 10;
+
+	if (args[0] != NULL && strcmp(args[0], "-n") == 0)
+	{
+		if (args[1] == NULL || parseNumber(args[1], &increment) < 0)
+			return NULL;
+		args += 2;
+	}
+	else if (args[0] != NULL && strncmp(args[0], "-n", 2) == 0)
+	{
+		if (parseNumber(args[0] + 2, &increment) < 0)
+			return NULL;
+		args++;
+	}
+	else if (args[0] != NULL && strncmp(args[0], "--adjustment=", 13) == 0)
+	{
+		if (parseNumber(args[0] + 13, &increment) < 0)
+			return NULL;
+		args++;
+	}
+	// The historical form: -5 adds 5, --5 subtracts it
+	else if (args[0] != NULL && args[0][0] == '-' && strcmp(args[0], "--") != 0)
+	{
+		if (parseNumber(args[0] + 1, &increment) < 0)
+			return NULL;
+		args++;
+	}
+	if (args[0] != NULL && strcmp(args[0], "--") == 0)
+		args++;
+
+	controls->setNice = 1;
+	controls->niceIncrement += increment;
+	return args;
+}
+
+/**
+* Function: parseTasksetPrefix
+* -------------------------------------------
+* Takes the options of a 'taskset' prefix; returns where its command starts or NULL if they don't parse
+* (-p and the other options about running processes stay with the real taskset)
+*	taskset MASK command | taskset -c LIST command
+*
+* args - the words after 'taskset'
+* controls - updated with the affinity
+*/
+static char ** parseTasksetPrefix(char **args, struct resourceControls *controls)
+{
+	cpu_set_t set;
+
+	if (args[0] == NULL)
+		return NULL;
+	if (strcmp(args[0], "-c") == 0 || strcmp(args[0], "--cpu-list") == 0)
+	{
+		if (args[1] == NULL || parseCpuList(args[1], &set) < 0)
+			return NULL;
+		args += 2;
+	}
+	else if (args[0][0] == '-' || parseCpuMask(args[0], &set) < 0)
+		return NULL;
+	else
+		args++;
+
+	controls->setAffinity = 1;
+	controls->affinity = set;
+	return args;
+}
+
+/**
+* Function: parseIonicePrefix
+* -------------------------------------------
+* Takes the options of an 'ionice' prefix; returns where its command starts or NULL if they don't parse.
+* The class defaults to best-effort and the level to 4
+*	ionice [-c CLASS] [-n LEVEL] [-t] [--] command
+*
+* args - the words after 'ionice'
+* controls - updated with the I/O priority
+*/
+static char ** parseIonicePrefix(char **args, struct resourceControls *controls)
+{
+	int ioClass = -1;
+	int level = -1;
+	int ignoreFailure = 0;
+	const char *value;
+
+	while (args[0] != NULL && args[0][0] == '-')
+	{
+		if (strcmp(args[0], "--") == 0)
+		{
+			args++;
+			break;
+		}
+		if (strcmp(args[0], "-t") == 0)
+		{
+			ignoreFailure = 1;
+			args++;
+			continue;
+		}
+		if ((args[0][1] != 'c' && args[0][1] != 'n'))
+			return NULL;
+		// The value may be attached (-c3) or the next word (-c 3)
+		value = args[0][2] != 0 ? args[0] + 2 : args[1];
+		if (value == NULL)
+			return NULL;
+		if (args[0][1] == 'c' && (ioClass = parseIoClass(value)) < 0)
+			return NULL;
+		if (args[0][1] == 'n' && (parseNumber(value, &level) < 0 || level < 0 || level > 7))
+			return NULL;
+		args += args[0][2] != 0 ? 1 : 2;
+	}
+	if (ioClass < 0 && level < 0)
+		return NULL;
+
+	if (ioClass < 0)
+		ioClass = 2;
+	// Only the realtime and best-effort classes have levels
+	if (level < 0 || ioClass == 0 || ioClass == 3)
+		level = ioClass == 1 || ioClass == 2 ? 4 : 0;
+	controls->setIoPriority = 1;
+	controls->ioPriority = ioClass << IOPRIO_CLASS_SHIFT | level;
+	controls->ignoreIoPriorityFailure = ignoreFailure;
+	return args;
+}
+
+/**
+* Function: addLimit
+* -------------------------------------------
+* Takes one 'prlimit' limit (soft:hard, a value for both, soft: or :hard) into the controls; returns 0 on
+* success and -1 if the value doesn't parse
+*
+* controls - updated with the limit
+* resource - the RLIMIT_* resource
+* value - the text of the limit
+*/
+static int addLimit(struct resourceControls *controls, int resource, const char *value)
+{
+	int i;
+	const char *colon = strchr(value, ':');
+	struct resourceLimit limit = { resource, 0, 0, { 0, 0 } };
+
+	if (colon == NULL)
+	{
+		if (parseLimitValue(value, strlen(value), 1, &limit.limit.rlim_cur) < 0)
+			return -1;
+		limit.limit.rlim_max = limit.limit.rlim_cur;
+		limit.setSoft = limit.setHard = 1;
+	}
+	else
+	{
+		if (colon > value && parseLimitValue(value, colon - value, 1, &limit.limit.rlim_cur) < 0)
+			return -1;
+		if (colon[1] != 0 && parseLimitValue(colon + 1, strlen(colon + 1), 1, &limit.limit.rlim_max) < 0)
+			return -1;
+		limit.setSoft = colon > value;
+		limit.setHard = colon[1] != 0;
+		if (!limit.setSoft && !limit.setHard)
+			return -1;
+	}
+
+	// A resource given twice keeps the last value
+	for (i = 0; i < controls->numberOfLimits && controls->limits[i].resource != resource; i++)
+		;
+	controls->limits[i] = limit;
+	if (i == controls->numberOfLimits)
+		controls->numberOfLimits++;
+	return 0;
+}
+
+/**
+* Function: parsePrlimitPrefix
+* -------------------------------------------
+* Takes the options of a 'prlimit' prefix; returns where its command starts or NULL if they don't parse
+*	prlimit [--as=L] [--cpu=L] [--nofile=L] [--] command
+*
+* args - the words after 'prlimit'
+* controls - updated with the limits
+*/
+static char ** parsePrlimitPrefix(char **args, struct resourceControls *controls)
+{
+	int i;
+	int numberOfLimits = 0;
+	size_t length;
+
+	while (args[0] != NULL && args[0][0] == '-')
+	{
+		if (strcmp(args[0], "--") == 0)
+		{
+			args++;
+			break;
+		}
+		for (i = 0; i < RESOURCE_MAXIMUM_LIMITS; i++)
+		{
+			length = strlen(limitNames[i].prlimitOption);
+			if (strncmp(args[0], limitNames[i].prlimitOption, length) == 0)
+				break;
+		}
+		if (i == RESOURCE_MAXIMUM_LIMITS || addLimit(controls, limitNames[i].resource, args[0] + length) < 0)
+			return NULL;
+		numberOfLimits++;
+		args++;
+	}
+	return numberOfLimits > 0 ? args : NULL;
+}
+
+/**
+* Function: initializeResourceControls
+* -------------------------------------------
+* Starts the controls of a pipeline stage: a background stage gets the defaults set with 'set -o bgnice'
+* and 'set -o bgcpus', a foreground one nothing
+*
+* controls - the controls to initialize
+* runInBackground - 1 = the stage belongs to a background job
+*/
+void initializeResourceControls(struct resourceControls *controls, int runInBackground)
+{
+	memset(controls, 0, sizeof(*controls));
+	if (!runInBackground)
+		return;
+	if (backgroundNice != 0)
+	{
+		controls->setNice = 1;
+		controls->niceIncrement = backgroundNice;
+	}
+	if (backgroundCpuList != NULL)
+	{
+		controls->setAffinity = 1;
+		controls->affinity = backgroundCpus;
+	}
+}
+
+/**
+* Function: parseResourcePrefixes
+* -------------------------------------------
+* Takes the leading 'nice', 'taskset', 'ionice' and 'prlimit' words of a stage, with their options, into
+* the controls and returns where the command itself starts. A prefix whose options don't parse, or that has
+* no command after it, is left alone so it runs as the ordinary program of that name
+*	nice [-n N] command             - add N (default 10) to the niceness
+*	taskset MASK command            - run on the CPUs of a hexadecimal mask
+*	taskset -c LIST command         - run on a list of CPUs such as 0,2-3
+*	ionice [-c CLASS] [-n LEVEL] [-t] command - set the I/O class (1-3 or realtime, best-effort, idle)
+*	prlimit [--as=L] [--cpu=L] [--nofile=L] command - L is soft:hard, a value for both, soft: or :hard
+*
+* args - the words of the stage
+* controls - updated with every prefix taken
+*/
+char ** parseResourcePrefixes(char **args, struct resourceControls *controls)
+{
+	char **command;
+	struct resourceControls parsed;
+
+	while (args[0] != NULL)
+	{
+		// Parse into a copy so a prefix that turns out not to be one leaves the controls as they were
+		parsed = *controls;
+		if (strcmp(args[0], "nice") == 0)
+			command = parseNicePrefix(args + 1, &parsed);
+		else if (strcmp(args[0], "taskset") == 0)
+			command = parseTasksetPrefix(args + 1, &parsed);
+		else if (strcmp(args[0], "ionice") == 0)
+			command = parseIonicePrefix(args + 1, &parsed);
+		else if (strcmp(args[0], "prlimit") == 0)
+			command = parsePrlimitPrefix(args + 1, &parsed);
+		else
+			break;
+		if (command == NULL || command[0] == NULL)
+			break;
+		*controls = parsed;
+		args = command;
+	}
+	return args;
+}
+
+/**
+* Function: hasResourceControls
+* -------------------------------------------
+* Returns 1 if the controls change anything in the child and 0 otherwise
+*
+* controls - the controls of a stage
+*/
+int hasResourceControls(const struct resourceControls *controls)
+{
+	return controls->numberOfLimits > 0 || controls->setAffinity || controls->setNice
+		|| controls->setIoPriority;
+}
+
+/**
+* Function: limitDescription
+* -------------------------------------------
+* Returns the description of an RLIMIT_* resource handled here
+*
+* resource - the resource
+*/
+static const char * limitDescription(int resource)
+{
+	int i;
+	for (i = 0; i < RESOURCE_MAXIMUM_LIMITS; i++)
+		if (limitNames[i].resource == resource)
+			return limitNames[i].description;
+	return "resource";
+}
+
+/**
+* Function: applyResourceControls
+* -------------------------------------------
+* Runs in the child between fork and exec: sets the limits, affinity, I/O priority and niceness on the
+* calling process. Returns 0 on success and -1 after printing why a control could not be set; failing to
+* change the niceness only prints a warning, as with nice(1)
+*
+* controls - the controls of the stage
+*/
+int applyResourceControls(const struct resourceControls *controls)
+{
+	int i;
+	struct rlimit limit;
+	const struct resourceLimit *wanted;
+
+	for (i = 0; i < controls->numberOfLimits; i++)
+	{
+		wanted = &controls->limits[i];
+		getrlimit(wanted->resource, &limit);
+		if (wanted->setSoft)
+			limit.rlim_cur = wanted->limit.rlim_cur;
+		if (wanted->setHard)
+			limit.rlim_max = wanted->limit.rlim_max;
+		if (setrlimit(wanted->resource, &limit) < 0)
+		{
+			fprintf(stderr, "prlimit: %s: %s\n", limitDescription(wanted->resource), strerror(errno));
+			return -1;
+		}
+	}
+	if (controls->setAffinity && sched_setaffinity(0, sizeof(cpu_set_t), &controls->affinity) < 0)
+	{
+		fprintf(stderr, "taskset: failed to set the CPU affinity: %s\n", strerror(errno));
+		return -1;
+	}
+	if (controls->setIoPriority && syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, controls->ioPriority) < 0
+		&& !controls->ignoreIoPriorityFailure)
+	{
+		fprintf(stderr, "ionice: failed to set the I/O priority: %s\n", strerror(errno));
+		return -1;
+	}
+	if (controls->setNice)
+	{
+		errno = 0;
+		if (nice(controls->niceIncrement) == -1 && errno != 0)
+			fprintf(stderr, "nice: cannot set niceness: %s\n", strerror(errno));
+	}
+	return 0;
+}
+
+/**
+* Function: setBackgroundControl
+* -------------------------------------------
+* Handles the 'set' options for background jobs; returns 1 if the option was one of them and valid, 0 if it
+* isn't a background option and -1 if its value is invalid
+*	bgnice=N   - background jobs run with N added to their niceness
+*	bgcpus=LIST - background jobs run on a list of CPUs such as 0,2-3
+*
+* option - the option name, with '=value' when enabling
+* enable - 1 = set -o, 0 = set +o
+*/
+int setBackgroundControl(const char *option, int enable)
+{
+	int increment;
+	cpu_set_t set;
+
+	if (!enable && strcmp(option, "bgnice") == 0)
+		backgroundNice = 0;
+	else if (!enable && strcmp(option, "bgcpus") == 0)
+	{
+		free(backgroundCpuList);
+		backgroundCpuList = NULL;
+	}
+	else if (enable && strncmp(option, "bgnice=", 7) == 0)
+	{
+		if (parseNumber(option + 7, &increment) < 0)
+			return -1;
+		backgroundNice = increment;
+	}
+	else if (enable && strncmp(option, "bgcpus=", 7) == 0)
+	{
+		if (parseCpuList(option + 7, &set) < 0)
+			return -1;
+		free(backgroundCpuList);
+		backgroundCpuList = strdup(option + 7);
+		backgroundCpus = set;
+	}
+	else
+		return 0;
+	return 1;
+}
+
+/**
+* Function: printBackgroundControls
+* -------------------------------------------
+* Lists the background job options in the format of 'set -o'
+*
+* outputFd - the file descriptor to print to
+*/
+void printBackgroundControls(int outputFd)
+{
+	if (backgroundNice != 0)
+		dprintf(outputFd, "bgnice\t%d\n", backgroundNice);
+	else
+		dprintf(outputFd, "bgnice\toff\n");
+	dprintf(outputFd, "bgcpus\t%s\n", backgroundCpuList != NULL ? backgroundCpuList : "all");
+}
+
+/**
+* Function: printLimit
+* -------------------------------------------
+* Prints one limit in the units 'ulimit' uses for it; returns 0 on success and 1 if it can't be read
+*
+* outputFd - the file descriptor to print to
+* name - the limit
+* hard - 1 = print the hard limit, 0 = the soft one
+* withDescription - 1 = start the line with the limit's description (for -a)
+*/
+static int printLimit(int outputFd, const struct limitName *name, int hard, int withDescription)
+{
+	struct rlimit limit;
+	rlim_t value;
+
+	if (getrlimit(name->resource, &limit) < 0)
+	{
+		fprintf(stderr, "ulimit: %s\n", strerror(errno));
+		return 1;
+	}
+	value = hard ? limit.rlim_max : limit.rlim_cur;
+	if (withDescription)
+		dprintf(outputFd, "%-32s", name->description);
+	if (value == RLIM_INFINITY)
+		dprintf(outputFd, "unlimited\n");
+	else
+		dprintf(outputFd, "%llu\n", (unsigned long long) (value / name->ulimitUnit));
+	return 0;
+}
+
+/**
+* Function: executeUlimitCommand
+* -------------------------------------------
+* Defines logic for the 'ulimit' shell command, which shows or sets the shell's resource limits; every
+* command started afterwards inherits them
+*	ulimit [-S | -H] -a              - show every limit
+*	ulimit [-S | -H] -t | -v | -n    - show the CPU seconds, address space (KiB) or open files limit
+*	ulimit [-S | -H] -t | -v | -n N  - set it to N or 'unlimited' (both soft and hard without -S or -H)
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - where limits are shown
+* status - unused
+*/
+int executeUlimitCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int i = 1;
+	int result = 0;
+	int soft = 0;
+	int hard = 0;
+	int showAll = 0;
+	const char *option;
+	const struct limitName *selected = NULL;
+	struct rlimit limit;
+	rlim_t value;
+
+	for (; inputArgs[i] != NULL && inputArgs[i][0] == '-' && inputArgs[i][1] != 0; i++)
+		for (option = inputArgs[i] + 1; *option != 0; option++)
+		{
+			if (*option == 'S')
+				soft = 1;
+			else if (*option == 'H')
+				hard = 1;
+			else if (*option == 'a')
+				showAll = 1;
+			else if (*option == 't' || *option == 'v' || *option == 'n')
+				selected = &limitNames[*option == 't' ? 0 : *option == 'v' ? 1 : 2];
+			else
+			{
+				fprintf(stderr, "ulimit: usage: ulimit [-S | -H] [-a | -t | -v | -n] [limit]\n");
+				return 2;
+			}
+		}
+
+	if (showAll || (selected == NULL && inputArgs[i] == NULL))
+	{
+		for (selected = limitNames; selected < limitNames + RESOURCE_MAXIMUM_LIMITS; selected++)
+			result |= printLimit(outputFd, selected, hard && !soft, 1);
+		return result;
+	}
+	if (selected == NULL || (inputArgs[i] != NULL && inputArgs[i + 1] != NULL))
+	{
+		fprintf(stderr, "ulimit: usage: ulimit [-S | -H] [-a | -t | -v | -n] [limit]\n");
+		return 2;
+	}
+	if (inputArgs[i] == NULL)
+		return printLimit(outputFd, selected, hard && !soft, 0);
+
+	if (parseLimitValue(inputArgs[i], strlen(inputArgs[i]), selected->ulimitUnit, &value) < 0)
+	{
+		fprintf(stderr, "ulimit: %s: invalid limit\n", inputArgs[i]);
+		return 1;
+	}
+	getrlimit(selected->resource, &limit);
+	// Without -S or -H both limits change
+	if (soft || !hard)
+		limit.rlim_cur = value;
+	if (hard || !soft)
+		limit.rlim_max = value;
+	if (setrlimit(selected->resource, &limit) < 0)
+	{
+		fprintf(stderr, "ulimit: %s: %s\n", selected->description, strerror(errno));
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,126 @@
+/***********************************************************************************************************
+ * Filename: resources.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the resource controls applied to spawned commands (rlimits, CPU
+ * affinity, nice and I/O priority) and for the 'ulimit' builtin
+ **********************************************************************************************************/
+
+#ifndef RESOURCES_H_
+#define RESOURCES_H_
+
+#include "shell.h"
+
+#include <sched.h>
+#include <sys/resource.h>
+
+// Address space, CPU seconds and open files
+#define RESOURCE_MAXIMUM_LIMITS 3
+
+#define IOPRIO_CLASS_SHIFT 13
+#define IOPRIO_WHO_PROCESS 1
+
+struct resourceLimit
+{
+	int resource;
+	int setSoft;
+	int setHard;
+	struct rlimit limit;
+};
+
+// What a command's child sets on itself before it runs the command; the set* fields say what applies
+struct resourceControls
+{
+	int numberOfLimits;
+	struct resourceLimit limits[RESOURCE_MAXIMUM_LIMITS];
+	int setAffinity;
+	cpu_set_t affinity;
+	int setNice;
+	int niceIncrement;
+	int setIoPriority;
+	int ioPriority;				// class << IOPRIO_CLASS_SHIFT | level
+	int ignoreIoPriorityFailure;
+};
+
+/**
+* Function: initializeResourceControls
+* -------------------------------------------
+* Starts the controls of a pipeline stage: a background stage gets the defaults set with 'set -o bgnice'
+* and 'set -o bgcpus', a foreground one nothing
+*
+* controls - the controls to initialize
+* runInBackground - 1 = the stage belongs to a background job
+*/
+void initializeResourceControls(struct resourceControls *controls, int runInBackground);
+/**
+* Function: parseResourcePrefixes
+* -------------------------------------------
+* Takes the leading 'nice', 'taskset', 'ionice' and 'prlimit' words of a stage, with their options, into
+* the controls and returns where the command itself starts. A prefix whose options don't parse, or that has
+* no command after it, is left alone so it runs as the ordinary program of that name
+*	nice [-n N] command             - add N (default 10) to the niceness
+*	taskset MASK command            - run on the CPUs of a hexadecimal mask
+*	taskset -c LIST command         - run on a list of CPUs such as 0,2-3
+*	ionice [-c CLASS] [-n LEVEL] [-t] command - set the I/O class (1-3 or realtime, best-effort, idle)
+*	prlimit [--as=L] [--cpu=L] [--nofile=L] command - L is soft:hard, a value for both, soft: or :hard
+*
+* args - the words of the stage
+* controls - updated with every prefix taken
+*/
+char ** parseResourcePrefixes(char **args, struct resourceControls *controls);
+/**
+* Function: hasResourceControls
+* -------------------------------------------
+* Returns 1 if the controls change anything in the child and 0 otherwise
+*
+* controls - the controls of a stage
+*/
+int hasResourceControls(const struct resourceControls *controls);
+/**
+* Function: applyResourceControls
+* -------------------------------------------
+* Runs in the child between fork and exec: sets the limits, affinity, I/O priority and niceness on the
+* calling process. Returns 0 on success and -1 after printing why a control could not be set; failing to
+* change the niceness only prints a warning, as with nice(1)
+*
+* controls - the controls of the stage
+*/
+int applyResourceControls(const struct resourceControls *controls);
+/**
+* Function: setBackgroundControl
+* -------------------------------------------
+* Handles the 'set' options for background jobs; returns 1 if the option was one of them and valid, 0 if it
+* isn't a background option and -1 if its value is invalid
+*	bgnice=N   - background jobs run with N added to their niceness
+*	bgcpus=LIST - background jobs run on a list of CPUs such as 0,2-3
+*
+* option - the option name, with '=value' when enabling
+* enable - 1 = set -o, 0 = set +o
+*/
+int setBackgroundControl(const char *option, int enable);
+/**
+* Function: printBackgroundControls
+* -------------------------------------------
+* Lists the background job options in the format of 'set -o'
+*
+* outputFd - the file descriptor to print to
+*/
+void printBackgroundControls(int outputFd);
+/**
+* Function: executeUlimitCommand
+* -------------------------------------------
+* Defines logic for the 'ulimit' shell command, which shows or sets the shell's resource limits; every
+* command started afterwards inherits them
+*	ulimit [-S | -H] -a              - show every limit
+*	ulimit [-S | -H] -t | -v | -n    - show the CPU seconds, address space (KiB) or open files limit
+*	ulimit [-S | -H] -t | -v | -n N  - set it to N or 'unlimited' (both soft and hard without -S or -H)
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - where limits are shown
+* status - unused
+*/
+int executeUlimitCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+
+#endif /* RESOURCES_H_ */
@@ -0,0 +1,355 @@
+/***********************************************************************************************************
+ * Filename: serve.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the command server. One long-lived shell listens on a Unix socket and forks a
+ * session per client, so every session starts with the server's warm path cache, parse cache, executable
+ * index and variables, and keeps its own working directory, variables and jobs. A session runs the lines
+ * its client sends through the normal command loop; a relay process frames the session's standard out and
+ * error onto the socket as they are written. After each line the session hands its status to the relay
+ * and waits for the exit frame to go out, so no output of the next line can overtake it. How many lines
+ * run at once is capped with a pipe holding one byte per running slot, which a session reads before a
+ * line and writes back after it.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "serve.h"
+#include "events.h"
+#include "util.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+static int slotPipe[2] = { -1, -1 };
+static int statusFd = -1;
+
+/**
+* Function: sendFrame
+* -------------------------------------------
+* Writes a frame whose payload already sits in buffer after room for the header; once the client has gone
+* away frames are dropped, so the session's writers never block or see SIGPIPE
+*
+* socketFd - the client's socket
+* type - SERVE_FRAME_STDOUT, SERVE_FRAME_STDERR or SERVE_FRAME_EXIT
+* buffer - SERVE_HEADER_SIZE bytes of room followed by the payload
+* length - the length of the payload
+* connected - 1 while the client is reading; set to 0 once a write fails
+*/
+static void sendFrame(int socketFd, char type, char *buffer, size_t length, int *connected)
+{
+	if (!*connected)
+		return;
+	buffer[0] = type;
+	buffer[1] = (length >> 24) & 0xff;
+	buffer[2] = (length >> 16) & 0xff;
+	buffer[3] = (length >> 8) & 0xff;
+	buffer[4] = length & 0xff;
+	if (writeAll(socketFd, buffer, SERVE_HEADER_SIZE + length) < 0)
+		*connected = 0;
+}
+
+/**
+* Function: relayChunk
+* -------------------------------------------
+* Reads what one of the session's output pipes holds, up to SERVE_CHUNK_SIZE bytes, and sends it as a
+* frame; returns the number of bytes relayed, 0 once every writer has closed the pipe (which is then
+* closed and set to -1) or -1 if the pipe is empty
+*
+* fd - the read end of the pipe
+* type - the frame type the pipe's output goes out as
+* socketFd - the client's socket
+* buffer - room for a header and SERVE_CHUNK_SIZE bytes
+* connected - 1 while the client is reading
+*/
+static ssize_t relayChunk(int *fd, char type, int socketFd, char *buffer, int *connected)
+{
+	ssize_t bytesRead;
+
+	do
+		bytesRead = read(*fd, buffer + SERVE_HEADER_SIZE, SERVE_CHUNK_SIZE);
+	while (bytesRead < 0 && errno == EINTR);
+	if (bytesRead == 0)
+	{
+		close(*fd);
+		*fd = -1;
+		return 0;
+	}
+	if (bytesRead < 0)
+		return -1;
+	sendFrame(socketFd, type, buffer, bytesRead, connected);
+	return bytesRead;
+}
+
+/**
+* Function: relayOutput
+* -------------------------------------------
+* Runs in the relay process: sends the session's output as frames while it is written and, for each
+* status the session reports, first everything its pipes already hold, then the exit frame, then a byte
+* that lets the session go on. Returns once nothing can write to the pipes any more, background jobs
+* included
+*
+* socketFd - the client's socket
+* outputFd - the read end of the session's standard out
+* errorFd - the read end of the session's standard error
+* sessionFd - the relay's end of the socket pair the session reports each line's status through
+*/
+static void relayOutput(int socketFd, int outputFd, int errorFd, int sessionFd)
+{
+	struct pollfd fds[3] = { { outputFd, POLLIN, 0 }, { errorFd, POLLIN, 0 }, { sessionFd, POLLIN, 0 } };
+	const char types[2] = { SERVE_FRAME_STDOUT, SERVE_FRAME_STDERR };
+	char *buffer = malloc(SERVE_HEADER_SIZE + SERVE_CHUNK_SIZE);
+	int connected = 1;
+	int exitStatus;
+	char done = 0;
+	int i;
+
+	// Draining for a status must stop at an empty pipe rather than wait for the next writer
+	fcntl(outputFd, F_SETFL, O_NONBLOCK);
+	fcntl(errorFd, F_SETFL, O_NONBLOCK);
+	while (fds[0].fd >= 0 || fds[1].fd >= 0)
+	{
+		if (poll(fds, 3, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			perror("poll");
+			break;
+		}
+		for (i = 0; i < 2; i++)
+			if (fds[i].fd >= 0 && fds[i].revents != 0)
+				relayChunk(&fds[i].fd, types[i], socketFd, buffer, &connected);
+		if (fds[2].fd >= 0 && fds[2].revents != 0)
+		{
+			if (read(fds[2].fd, &exitStatus, sizeof(exitStatus)) != sizeof(exitStatus))
+			{
+				close(fds[2].fd);
+				fds[2].fd = -1;
+				continue;
+			}
+			// The line has finished, so whatever it wrote is already in the pipes
+			for (i = 0; i < 2; i++)
+				while (fds[i].fd >= 0 && relayChunk(&fds[i].fd, types[i], socketFd, buffer, &connected) > 0)
+					;
+			sendFrame(socketFd, SERVE_FRAME_EXIT, buffer,
+				sprintf(buffer + SERVE_HEADER_SIZE, "%d", exitStatus), &connected);
+			write(fds[2].fd, &done, 1);
+		}
+	}
+	free(buffer);
+}
+
+/**
+* Function: startSession
+* -------------------------------------------
+* Runs in a client's session process: starts the relay, points standard out and error at it and standard
+* in at /dev/null, and returns the client's socket to read command lines from, or -1 on failure
+*
+* clientFd - the client's socket
+*/
+static int startSession(int clientFd)
+{
+	int outputPipe[2];
+	int errorPipe[2];
+	int statusPair[2];
+	int nullFd;
+
+	// The server's epoll instance is shared with it after fork, so the session opens its own, and likewise
+	// its own trace file
+	closeEvents();
+	initializeEvents(NULL);
+	openSessionTrace();
+	if (pipe2(outputPipe, O_CLOEXEC) < 0 || pipe2(errorPipe, O_CLOEXEC) < 0 ||
+		socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, statusPair) < 0)
+	{
+		perror("pipe");
+		return -1;
+	}
+
+	switch (fork())
+	{
+		case -1:
+			perror("fork");
+			return -1;
+		case 0:
+			closeEvents();
+			close(outputPipe[1]);
+			close(errorPipe[1]);
+			close(statusPair[1]);
+			close(slotPipe[0]);
+			close(slotPipe[1]);
+			signal(SIGPIPE, SIG_IGN);
+			relayOutput(clientFd, outputPipe[0], errorPipe[0], statusPair[0]);
+			_exit(0);
+	}
+
+	close(outputPipe[0]);
+	close(errorPipe[0]);
+	close(statusPair[0]);
+	dup2(outputPipe[1], STDOUT_FILENO);
+	dup2(errorPipe[1], STDERR_FILENO);
+	close(outputPipe[1]);
+	close(errorPipe[1]);
+	nullFd = open("/dev/null", O_RDONLY);
+	dup2(nullFd, STDIN_FILENO);
+	close(nullFd);
+	statusFd = statusPair[1];
+	return clientFd;
+}
+
+/**
+* Function: serveClients
+* -------------------------------------------
+* Listens on a Unix socket and forks a session for every client, each with its own working directory,
+* variables, functions and jobs, starting from the server's. The server returns -1 if the socket can't be
+* set up or waiting on it fails, and SERVE_STOPPED after ^C. In each session's process it returns the
+* client's socket instead, with standard out and error relayed to the client as frames and standard in at
+* /dev/null: the caller then reads command lines from the socket like from a script
+*
+* socketPath - where to create the socket; a stale socket there is replaced
+* maximumRunning - how many lines may run at once across all sessions
+*/
+int serveClients(const char *socketPath, int maximumRunning)
+{
+	struct sockaddr_un address;
+	struct stat information;
+	int listenFd;
+	int clientFd;
+	int waited;
+	int result = SERVE_STOPPED;
+	char slot = 0;
+	int i;
+
+	if (strlen(socketPath) >= sizeof(address.sun_path))
+	{
+		fprintf(stderr, "%s: %s\n", socketPath, strerror(ENAMETOOLONG));
+		return -1;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath);
+	// A socket left behind by a server that was killed would make bind fail
+	if (lstat(socketPath, &information) == 0 && S_ISSOCK(information.st_mode))
+		unlink(socketPath);
+
+	listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (listenFd < 0 || bind(listenFd, (struct sockaddr *) &address, sizeof(address)) < 0 ||
+		listen(listenFd, SOMAXCONN) < 0)
+	{
+		perror(socketPath);
+		closeFile(listenFd >= 0, listenFd);
+		return -1;
+	}
+	if (pipe2(slotPipe, O_CLOEXEC) < 0)
+	{
+		perror("pipe");
+		close(listenFd);
+		return -1;
+	}
+	for (i = 0; i < maximumRunning; i++)
+		write(slotPipe[1], &slot, 1);
+
+	// Relays and background jobs outliving their session are handed to the server, which reaps them
+	prctl(PR_SET_CHILD_SUBREAPER, 1);
+	fprintf(stderr, "serving on %s (%d running at most)\n", socketPath, maximumRunning);
+	takeInterrupts();
+	while (takeInterrupts() == 0)
+	{
+		// Sessions that ended are reaped here like any other child
+		waited = waitForInput(listenFd);
+		if (waited == EVENTS_PENDING)
+		{
+			processPendingEvents();
+			continue;
+		}
+		// Waiting again would fail the same way at once, forever
+		if (waited == WAIT_FAILED)
+		{
+			perror("epoll_wait");
+			result = -1;
+			break;
+		}
+		clientFd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+		if (clientFd < 0)
+			continue;
+		fflush(stdout);
+		flushTrace();
+		switch (fork())
+		{
+			case -1:
+				perror("fork");
+				break;
+			case 0:
+				close(listenFd);
+				clientFd = startSession(clientFd);
+				if (clientFd < 0)
+					_exit(1);
+				return clientFd;
+		}
+		close(clientFd);
+	}
+
+	// Sessions still running carry on until their clients leave
+	close(listenFd);
+	unlink(socketPath);
+	close(slotPipe[0]);
+	close(slotPipe[1]);
+	return result;
+}
+
+/**
+* Function: beginServedCommand
+* -------------------------------------------
+* In a session, waits for one of the server's running slots before a line runs; does nothing otherwise
+*/
+void beginServedCommand()
+{
+	char slot;
+
+	if (statusFd < 0)
+		return;
+	while (read(slotPipe[0], &slot, 1) < 0 && errno == EINTR)
+		;
+}
+
+/**
+* Function: endServedCommand
+* -------------------------------------------
+* In a session, gives the running slot back and sends the line's exit status once its output is out,
+* returning when the relay has framed it; does nothing otherwise
+*
+* status - the last known termination status
+* parseStatus - 0, or -1 when the line had a syntax error (reported as status 2)
+*/
+void endServedCommand(const struct shellStatus *status, int parseStatus)
+{
+	char slot = 0;
+	char done;
+	int exitStatus;
+
+	if (statusFd < 0)
+		return;
+	write(slotPipe[1], &slot, 1);
+	if (parseStatus != 0)
+		exitStatus = 2;
+	else
+		exitStatus = status->signalOrTerminated ? 128 + status->terminationStatus : status->terminationStatus;
+	fflush(stdout);
+	fflush(stderr);
+	if (writeAll(statusFd, &exitStatus, sizeof(exitStatus)) < 0)
+		return;
+	while (read(statusFd, &done, 1) < 0 && errno == EINTR)
+		;
+}
@@ -0,0 +1,55 @@
+/***********************************************************************************************************
+ * Filename: serve.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the command server (smallsh --serve PATH), which keeps one warm
+ * shell listening on a Unix socket and runs the command lines its clients send, framing their output and
+ * exit statuses back
+ **********************************************************************************************************/
+
+#ifndef SERVE_H_
+#define SERVE_H_
+
+#include "shell.h"
+
+// Every frame is a type byte, the payload length as 4 bytes in network order, then the payload
+#define SERVE_FRAME_STDOUT 'o'
+#define SERVE_FRAME_STDERR 'e'
+#define SERVE_FRAME_EXIT 'x'		// the line's exit status in decimal; sent after all of the line's output
+#define SERVE_HEADER_SIZE 5
+#define SERVE_CHUNK_SIZE 65536
+// Returned by serveClients once the server is stopped with ^C
+#define SERVE_STOPPED -2
+
+/**
+* Function: serveClients
+* -------------------------------------------
+* Listens on a Unix socket and forks a session for every client, each with its own working directory,
+* variables, functions and jobs, starting from the server's. The server returns -1 if the socket can't be
+* set up or waiting on it fails, and SERVE_STOPPED after ^C. In each session's process it returns the
+* client's socket instead, with standard out and error relayed to the client as frames and standard in at
+* /dev/null: the caller then reads command lines from the socket like from a script
+*
+* socketPath - where to create the socket; a stale socket there is replaced
+* maximumRunning - how many lines may run at once across all sessions
+*/
+int serveClients(const char *socketPath, int maximumRunning);
+/**
+* Function: beginServedCommand
+* -------------------------------------------
+* In a session, waits for one of the server's running slots before a line runs; does nothing otherwise
+*/
+void beginServedCommand();
+/**
+* Function: endServedCommand
+* -------------------------------------------
+* In a session, gives the running slot back and sends the line's exit status once its output is out,
+* returning when the relay has framed it; does nothing otherwise
+*
+* status - the last known termination status
+* parseStatus - 0, or -1 when the line had a syntax error (reported as status 2)
+*/
+void endServedCommand(const struct shellStatus *status, int parseStatus);
+
+#endif /* SERVE_H_ */
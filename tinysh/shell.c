@@ -6,10 +6,26 @@
  * Description: Contains implementations for the core shell operations (executing commands)
  **********************************************************************************************************/
 
+#define _GNU_SOURCE
+
 #include "shell.h"
 #include "util.h"
 #include "cli.h"
+#include "pathcache.h"
+#include "spawn.h"
+#include "jobs.h"
+#include "builtins.h"
+#include "parsecache.h"
+#include "copy.h"
+#include "parallel.h"
+#include "history.h"
+#include "resources.h"
+#include "trace.h"
+#include "variables.h"
+#include "functions.h"
+#include "heredoc.h"
 
+#include <errno.h>
 #include <unistd.h>
 #include <string.h>
 #include <sys/wait.h> 
@@ -19,19 +35,9 @@
 #include <fcntl.h> 
 #include <signal.h>
 
-/**
-* Function: executeCommand
-* -------------------------------------------
-* Executes a given command by searching in current path for matching file/program
-*
-* inputArgs - an array of inputs given to the shell where the command is available at
-*	inputArgs[0]
-*/
-void executeCommand(char **inputArgs) 
-{
-	execvp(inputArgs[0], inputArgs);
-	perror(inputArgs[0]);
-}
+// Shell options changed through 'set -o'
+static int pipeFail = 0;
+static int pipeBufferSize = 0;
 
 /**
 * Function: executeChangeDirectory
@@ -39,10 +45,11 @@ void executeCommand(char **inputArgs)
 * Defines logic for the 'cd' shell command, which changes the current directory
 * to the one by the given path
 *
-* targetDirectory - the full path of the directory to change to
+* inputArgs - contains the arguments given to CLI component; inputArgs[1] is the directory to change to
 */
-void executeChangeDirectory(char *targetDirectory)
+int executeChangeDirectory(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
 {
+	char *targetDirectory = inputArgs[1];
 	// Get home directory
 	char homeDirectory[PATH_MAXIMUM];
 	assignHomeDirectory(homeDirectory);
@@ -52,47 +59,184 @@ void executeChangeDirectory(char *targetDirectory)
 		travelToDirectory(homeDirectory);
 	else
 		travelToDirectory(targetDirectory);
+	return 0;
 }
 
 /**
-* Function: executeStatusCommand
+* Function: printTerminationStatus
 * -------------------------------------------
-* Defines logic for the 'status' shell command, which prints the exit status
-* of the last child process that ran
+* Prints an exit value or the signal that terminated a process
 *
-* terminationStatus - the last known child termination status
+* outputFd - the file descriptor to print to
+* terminationStatus - the termination status to print
 * signalOrTerminated - 0 = normal exit, 1 = signal terminated
 */
-void executeStatusCommand(int *terminationStatus, int *signalOrTerminated)
+void printTerminationStatus(int outputFd, int terminationStatus, int signalOrTerminated)
 {
 	// Process exited successfully
-	if (*signalOrTerminated == 0)
-		printf("exit value %d\n", *terminationStatus);
+	if (signalOrTerminated == 0)
+		dprintf(outputFd, "exit value %d\n", terminationStatus);
 	// Process was killed by a signal
-	else if (*signalOrTerminated == 1)
-		printf("terminated by signal %d\n", *terminationStatus);
+	else if (signalOrTerminated == 1)
+		dprintf(outputFd, "terminated by signal %d\n", terminationStatus);
 }
 
 /**
-* Function: processSingleThreadedCommand
+* Function: executeStatusCommand
 * -------------------------------------------
-* Executes commands that don't need to run as children of main process
+* Defines logic for the 'status' shell command, which prints the exit status
+* of the last child process that ran
+*
+* outputFd - the file descriptor to print to
+* status - holds the last known termination status
+*/
+int executeStatusCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	printTerminationStatus(outputFd, status->terminationStatus, status->signalOrTerminated);
+	return 0;
+}
+
+/**
+* Function: executeExitCommand
+* -------------------------------------------
+* Defines logic for the 'exit' shell command, which stops the shell; 'exit N' makes N the shell's exit
+* status
 *
 * inputArgs - contains the arguments given to CLI component
-* exitIndicator - has the user specified that they want to exit 0 = no 1 = yes
-* terminationStatus - the last known child termination status
-* signalOrTerminated - 0 = normal exit, 1 = signal terminated
+* status - assigned the exit indicator and, when given, the exit status
 */
-void processSingleThreadedCommand(char **inputArgs, int *exitIndicator, int *terminationStatus, int *signalOrTerminated)
+int executeExitCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
 {
-	if (strncmp(inputArgs[0], "cd", 2) == 0)
-		executeChangeDirectory(inputArgs[1]);
+	status->exitIndicator = 1;
+	if (inputArgs[1] != NULL)
+	{
+		status->terminationStatus = atoi(inputArgs[1]) & 255;
+		status->signalOrTerminated = 0;
+	}
+	return status->terminationStatus;
+}
 
-	else if (strncmp(inputArgs[0], "exit", 4) == 0)
-		*exitIndicator = 1;
+/**
+* Function: executeHashCommand
+* -------------------------------------------
+* Defines logic for the 'hash' shell command, which lists, adds or clears entries in the cache of
+* command locations found on $PATH
+*	hash            - list cached commands and their hit counts
+*	hash -r         - forget every cached command
+*	hash -d name... - forget the given commands
+*	hash name...    - look up the given commands and remember their locations
+* Returns 1 if any of the given commands wasn't found
+*
+* inputArgs - contains the arguments given to CLI component
+* outputFd - the file descriptor to print the table to
+*/
+int executeHashCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int i = 1;
+	int forget = 0;
+	int result = 0;
 
-	else if (strncmp(inputArgs[0], "status", 5) == 0)
-		executeStatusCommand(terminationStatus, signalOrTerminated);
+	if (inputArgs[1] == NULL)
+	{
+		printPathCache(outputFd);
+		return 0;
+	}
+	if (strcmp(inputArgs[1], "-r") == 0)
+	{
+		clearPathCache();
+		i = 2;
+	}
+	else if (strcmp(inputArgs[1], "-d") == 0)
+	{
+		forget = 1;
+		i = 2;
+	}
+
+	for (; inputArgs[i] != NULL; i++)
+	{
+		if (forget ? !removeCommandPath(inputArgs[i]) : !addCommandPath(inputArgs[i]))
+		{
+			fprintf(stderr, "hash: %s: not found\n", inputArgs[i]);
+			result = 1;
+		}
+	}
+	return result;
+}
+
+/**
+* Function: executeSetCommand
+* -------------------------------------------
+* Defines logic for the 'set' shell command, which lists the variables and turns shell options on (-o) and
+* off (+o)
+*	set                     - list every variable and its value
+*	set -o                  - list the options and their values
+*	set -o pipefail         - a pipeline's status is the last non-zero status of any stage
+*	set -o history          - record lines and expand history references (on by default when interactive)
+*	set -o pipesize=BYTES   - resize the kernel buffer of every pipe between pipeline stages
+*	set -o bgnice=N         - background jobs run with N added to their niceness
+*	set -o bgcpus=LIST      - background jobs run on a list of CPUs such as 0,2-3
+*	set +o OPTION           - back to the default
+*
+* inputArgs - contains the arguments given to CLI component
+* outputFd - the file descriptor to list the options on
+*/
+int executeSetCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int enable;
+	int background;
+	char *option;
+
+	if (inputArgs[1] == NULL)
+	{
+		printVariables(outputFd);
+		return 0;
+	}
+	if (inputArgs[2] == NULL)
+	{
+		dprintf(outputFd, "pipefail\t%s\n", pipeFail ? "on" : "off");
+		dprintf(outputFd, "history\t%s\n", historyEnabled() ? "on" : "off");
+		if (pipeBufferSize > 0)
+			dprintf(outputFd, "pipesize\t%d\n", pipeBufferSize);
+		else
+			dprintf(outputFd, "pipesize\tdefault\n");
+		printBackgroundControls(outputFd);
+		return 0;
+	}
+	if (strcmp(inputArgs[1], "-o") != 0 && strcmp(inputArgs[1], "+o") != 0)
+	{
+		printf("set: %s: invalid option\n", inputArgs[1]);
+		return 1;
+	}
+	enable = inputArgs[1][0] == '-';
+	option = inputArgs[2];
+
+	if (strcmp(option, "pipefail") == 0)
+		pipeFail = enable;
+	else if (strcmp(option, "history") == 0)
+	{
+		if (!enable)
+			disableHistory();
+		else if (enableHistory() < 0)
+		{
+			perror("set: history");
+			return 1;
+		}
+	}
+	else if (!enable && strcmp(option, "pipesize") == 0)
+		pipeBufferSize = 0;
+	else if (enable && strncmp(option, "pipesize=", 9) == 0 && atoi(option + 9) > 0)
+		pipeBufferSize = atoi(option + 9);
+	else if ((background = setBackgroundControl(option, enable)) < 0)
+	{
+		printf("set: %s: invalid value\n", option);
+		return 1;
+	}
+	else if (background == 0)
+	{
+		printf("set: %s: invalid option name\n", option);
+		return 1;
+	}
+	return 0;
 }
 
 /**
@@ -121,182 +265,898 @@ void assignChildStatus(int *childStatus, int *terminationStatus, int *signalOrTe
 }
 
 /**
-* Function: checkBackgroundPidStatus
+* Function: recordJobPidExit
 * -------------------------------------------
-* Checks the status of a process currently running in the background and returns if
-* the process completed or not
+* Records that a process of a job terminated, keeping the last stage's status as the job's status and
+* adding its resource usage to the job's; returns the number of the job's processes still alive
 *
-* pid - the id of the background process
+* job - the job the process belongs to
+* pid - the pid that terminated
+* childStatus - the status reported by wait4
+* usage - the resources the process used, as reported by wait4
 */
-int checkBackgroundPidStatus(pid_t pid)
+int recordJobPidExit(struct job *job, pid_t pid, int *childStatus, struct rusage *usage)
 {
+	int remaining;
+
+	addResourceUsage(&job->usage, usage);
+	if (pid == job->lastPid)
+		assignChildStatus(childStatus, &job->terminationStatus, &job->signalOrTerminated);
+	remaining = markJobPidReaped(job, pid);
+	// The job's event ends when it did, not when it is reported
+	if (remaining == 0 && traceEnabled())
+		job->trace.exitDone = monotonicNanoseconds();
+	return remaining;
+}
+
+/**
+* Function: recordChildStateChange
+* -------------------------------------------
+* Applies a state change reaped by wait4(-1) to the job the child belongs to, printing the status of
+* background jobs that completed or stopped (with their resource usage when started with 'time') and
+* removing completed jobs from the job table. Children that belong to no job are ignored. Returns 1 if a
+* notice was printed and 0 otherwise
+*
+* pid - the child reported by wait4
+* childStatus - the status reported by wait4
+* usage - the resources the child used, as reported by wait4
+*/
+int recordChildStateChange(pid_t pid, int childStatus, struct rusage *usage)
+{
+	struct job *job = findJobByPid(pid);
+	int printed = 0;
+	if (job == NULL)
+		return 0;
+
+	if (WIFSTOPPED(childStatus))
+	{
+		if (job->state != JOB_STOPPED)
+		{
+			printf("[%d] Stopped\t%s\n", job->jobNumber, job->commandLine);
+			printed = 1;
+		}
+		job->state = JOB_STOPPED;
+		touchJob(job);
+	}
+	else if (WIFCONTINUED(childStatus))
+		job->state = JOB_RUNNING;
+	// Report the job once its last process is gone
+	else if (recordJobPidExit(job, pid, &childStatus, usage) == 0)
+	{
+		printf("background pid %d is done: ", job->lastPid);
+		fflush(stdout);
+		printTerminationStatus(STDOUT_FILENO, job->terminationStatus, job->signalOrTerminated);
+		if (job->timed)
+			printResourceUsage(STDERR_FILENO, &job->startTime, &job->usage);
+		traceCommand(job->commandLine, job->lastPid, &job->trace, 1,
+			job->terminationStatus, job->signalOrTerminated, &job->usage);
+		removeJob(job);
+		printed = 1;
+	}
+	return printed;
+}
+
+/**
+* Function: monitorBackgroundPids
+* -------------------------------------------
+* Reaps every child that changed state since the last prompt with a single wait4(-1) loop, prints the
+* status of background jobs that completed or stopped and removes completed jobs from the job table;
+* returns the number of notices printed
+*/
+int monitorBackgroundPids()
+{
+	int childStatus;
+	pid_t pid;
+	struct rusage usage;
+	int notices = 0;
+
+	while ((pid = wait4(-1, &childStatus, WNOHANG | WUNTRACED | WCONTINUED, &usage)) > 0)
+		notices += recordChildStateChange(pid, childStatus, &usage);
+	return notices;
+}
+
+/**
+* Function: waitForStage
+* -------------------------------------------
+* Waits in the foreground for the next state change of one of a command's processes and returns its index
+* in pids, or -1 once none is left to wait for. Background children that change state meanwhile go to
+* recordChildStateChange, so they are reaped and reported as they exit rather than after the command
+*
+* pids - the processes of the command; entries of 0 or less are skipped
+* numberOfPids - the length of pids
+* childStatus - assigned the status reported by wait4
+* usage - assigned the resources the process used, as reported by wait4
+*/
+static int waitForStage(const pid_t *pids, int numberOfPids, int *childStatus, struct rusage *usage)
+{
+	int i;
+	pid_t pid;
+
+	for (i = 0; i < numberOfPids && pids[i] <= 0; i++)
+		;
+	if (i == numberOfPids)
+		return -1;
+	while (1)
+	{
+		pid = wait4(-1, childStatus, WUNTRACED, usage);
+		if (pid < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		for (i = 0; i < numberOfPids; i++)
+			if (pids[i] == pid)
+				return i;
+		recordChildStateChange(pid, *childStatus, usage);
+	}
+}
+
+/**
+* Function: waitForJob
+* -------------------------------------------
+* Waits in the foreground for every remaining process of a job. If the job finishes its status becomes the
+* shell's last status and it leaves the job table; if it is stopped again it stays in the table. A job
+* started with 'time' reports its resource usage once it finishes
+*
+* job - the job to wait for
+* terminationStatus - the last known child termination status
+* signalOrTerminated - 0 = normal exit, 1 = signal terminated
+*/
+void waitForJob(struct job *job, int *terminationStatus, int *signalOrTerminated)
+{
+	int i;
 	int childStatus;
-	int terminationStatus;
-	int signalOrTerminated;
-	pid_t returnStatus;
-
-	// Check the status of the ongoing background process
-	returnStatus = waitpid(pid, &childStatus, WNOHANG);
-	// Print the status if the background process completed and return 1 to denote completion
-	if (returnStatus > 0)
-	{
-		printf("background pid %d is done: ", pid);
-		// What was the exit or signal code
-		assignChildStatus(&childStatus, &terminationStatus, &signalOrTerminated);
-		// Print status to stdout
-		executeStatusCommand(&terminationStatus, &signalOrTerminated);
+	struct rusage usage;
+
+	while ((i = waitForStage(job->pids, job->numberOfPids, &childStatus, &usage)) >= 0)
+	{
+		if (WIFSTOPPED(childStatus))
+		{
+			job->state = JOB_STOPPED;
+			touchJob(job);
+			printf("\n[%d] Stopped\t%s\n", job->jobNumber, job->commandLine);
+			return;
+		}
+		recordJobPidExit(job, job->pids[i], &childStatus, &usage);
+	}
+
+	*terminationStatus = job->terminationStatus;
+	*signalOrTerminated = job->signalOrTerminated;
+	if (*signalOrTerminated == 1)
+		printTerminationStatus(STDOUT_FILENO, *terminationStatus, *signalOrTerminated);
+	if (job->timed)
+		printResourceUsage(STDERR_FILENO, &job->startTime, &job->usage);
+	traceCommand(job->commandLine, job->lastPid, &job->trace, 1,
+		job->terminationStatus, job->signalOrTerminated, &job->usage);
+	removeJob(job);
+}
+
+/**
+* Function: continueJob
+* -------------------------------------------
+* Sends SIGCONT to every remaining process of a job and marks it running
+*
+* job - the job to resume
+*/
+void continueJob(struct job *job)
+{
+	int i;
+	for (i = 0; i < job->numberOfPids; i++)
+		if (job->pids[i] > 0)
+			kill(job->pids[i], SIGCONT);
+	job->state = JOB_RUNNING;
+	touchJob(job);
+}
+
+/**
+* Function: resolveJobSpec
+* -------------------------------------------
+* Returns the job named by a job spec ("%2" or "2"), the current job when no spec is given, or NULL after
+* printing an error if there is no such job
+*
+* commandName - the builtin asking, used in error messages
+* jobSpec - the argument given to the builtin or NULL
+*/
+struct job * resolveJobSpec(char *commandName, char *jobSpec)
+{
+	struct job *job;
+	if (jobSpec == NULL)
+	{
+		job = currentJob();
+		if (job == NULL)
+			printf("%s: no current job\n", commandName);
+		return job;
+	}
+
+	job = findJobByNumber(atoi(jobSpec[0] == '%' ? jobSpec + 1 : jobSpec));
+	if (job == NULL)
+		printf("%s: %s: no such job\n", commandName, jobSpec);
+	return job;
+}
+
+/**
+* Function: executeJobsCommand
+* -------------------------------------------
+* Defines logic for the 'jobs' shell command, which lists background and stopped jobs; 'jobs -l' also
+* shows the pid of the last stage and how long ago the job started
+*
+* inputArgs - contains the arguments given to CLI component
+* outputFd - the file descriptor to list the jobs on
+*/
+int executeJobsCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int longFormat = inputArgs[1] != NULL && strcmp(inputArgs[1], "-l") == 0;
+	struct job *current = currentJob();
+	struct job *job = NULL;
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	while ((job = nextJob(job)) != NULL)
+	{
+		const char *state = job->state == JOB_STOPPED ? "Stopped" : "Running";
+		dprintf(outputFd, "[%d]%c ", job->jobNumber, job == current ? '+' : ' ');
+		if (longFormat)
+			dprintf(outputFd, "%d %-8s %lds\t", job->lastPid, state, (long) (now.tv_sec - job->startTime.tv_sec));
+		else
+			dprintf(outputFd, "%-8s\t", state);
+		dprintf(outputFd, "%s\n", job->commandLine);
+	}
+	return 0;
+}
+
+/**
+* Function: executeForegroundCommand
+* -------------------------------------------
+* Defines logic for the 'fg' shell command, which resumes a job if it is stopped and waits for it in the
+* foreground
+*
+* inputArgs - contains the arguments given to CLI component
+* outputFd - the file descriptor to print the job's command line to
+* status - assigned the job's termination status once it completes
+*/
+int executeForegroundCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	struct job *job = resolveJobSpec("fg", inputArgs[1]);
+	if (job == NULL)
+		return 1;
+
+	dprintf(outputFd, "%s\n", job->commandLine);
+	if (job->state == JOB_STOPPED)
+		continueJob(job);
+	waitForJob(job, &status->terminationStatus, &status->signalOrTerminated);
+	return 0;
+}
+
+/**
+* Function: executeBackgroundCommand
+* -------------------------------------------
+* Defines logic for the 'bg' shell command, which resumes a stopped job in the background
+*
+* inputArgs - contains the arguments given to CLI component
+* outputFd - the file descriptor to print the resumed job to
+*/
+int executeBackgroundCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	struct job *job = resolveJobSpec("bg", inputArgs[1]);
+	if (job == NULL)
+		return 1;
+
+	if (job->state != JOB_STOPPED)
+	{
+		printf("bg: job %d already in background\n", job->jobNumber);
 		return 1;
 	}
+	continueJob(job);
+	dprintf(outputFd, "[%d] %s\n", job->jobNumber, job->commandLine);
 	return 0;
 }
 
 /**
-* Function: monitorBackgroundPids
+* Function: executeSpawnStatisticsCommand
+* -------------------------------------------
+* Defines logic for the 'spawnstat' shell command, which prints the launch latency of each spawn path;
+* 'spawnstat -r' starts the measurements over
+*
+* inputArgs - contains the arguments given to CLI component
+* outputFd - the file descriptor to print the statistics to
+*/
+int executeSpawnStatisticsCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	if (inputArgs[1] != NULL && strcmp(inputArgs[1], "-r") == 0)
+		resetSpawnStatistics();
+	else
+		printSpawnStatistics(outputFd);
+	return 0;
+}
+
+/**
+* Function: executeParseCacheCommand
+* -------------------------------------------
+* Defines logic for the 'parsecache' shell command, which prints how many lines the parsed-command cache
+* holds and how often it was hit; 'parsecache -r' empties it
+*
+* inputArgs - contains the arguments given to CLI component
+* outputFd - the file descriptor to print the counters to
+*/
+int executeParseCacheCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	if (inputArgs[1] != NULL && strcmp(inputArgs[1], "-r") == 0)
+		clearParseCache();
+	else
+		printParseCache(outputFd);
+	return 0;
+}
+
+// The builtin registry, sorted by name for findBuiltin's binary search. Builtins standing in for external
+// utilities set the shell's status; the ones managing the shell itself leave it alone
+static const struct builtinCommand builtins[] = {
+	{ "[", executeTestCommand, BUILTIN_SETS_STATUS | BUILTIN_OUTPUT_ONLY },
+	{ "bg", executeBackgroundCommand, 0 },
+	{ "cat", executeCatCommand,
+		BUILTIN_SETS_STATUS | BUILTIN_FORKS_IN_BACKGROUND | BUILTIN_FORKS_ON_TERMINAL | BUILTIN_OUTPUT_ONLY },
+	{ "cd", executeChangeDirectory, 0 },
+	{ "cp", executeCpCommand, BUILTIN_SETS_STATUS | BUILTIN_FORKS_IN_BACKGROUND },
+	{ "echo", executeEchoCommand, BUILTIN_SETS_STATUS | BUILTIN_OUTPUT_ONLY },
+	{ "exit", executeExitCommand, 0 },
+	{ "export", executeExportCommand, 0 },
+	{ "false", executeFalseCommand, BUILTIN_SETS_STATUS | BUILTIN_OUTPUT_ONLY },
+	{ "fg", executeForegroundCommand, 0 },
+	{ "hash", executeHashCommand, BUILTIN_SETS_STATUS },
+	{ "history", executeHistoryCommand, 0 },
+	{ "jobs", executeJobsCommand, 0 },
+	{ "parallel", executeParallelCommand, BUILTIN_SETS_STATUS | BUILTIN_FORKS_IN_BACKGROUND },
+	{ "parsecache", executeParseCacheCommand, 0 },
+	{ "printf", executePrintfCommand, BUILTIN_SETS_STATUS | BUILTIN_OUTPUT_ONLY },
+	{ "pwd", executePwdCommand, BUILTIN_SETS_STATUS | BUILTIN_OUTPUT_ONLY },
+	{ "return", executeReturnCommand, BUILTIN_SETS_STATUS },
+	{ "set", executeSetCommand, 0 },
+	{ "shift", executeShiftCommand, BUILTIN_SETS_STATUS },
+	{ "spawnstat", executeSpawnStatisticsCommand, 0 },
+	{ "status", executeStatusCommand, 0 },
+	{ "test", executeTestCommand, BUILTIN_SETS_STATUS | BUILTIN_OUTPUT_ONLY },
+	{ "true", executeTrueCommand, BUILTIN_SETS_STATUS | BUILTIN_OUTPUT_ONLY },
+	{ "ulimit", executeUlimitCommand, BUILTIN_SETS_STATUS },
+	{ "unset", executeUnsetCommand, 0 }
+};
+
+#define NUMBER_OF_BUILTINS ((int) (sizeof(builtins) / sizeof(builtins[0])))
+
+// Functions run like builtins: in the shell on their own, in a child as a pipeline stage or with '&'
+static const struct builtinCommand functionCommand = {
+	NULL, executeFunctionCommand, BUILTIN_SETS_STATUS | BUILTIN_FORKS_IN_BACKGROUND
+};
+
+/**
+* Function: findCommandHandler
+* -------------------------------------------
+* Returns how to run a command inside the shell: the function of that name, which takes precedence, or
+* the builtin; NULL if it is neither
+*
+* commandName - the name of the command
+*/
+static const struct builtinCommand * findCommandHandler(const char *commandName)
+{
+	if (findFunction(commandName) != NULL)
+		return &functionCommand;
+	return findBuiltin(builtins, NUMBER_OF_BUILTINS, commandName);
+}
+
+/**
+* Function: builtinNameAt
 * -------------------------------------------
-* Track and print the status of processes running in the background; remove completed background tasks from
-* collection of background processes
+* Returns the name of a builtin by its position in the registry, or NULL past the last one
 *
-* pidArray - an array of pid ids running in the background
-* terminatedPids - an array of background pids that have completed
-* numberOfPids - the length of the pid array
-* maxNumberOfPids - the current size allocated to the pid array
-* numberOfTerminatedPids - the length of the terminatedPids array
-* maxNumberOfTerminatedPids - the current size allocated to the terminatedPids array
+* index - the position in the registry
 */
-void monitorBackgroundPids(
-	pid_t *pidArray, pid_t *terminatedPids, 
-	int *numberOfPids, int *maxNumberOfPids,
-	int *numberOfTerminatedPids, int *maxNumberOfTerminatedPids)
+const char * builtinNameAt(int index)
+{
+	return index >= 0 && index < NUMBER_OF_BUILTINS ? builtins[index].name : NULL;
+}
+
+/**
+* Function: capturedInShell
+* -------------------------------------------
+* Returns 1 if a command substitution starting with a command can run inside the shell: the command is a
+* builtin that only writes output, so the shell is left as a subshell would leave it; 0 if it needs a child
+*
+* commandName - the name of the command
+*/
+int capturedInShell(const char *commandName)
+{
+	const struct builtinCommand *builtin = findCommandHandler(commandName);
+
+	// A function can change directory, variables or positional parameters, which a subshell keeps to itself
+	return builtin != NULL && builtin != &functionCommand && (builtin->flags & BUILTIN_OUTPUT_ONLY);
+}
+
+/**
+* Function: buildCommandLine
+* -------------------------------------------
+* Returns a newly allocated copy of the command as typed (stages, redirections and '&') for the job table
+*
+* command - the parsed command
+*/
+char * buildCommandLine(struct parsedCommand *command)
 {
 	int i;
-	int bgPidStatus;
-	// Iterate over existing background pids and print their statuses
-	for (i = 0; i < *numberOfPids; i++)
+	size_t length = 16;
+	char *commandLine;
+
+	for (i = 0; i < command->numberOfArgs; i++)
+		length += command->args[i] ? strlen(command->args[i]) + 1 : 2;
+	if (command->redirectInput)
+		length += strlen(command->inputRedirect) + 5;
+	if (command->redirectOutput)
+		length += strlen(command->outputRedirect) + 3;
+
+	commandLine = malloc(length);
+	commandLine[0] = 0;
+	// Every stage but the last ends with a NULL entry that reads as a pipe
+	for (i = 0; i < command->numberOfArgs - 1; i++)
+	{
+		if (i > 0)
+			strcat(commandLine, " ");
+		strcat(commandLine, command->args[i] ? command->args[i] : "|");
+	}
+	// A here-document shows as its <<WORD, without the body
+	if (command->redirectInput == REDIRECT_HERE_DOCUMENT)
+		strcat(strcat(commandLine, " <<"), command->inputRedirect);
+	else if (command->redirectInput == REDIRECT_HERE_STRING)
+		strcat(strcat(commandLine, " <<< "), command->inputRedirect);
+	else if (command->redirectInput)
+		strcat(strcat(commandLine, " < "), command->inputRedirect);
+	if (command->redirectOutput)
+		strcat(strcat(commandLine, " > "), command->outputRedirect);
+	if (command->runInBackground)
+		strcat(commandLine, " &");
+	return commandLine;
+}
+
+/**
+* Function: createStagePipe
+* -------------------------------------------
+* Creates the close-on-exec pipe connecting two pipeline stages, applying the 'set -o pipesize' buffer
+* size; returns 0 on success and -1 on failure
+*
+* pipeFds - assigned the read and write ends of the pipe
+*/
+int createStagePipe(int pipeFds[2])
+{
+	if (pipe2(pipeFds, O_CLOEXEC) < 0)
+	{
+		perror("pipe");
+		return -1;
+	}
+	// Best effort: the kernel caps unprivileged users at /proc/sys/fs/pipe-max-size
+	if (pipeBufferSize > 0 && fcntl(pipeFds[1], F_SETPIPE_SZ, pipeBufferSize) < 0)
+		perror("F_SETPIPE_SZ");
+	return 0;
+}
+
+/**
+* Function: openCommandInput
+* -------------------------------------------
+* Opens what standard in of a command should be redirected from: the file given with <, or a pipe
+* delivering a here-document or here-string. Returns its file descriptor, -1 after reporting why it
+* couldn't be opened, or -2 when no redirection was requested
+*
+* command - the parsed command
+*/
+static int openCommandInput(struct parsedCommand *command)
+{
+	int inputFileDescriptor;
+
+	if (command->hereDocument != NULL)
+		return openHereDocument(command);
+	inputFileDescriptor = openInputRedirect(command->redirectInput, command->inputRedirect);
+	if (inputFileDescriptor == -1)
+		printf("cannot open %s for input\n", command->inputRedirect);
+	return inputFileDescriptor;
+}
+
+/**
+* Function: launchPipeline
+* -------------------------------------------
+* Starts every stage of a command at once, connected by pipes, and returns the number of stages started
+* (their pids, -1 for a stage that couldn't be spawned, are assigned to stagePids) or -1 if a redirection
+* target couldn't be opened. The command's own < and > take precedence over the given descriptors
+*
+* command - the parsed command; its pipeline stages are separated by NULL entries
+* inputFd - standard in for the first stage or -1 to inherit the shell's
+* outputFd - standard out for the last stage or -1 to inherit the shell's
+* stagePids - assigned the pid of every stage; room for command->numberOfStages pids
+* status - the shell's status, handed to builtins run as stages
+*/
+int launchPipeline(
+	struct parsedCommand *command, int inputFd, int outputFd, pid_t *stagePids, struct shellStatus *status)
+{
+	int stage;
+	int pipeFds[2];
+	int stageInput;
+	int stageOutput;
+	int numberOfStages = command->numberOfStages;
+	char **stageArgs = command->args;
+	char **commandArgs;
+	const struct builtinCommand *builtin;
+	struct resourceControls controls;
+	// Open the redirection targets here; the spawn path hands them to the child as its stdin and stdout
+	int outputFileDescriptor = openOutputRedirect(command->redirectOutput, command->outputRedirect);
+	int inputFileDescriptor;
+
+	if (outputFileDescriptor == -1)
 	{
-		// Print statuses of background pid and get back whether it finished or not
-		bgPidStatus = checkBackgroundPidStatus(pidArray[i]);
-		// Keep track of pid in an array of pids to delete if the corresponding process terminated
-		if (bgPidStatus)
-			appendPidToArray(terminatedPids, pidArray[i], numberOfTerminatedPids, maxNumberOfTerminatedPids);
+		printf("cannot open %s for output\n", command->outputRedirect);
+		return -1;
 	}
-	// Iterate over pids of processes that ended
-	for (i = 0; i < *numberOfTerminatedPids; i ++)
+	inputFileDescriptor = openCommandInput(command);
+	if (inputFileDescriptor == -1)
+	{
+		closeFile(command->redirectOutput, outputFileDescriptor);
+		return -1;
+	}
+
+	// Start every stage before waiting on any of them so they all run concurrently
+	fflush(stdout);
+	stageInput = command->redirectInput ? inputFileDescriptor : inputFd;
+	for (stage = 0; stage < numberOfStages; stage++)
 	{
-		// Remove the pid from the array of ongoing background pids
-		removePidFromArray(pidArray, terminatedPids[i], numberOfPids);
-		terminatedPids[i] = 0;
+		stageOutput = command->redirectOutput ? outputFileDescriptor : outputFd;
+		if (stage < numberOfStages - 1)
+		{
+			if (createStagePipe(pipeFds) < 0)
+			{
+				// The read end of the previous stage's pipe has no stage left to hand it to
+				if (stage > 0 && stageInput != inputFd)
+					close(stageInput);
+				numberOfStages = stage;
+				break;
+			}
+			stageOutput = pipeFds[1];
+		}
+
+		// nice, taskset, ionice and prlimit in front of a stage become settings of that stage's child
+		initializeResourceControls(&controls, command->runInBackground);
+		commandArgs = parseResourcePrefixes(stageArgs, &controls);
+
+		// Builtins in a pipeline run in a child of their own like any other stage
+		builtin = findCommandHandler(commandArgs[0]);
+		if (builtin != NULL)
+			stagePids[stage] = spawnBuiltin(builtin->handler, commandArgs, stageInput, stageOutput,
+				command->runInBackground, &controls, status);
+		else
+			stagePids[stage] = spawnCommand(
+				commandArgs, stageInput, stageOutput, command->runInBackground, &controls);
+
+		// The children hold their own copies of the pipe ends
+		if (stage > 0)
+			close(stageInput);
+		if (stage < numberOfStages - 1)
+		{
+			close(pipeFds[1]);
+			stageInput = pipeFds[0];
+		}
+		// Move past the NULL entry ending this stage
+		while (*stageArgs != NULL)
+			stageArgs++;
+		stageArgs++;
 	}
-	*numberOfTerminatedPids = 0;
+	closeFile(command->redirectOutput, outputFileDescriptor);
+	closeFile(command->redirectInput, inputFileDescriptor);
+	return numberOfStages;
 }
 
 /**
 * Function: processMultiThreadedCommand
 * -------------------------------------------
-* Executes a command as a child process and returns the pid created
+* Executes a command, or every stage of a pipeline at once, as child processes connected by pipes and
+* returns the pid of the last stage (-1 if it couldn't be started). The status recorded is the last stage's,
+* or with 'set -o pipefail' the last non-zero status of any stage. Every stage is reaped with wait4 so a
+* timed command can report the resources all of its stages used
 *
-* inputArgs - contains the arguments given to CLI component
-* terminationStatus - the last known child termination status
-* signalOrTerminated - 0 = normal exit, 1 = signal terminated
-* runInBackground - 0 = run in foreground, 1 = run in background
+* command - the parsed command; its pipeline stages are separated by NULL entries
+* status - assigned the termination status of the pipeline
+* timed - 1 = the command was prefixed with 'time'; report its resource usage once it is done
 */
-pid_t processMultiThreadedCommand(
-	char **inputArgs, int *terminationStatus, int *signalOrTerminated, int *runInBackground,
-	int redirectInput, int redirectOutput, char *inputRedirect, char *outputRedirect)
+pid_t processMultiThreadedCommand(struct parsedCommand *command, struct shellStatus *status, int timed)
 {
+	int stage;
 	int childStatus;
-	int backgroundChildStatus;
-	pid_t spawnPid = fork();
-	int outputFileDescriptor;
-	int inputFileDescriptor;
-	struct sigaction SIGINT_action = {0};
-	SIGINT_action.sa_handler = handle_SIGINT;
-	sigfillset(&SIGINT_action.sa_mask);
-	SIGINT_action.sa_flags = 0;
-
-	switch(spawnPid)
-	{
-	    case -1:
-	    	// Error creating child process
-	    	perror("fork()\n");
-	    	break;
-	    case 0:
-	    	if (*runInBackground != 1)
-	    		sigaction(SIGINT, &SIGINT_action, NULL);
-	    	// Try to redirect output first
-	    	outputFileDescriptor = redirectStdout(redirectOutput, outputRedirect);
-	    	if (outputFileDescriptor < 0)
-	    	{
-	    		printf("cannot open %s for output\n", outputRedirect);
-	    		exit(1);
-	    	}
-	    	closeFile(redirectOutput, outputFileDescriptor);
-	    	// then input
-	    	inputFileDescriptor = redirectStdin(redirectInput, inputRedirect);
-	    	if (inputFileDescriptor < 0)
-	    	{
-	    		printf("cannot open %s for input\n", inputRedirect);
-	    		exit(1);
-	    	}
-	    	closeFile(redirectInput, inputFileDescriptor);
-	    	// Child process
-	    	executeCommand(inputArgs);
-	    	exit(1);
-	    	break;
-	    default:
-	   		if (*runInBackground == 1)
-	   		{
-	   			// Parent process launched child in background
-	   			waitpid(spawnPid, &backgroundChildStatus, WNOHANG);
-	   			printf("background pid is %d\n", spawnPid);
-	   		}
-	   		else
-	   		{
-	   			// Parent process waits for child to complete
-	   			spawnPid = waitpid(spawnPid, &childStatus, 0);
-	   			// Keep track of the child's exit or signal termination status
-	    		assignChildStatus(&childStatus, terminationStatus, signalOrTerminated);
-	    		if (*signalOrTerminated == 1)
-	    			executeStatusCommand(terminationStatus, signalOrTerminated);
-	    	}
-	    	break;
-	} 
+	int stageStatus;
+	int stageSignaled;
+	int pipelineFailed = 0;
+	int numberOfStages;
+	int runInBackground = command->runInBackground;
+	char *commandLine;
+	int *terminationStatus = &status->terminationStatus;
+	int *signalOrTerminated = &status->signalOrTerminated;
+	struct job *job = NULL;
+	struct timespec startTime;
+	struct rusage usage;
+	struct rusage stageUsage;
+	struct commandTrace trace;
+	pid_t *stagePids = malloc(sizeof(pid_t) * command->numberOfStages);
+	int *stageStatuses = NULL;
+	pid_t spawnPid;
+
+	memset(&usage, 0, sizeof(usage));
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+	beginCommandTrace(&trace);
+	numberOfStages = launchPipeline(command, -1, -1, stagePids, status);
+	// posix_spawn returns once the child has exec'd
+	if (traceEnabled())
+		trace.execDone = monotonicNanoseconds();
+	if (numberOfStages < 0)
+	{
+		free(stagePids);
+		*signalOrTerminated = 0;
+		*terminationStatus = 1;
+		return -1;
+	}
+
+	spawnPid = numberOfStages > 0 ? stagePids[numberOfStages - 1] : -1;
+	*signalOrTerminated = 0;
+	*terminationStatus = 1;
+
+	if (runInBackground == 1)
+	{
+		// A job is known by its last stage, so without one nothing is registered; the reason was printed
+		// when the stage failed to start, and any earlier stages are reaped like other unknown children
+		if (spawnPid <= 0 || numberOfStages < command->numberOfStages)
+		{
+			fprintf(stderr, "background job not started\n");
+			free(stagePids);
+			return -1;
+		}
+		// The whole pipeline is one job, reported through its last stage once every stage is gone
+		commandLine = buildCommandLine(command);
+		job = addJob(stagePids, numberOfStages, commandLine, JOB_RUNNING);
+		// An earlier stage that couldn't start counts like a child that failed to exec
+		job->terminationStatus = 1;
+		job->timed = timed;
+		job->trace = trace;
+		free(commandLine);
+		*terminationStatus = 0;
+		// Parent process launched child in background
+		printf("background pid is %d\n", spawnPid);
+	}
+	else
+	{
+		// A stage that couldn't be started counts like a child that failed to exec
+		stageStatuses = malloc(sizeof(int) * numberOfStages);
+		for (stage = 0; stage < numberOfStages; stage++)
+			stageStatuses[stage] = W_EXITCODE(1, 0);
+		// Parent process waits for every stage to complete, in whatever order they exit
+		while ((stage = waitForStage(stagePids, numberOfStages, &childStatus, &stageUsage)) >= 0)
+		{
+			// A stopped (CTRL + Z) foreground command moves to the job table with its remaining stages
+			if (WIFSTOPPED(childStatus))
+			{
+				commandLine = buildCommandLine(command);
+				job = addJob(stagePids, numberOfStages, commandLine, JOB_STOPPED);
+				// The job is still reported through its last stage, which may be gone already
+				job->lastPid = spawnPid;
+				assignChildStatus(&stageStatuses[numberOfStages - 1], &job->terminationStatus,
+					&job->signalOrTerminated);
+				// The job keeps timing from when the command was started
+				job->timed = timed;
+				job->usage = usage;
+				job->startTime = startTime;
+				job->trace = trace;
+				printf("\n[%d] Stopped\t%s\n", job->jobNumber, job->commandLine);
+				free(commandLine);
+				break;
+			}
+			stageStatuses[stage] = childStatus;
+			addResourceUsage(&usage, &stageUsage);
+			stagePids[stage] = 0;
+		}
+		// Keep track of each stage's exit or signal termination status, in stage order
+		for (stage = 0; job == NULL && stage < numberOfStages; stage++)
+		{
+			assignChildStatus(&stageStatuses[stage], &stageStatus, &stageSignaled);
+			// With pipefail a later successful stage doesn't hide an earlier failure
+			if (pipeFail && (stageStatus != 0 || stageSignaled))
+			{
+				*terminationStatus = stageStatus;
+				*signalOrTerminated = stageSignaled;
+				pipelineFailed = 1;
+			}
+			else if (stage == numberOfStages - 1 && !pipelineFailed)
+			{
+				*terminationStatus = stageStatus;
+				*signalOrTerminated = stageSignaled;
+			}
+		}
+		if (*signalOrTerminated == 1)
+			printTerminationStatus(STDOUT_FILENO, *terminationStatus, *signalOrTerminated);
+		if (timed && job == NULL)
+			printResourceUsage(STDERR_FILENO, &startTime, &usage);
+		if (traceEnabled() && job == NULL)
+		{
+			commandLine = buildCommandLine(command);
+			traceCommand(commandLine, spawnPid, &trace, 0, *terminationStatus, *signalOrTerminated, &usage);
+			free(commandLine);
+		}
+	}
+	free(stageStatuses);
+	free(stagePids);
 	return spawnPid;
 }
 
 /**
-* Function: processCommand
+* Function: processSingleThreadedCommand
 * -------------------------------------------
-* Executes a command from an array of arguments given to CLI
+* Executes a builtin inside the shell process, with its standard in and out redirected as the command asks
 *
-* inputArgs - contains the arguments given to CLI component
-* exitIndicator - used to indicate whether an exit command has been found and the shell should exit
-* terminationStatus - the last known child termination status
-* signalOrTerminated - 0 = normal exit, 1 = signal terminated
-* runInBackground - 0 = run in foreground, 1 = run in background
-* redirectInput - 0 = don't redirect input, 1 = redirect input
-* redirectOutput - 0 = don't redirect output, 1 = redirect output
-* inputRedirect - name of file to redirect input via stdin
-* outputRedirect - name of file to redirect output via stdout
+* builtin - the registry entry of the command
+* command - the parsed command
+* status - the shell's status; assigned the builtin's exit value when it stands in for an external utility
+* timed - 1 = the command was prefixed with 'time'; report the resources the shell used running it
+*/
+void processSingleThreadedCommand(
+	const struct builtinCommand *builtin, struct parsedCommand *command, struct shellStatus *status, int timed)
+{
+	int result;
+	struct timespec startTime;
+	struct rusage before;
+	struct rusage usage;
+	struct commandTrace trace;
+	char *commandLine;
+	int outputFileDescriptor = openOutputRedirect(command->redirectOutput, command->outputRedirect);
+	int inputFileDescriptor;
+
+	if (outputFileDescriptor == -1)
+	{
+		printf("cannot open %s for output\n", command->outputRedirect);
+		status->signalOrTerminated = 0;
+		status->terminationStatus = 1;
+		return;
+	}
+	inputFileDescriptor = openCommandInput(command);
+	if (inputFileDescriptor == -1)
+	{
+		closeFile(command->redirectOutput, outputFileDescriptor);
+		status->signalOrTerminated = 0;
+		status->terminationStatus = 1;
+		return;
+	}
+
+	// Builtins write to the descriptor directly, so anything still buffered has to go out first
+	fflush(stdout);
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+	beginCommandTrace(&trace);
+	if (timed || traceEnabled())
+		getrusage(RUSAGE_SELF, &before);
+	result = builtin->handler(
+		command->args, command->redirectInput ? inputFileDescriptor : STDIN_FILENO,
+		command->redirectOutput ? outputFileDescriptor : STDOUT_FILENO, status);
+	fflush(stdout);
+	if (timed || traceEnabled())
+	{
+		// A builtin runs in the shell itself, so its cost is how much the shell's own usage grew
+		getrusage(RUSAGE_SELF, &usage);
+		subtractResourceUsage(&usage, &before);
+		if (timed)
+			printResourceUsage(STDERR_FILENO, &startTime, &usage);
+		commandLine = buildCommandLine(command);
+		traceCommand(commandLine, getpid(), &trace, 0, result, 0, &usage);
+		free(commandLine);
+	}
+
+	closeFile(command->redirectOutput, outputFileDescriptor);
+	closeFile(command->redirectInput, inputFileDescriptor);
+	if (builtin->flags & BUILTIN_SETS_STATUS)
+	{
+		status->terminationStatus = result;
+		status->signalOrTerminated = 0;
+	}
+}
+
+/**
+* Function: builtinNeedsChild
+* -------------------------------------------
+* Returns 1 if a builtin given on its own should still run in a child process: a long-running one started
+* in the background, or one reading a terminal, which only a child can be interrupted from
+*
+* builtin - the builtin the command runs
+* command - the parsed command
+*/
+static int builtinNeedsChild(const struct builtinCommand *builtin, struct parsedCommand *command)
+{
+	if ((builtin->flags & BUILTIN_FORKS_IN_BACKGROUND) && command->runInBackground)
+		return 1;
+	return (builtin->flags & BUILTIN_FORKS_ON_TERMINAL) && !command->redirectInput && isatty(STDIN_FILENO);
+}
+
+/**
+* Function: executeCommand
+* -------------------------------------------
+* Executes a parsed command whose process substitutions have been started
+*
+* command - the parsed command: arguments, pipeline stages, redirections and background indicator
+* status - the exit indicator (set by 'exit') and the last known termination status
 */
-pid_t processCommand(
-	char **inputArgs, int *exitIndicator, int *terminationStatus, int *signalOrTerminated, int *runInBackground,
-	int redirectInput, int redirectOutput, char *inputRedirect, char *outputRedirect)
+static pid_t executeCommand(struct parsedCommand *command, struct shellStatus *status)
 {
-	// Process build-in commands that should not be run in child process
-	if 
-	(
-		strncmp(inputArgs[0], "cd", 2) == 0 || 
-		strncmp(inputArgs[0], "exit", 4) == 0 ||
-		strncmp(inputArgs[0], "status", 5) == 0 ||
-		strncmp(inputArgs[0], "#", 1) == 0
-	) {
-		processSingleThreadedCommand(inputArgs, exitIndicator, terminationStatus, signalOrTerminated);
-		*runInBackground = 0;
+	int timed = 0;
+	int i;
+	const struct builtinCommand *builtin;
+	struct timespec startTime;
+	struct rusage usage;
+
+	// 'time' is a keyword in front of the command or pipeline rather than a command of its own
+	if (strcmp(command->args[0], "time") == 0)
+	{
+		timed = 1;
+		command->args++;
+		command->numberOfArgs--;
+		if (command->args[0] == NULL)
+		{
+			memset(&usage, 0, sizeof(usage));
+			clock_gettime(CLOCK_MONOTONIC, &startTime);
+			printResourceUsage(STDERR_FILENO, &startTime, &usage);
+			return getpid();
+		}
+	}
+	// A command made only of NAME=value words sets shell variables
+	if (command->numberOfStages == 1 && !timed && isAssignment(command->args[0]))
+	{
+		for (i = 0; command->args[i] != NULL && isAssignment(command->args[i]); i++)
+			;
+		if (command->args[i] == NULL)
+		{
+			for (i = 0; command->args[i] != NULL; i++)
+				assignVariable(command->args[i]);
+			// x=$(COMMAND) leaves the status of the substituted command
+			if (!command->substituted)
+			{
+				status->terminationStatus = 0;
+				status->signalOrTerminated = 0;
+			}
+			command->runInBackground = 0;
+			return getpid();
+		}
+	}
+	builtin = findCommandHandler(command->args[0]);
+
+	// A builtin or function on its own runs in the shell process; exact names only, so 'cdx' is not 'cd'
+	if (command->numberOfStages == 1 && builtin != NULL && !builtinNeedsChild(builtin, command))
+	{
+		processSingleThreadedCommand(builtin, command, status, timed);
+		command->runInBackground = 0;
 		return getpid();
 	}
 	// Process any other command in child process
 	else
-		return processMultiThreadedCommand(
-			inputArgs, terminationStatus, signalOrTerminated, runInBackground,
-			redirectInput, redirectOutput, inputRedirect, outputRedirect);
+		return processMultiThreadedCommand(command, status, timed);
+}
+
+/**
+* Function: processCommand
+* -------------------------------------------
+* Executes a parsed command given to CLI. Its <(COMMAND) and >(COMMAND) words are started first and
+* named /dev/fd/N; a foreground command that finishes waits for them too, so their output comes before
+* the next prompt
+*
+* command - the parsed command: arguments, pipeline stages, redirections and background indicator
+* status - the exit indicator (set by 'exit') and the last known termination status
+*/
+pid_t processCommand(struct parsedCommand *command, struct shellStatus *status)
+{
+	struct substitutionSet substitutions;
+	int runInBackground = command->runInBackground;
+	pid_t pid;
+
+	if (startProcessSubstitutions(command, status, &substitutions) < 0)
+	{
+		finishProcessSubstitutions(&substitutions, 1);
+		status->terminationStatus = 1;
+		status->signalOrTerminated = 0;
+		return -1;
+	}
+	pid = executeCommand(command, status);
+	// A command stopped with ^Z keeps its job; its substitutions go on with it
+	finishProcessSubstitutions(&substitutions, !runInBackground && (pid <= 0 || findJobByPid(pid) == NULL));
+	return pid;
 }
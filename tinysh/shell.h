@@ -9,44 +9,91 @@
 #ifndef SHELL_H_
 #define SHELL_H_
 
+#include "cli.h"
+
 #include <sys/types.h>
+#include <sys/resource.h>
+
+// What the shell remembers between commands: whether to exit and the last command's status
+struct shellStatus
+{
+	int exitIndicator;
+	int terminationStatus;
+	int signalOrTerminated;
+	int returnIndicator;		// set by 'return' until the function it leaves has ended
+};
 
-int checkBackgroundPidStatus(pid_t pid);
 /**
 * Function: monitorBackgroundPids
 * -------------------------------------------
-* Track and print the status of processes running in the background; remove completed background tasks from
-* collection of background processes
+* Reaps every child that changed state since the last prompt with a single waitpid(-1) loop, prints the
+* status of background jobs that completed or stopped and removes completed jobs from the job table;
+* returns the number of notices printed
+*/
+int monitorBackgroundPids();
+/**
+* Function: recordChildStateChange
+* -------------------------------------------
+* Applies a state change reaped by wait4(-1) to the job the child belongs to, printing the status of
+* background jobs that completed or stopped (with their resource usage when started with 'time') and
+* removing completed jobs from the job table. Children that belong to no job are ignored. Returns 1 if a
+* notice was printed and 0 otherwise
 *
-* pidArray - an array of pid ids running in the background
-* terminatedPids - an array of background pids that have completed
-* numberOfPids - the length of the pid array
-* maxNumberOfPids - the current size allocated to the pid array
-* numberOfTerminatedPids - the length of the terminatedPids array
-* maxNumberOfTerminatedPids - the current size allocated to the terminatedPids array
+* pid - the child reported by wait4
+* childStatus - the status reported by wait4
+* usage - the resources the child used, as reported by wait4
 */
-void monitorBackgroundPids(
-	pid_t *pidArray, pid_t *terminatedPids, 
-	int *numberOfPids, int *maxNumberOfPids,
-	int *numberOfTerminatedPids, int *maxNumberOfTerminatedPids);
+int recordChildStateChange(pid_t pid, int childStatus, struct rusage *usage);
 /**
-* Function: processCommand
+* Function: launchPipeline
 * -------------------------------------------
-* Executes a command from an array of arguments given to CLI
+* Starts every stage of a command at once, connected by pipes, and returns the number of stages started
+* (their pids, -1 for a stage that couldn't be spawned, are assigned to stagePids) or -1 if a redirection
+* target couldn't be opened. The command's own < and > take precedence over the given descriptors
 *
-* inputArgs - contains the arguments given to CLI component
-* exitIndicator - used to indicate whether an exit command has been found and the shell should exit
-* terminationStatus - the last known child termination status
+* command - the parsed command; its pipeline stages are separated by NULL entries
+* inputFd - standard in for the first stage or -1 to inherit the shell's
+* outputFd - standard out for the last stage or -1 to inherit the shell's
+* stagePids - assigned the pid of every stage; room for command->numberOfStages pids
+* status - the shell's status, handed to builtins run as stages
+*/
+int launchPipeline(
+	struct parsedCommand *command, int inputFd, int outputFd, pid_t *stagePids, struct shellStatus *status);
+/**
+* Function: builtinNameAt
+* -------------------------------------------
+* Returns the name of a builtin by its position in the registry, or NULL past the last one
+*
+* index - the position in the registry
+*/
+const char * builtinNameAt(int index);
+/**
+* Function: capturedInShell
+* -------------------------------------------
+* Returns 1 if a command substitution starting with a command can run inside the shell: the command is a
+* builtin that only writes output, so the shell is left as a subshell would leave it; 0 if it needs a child
+*
+* commandName - the name of the command
+*/
+int capturedInShell(const char *commandName);
+/**
+* Function: assignChildStatus
+* -------------------------------------------
+* Records a child process' exit or signal termination status
+*
+* childStatus - the child status recorded by parent process via waitpaid
+* terminationStatus - a pointer to the last known termination status that will be reassigned
 * signalOrTerminated - 0 = normal exit, 1 = signal terminated
-* runInBackground - 0 = run in foreground, 1 = run in background
-* redirectInput - 0 = don't redirect input, 1 = redirect input
-* redirectOutput - 0 = don't redirect output, 1 = redirect output
-* inputRedirect - name of file to redirect input via stdin
-* outputRedirect - name of file to redirect output via stdout
 */
-pid_t processCommand(
-	char **inputArgs, int *exitIndicator, int *terminationStatus, int *signalOrTerminated, int *runInBackground,
-	int redirectInput, int redirectOutput, char *inputRedirect, char *outputRedirect
-	);
+void assignChildStatus(int *childStatus, int *terminationStatus, int *signalOrTerminated);
+/**
+* Function: processCommand
+* -------------------------------------------
+* Executes a parsed command given to CLI
+*
+* command - the parsed command: arguments, pipeline stages, redirections and background indicator
+* status - the exit indicator (set by 'exit') and the last known termination status
+*/
+pid_t processCommand(struct parsedCommand *command, struct shellStatus *status);
 
 #endif /* SHELL_H_ */
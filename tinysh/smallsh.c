@@ -9,6 +9,17 @@
 #include "cli.h"
 #include "shell.h"
 #include "util.h"
+#include "reader.h"
+#include "parsecache.h"
+#include "history.h"
+#include "editor.h"
+#include "complete.h"
+#include "trace.h"
+#include "variables.h"
+#include "control.h"
+#include "events.h"
+#include "serve.h"
+#include "startup.h"
 
 #include <limits.h>
 #include <string.h>
@@ -17,103 +28,393 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <time.h>
 
-#define STARTING_NUMBER_OF_BG_PIDS 4
+extern char **environ;
 
 int FOREGROUND_ONLY = 0;
 
 /**
-* Function: handle_SIGTSTP
+* Function: readInputLine
 * -------------------------------------------
-* Custom implementation of SIGTSTP signal to enter or exit foreground process only mode
+* Displays a prompt when interactive, reads the next line and replaces its history references, recording
+* the line as it will run; returns NULL once the input ends
 *
-* signo - signal number
-* foregroundOnly - pointer to binary indicator (0 = not in foreground only mode; 1 = in foreground only mode)
+* reader - the source of input lines
+* interactive - 1 = display the prompt
+* editing - 1 = read through the line editor, which draws the prompt itself
+* prompt - the prompt to display
+* length - assigned the length of the line
+* expansion - assigned the result of expandHistory: -1 when a reference couldn't be replaced
+* arena - holds the line once references are replaced
 */
-void handle_SIGTSTP(int signo){
-	if (FOREGROUND_ONLY == 0)
+char * readInputLine(struct lineReader *reader, int interactive, int editing, const char *prompt, size_t *length,
+	int *expansion, struct arena *arena)
+{
+	char *inputBuffer;
+
+	if (editing)
 	{
-		FOREGROUND_ONLY = 1;
-		printf("Entering foreground-only mode (& is now ignored)\n");
-	} else if (FOREGROUND_ONLY == 1)
+		fflush(stdout);
+		inputBuffer = editLine(prompt, length);
+	}
+	else
 	{
-		FOREGROUND_ONLY = 0;
-		printf("Exiting foreground-only mode\n");
+		if (interactive)
+		{
+			displayPrompt(prompt);
+			fflush(stdout);
+		}
+		inputBuffer = readLine(reader, length);
+	}
+	if (inputBuffer == NULL)
+		return NULL;
+	*expansion = expandHistory(inputBuffer, *length, &inputBuffer, length, arena);
+	if (*expansion > 0)
+		printf("%s\n", inputBuffer);
+	if (*expansion >= 0)
+		addHistory(inputBuffer, *length);
+	return inputBuffer;
+}
+
+/**
+* Function: endsHereDocument
+* -------------------------------------------
+* Returns 1 if a line, without its leading tabs, is the WORD that ends a here-document's body, and 0 if
+* the block can't be whole yet
+*
+* line - the line read
+* awaitedWord - the WORD, or NULL when no body is unfinished
+*/
+static int endsHereDocument(const char *line, const char *awaitedWord)
+{
+	if (awaitedWord == NULL)
+		return 1;
+	while (*line == '\t')
+		line++;
+	return strcmp(line, awaitedWord) == 0;
+}
+
+/**
+* Function: runBlockLines
+* -------------------------------------------
+* Gathers the lines of an if, loop or case block, or of a here-document's body, starting with one already
+* read, until the block is whole, then compiles and runs it; returns 0, or -1 after a syntax error
+*
+* reader - the source of further lines
+* interactive - 1 = prompt for further lines
+* editing - 1 = read further lines through the line editor
+* firstLine - the line that starts the block
+* firstLength - the length of that line
+* status - the exit indicator and the last known termination status
+* arena - provides the lines read and each command's arguments
+*/
+int runBlockLines(struct lineReader *reader, int interactive, int editing, const char *firstLine, size_t firstLength,
+	struct shellStatus *status, struct arena *arena)
+{
+	char *text = malloc(firstLength + 1);
+	char *line;
+	size_t textLength = firstLength;
+	size_t length;
+	size_t capacity = firstLength + 1;
+	int expansion = 0;
+	char *awaitedWord = NULL;
+	struct compiledBlock block;
+
+	memcpy(text, firstLine, firstLength + 1);
+	// Body lines are only appended until the one holding the awaited WORD, so a long body isn't rechecked
+	// after each of its lines
+	while (checkBlock(text, &awaitedWord) == BLOCK_INCOMPLETE)
+	{
+		do
+		{
+			line = readInputLine(reader, interactive, editing, CONTINUATION_PROMPT, &length, &expansion, arena);
+			if (line == NULL || expansion < 0)
+				break;
+			if (textLength + length + 2 > capacity)
+			{
+				capacity = (textLength + length + 2) * 2;
+				text = realloc(text, capacity);
+			}
+			text[textLength++] = '\n';
+			memcpy(text + textLength, line, length + 1);
+			textLength += length;
+		}
+		while (!endsHereDocument(line, awaitedWord));
+		free(awaitedWord);
+		awaitedWord = NULL;
+		if (line == NULL || expansion < 0)
+			break;
+	}
+
+	if (expansion >= 0 && compileBlock(text, &block) == 0)
+	{
+		free(text);
+		runBlock(&block, status, arena);
+		freeBlock(&block);
+		return 0;
+	}
+	free(text);
+	return -1;
+}
+
+/**
+* Function: runCommandLoop
+* -------------------------------------------
+* Reads, parses and runs commands one line at a time until the input ends, 'exit' is run or, when asked,
+* a command fails. The prompt is only shown when the shell is interactive, and lines are read through the
+* line editor when it is interactive on a terminal that supports it. Lines starting an if, loop or case
+* block, or holding several commands separated by ;, are gathered and compiled into one block. In a served
+* session each line holds one of the server's running slots and its status is sent to the client
+*
+* reader - the source of input lines
+* interactive - 1 = display the prompt before each line; 0 = script, -c or piped input
+* stopOnError - 1 = stop at the first syntax error or command with a non-zero status (smallsh -e)
+* status - the exit indicator (set once 'exit' has been run) and the last known termination status
+*/
+void runCommandLoop(struct lineReader *reader, int interactive, int stopOnError, struct shellStatus *status)
+{
+	int parseStatus;
+	int expansion;
+	int editing = interactive && editorAvailable();
+	size_t length;
+
+	char *inputBuffer;
+	struct parsedCommand command;
+	struct arena arena;
+
+	initializeArena(&arena);
+
+	// Keep accepting user commands unless told otherwise
+	while (!status->exitIndicator)
+	{
+		// First display the prompt and second accept user input, stopping once there is no more; third
+		// replace history references (!!, !n, !prefix) and record the line as it will run
+		inputBuffer = readInputLine(reader, interactive, editing, PROMPT, &length, &expansion, &arena);
+		if (inputBuffer == NULL)
+			break;
+		// A served session waits for a running slot first
+		beginServedCommand();
+		markParseStart();
+		// A block is compiled once all of its lines are in and runs each of its commands itself
+		if (expansion >= 0 && startsBlock(inputBuffer))
+			parseStatus = runBlockLines(reader, interactive, editing, inputBuffer, length, status, &arena);
+		else
+		{
+			// Fourth parse the arguments given by user, reusing the parse of a line seen before
+			parseStatus = expansion < 0 ? -1 : parseCommandCached(inputBuffer, length, &command, &arena);
+			// Only if command was given attempt to process
+			if (parseStatus == 0 && command.args[0] != NULL)
+			{
+				// Overwrite run in background indicator if currently in foreground only
+				command.runInBackground = resolveBackgroundRun(FOREGROUND_ONLY, command.runInBackground);
+				// Fifth run the command from user
+				processCommand(&command, status);
+			}
+		}
+		// A syntax error fails the line like a command would, so scripts don't end as if it had run
+		if (parseStatus != 0)
+		{
+			status->terminationStatus = 2;
+			status->signalOrTerminated = 0;
+		}
+		// Sixth release everything parsed for this command in one step
+		resetArena(&arena);
+		// Last reap the background processes that finished meanwhile and handle ^Z
+		processPendingEvents();
+		endServedCommand(status, parseStatus);
+
+		if (stopOnError && (status->terminationStatus != 0 || status->signalOrTerminated != 0))
+			break;
 	}
+	freeArena(&arena);
+}
+
+/**
+* Function: printUsage
+* -------------------------------------------
+* Prints the command line options understood by the shell
+*/
+void printUsage()
+{
+	fprintf(stderr, "usage: smallsh [-e] [--stats] [--trace file] [--norc] [--startup-time] "
+		"[-c command | script [argument...]]\n");
+	fprintf(stderr, "       smallsh [--norc] --serve socket [-j running]\n");
+	fprintf(stderr, "       smallsh --compile-rc\n");
 }
 
 int main(int argc, char *argv[])
 {
-	int runInBackground = 0;
-	int exit = 0;
-	int terminationStatus = 0;
-	int signalOrTerminated = 0;
-	int numberOfPids = 0;
-	int numberOfTerminatedPids = 0;
-	int redirectInput = 0;
-	int redirectOutput = 0;
-	int maxNumberOfTerminatedPids = STARTING_NUMBER_OF_BG_PIDS;
-	int maxNumberOfPids = STARTING_NUMBER_OF_BG_PIDS;
-
-	char inputBuffer[MAX_INPUT_BUFFER];
-	char *inputArgs[MAX_ARGS];
+	struct shellStatus status = { 0, 0, 0, 0 };
+	int interactive = 0;
+	int stopOnError = 0;
+	int reportStatistics = 0;
+	int scriptFileDescriptor = -1;
+	int maximumRunning = sysconf(_SC_NPROCESSORS_ONLN);
+	int loadStartupFile = 1;
+	int measureStartup = 0;
+	int startupResult = STARTUP_NONE;
+	unsigned long long execTime = 0;
+	unsigned long long startupTime = 0;
+	int i;
+
+	char *commandString = NULL;
+	char *scriptName = NULL;
+	char *tracePath = NULL;
+	char *socketPath = NULL;
+	char *traceFormat;
+	int traceStatus;
 	char workingDirectory[PATH_MAXIMUM];
-	char inputRedirect[MAX_REDIRECT_FILENAME_SIZE];
-	char outputRedirect[MAX_REDIRECT_FILENAME_SIZE];
-	pid_t *pidArray = NULL;
-	pid_t *terminatedPids = NULL;
+	struct lineReader reader;
+	struct positionalParameters parameters;
+	struct timespec startTime;
+	struct timespec endTime;
+
+	// Options come first; the first other argument names a script to run
+	for (i = 1; i < argc && scriptName == NULL; i++)
+	{
+		if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+			commandString = argv[++i];
+		else if (strcmp(argv[i], "-e") == 0)
+			stopOnError = 1;
+		else if (strcmp(argv[i], "--stats") == 0)
+			reportStatistics = 1;
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			tracePath = argv[++i];
+		else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc)
+			socketPath = argv[++i];
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+			maximumRunning = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--norc") == 0)
+			loadStartupFile = 0;
+		else if (strcmp(argv[i], "--startup-time") == 0)
+			measureStartup = 1;
+		else if (strcmp(argv[i], "--compile-rc") == 0)
+		{
+			initializeVariables(environ, &status);
+			return compileStartupFile() < 0 ? 1 : 0;
+		}
+		else if (argv[i][0] == '-')
+		{
+			printUsage();
+			return 2;
+		}
+		else
+			scriptName = argv[i];
+	}
+
+	// Measuring startup executes the shell again first, so the clock runs from a fresh exec
+	if (measureStartup)
+		execTime = execStartTime(argv);
+	// Variables start out as the environment the shell was given, all of them exported
+	initializeVariables(environ, &status);
+	// A script's own arguments are its positional parameters, $0 being the script
+	if (scriptName != NULL)
+	{
+		parameters.name = scriptName;
+		parameters.args = argv + i;
+		parameters.count = argc - i;
+		swapPositionalParameters(&parameters);
+	}
+	configureBlocks(&FOREGROUND_ONLY, stopOnError);
 
 	// Custom signal handling
-	struct sigaction ignore_action = {0}, SIGTSTP_action = {0};
-	// Ignore sigint at the parent process level
+	struct sigaction ignore_action = {0};
+	// Ignore sigint at the parent process level (background children inherit that); SIGTSTP only toggles
+	// foreground-only mode, which the event loop does once it reads the signal
 	ignore_action.sa_handler = SIG_IGN;
 	sigaction(SIGINT, &ignore_action, NULL);
-	// Handle foreground only mode signals
-	SIGTSTP_action.sa_handler = handle_SIGTSTP;
-	sigfillset(&SIGTSTP_action.sa_mask);
-	SIGTSTP_action.sa_flags = 0;
-	sigaction(SIGTSTP, &SIGTSTP_action, NULL);
+	sigaction(SIGTSTP, &ignore_action, NULL);
+	// Blocked signals are queued even when ignored, so SIGCHLD, SIGINT and SIGTSTP all reach the signalfd
+	if (initializeEvents(&FOREGROUND_ONLY) < 0)
+		perror("events");
 
-	memset(inputArgs, 0, sizeof(inputArgs));
-
-	// Initialize arrays to keep track of individual pids and their statuses
-	pidArray = initializeDynamicPidArray(maxNumberOfPids);
-	terminatedPids = initializeDynamicPidArray(maxNumberOfTerminatedPids);
+	// Trace every command when asked through --trace or TINYSH_TRACE (TINYSH_TRACE_FORMAT=chrome for
+	// about:tracing instead of JSON lines)
+	if (tracePath == NULL)
+		tracePath = getenv("TINYSH_TRACE");
+	if (tracePath != NULL && *tracePath != 0)
+	{
+		traceFormat = getenv("TINYSH_TRACE_FORMAT");
+		if (traceFormat != NULL && strcmp(traceFormat, "chrome") == 0)
+			traceStatus = openTrace(tracePath, TRACE_CHROME);
+		else
+			traceStatus = openTrace(tracePath, TRACE_JSON_LINES);
+		if (traceStatus < 0)
+		{
+			perror(tracePath);
+			return 2;
+		}
+	}
 
 	// Keep track of the working directory the shell was launched from
 	assignCurrentWorkingDirectory(workingDirectory);
 
-	// Keep accepting user commands unless told otherwise
-	while (!exit)
+	// The startup file runs for interactive shells, -c and the server (whose sessions inherit what it
+	// defines), but not for scripts or piped input
+	if (loadStartupFile && (socketPath != NULL || commandString != NULL || (scriptName == NULL && isatty(0))))
+	{
+		startupTime = monotonicNanoseconds();
+		startupResult = runStartupFile(&status);
+		startupTime = monotonicNanoseconds() - startupTime;
+	}
+
+	// Pick the input: a client's socket, a -c string, a script file, or standard in (prompting only when
+	// it's a terminal)
+	if (socketPath != NULL)
+	{
+		// The server only returns in a client's session, with the socket to read the client's lines from
+		scriptFileDescriptor = serveClients(socketPath, maximumRunning);
+		if (scriptFileDescriptor < 0)
+		{
+			closeTrace();
+			return scriptFileDescriptor == SERVE_STOPPED ? 0 : 2;
+		}
+		initializeFileReader(&reader, scriptFileDescriptor);
+	}
+	else if (commandString != NULL)
+		initializeStringReader(&reader, commandString);
+	else if (scriptName != NULL)
 	{
-		// First display the prompt
-		displayPrompt();
-		// Third accept user input and parse the arguments given by user
-		parseArgs(
-			inputBuffer, inputArgs, &redirectInput, &redirectOutput, 
-			inputRedirect, outputRedirect, &runInBackground);
-		// Overwrite run in background indicator if currently in foreground only
-		runInBackground = resolveBackgroundRun(FOREGROUND_ONLY, runInBackground);
-		// Only if command was given attempt to process
-		if (inputArgs[0] != 0)
+		scriptFileDescriptor = open(scriptName, O_RDONLY | O_CLOEXEC);
+		if (scriptFileDescriptor < 0)
 		{
-			// Fourth run the command from user
-			pid_t tmpPid = processCommand(
-				inputArgs, &exit, &terminationStatus, &signalOrTerminated, &runInBackground,
-				redirectInput, redirectOutput, inputRedirect, outputRedirect);
-			// Fifth if a command was run in background then keep track of it
-			if (runInBackground == 1)
-				appendPidToArray(pidArray, tmpPid, &numberOfPids, &maxNumberOfPids);
-			// Sixth clear the collection of arguments parsed for next round and reset background indicator
-			memset(inputArgs, 0, sizeof(inputArgs));
-			runInBackground = 0;
-			redirectInput = 0;
-			redirectOutput = 0;
+			perror(scriptName);
+			return 127;
 		}
-		// Last monitor the ongoing background processes
-		monitorBackgroundPids(
-			pidArray, terminatedPids, &numberOfPids, &maxNumberOfPids,
-			&numberOfTerminatedPids, &maxNumberOfTerminatedPids);
+		initializeFileReader(&reader, scriptFileDescriptor);
+	}
+	else
+	{
+		initializeFileReader(&reader, 0);
+		interactive = isatty(0);
 	}
-	return 0;
+	// Interactive shells keep a history; scripts only with 'set -o history'
+	if (interactive && enableHistory() < 0)
+		perror("history");
+
+	if (measureStartup)
+		reportStartupTime(execTime, startupResult, startupTime);
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+	runCommandLoop(&reader, interactive, stopOnError, &status);
+	clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+	if (reportStatistics)
+	{
+		double seconds = (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+		fprintf(stderr, "%lu lines in %.3f s (%.0f lines/s)\n",
+			reader.numberOfLines, seconds, seconds > 0 ? reader.numberOfLines / seconds : 0.0);
+	}
+	closeTrace();
+	disableHistory();
+	freeExecutableIndex();
+	freeLineReader(&reader);
+	closeEvents();
+	closeFile(scriptFileDescriptor >= 0, scriptFileDescriptor);
+
+	// Scripts and 'exit' report the status of the last command run ('exit N' sets it)
+	if (interactive && !status.exitIndicator)
+		return 0;
+	return status.signalOrTerminated ? 128 + status.terminationStatus : status.terminationStatus;
 }
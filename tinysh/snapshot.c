@@ -0,0 +1,420 @@
+/***********************************************************************************************************
+ * Filename: snapshot.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements compiled-block snapshots. A block is written depth first into one buffer of
+ * fixed-size records and strings that refer to each other by offset, so the file needs no fixing up and
+ * can be mapped as is. Loading maps the file and rebuilds only the instruction arrays and argument arrays
+ * around it; every string stays in the mapping, so no text is copied, and only commands with expansions are
+ * tokenized again into their templates.
+ **********************************************************************************************************/
+
+#include "snapshot.h"
+#include "util.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define SNAPSHOT_ALIGNMENT 8
+
+struct snapshotWriter
+{
+	char *data;
+	size_t length;
+	size_t capacity;
+};
+
+// Every loaded command lives as long as the mapping its arguments point into, so they share one arena
+// instead of each function body starting an arena block of its own
+static struct arena commandArena;
+
+/**
+* Function: reserve
+* -------------------------------------------
+* Returns the offset of size zeroed bytes added to the snapshot, aligned for any record. Adding may move
+* the buffer, so records are only reached through their offsets
+*
+* writer - the snapshot being written
+* size - the number of bytes needed
+*/
+static uint32_t reserve(struct snapshotWriter *writer, size_t size)
+{
+	size_t offset = (writer->length + SNAPSHOT_ALIGNMENT - 1) & ~(size_t) (SNAPSHOT_ALIGNMENT - 1);
+
+	while (offset + size > writer->capacity)
+	{
+		writer->capacity *= 2;
+		writer->data = realloc(writer->data, writer->capacity);
+	}
+	memset(writer->data + writer->length, 0, offset + size - writer->length);
+	writer->length = offset + size;
+	return offset;
+}
+
+/**
+* Function: appendString
+* -------------------------------------------
+* Adds a string to the snapshot and returns its offset, or 0 for NULL
+*
+* writer - the snapshot being written
+* text - the string to add or NULL
+*/
+static uint32_t appendString(struct snapshotWriter *writer, const char *text)
+{
+	size_t length;
+	uint32_t offset;
+
+	if (text == NULL)
+		return 0;
+	length = strlen(text) + 1;
+	offset = reserve(writer, length);
+	memcpy(writer->data + offset, text, length);
+	return offset;
+}
+
+/**
+* Function: appendCommand
+* -------------------------------------------
+* Adds a pre-parsed command and its arguments to the snapshot and returns its offset
+*
+* writer - the snapshot being written
+* command - the command to add
+*/
+static uint32_t appendCommand(struct snapshotWriter *writer, const struct parsedCommand *command)
+{
+	struct snapshotCommand record;
+	uint32_t offset = reserve(writer, sizeof(record));
+	uint32_t argument;
+	int i;
+
+	record.numberOfArgs = command->numberOfArgs;
+	record.numberOfStages = command->numberOfStages;
+	record.redirectInput = command->redirectInput;
+	record.redirectOutput = command->redirectOutput;
+	record.inputRedirect = appendString(writer, command->redirectInput ? command->inputRedirect : NULL);
+	record.outputRedirect = appendString(writer, command->redirectOutput ? command->outputRedirect : NULL);
+	record.runInBackground = command->runInBackground;
+	record.hereDocument = appendString(writer, command->hereDocument);
+	record.args = reserve(writer, sizeof(uint32_t) * command->numberOfArgs);
+	for (i = 0; i < command->numberOfArgs; i++)
+	{
+		argument = appendString(writer, command->args[i]);
+		memcpy(writer->data + record.args + sizeof(uint32_t) * i, &argument, sizeof(argument));
+	}
+	memcpy(writer->data + offset, &record, sizeof(record));
+	return offset;
+}
+
+/**
+* Function: appendBlock
+* -------------------------------------------
+* Adds a compiled block, the bodies of the functions it defines and its pre-parsed commands to the
+* snapshot and returns its offset
+*
+* writer - the snapshot being written
+* block - the block to add
+*/
+static uint32_t appendBlock(struct snapshotWriter *writer, const struct compiledBlock *block)
+{
+	struct snapshotBlock record;
+	struct snapshotInstruction instruction;
+	const struct instruction *source;
+	uint32_t offset = reserve(writer, sizeof(record));
+	int i;
+
+	record.numberOfInstructions = block->numberOfInstructions;
+	record.numberOfSlots = block->numberOfSlots;
+	record.instructions = reserve(writer, sizeof(instruction) * block->numberOfInstructions);
+	for (i = 0; i < block->numberOfInstructions; i++)
+	{
+		source = &block->instructions[i];
+		instruction.opcode = source->opcode;
+		instruction.target = source->target;
+		instruction.slot = source->slot;
+		instruction.condition = source->condition;
+		instruction.text = appendString(writer, source->text);
+		instruction.pattern = appendString(writer, source->pattern);
+		instruction.command = source->command != NULL ? appendCommand(writer, source->command) : 0;
+		instruction.function = source->opcode == OP_DEFINE ? appendBlock(writer, source->function) : 0;
+		memcpy(writer->data + record.instructions + sizeof(instruction) * i, &instruction, sizeof(instruction));
+	}
+	memcpy(writer->data + offset, &record, sizeof(record));
+	return offset;
+}
+
+/**
+* Function: writeSnapshot
+* -------------------------------------------
+* Writes a compiled block to a file, replacing it in one step so a shell starting meanwhile never maps a
+* partial snapshot; returns 0 on success and -1 otherwise
+*
+* path - the snapshot file
+* block - the block to write
+* source - the status of the file the block was compiled from
+*/
+int writeSnapshot(const char *path, const struct compiledBlock *block, const struct stat *source)
+{
+	struct snapshotWriter writer;
+	struct snapshotHeader header;
+	char temporaryPath[PATH_MAXIMUM];
+	uint32_t offset;
+	int fd;
+	int result = -1;
+
+	if (snprintf(temporaryPath, sizeof(temporaryPath), "%s.%d", path, getpid()) >= sizeof(temporaryPath))
+		return -1;
+	writer.capacity = 4096;
+	writer.length = 0;
+	writer.data = malloc(writer.capacity);
+	offset = reserve(&writer, sizeof(header));
+	header.block = appendBlock(&writer, block);
+	// A terminator at the very end keeps every string inside the file, however it was damaged
+	reserve(&writer, 1);
+
+	memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = SNAPSHOT_VERSION;
+	header.size = writer.length;
+	header.sourceSize = source->st_size;
+	header.sourceModified = source->st_mtim.tv_sec * 1000000000LL + source->st_mtim.tv_nsec;
+	header.padding = 0;
+	memcpy(writer.data + offset, &header, sizeof(header));
+
+	fd = open(temporaryPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+	if (fd >= 0)
+	{
+		if (writer.length <= UINT32_MAX && writeAll(fd, writer.data, writer.length) == writer.length)
+			result = 0;
+		close(fd);
+		if (result == 0 && rename(temporaryPath, path) < 0)
+			result = -1;
+		if (result < 0)
+			unlink(temporaryPath);
+	}
+	free(writer.data);
+	return result;
+}
+
+/**
+* Function: fits
+* -------------------------------------------
+* Returns 1 if a record of the given size at an offset lies inside the snapshot and 0 otherwise
+*
+* offset - where the record starts
+* size - the size of the record
+* snapshotSize - the size of the snapshot
+*/
+static int fits(uint32_t offset, size_t size, size_t snapshotSize)
+{
+	return offset != 0 && offset % SNAPSHOT_ALIGNMENT == 0 && size <= snapshotSize &&
+		offset <= snapshotSize - size;
+}
+
+/**
+* Function: stringAt
+* -------------------------------------------
+* Returns the string at an offset in the mapped snapshot, or NULL for offset 0
+*
+* base - the start of the mapping
+* size - the size of the snapshot
+* offset - where the string starts
+* valid - set to 0 if the offset lies outside the snapshot
+*/
+static char * stringAt(char *base, size_t size, uint32_t offset, int *valid)
+{
+	if (offset == 0)
+		return NULL;
+	if (offset >= size)
+	{
+		*valid = 0;
+		return NULL;
+	}
+	return base + offset;
+}
+
+/**
+* Function: loadCommand
+* -------------------------------------------
+* Rebuilds a pre-parsed command whose arguments point into the mapped snapshot; returns NULL if its
+* records don't fit in the snapshot
+*
+* base - the start of the mapping
+* size - the size of the snapshot
+* offset - where the command's record starts
+* arena - provides the command and its argument array
+*/
+static struct parsedCommand * loadCommand(char *base, size_t size, uint32_t offset, struct arena *arena)
+{
+	struct snapshotCommand *record = (struct snapshotCommand *) (base + offset);
+	struct parsedCommand *command;
+	uint32_t *args;
+	int valid = 1;
+	int i;
+
+	if (!fits(offset, sizeof(*record), size) ||
+		!fits(record->args, sizeof(uint32_t) * (size_t) record->numberOfArgs, size))
+		return NULL;
+	args = (uint32_t *) (base + record->args);
+	command = arenaAllocate(arena, sizeof(struct parsedCommand));
+	command->args = arenaAllocate(arena, sizeof(char *) * record->numberOfArgs);
+	for (i = 0; i < record->numberOfArgs; i++)
+		command->args[i] = stringAt(base, size, args[i], &valid);
+	command->numberOfArgs = record->numberOfArgs;
+	command->numberOfStages = record->numberOfStages;
+	command->redirectInput = record->redirectInput;
+	command->redirectOutput = record->redirectOutput;
+	command->inputRedirect = stringAt(base, size, record->inputRedirect, &valid);
+	command->outputRedirect = stringAt(base, size, record->outputRedirect, &valid);
+	command->runInBackground = record->runInBackground;
+	command->expanded = 0;
+	command->substituted = 0;
+	command->hereDocument = stringAt(base, size, record->hereDocument, &valid);
+	command->substitutions = NULL;
+	if (record->numberOfArgs == 0 || command->args[record->numberOfArgs - 1] != NULL)
+		valid = 0;
+	return valid ? command : NULL;
+}
+
+/**
+* Function: validInstruction
+* -------------------------------------------
+* Returns 1 if a rebuilt instruction can run: a known opcode, jumps that land inside the block, a slot the
+* block has and text wherever the opcode reads it; 0 otherwise
+*
+* instruction - the instruction to check
+* numberOfInstructions - the size of its block
+* numberOfSlots - the slots of its block
+*/
+static int validInstruction(const struct instruction *instruction, uint32_t numberOfInstructions,
+	uint32_t numberOfSlots)
+{
+	int jumps = instruction->opcode == OP_JUMP || instruction->opcode == OP_JUMP_IF_FAILED ||
+		instruction->opcode == OP_JUMP_IF_SUCCEEDED || instruction->opcode == OP_FOR_NEXT ||
+		instruction->opcode == OP_CASE_MATCH;
+
+	if (instruction->opcode > OP_DEFINE || instruction->target < -1 ||
+		instruction->target > (int) numberOfInstructions || (jumps && instruction->target < 0) ||
+		instruction->slot < 0 || (instruction->slot > 0 && instruction->slot >= (int) numberOfSlots))
+		return 0;
+	if (instruction->opcode == OP_JUMP || instruction->opcode == OP_JUMP_IF_FAILED ||
+		instruction->opcode == OP_JUMP_IF_SUCCEEDED || instruction->opcode == OP_SUCCEED)
+		return 1;
+	return instruction->text != NULL;
+}
+
+/**
+* Function: loadBlock
+* -------------------------------------------
+* Rebuilds a compiled block, and the bodies of the functions it defines, from the mapped snapshot; returns
+* 0 on success and -1 if its records are damaged, in which case the block is still freed with freeBlock
+*
+* base - the start of the mapping
+* size - the size of the snapshot
+* offset - where the block's record starts
+* block - assigned the block
+*/
+static int loadBlock(char *base, size_t size, uint32_t offset, struct compiledBlock *block)
+{
+	struct snapshotBlock *record = (struct snapshotBlock *) (base + offset);
+	struct snapshotInstruction *source;
+	struct instruction *instruction;
+	int valid = 1;
+	uint32_t i;
+
+	block->instructions = NULL;
+	block->numberOfInstructions = 0;
+	block->capacity = 0;
+	block->numberOfSlots = 0;
+	block->references = 1;
+	initializeArena(&block->arena);
+	if (!fits(offset, sizeof(*record), size) ||
+		!fits(record->instructions, sizeof(*source) * (size_t) record->numberOfInstructions, size))
+		return -1;
+	block->capacity = record->numberOfInstructions > 0 ? record->numberOfInstructions : 1;
+	block->numberOfSlots = record->numberOfSlots;
+	block->instructions = malloc(sizeof(struct instruction) * block->capacity);
+
+	for (i = 0; i < record->numberOfInstructions; i++)
+	{
+		source = (struct snapshotInstruction *) (base + record->instructions) + i;
+		instruction = &block->instructions[i];
+		memset(instruction, 0, sizeof(*instruction));
+		instruction->opcode = source->opcode;
+		instruction->target = source->target;
+		instruction->slot = source->slot;
+		instruction->condition = source->condition;
+		instruction->text = stringAt(base, size, source->text, &valid);
+		instruction->pattern = stringAt(base, size, source->pattern, &valid);
+		if (!valid || !validInstruction(instruction, record->numberOfInstructions, record->numberOfSlots))
+			return -1;
+		if (source->command != 0 &&
+			(instruction->command = loadCommand(base, size, source->command, &commandArena)) == NULL)
+			return -1;
+		// Templates point nowhere outside themselves, so they are simply tokenized again from the text
+		if (source->opcode == OP_RUN && source->command == 0)
+			instruction->template = compileTemplate(instruction->text, &block->arena);
+		// Counted before the body is loaded so freeBlock releases it, whole or not
+		block->numberOfInstructions++;
+		if (source->opcode == OP_DEFINE)
+		{
+			instruction->function = malloc(sizeof(struct compiledBlock));
+			if (loadBlock(base, size, source->function, instruction->function) < 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+* Function: mapSnapshot
+* -------------------------------------------
+* Maps a snapshot and rebuilds the block it holds; returns 0 on success and -1 if the file is missing,
+* damaged, from another version or compiled from a source that has changed since. Text, patterns and
+* arguments point into the mapping, which stays for the life of the shell since function bodies may
+* outlive the block
+*
+* path - the snapshot file
+* source - the status of the file the block was compiled from
+* block - assigned the block; freed with freeBlock
+*/
+int mapSnapshot(const char *path, const struct stat *source, struct compiledBlock *block)
+{
+	struct snapshotHeader *header;
+	struct stat information;
+	struct arenaMark mark = markArena(&commandArena);
+	char *base;
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &information) < 0 || information.st_size < (off_t) sizeof(*header) ||
+		information.st_size > UINT32_MAX)
+	{
+		close(fd);
+		return -1;
+	}
+	// Private and writable, so nothing that edits an argument in place can fault or reach the file; every
+	// page is read in by the one call rather than faulted in one at a time while the block is rebuilt
+	base = mmap(NULL, information.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return -1;
+
+	header = (struct snapshotHeader *) base;
+	if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 && header->version == SNAPSHOT_VERSION &&
+		header->size == information.st_size && base[header->size - 1] == 0 &&
+		header->sourceSize == source->st_size &&
+		header->sourceModified == source->st_mtim.tv_sec * 1000000000LL + source->st_mtim.tv_nsec)
+	{
+		if (loadBlock(base, header->size, header->block, block) == 0)
+			return 0;
+		freeBlock(block);
+	}
+	rewindArena(&commandArena, mark);
+	munmap(base, information.st_size);
+	return -1;
+}
@@ -0,0 +1,92 @@
+/***********************************************************************************************************
+ * Filename: snapshot.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for compiled-block snapshots: a compiled block, the bodies of the
+ * functions it defines and its pre-parsed commands written to a file as offsets, so a later shell maps the
+ * file and runs the block without parsing its text again
+ **********************************************************************************************************/
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "control.h"
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#define SNAPSHOT_MAGIC "tinysnap"
+// Bumped whenever the layout of the records or of compiled blocks changes
+#define SNAPSHOT_VERSION 2
+
+// Every reference in a snapshot is an offset from the start of the file; 0 stands for none
+struct snapshotHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t size;				// the size of the whole file
+	int64_t sourceSize;			// the source file the block was compiled from, as it was then
+	int64_t sourceModified;		// in nanoseconds
+	uint32_t block;				// the top-level block
+	uint32_t padding;
+};
+
+struct snapshotBlock
+{
+	uint32_t numberOfInstructions;
+	uint32_t numberOfSlots;
+	uint32_t instructions;		// numberOfInstructions snapshotInstruction records
+};
+
+struct snapshotInstruction
+{
+	uint32_t opcode;
+	int32_t target;
+	int32_t slot;
+	uint32_t condition;
+	uint32_t text;
+	uint32_t pattern;
+	uint32_t command;			// a snapshotCommand
+	uint32_t function;			// a snapshotBlock
+};
+
+struct snapshotCommand
+{
+	uint32_t numberOfArgs;
+	uint32_t numberOfStages;
+	uint32_t redirectInput;
+	uint32_t redirectOutput;
+	uint32_t inputRedirect;
+	uint32_t outputRedirect;
+	uint32_t runInBackground;
+	uint32_t hereDocument;
+	uint32_t args;				// numberOfArgs offsets, 0 for the NULL that ends each stage
+};
+
+/**
+* Function: writeSnapshot
+* -------------------------------------------
+* Writes a compiled block to a file, replacing it in one step so a shell starting meanwhile never maps a
+* partial snapshot; returns 0 on success and -1 otherwise
+*
+* path - the snapshot file
+* block - the block to write
+* source - the status of the file the block was compiled from
+*/
+int writeSnapshot(const char *path, const struct compiledBlock *block, const struct stat *source);
+/**
+* Function: mapSnapshot
+* -------------------------------------------
+* Maps a snapshot and rebuilds the block it holds; returns 0 on success and -1 if the file is missing,
+* damaged, from another version or compiled from a source that has changed since. Text, patterns and
+* arguments point into the mapping, which stays for the life of the shell since function bodies may
+* outlive the block
+*
+* path - the snapshot file
+* source - the status of the file the block was compiled from
+* block - assigned the block; freed with freeBlock
+*/
+int mapSnapshot(const char *path, const struct stat *source, struct compiledBlock *block);
+
+#endif /* SNAPSHOT_H_ */
@@ -0,0 +1,368 @@
+/***********************************************************************************************************
+ * Filename: spawn.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements launching child processes. posix_spawn (clone with CLONE_VM | CLONE_VFORK in
+ * glibc) avoids copying the shell's page tables for every command; redirections become dup2 file actions
+ * and the child's signal dispositions are reset through spawn attributes. A classic fork + exec path is
+ * kept as a fallback for files the kernel can't exec directly and for anything spawn attributes can't do.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "spawn.h"
+#include "events.h"
+#include "heredoc.h"
+#include "variables.h"
+#include "pathcache.h"
+#include "util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+struct spawnStatistics
+{
+	const char *name;
+	unsigned long spawns;
+	unsigned long long totalNanoseconds;
+	unsigned long long minimumNanoseconds;
+	unsigned long long maximumNanoseconds;
+};
+
+static struct spawnStatistics statistics[2] = {
+	{ "posix_spawn", 0, 0, 0, 0 },
+	{ "fork", 0, 0, 0, 0 }
+};
+
+/**
+* Function: recordSpawnLatency
+* -------------------------------------------
+* Adds one launch to the statistics of a spawn path
+*
+* method - SPAWN_WITH_POSIX_SPAWN or SPAWN_WITH_FORK
+* startedAt - monotonic time the spawn began
+*/
+static void recordSpawnLatency(int method, unsigned long long startedAt)
+{
+	unsigned long long elapsed = monotonicNanoseconds() - startedAt;
+	struct spawnStatistics *stats = &statistics[method];
+	if (stats->spawns == 0 || elapsed < stats->minimumNanoseconds)
+		stats->minimumNanoseconds = elapsed;
+	if (elapsed > stats->maximumNanoseconds)
+		stats->maximumNanoseconds = elapsed;
+	stats->totalNanoseconds += elapsed;
+	stats->spawns++;
+}
+
+/**
+* Function: preferredSpawnMethod
+* -------------------------------------------
+* Returns SPAWN_WITH_FORK if the user asked for the fork path through TINYSH_SPAWN=fork and
+* SPAWN_WITH_POSIX_SPAWN otherwise
+*/
+static int preferredSpawnMethod()
+{
+	const char *method = getVariable("TINYSH_SPAWN");
+	if (method != NULL && strcmp(method, "fork") == 0)
+		return SPAWN_WITH_FORK;
+	return SPAWN_WITH_POSIX_SPAWN;
+}
+
+/**
+* Function: spawnWithPosixSpawn
+* -------------------------------------------
+* Launches a command with posix_spawn; returns 0 and assigns the child pid on success or the error number
+* reported by posix_spawn on failure
+*
+* commandPath - full path of the program to run
+* inputArgs - the command and its arguments
+* inputFd - file descriptor for the child's standard in or -1
+* outputFd - file descriptor for the child's standard out or -1
+* runInBackground - 0 = foreground, 1 = background
+* environment - the environment of the command
+* spawnPid - assigned the pid of the new child
+*/
+static int spawnWithPosixSpawn(char *commandPath, char **inputArgs, int inputFd, int outputFd, int runInBackground,
+	char **environment, pid_t *spawnPid)
+{
+	int error;
+	posix_spawn_file_actions_t fileActions;
+	posix_spawnattr_t attributes;
+	sigset_t defaultSignals;
+	sigset_t blockedSignals;
+
+	posix_spawn_file_actions_init(&fileActions);
+	if (outputFd >= 0)
+		posix_spawn_file_actions_adddup2(&fileActions, outputFd, 1);
+	if (inputFd >= 0)
+		posix_spawn_file_actions_adddup2(&fileActions, inputFd, 0);
+	inheritSubstitutionDescriptors(inputArgs, &fileActions);
+
+	// The shell ignores SIGINT; only foreground children get the default (terminating) action back
+	posix_spawnattr_init(&attributes);
+	sigemptyset(&defaultSignals);
+	sigaddset(&defaultSignals, SIGTSTP);
+	if (!runInBackground)
+		sigaddset(&defaultSignals, SIGINT);
+	posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+	// The shell reads its signals from a signalfd with them blocked; children start with none blocked
+	sigemptyset(&blockedSignals);
+	posix_spawnattr_setsigmask(&attributes, &blockedSignals);
+	posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+	error = posix_spawn(spawnPid, commandPath, &fileActions, &attributes, inputArgs, environment);
+
+	posix_spawnattr_destroy(&attributes);
+	posix_spawn_file_actions_destroy(&fileActions);
+	return error;
+}
+
+/**
+* Function: execInChild
+* -------------------------------------------
+* Runs in the forked child: execs the program, handing files without an executable header to the system
+* shell like execvp does; only returns if every exec failed
+*
+* commandPath - full path of the program to run
+* inputArgs - the command and its arguments
+* environment - the environment of the command
+*/
+static void execInChild(char *commandPath, char **inputArgs, char **environment)
+{
+	int numberOfArgs = 0;
+	char **shellArgs;
+
+	execve(commandPath, inputArgs, environment);
+	if (errno != ENOEXEC)
+		return;
+
+	while (inputArgs[numberOfArgs] != NULL)
+		numberOfArgs++;
+	shellArgs = malloc(sizeof(char *) * (numberOfArgs + 2));
+	shellArgs[0] = "sh";
+	shellArgs[1] = commandPath;
+	memcpy(shellArgs + 2, inputArgs + 1, sizeof(char *) * numberOfArgs);
+	execve("/bin/sh", shellArgs, environment);
+	errno = ENOEXEC;
+}
+
+/**
+* Function: spawnWithFork
+* -------------------------------------------
+* Launches a command with fork + exec; returns 0 and assigns the child pid on success or the error number
+* of the failed exec. A close-on-exec pipe tells the parent when the exec happened (or why it didn't)
+*
+* commandPath - full path of the program to run
+* inputArgs - the command and its arguments
+* inputFd - file descriptor for the child's standard in or -1
+* outputFd - file descriptor for the child's standard out or -1
+* runInBackground - 0 = foreground, 1 = background
+* controls - limits, affinity and priorities the child sets on itself before exec
+* environment - the environment of the command
+* spawnPid - assigned the pid of the new child
+*/
+static int spawnWithFork(
+	char *commandPath, char **inputArgs, int inputFd, int outputFd, int runInBackground,
+	const struct resourceControls *controls, char **environment, pid_t *spawnPid)
+{
+	int execPipe[2];
+	int childError = 0;
+	ssize_t bytesRead;
+	sigset_t blockedSignals;
+
+	if (pipe2(execPipe, O_CLOEXEC) < 0)
+		return errno;
+
+	*spawnPid = fork();
+	switch (*spawnPid)
+	{
+		case -1:
+			childError = errno;
+			close(execPipe[0]);
+			close(execPipe[1]);
+			return childError;
+		case 0:
+			close(execPipe[0]);
+			signal(SIGTSTP, SIG_DFL);
+			if (!runInBackground)
+				signal(SIGINT, SIG_DFL);
+			sigemptyset(&blockedSignals);
+			sigprocmask(SIG_SETMASK, &blockedSignals, NULL);
+			if (outputFd >= 0)
+				dup2(outputFd, 1);
+			if (inputFd >= 0)
+				dup2(inputFd, 0);
+			inheritSubstitutionDescriptors(inputArgs, NULL);
+			// A control that can't be set fails the command like taskset or prlimit would
+			if (applyResourceControls(controls) < 0)
+				_exit(1);
+			execInChild(commandPath, inputArgs, environment);
+			childError = errno;
+			write(execPipe[1], &childError, sizeof(childError));
+			_exit(1);
+		default:
+			close(execPipe[1]);
+			// Blocks until the child exec'd (pipe closed with nothing written) or reported its errno
+			do
+				bytesRead = read(execPipe[0], &childError, sizeof(childError));
+			while (bytesRead < 0 && errno == EINTR);
+			close(execPipe[0]);
+			return bytesRead == sizeof(childError) ? childError : 0;
+	}
+}
+
+/**
+* Function: spawnCommand
+* -------------------------------------------
+* Starts a command as a child process with its standard in and out connected to the given file descriptors
+* and returns the pid of the child, or -1 if the command could not be started (an error is printed). The
+* command is launched with posix_spawn unless the fork fallback is required or requested through the
+* TINYSH_SPAWN=fork environment variable, or resource controls have to be set in the child
+*
+* inputArgs - the command and its arguments; inputArgs[0] is looked up in the path cache
+* inputFd - file descriptor to use as the child's standard in or -1 to inherit the shell's
+* outputFd - file descriptor to use as the child's standard out or -1 to inherit the shell's
+* runInBackground - 0 = foreground (SIGINT restored to default), 1 = background (SIGINT stays ignored)
+* controls - limits, affinity and priorities the child sets on itself before exec
+*/
+pid_t spawnCommand(
+	char **inputArgs, int inputFd, int outputFd, int runInBackground, const struct resourceControls *controls)
+{
+	pid_t spawnPid = -1;
+	int error;
+	int method = preferredSpawnMethod();
+	unsigned long long startedAt = monotonicNanoseconds();
+	char *commandPath = lookupCommandPath(inputArgs[0]);
+	// Built in the parent, and only when an exported variable changed since the last spawn
+	char **environment = exportedEnvironment();
+
+	if (commandPath == NULL)
+	{
+		fprintf(stderr, "%s: %s\n", inputArgs[0], strerror(ENOENT));
+		return -1;
+	}
+
+	// Spawn attributes have no rlimit, affinity or priority settings, so those need code in the child
+	if (hasResourceControls(controls))
+		method = SPAWN_WITH_FORK;
+	if (method == SPAWN_WITH_POSIX_SPAWN)
+	{
+		error = spawnWithPosixSpawn(commandPath, inputArgs, inputFd, outputFd, runInBackground, environment,
+			&spawnPid);
+		// Files without an executable header need the fork path, which falls back to /bin/sh
+		if (error == ENOEXEC || error == ENOSYS)
+			method = SPAWN_WITH_FORK;
+	}
+	if (method == SPAWN_WITH_FORK)
+		error = spawnWithFork(commandPath, inputArgs, inputFd, outputFd, runInBackground, controls, environment,
+			&spawnPid);
+
+	if (error != 0)
+	{
+		fprintf(stderr, "%s: %s\n", inputArgs[0], strerror(error));
+		// The fork path leaves a child behind that already exited
+		if (spawnPid > 0)
+			waitpid(spawnPid, NULL, 0);
+		return -1;
+	}
+	recordSpawnLatency(method, startedAt);
+	return spawnPid;
+}
+
+/**
+* Function: spawnBuiltin
+* -------------------------------------------
+* Runs a builtin in a forked child, as a stage of a pipeline, and returns the pid of the child or -1 if it
+* could not be forked. The child exits with the builtin's return value
+*
+* handler - the builtin to run
+* inputArgs - the builtin's name and arguments
+* inputFd - file descriptor to use as the child's standard in or -1 to inherit the shell's
+* outputFd - file descriptor to use as the child's standard out or -1 to inherit the shell's
+* runInBackground - 0 = foreground (SIGINT restored to default), 1 = background (SIGINT stays ignored)
+* controls - limits, affinity and priorities the child sets on itself before running the builtin
+* status - the shell's status, as the builtin would see it in the shell process
+*/
+pid_t spawnBuiltin(
+	builtinHandler handler, char **inputArgs, int inputFd, int outputFd, int runInBackground,
+	const struct resourceControls *controls, struct shellStatus *status)
+{
+	int result;
+	pid_t spawnPid = fork();
+	switch (spawnPid)
+	{
+		case -1:
+			perror("fork");
+			return -1;
+		case 0:
+			signal(SIGTSTP, SIG_DFL);
+			if (!runInBackground)
+				signal(SIGINT, SIG_DFL);
+			// The shell's signalfd reads only the shell's signals; the child reaps its own children by polling
+			closeEvents();
+			if (outputFd >= 0)
+				dup2(outputFd, 1);
+			if (inputFd >= 0)
+				dup2(inputFd, 0);
+			// Nothing gets exec'd, so close-on-exec never drops the pipe ends and files this stage inherited;
+			// left open, a builtin writing into a pipe would hold its read end and never see the reader go.
+			// Only the /dev/fd/N ends of process substitutions stay, for the builtin to open
+			closeInheritedDescriptors();
+			if (applyResourceControls(controls) < 0)
+				_exit(1);
+			// The shell flushed stdout before forking, so only the builtin's own output is flushed here
+			result = handler(inputArgs, 0, 1, status);
+			fflush(stdout);
+			_exit(result);
+		default:
+			return spawnPid;
+	}
+}
+
+/**
+* Function: printSpawnStatistics
+* -------------------------------------------
+* Prints how many children were launched through each spawn path and the time taken from the start of
+* the spawn until the child had exec'd, then how many times the environment handed to commands was built
+*
+* outputFd - the file descriptor to print to
+*/
+void printSpawnStatistics(int outputFd)
+{
+	int i;
+	dprintf(outputFd, "method\tspawns\tmean(us)\tmin(us)\tmax(us)\n");
+	for (i = 0; i < 2; i++)
+	{
+		struct spawnStatistics *stats = &statistics[i];
+		double mean = stats->spawns ? (double) stats->totalNanoseconds / stats->spawns / 1000.0 : 0.0;
+		dprintf(outputFd, "%s\t%lu\t%.1f\t%.1f\t%.1f\n", stats->name, stats->spawns, mean,
+			stats->minimumNanoseconds / 1000.0, stats->maximumNanoseconds / 1000.0);
+	}
+	dprintf(outputFd, "environment builds\t%lu\n", environmentRebuilds());
+}
+
+/**
+* Function: resetSpawnStatistics
+* -------------------------------------------
+* Zeroes the spawn counters and timings for every spawn path
+*/
+void resetSpawnStatistics()
+{
+	int i;
+	for (i = 0; i < 2; i++)
+	{
+		statistics[i].spawns = 0;
+		statistics[i].totalNanoseconds = 0;
+		statistics[i].minimumNanoseconds = 0;
+		statistics[i].maximumNanoseconds = 0;
+	}
+}
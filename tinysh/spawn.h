@@ -0,0 +1,69 @@
+/***********************************************************************************************************
+ * Filename: spawn.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for launching child processes (posix_spawn with a fork fallback)
+ **********************************************************************************************************/
+
+#ifndef SPAWN_H_
+#define SPAWN_H_
+
+#include "builtins.h"
+#include "resources.h"
+
+#include <sys/types.h>
+
+#define SPAWN_WITH_POSIX_SPAWN 0
+#define SPAWN_WITH_FORK 1
+
+/**
+* Function: spawnCommand
+* -------------------------------------------
+* Starts a command as a child process with its standard in and out connected to the given file descriptors
+* and returns the pid of the child, or -1 if the command could not be started (an error is printed). The
+* command is launched with posix_spawn unless the fork fallback is required or requested through the
+* TINYSH_SPAWN=fork environment variable, or resource controls have to be set in the child
+*
+* inputArgs - the command and its arguments; inputArgs[0] is looked up in the path cache
+* inputFd - file descriptor to use as the child's standard in or -1 to inherit the shell's
+* outputFd - file descriptor to use as the child's standard out or -1 to inherit the shell's
+* runInBackground - 0 = foreground (SIGINT restored to default), 1 = background (SIGINT stays ignored)
+* controls - limits, affinity and priorities the child sets on itself before exec
+*/
+pid_t spawnCommand(
+	char **inputArgs, int inputFd, int outputFd, int runInBackground, const struct resourceControls *controls);
+/**
+* Function: spawnBuiltin
+* -------------------------------------------
+* Runs a builtin in a forked child, as a stage of a pipeline, and returns the pid of the child or -1 if it
+* could not be forked. The child exits with the builtin's return value
+*
+* handler - the builtin to run
+* inputArgs - the builtin's name and arguments
+* inputFd - file descriptor to use as the child's standard in or -1 to inherit the shell's
+* outputFd - file descriptor to use as the child's standard out or -1 to inherit the shell's
+* runInBackground - 0 = foreground (SIGINT restored to default), 1 = background (SIGINT stays ignored)
+* controls - limits, affinity and priorities the child sets on itself before running the builtin
+* status - the shell's status, as the builtin would see it in the shell process
+*/
+pid_t spawnBuiltin(
+	builtinHandler handler, char **inputArgs, int inputFd, int outputFd, int runInBackground,
+	const struct resourceControls *controls, struct shellStatus *status);
+/**
+* Function: printSpawnStatistics
+* -------------------------------------------
+* Prints how many children were launched through each spawn path and the time taken from the start of
+* the spawn until the child had exec'd, then how many times the environment handed to commands was built
+*
+* outputFd - the file descriptor to print to
+*/
+void printSpawnStatistics(int outputFd);
+/**
+* Function: resetSpawnStatistics
+* -------------------------------------------
+* Zeroes the spawn counters and timings for every spawn path
+*/
+void resetSpawnStatistics();
+
+#endif /* SPAWN_H_ */
@@ -0,0 +1,250 @@
+/***********************************************************************************************************
+ * Filename: startup.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the startup file. The file is compiled as one block and run before the first
+ * prompt, defining the user's variables and functions. Compiling a long file on every start costs more than
+ * the rest of startup together, so smallsh --compile-rc writes the compiled block to FILE.snapshot, which
+ * later shells map and run without parsing; the snapshot records the size and modification time of the file
+ * it came from and is rebuilt once the file changes. Also measures the time from exec to the first prompt.
+ **********************************************************************************************************/
+
+#include "startup.h"
+#include "snapshot.h"
+#include "control.h"
+#include "variables.h"
+#include "arena.h"
+#include "util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+* Function: assignStartupPaths
+* -------------------------------------------
+* Assigns the path of the startup file ($TINYSH_RC, or ~/.tinyshrc) and of its snapshot; returns 0 on
+* success and -1 if they don't fit
+*
+* path - assigned the startup file's path
+* snapshotPath - assigned the snapshot's path
+*/
+static int assignStartupPaths(char *path, char *snapshotPath)
+{
+	const char *variable = getVariable("TINYSH_RC");
+	char homeDirectory[PATH_MAXIMUM];
+
+	if (variable == NULL || *variable == 0)
+	{
+		assignHomeDirectory(homeDirectory);
+		variable = homeDirectory;
+	}
+	if (snprintf(path, PATH_MAXIMUM, "%s%s%s", variable, variable == homeDirectory ? "/" : "",
+			variable == homeDirectory ? STARTUP_FILE_NAME : "") >= PATH_MAXIMUM ||
+		snprintf(snapshotPath, PATH_MAXIMUM, "%s%s", path, SNAPSHOT_SUFFIX) >= PATH_MAXIMUM)
+	{
+		fprintf(stderr, "startup file: %s\n", strerror(ENAMETOOLONG));
+		return -1;
+	}
+	return 0;
+}
+
+/**
+* Function: compileOpenFile
+* -------------------------------------------
+* Reads an open startup file and compiles it; returns 0 on success and -1 if it can't be read or has a
+* syntax error
+*
+* fd - the startup file
+* path - its path, for messages
+* source - its status, giving the size to read
+* block - assigned the compiled block
+*/
+static int compileOpenFile(int fd, const char *path, const struct stat *source, struct compiledBlock *block)
+{
+	char *text = malloc(source->st_size + 1);
+	ssize_t length = 0;
+	ssize_t bytesRead;
+	int result;
+
+	while (length < source->st_size)
+	{
+		bytesRead = read(fd, text + length, source->st_size - length);
+		if (bytesRead < 0 && errno == EINTR)
+			continue;
+		if (bytesRead <= 0)
+			break;
+		length += bytesRead;
+	}
+	if (length < source->st_size)
+	{
+		perror(path);
+		free(text);
+		return -1;
+	}
+	text[length] = 0;
+
+	// The block keeps copies of what it needs from the text
+	result = compileBlock(text, block);
+	free(text);
+	if (result < 0)
+		fprintf(stderr, "%s: not run\n", path);
+	return result;
+}
+
+/**
+* Function: runStartupFile
+* -------------------------------------------
+* Runs the startup file ($TINYSH_RC, or ~/.tinyshrc) as one block. When FILE.snapshot holds the file
+* compiled in its current state it is mapped instead of reading and compiling the file; a snapshot that
+* has gone stale is rewritten. Returns STARTUP_NONE, STARTUP_PARSED or STARTUP_MAPPED, or -1 if the file
+* can't be read or has a syntax error, in which case none of it runs
+*
+* status - the shell's status, as the file's commands leave it
+*/
+int runStartupFile(struct shellStatus *status)
+{
+	char path[PATH_MAXIMUM];
+	char snapshotPath[PATH_MAXIMUM];
+	struct compiledBlock block;
+	struct stat source;
+	struct arena arena;
+	int result = STARTUP_MAPPED;
+	int fd;
+
+	if (assignStartupPaths(path, snapshotPath) < 0)
+		return -1;
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		if (errno == ENOENT)
+			return STARTUP_NONE;
+		perror(path);
+		return -1;
+	}
+	// The status comes from the open file, so a snapshot written below describes the text that was read
+	if (fstat(fd, &source) < 0 || mapSnapshot(snapshotPath, &source, &block) < 0)
+	{
+		result = STARTUP_PARSED;
+		if (compileOpenFile(fd, path, &source, &block) < 0)
+		{
+			close(fd);
+			return -1;
+		}
+		// Only a snapshot that was asked for once with --compile-rc is kept up to date
+		if (access(snapshotPath, F_OK) == 0 && writeSnapshot(snapshotPath, &block, &source) < 0)
+			perror(snapshotPath);
+	}
+	close(fd);
+
+	initializeArena(&arena);
+	runBlock(&block, status, &arena);
+	freeArena(&arena);
+	freeBlock(&block);
+	return result;
+}
+
+/**
+* Function: compileStartupFile
+* -------------------------------------------
+* Compiles the startup file and writes its snapshot, which later shells map instead of parsing the file;
+* returns 0 on success and -1 after printing why it failed
+*/
+int compileStartupFile()
+{
+	char path[PATH_MAXIMUM];
+	char snapshotPath[PATH_MAXIMUM];
+	struct compiledBlock block;
+	struct stat source;
+	int result;
+	int fd;
+
+	if (assignStartupPaths(path, snapshotPath) < 0)
+		return -1;
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0 || fstat(fd, &source) < 0)
+	{
+		perror(path);
+		closeFile(fd >= 0, fd);
+		return -1;
+	}
+	result = compileOpenFile(fd, path, &source, &block);
+	close(fd);
+	if (result < 0)
+		return -1;
+
+	result = writeSnapshot(snapshotPath, &block, &source);
+	if (result < 0)
+		perror(snapshotPath);
+	else
+		fprintf(stderr, "%s: %d instructions written to %s\n", path, block.numberOfInstructions, snapshotPath);
+	freeBlock(&block);
+	return result;
+}
+
+/**
+* Function: execStartTime
+* -------------------------------------------
+* Returns the monotonic time in nanoseconds at which the shell was executed. The first call re-executes
+* the shell with the time in STARTUP_CLOCK_VARIABLE, so what is measured includes exec and dynamic
+* loading; the re-executed shell reads the time back and drops the variable from its environment
+*
+* argv - the shell's arguments, to execute it again with
+*/
+unsigned long long execStartTime(char **argv)
+{
+	char clock[32];
+	const char *value = getenv(STARTUP_CLOCK_VARIABLE);
+	unsigned long long execTime;
+
+	if (value == NULL)
+	{
+		execTime = monotonicNanoseconds();
+		snprintf(clock, sizeof(clock), "%llu", execTime);
+		setenv(STARTUP_CLOCK_VARIABLE, clock, 1);
+		execv("/proc/self/exe", argv);
+		// Without /proc the measurement starts here instead
+		unsetenv(STARTUP_CLOCK_VARIABLE);
+		return execTime;
+	}
+	execTime = strtoull(value, NULL, 10);
+	unsetenv(STARTUP_CLOCK_VARIABLE);
+	return execTime;
+}
+
+/**
+* Function: reportStartupTime
+* -------------------------------------------
+* Prints the time from exec to the first prompt, and how the startup file was run, to standard error
+*
+* execTime - the time returned by execStartTime
+* startupResult - what runStartupFile returned, or STARTUP_NONE if it wasn't called
+* startupNanoseconds - the time runStartupFile took
+*/
+void reportStartupTime(unsigned long long execTime, int startupResult, unsigned long long startupNanoseconds)
+{
+	const char *how;
+
+	switch (startupResult)
+	{
+		case STARTUP_PARSED:
+			how = "parsed";
+			break;
+		case STARTUP_MAPPED:
+			how = "from snapshot";
+			break;
+		case STARTUP_NONE:
+			how = "none";
+			break;
+		default:
+			how = "failed";
+	}
+	fprintf(stderr, "startup: %.3f ms from exec to the first prompt (startup file %s, %.3f ms)\n",
+		(monotonicNanoseconds() - execTime) / 1e6, how, startupNanoseconds / 1e6);
+}
@@ -0,0 +1,64 @@
+/***********************************************************************************************************
+ * Filename: startup.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the startup file (~/.tinyshrc), run through a mapped snapshot of
+ * its compiled form when one is up to date, and for measuring the time from exec to the first prompt
+ **********************************************************************************************************/
+
+#ifndef STARTUP_H_
+#define STARTUP_H_
+
+#include "shell.h"
+
+#define STARTUP_FILE_NAME ".tinyshrc"
+#define SNAPSHOT_SUFFIX ".snapshot"
+// Carries the time of the first exec into the re-executed shell under smallsh --startup-time
+#define STARTUP_CLOCK_VARIABLE "TINYSH_STARTUP_CLOCK"
+
+// Returned by runStartupFile
+#define STARTUP_NONE 0				// there is no startup file
+#define STARTUP_PARSED 1			// the file was read and compiled
+#define STARTUP_MAPPED 2			// its snapshot was mapped instead
+
+/**
+* Function: runStartupFile
+* -------------------------------------------
+* Runs the startup file ($TINYSH_RC, or ~/.tinyshrc) as one block. When FILE.snapshot holds the file
+* compiled in its current state it is mapped instead of reading and compiling the file; a snapshot that
+* has gone stale is rewritten. Returns STARTUP_NONE, STARTUP_PARSED or STARTUP_MAPPED, or -1 if the file
+* can't be read or has a syntax error, in which case none of it runs
+*
+* status - the shell's status, as the file's commands leave it
+*/
+int runStartupFile(struct shellStatus *status);
+/**
+* Function: compileStartupFile
+* -------------------------------------------
+* Compiles the startup file and writes its snapshot, which later shells map instead of parsing the file;
+* returns 0 on success and -1 after printing why it failed
+*/
+int compileStartupFile();
+/**
+* Function: execStartTime
+* -------------------------------------------
+* Returns the monotonic time in nanoseconds at which the shell was executed. The first call re-executes
+* the shell with the time in STARTUP_CLOCK_VARIABLE, so what is measured includes exec and dynamic
+* loading; the re-executed shell reads the time back and drops the variable from its environment
+*
+* argv - the shell's arguments, to execute it again with
+*/
+unsigned long long execStartTime(char **argv);
+/**
+* Function: reportStartupTime
+* -------------------------------------------
+* Prints the time from exec to the first prompt, and how the startup file was run, to standard error
+*
+* execTime - the time returned by execStartTime
+* startupResult - what runStartupFile returned, or STARTUP_NONE if it wasn't called
+* startupNanoseconds - the time runStartupFile took
+*/
+void reportStartupTime(unsigned long long execTime, int startupResult, unsigned long long startupNanoseconds);
+
+#endif /* STARTUP_H_ */
@@ -0,0 +1,269 @@
+/***********************************************************************************************************
+ * Filename: substitute.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements command substitution. A command that starts with a builtin that only writes
+ * output can't change anything a subshell would keep to itself, so it runs inside the shell without a fork:
+ * standard out points at an in-memory file for the length of the command, so a builtin never blocks on a
+ * pipe nobody reads, and the file is kept for the next substitution. Any other command, functions included,
+ * runs in a forked shell and its output is read through a pipe in large reads into a buffer that doubles
+ * as it fills.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "substitute.h"
+#include "cli.h"
+#include "control.h"
+#include "events.h"
+#include "heredoc.h"
+#include "shell.h"
+#include "variables.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+// An emptied in-memory file kept for the next substitution run inside the shell, or -1
+static int spareCapture = -1;
+// Stands in for the shell's status when the variables were never initialized, as in the benchmark driver
+static struct shellStatus detachedStatus;
+
+/**
+* Function: commandName
+* -------------------------------------------
+* Copies the first word of a command into name and returns 1 if it is a plain word, one without quotes,
+* escapes or expansions; 0 otherwise
+*
+* text - the command
+* name - assigned the word; room for CAPTURE_NAME_MAXIMUM bytes and the terminator
+*/
+static int commandName(const char *text, char *name)
+{
+	size_t length = 0;
+
+	while (*text == ' ' || *text == '\t')
+		text++;
+	while (text[length] != 0 && strchr(" \t|&;<>()'\"\\$`", text[length]) == NULL)
+	{
+		if (length == CAPTURE_NAME_MAXIMUM)
+			return 0;
+		name[length] = text[length];
+		length++;
+	}
+	name[length] = 0;
+	return length > 0 && (text[length] == 0 || strchr(" \t|&;<>", text[length]) != NULL);
+}
+
+/**
+* Function: readCapture
+* -------------------------------------------
+* Returns what was written to an in-memory file (newly allocated, with room for a terminator)
+*
+* fd - the file
+* length - assigned the number of bytes read
+*/
+static char * readCapture(int fd, size_t *length)
+{
+	struct stat file;
+	size_t size = fstat(fd, &file) == 0 ? (size_t) file.st_size : 0;
+	char *output = malloc(size + 1);
+	ssize_t bytesRead;
+
+	*length = 0;
+	while (*length < size)
+	{
+		bytesRead = pread(fd, output + *length, size - *length, *length);
+		if (bytesRead < 0 && errno == EINTR)
+			continue;
+		if (bytesRead <= 0)
+			break;
+		*length += bytesRead;
+	}
+	return output;
+}
+
+/**
+* Function: captureInShell
+* -------------------------------------------
+* Runs a command inside the shell with standard out on an in-memory file and returns the output (newly
+* allocated), or NULL if no file could be created, leaving the command to a forked shell
+*
+* text - the command; split in place as it is parsed
+* status - the shell's status, assigned the command's
+* arena - provides the command's arguments
+* length - assigned the length of the output
+*/
+static char * captureInShell(char *text, struct shellStatus *status, struct arena *arena, size_t *length)
+{
+	struct parsedCommand command;
+	int fd = spareCapture;
+	int saved;
+	char *output;
+
+	if (fd < 0 && (fd = memfd_create("tinysh-capture", MFD_CLOEXEC)) < 0)
+		return NULL;
+	spareCapture = -1;
+	if (parseArgs(text, &command, arena) != 0)
+	{
+		status->terminationStatus = 2;
+		status->signalOrTerminated = 0;
+		spareCapture = fd;
+		*length = 0;
+		return calloc(1, 1);
+	}
+
+	fflush(stdout);
+	saved = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 10);
+	dup2(fd, STDOUT_FILENO);
+	processCommand(&command, status);
+	fflush(stdout);
+	dup2(saved, STDOUT_FILENO);
+	close(saved);
+
+	output = readCapture(fd, length);
+	// A substitution nested in this one may have left its own file as the spare already
+	if (spareCapture < 0 && ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0)
+		spareCapture = fd;
+	else
+		close(fd);
+	return output;
+}
+
+/**
+* Function: runCapturedChild
+* -------------------------------------------
+* Runs in the forked shell of a command substitution: compiles and runs the command with standard out on
+* the pipe, then exits with the command's status
+*
+* text - the command
+* fd - the write end of the pipe
+* status - the shell's status, as the command starts with it
+*/
+static void runCapturedChild(const char *text, int fd, struct shellStatus *status)
+{
+	struct compiledBlock block;
+	struct arena arena;
+
+	signal(SIGTSTP, SIG_DFL);
+	signal(SIGINT, SIG_DFL);
+	closeEvents();
+	dup2(fd, STDOUT_FILENO);
+	closeInheritedDescriptors();
+
+	if (compileBlock(text, &block) < 0)
+		_exit(2);
+	initializeArena(&arena);
+	runBlock(&block, status, &arena);
+	fflush(stdout);
+	_exit(status->signalOrTerminated ? 128 + status->terminationStatus : status->terminationStatus);
+}
+
+/**
+* Function: captureInChild
+* -------------------------------------------
+* Runs a command in a forked shell and returns what it wrote to standard out (newly allocated), read
+* through a pipe until the command closes it
+*
+* text - the command
+* status - the shell's status, assigned the command's
+* length - assigned the length of the output
+*/
+static char * captureInChild(const char *text, struct shellStatus *status, size_t *length)
+{
+	size_t capacity = CAPTURE_READ_SIZE;
+	char *output = malloc(capacity + 1);
+	ssize_t bytesRead;
+	int pipeFds[2];
+	int childStatus;
+	pid_t pid;
+
+	*length = 0;
+	status->terminationStatus = 1;
+	status->signalOrTerminated = 0;
+	if (pipe2(pipeFds, O_CLOEXEC) < 0)
+	{
+		perror("pipe");
+		return output;
+	}
+	fflush(stdout);
+	pid = fork();
+	if (pid == 0)
+		runCapturedChild(text, pipeFds[1], status);
+	close(pipeFds[1]);
+	if (pid < 0)
+	{
+		perror("fork");
+		close(pipeFds[0]);
+		return output;
+	}
+
+	while (1)
+	{
+		if (capacity - *length < CAPTURE_READ_SIZE)
+		{
+			capacity *= 2;
+			output = realloc(output, capacity + 1);
+		}
+		bytesRead = read(pipeFds[0], output + *length, capacity - *length);
+		if (bytesRead < 0 && errno == EINTR)
+			continue;
+		if (bytesRead <= 0)
+			break;
+		*length += bytesRead;
+	}
+	close(pipeFds[0]);
+
+	while (waitpid(pid, &childStatus, 0) < 0)
+		if (errno != EINTR)
+			return output;
+	assignChildStatus(&childStatus, &status->terminationStatus, &status->signalOrTerminated);
+	return output;
+}
+
+/**
+* Function: substituteCommand
+* -------------------------------------------
+* Runs a command substitution's command and returns its output without trailing newlines (newly
+* allocated), the shell's status assigned the command's. A command starting with a builtin that only
+* writes output runs inside the shell with standard out on an in-memory file; anything else, functions
+* included, runs in a forked shell whose output is read through a pipe
+*
+* text - the command, terminated
+* arena - provides the command's arguments while it runs inside the shell
+*/
+char * substituteCommand(const char *text, struct arena *arena)
+{
+	struct shellStatus *status = expansionStatus();
+	struct arenaMark mark = markArena(arena);
+	char name[CAPTURE_NAME_MAXIMUM + 1];
+	char *output = NULL;
+	char *copy;
+	size_t length = strlen(text);
+
+	if (status == NULL)
+		status = &detachedStatus;
+	// Blocks can hold anything, 'cd' included, so only a single command runs inside the shell
+	if (commandName(text, name) && capturedInShell(name) && !startsBlock(text))
+	{
+		copy = arenaAllocate(arena, length + 1);
+		memcpy(copy, text, length + 1);
+		output = captureInShell(copy, status, arena, &length);
+	}
+	if (output == NULL)
+		output = captureInChild(text, status, &length);
+	rewindArena(arena, mark);
+
+	while (length > 0 && output[length - 1] == '\n')
+		length--;
+	output[length] = 0;
+	return output;
+}
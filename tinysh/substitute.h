@@ -0,0 +1,35 @@
+/***********************************************************************************************************
+ * Filename: substitute.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for command substitution, which runs the command of a $(COMMAND) or
+ * `COMMAND` word and captures its output
+ **********************************************************************************************************/
+
+#ifndef SUBSTITUTE_H_
+#define SUBSTITUTE_H_
+
+#include "arena.h"
+
+#include <stddef.h>
+
+// The size of each read from a forked command's pipe, and the least room left for the next one
+#define CAPTURE_READ_SIZE 65536
+// A command name longer than this never names a builtin, so the command is forked
+#define CAPTURE_NAME_MAXIMUM 64
+
+/**
+* Function: substituteCommand
+* -------------------------------------------
+* Runs a command substitution's command and returns its output without trailing newlines (newly
+* allocated), the shell's status assigned the command's. A command starting with a builtin that only
+* writes output runs inside the shell with standard out on an in-memory file; anything else, functions
+* included, runs in a forked shell whose output is read through a pipe
+*
+* text - the command, terminated
+* arena - provides the command's arguments while it runs inside the shell
+*/
+char * substituteCommand(const char *text, struct arena *arena);
+
+#endif /* SUBSTITUTE_H_ */
@@ -0,0 +1,313 @@
+/***********************************************************************************************************
+ * Filename: trace.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements the execution trace. Every finished command becomes one event holding its
+ * command line, pid, parse/spawn/exec/exit times, status and resource usage, written either as JSON lines
+ * or as a Chrome trace (one complete event per command, on a row per pid, so background jobs show up
+ * overlapping in about:tracing or Perfetto). Events are collected in a memory buffer and written out only
+ * when it fills or the shell exits, so tracing adds no system calls to the commands being measured.
+ **********************************************************************************************************/
+
+#include "trace.h"
+#include "util.h"
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static int traceFd = -1;
+static char *tracePath = NULL;
+static int traceFormat = TRACE_JSON_LINES;
+static pid_t shellPid;
+static unsigned long long traceStart;
+static unsigned long long lastParseStart;
+static char buffer[TRACE_BUFFER_SIZE];
+static size_t bufferLength = 0;
+
+/**
+* Function: flushTrace
+* -------------------------------------------
+* Writes the buffered events to the trace file, so a process forked next doesn't inherit them
+*/
+void flushTrace()
+{
+	size_t written = 0;
+	ssize_t result;
+
+	if (traceFd < 0)
+		return;
+	while (written < bufferLength)
+	{
+		result = write(traceFd, buffer + written, bufferLength - written);
+		if (result <= 0)
+			break;
+		written += result;
+	}
+	bufferLength = 0;
+}
+
+/**
+* Function: appendTrace
+* -------------------------------------------
+* Adds bytes to the trace buffer, writing it out first when they don't fit
+*
+* data - the bytes to add
+* length - the number of bytes
+*/
+static void appendTrace(const char *data, size_t length)
+{
+	size_t room;
+	while (length > 0)
+	{
+		if (bufferLength == TRACE_BUFFER_SIZE)
+			flushTrace();
+		room = TRACE_BUFFER_SIZE - bufferLength;
+		if (room > length)
+			room = length;
+		memcpy(buffer + bufferLength, data, room);
+		bufferLength += room;
+		data += room;
+		length -= room;
+	}
+}
+
+/**
+* Function: appendJsonString
+* -------------------------------------------
+* Adds a quoted JSON string to the trace buffer, escaping quotes, backslashes and control characters
+*
+* text - the text of the string
+* length - the number of bytes of text to use
+*/
+static void appendJsonString(const char *text, size_t length)
+{
+	char escaped[8];
+	size_t start = 0;
+	size_t i;
+
+	appendTrace("\"", 1);
+	for (i = 0; i < length; i++)
+	{
+		unsigned char c = text[i];
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+		appendTrace(text + start, i - start);
+		if (c == '"' || c == '\\')
+			snprintf(escaped, sizeof(escaped), "\\%c", c);
+		else
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+		appendTrace(escaped, strlen(escaped));
+		start = i + 1;
+	}
+	appendTrace(text + start, length - start);
+	appendTrace("\"", 1);
+}
+
+/**
+* Function: appendFields
+* -------------------------------------------
+* Adds printf-style formatted text (short, such as a run of numeric fields) to the trace buffer
+*
+* format - the printf(3) format
+*/
+static void appendFields(const char *format, ...)
+{
+	char fields[512];
+	int length;
+	va_list arguments;
+
+	va_start(arguments, format);
+	length = vsnprintf(fields, sizeof(fields), format, arguments);
+	va_end(arguments);
+	if (length > 0)
+		appendTrace(fields, (size_t) length < sizeof(fields) ? (size_t) length : sizeof(fields) - 1);
+}
+
+/**
+* Function: sinceStart
+* -------------------------------------------
+* Returns a monotonic time as microseconds since the trace was opened (0 for times never recorded)
+*
+* time - the monotonic time in nanoseconds
+*/
+static long long sinceStart(unsigned long long time)
+{
+	return time >= traceStart ? (long long) ((time - traceStart) / 1000) : 0;
+}
+
+/**
+* Function: openTrace
+* -------------------------------------------
+* Starts writing one event per command to a file; returns 0 on success and -1 if the file can't be opened
+*
+* path - the file to write (created or truncated)
+* format - TRACE_JSON_LINES (one JSON object per line) or TRACE_CHROME (about:tracing / Perfetto array)
+*/
+int openTrace(const char *path, int format)
+{
+	traceFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+	if (traceFd < 0)
+		return -1;
+	tracePath = strdup(path);
+	traceFormat = format;
+	shellPid = getpid();
+	traceStart = monotonicNanoseconds();
+	if (traceFormat == TRACE_CHROME)
+		appendTrace("[\n", 2);
+	return 0;
+}
+
+/**
+* Function: openSessionTrace
+* -------------------------------------------
+* In a command server's session, continues the trace in a file of its own, the server's path followed by
+* '.' and the session's pid, so that neither file ends up with another process's events, header or footer.
+* Times still count from the server's start. Returns 0 on success (or when there is no trace) and -1 if
+* the file can't be opened, which stops the session's trace
+*/
+int openSessionTrace()
+{
+	char *serverPath = tracePath;
+	char *path;
+
+	if (traceFd < 0)
+		return 0;
+	// The server wrote its events out before forking, and its file stays its own
+	close(traceFd);
+	traceFd = -1;
+	bufferLength = 0;
+	path = malloc(strlen(serverPath) + 24);
+	sprintf(path, "%s.%d", serverPath, (int) getpid());
+	tracePath = NULL;
+	free(serverPath);
+	traceFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+	if (traceFd < 0)
+	{
+		perror(path);
+		free(path);
+		return -1;
+	}
+	tracePath = path;
+	shellPid = getpid();
+	if (traceFormat == TRACE_CHROME)
+		appendTrace("[\n", 2);
+	return 0;
+}
+
+/**
+* Function: closeTrace
+* -------------------------------------------
+* Writes out any buffered events, finishes the file and closes it
+*/
+void closeTrace()
+{
+	if (traceFd < 0)
+		return;
+	// The closing instant event lets the array end without a trailing comma
+	if (traceFormat == TRACE_CHROME)
+		appendFields("{\"name\":\"exit\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%lld,\"pid\":%d,\"tid\":%d}\n]\n",
+			sinceStart(monotonicNanoseconds()), (int) shellPid, (int) shellPid);
+	flushTrace();
+	close(traceFd);
+	traceFd = -1;
+	free(tracePath);
+	tracePath = NULL;
+}
+
+/**
+* Function: traceEnabled
+* -------------------------------------------
+* Returns 1 if a trace is being written and 0 otherwise
+*/
+int traceEnabled()
+{
+	return traceFd >= 0;
+}
+
+/**
+* Function: markParseStart
+* -------------------------------------------
+* Records that the shell is starting to parse a line; the next command traced is stamped with this time
+*/
+void markParseStart()
+{
+	if (traceFd >= 0)
+		lastParseStart = monotonicNanoseconds();
+}
+
+/**
+* Function: beginCommandTrace
+* -------------------------------------------
+* Starts the trace of a command: its parse time comes from the last markParseStart and its spawn starts now
+*
+* trace - assigned the times recorded so far
+*/
+void beginCommandTrace(struct commandTrace *trace)
+{
+	trace->parseStart = lastParseStart;
+	trace->spawnStart = traceFd >= 0 ? monotonicNanoseconds() : 0;
+	trace->execDone = trace->spawnStart;
+	trace->exitDone = 0;
+}
+
+/**
+* Function: traceCommand
+* -------------------------------------------
+* Buffers the event of a command that just finished; the buffer is written out when full or at closeTrace
+*
+* commandLine - the command as typed
+* pid - the pid of the command's last stage (the shell's own pid for builtins)
+* trace - the parse, spawn and exec times of the command, and its exit time once it was reaped
+* background - 1 = the command ran as a background job
+* terminationStatus - exit value or signal number
+* signalOrTerminated - 0 = normal exit, 1 = signal terminated
+* usage - the resources the command used
+*/
+void traceCommand(
+	const char *commandLine, pid_t pid, const struct commandTrace *trace, int background,
+	int terminationStatus, int signalOrTerminated, const struct rusage *usage)
+{
+	long long exitTime;
+
+	if (traceFd < 0)
+		return;
+	exitTime = sinceStart(trace->exitDone != 0 ? trace->exitDone : monotonicNanoseconds());
+
+	if (traceFormat == TRACE_CHROME)
+	{
+		// One complete event per command; the command name alone keeps the timeline readable
+		appendTrace("{\"name\":", 8);
+		appendJsonString(commandLine, strcspn(commandLine, " "));
+		appendFields(",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%d",
+			background ? "background" : "foreground", sinceStart(trace->spawnStart),
+			exitTime - sinceStart(trace->spawnStart), (int) shellPid, (int) pid);
+		appendTrace(",\"args\":{\"command\":", 19);
+		appendJsonString(commandLine, strlen(commandLine));
+	}
+	else
+	{
+		appendTrace("{\"command\":", 11);
+		appendJsonString(commandLine, strlen(commandLine));
+		appendFields(",\"pid\":%d,\"background\":%s,\"spawn_us\":%lld,\"exit_us\":%lld",
+			(int) pid, background ? "true" : "false", sinceStart(trace->spawnStart), exitTime);
+	}
+
+	appendFields(",\"parse_us\":%lld,\"exec_us\":%lld,\"status\":%d,\"signaled\":%s",
+		sinceStart(trace->parseStart), sinceStart(trace->execDone), terminationStatus,
+		signalOrTerminated ? "true" : "false");
+	appendFields(",\"user_us\":%lld,\"sys_us\":%lld,\"maxrss_kb\":%ld,\"minflt\":%ld,\"majflt\":%ld"
+		",\"nvcsw\":%ld,\"nivcsw\":%ld",
+		(long long) usage->ru_utime.tv_sec * 1000000 + usage->ru_utime.tv_usec,
+		(long long) usage->ru_stime.tv_sec * 1000000 + usage->ru_stime.tv_usec,
+		usage->ru_maxrss, usage->ru_minflt, usage->ru_majflt, usage->ru_nvcsw, usage->ru_nivcsw);
+	if (traceFormat == TRACE_CHROME)
+		appendTrace("}},\n", 4);
+	else
+		appendTrace("}\n", 2);
+}
@@ -0,0 +1,96 @@
+/***********************************************************************************************************
+ * Filename: trace.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for the execution trace written when TINYSH_TRACE or --trace is set
+ **********************************************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <sys/types.h>
+#include <sys/resource.h>
+
+#define TRACE_JSON_LINES 0
+#define TRACE_CHROME 1
+
+#define TRACE_BUFFER_SIZE 65536
+
+// Monotonic times (nanoseconds) of the steps a command goes through before it exits
+struct commandTrace
+{
+	unsigned long long parseStart;
+	unsigned long long spawnStart;
+	unsigned long long execDone;	// when the last stage had exec'd
+	unsigned long long exitDone;	// when the last process was reaped; 0 = when the event is traced
+};
+
+/**
+* Function: openTrace
+* -------------------------------------------
+* Starts writing one event per command to a file; returns 0 on success and -1 if the file can't be opened
+*
+* path - the file to write (created or truncated)
+* format - TRACE_JSON_LINES (one JSON object per line) or TRACE_CHROME (about:tracing / Perfetto array)
+*/
+int openTrace(const char *path, int format);
+/**
+* Function: openSessionTrace
+* -------------------------------------------
+* In a command server's session, continues the trace in a file of its own, the server's path followed by
+* '.' and the session's pid, so that neither file ends up with another process's events, header or footer.
+* Times still count from the server's start. Returns 0 on success (or when there is no trace) and -1 if
+* the file can't be opened, which stops the session's trace
+*/
+int openSessionTrace();
+/**
+* Function: flushTrace
+* -------------------------------------------
+* Writes the buffered events to the trace file, so a process forked next doesn't inherit them
+*/
+void flushTrace();
+/**
+* Function: closeTrace
+* -------------------------------------------
+* Writes out any buffered events, finishes the file and closes it
+*/
+void closeTrace();
+/**
+* Function: traceEnabled
+* -------------------------------------------
+* Returns 1 if a trace is being written and 0 otherwise
+*/
+int traceEnabled();
+/**
+* Function: markParseStart
+* -------------------------------------------
+* Records that the shell is starting to parse a line; the next command traced is stamped with this time
+*/
+void markParseStart();
+/**
+* Function: beginCommandTrace
+* -------------------------------------------
+* Starts the trace of a command: its parse time comes from the last markParseStart and its spawn starts now
+*
+* trace - assigned the times recorded so far
+*/
+void beginCommandTrace(struct commandTrace *trace);
+/**
+* Function: traceCommand
+* -------------------------------------------
+* Buffers the event of a command that just finished; the buffer is written out when full or at closeTrace
+*
+* commandLine - the command as typed
+* pid - the pid of the command's last stage (the shell's own pid for builtins)
+* trace - the parse, spawn and exec times of the command, and its exit time once it was reaped
+* background - 1 = the command ran as a background job
+* terminationStatus - exit value or signal number
+* signalOrTerminated - 0 = normal exit, 1 = signal terminated
+* usage - the resources the command used
+*/
+void traceCommand(
+	const char *commandLine, pid_t pid, const struct commandTrace *trace, int background,
+	int terminationStatus, int signalOrTerminated, const struct rusage *usage);
+
+#endif /* TRACE_H_ */
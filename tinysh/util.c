@@ -6,6 +6,8 @@
  * Description: Contains implementations for utility functions used by other components of the program
  **********************************************************************************************************/
 
+#include "variables.h"
+
 #include <dirent.h>
 #include <errno.h>
 #include <unistd.h>
@@ -16,46 +18,42 @@
 #include <string.h>
 #include<fcntl.h> 
 #include <signal.h>
+#include <time.h>
+#include <sys/resource.h>
 
 /**
-* Function: redirectStdout
+* Function: openOutputRedirect
 * -------------------------------------------
-* Redirects standard out to a given file and returns file descriptor to close later
+* Opens (creating and truncating) the file standard out should be redirected to and returns its file
+* descriptor, -1 if the file can't be opened, or -2 when no redirection was requested. The descriptor is
+* close-on-exec; the spawn path dup2's it onto the child's standard out
 *
 * redirectOutput - 0 = no, don't redirect stdout; 1 = yes, redirect away
 * outputRedirect - the name of the file to redirect output to
 */
-int redirectStdout(int redirectOutput, char *outputRedirect)
+int openOutputRedirect(int redirectOutput, char *outputRedirect)
 {
 	if (redirectOutput)
-	{
-		int fileDesc = open(outputRedirect, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
-		dup2(fileDesc, 1);
-
-		return fileDesc;
-	}
+		return open(outputRedirect, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
 
-	return 0;
+	return -2;
 }
 /**
-* Function: redirectStdin
+* Function: openInputRedirect
 * -------------------------------------------
-* Redirects standard in from a given file and returns file descriptor to close later
+* Opens the file standard in should be redirected from and returns its file descriptor, -1 if the file
+* can't be opened, or -2 when no redirection was requested. The descriptor is close-on-exec; the spawn path
+* dup2's it onto the child's standard in
 *
 * redirectInput - 0 = no, don't redirect stdin; 1 = yes, redirect away
-* outputRedirect - the name of the file to redirect output to
+* inputRedirect - the name of the file to redirect input from
 */
-int redirectStdin(int redirectInput, char *inputRedirect)
+int openInputRedirect(int redirectInput, char *inputRedirect)
 {
 	if (redirectInput)
-	{
-		int fileDesc = open(inputRedirect, O_RDONLY);
-		dup2(fileDesc, 0);
-
-		return fileDesc;
-	}
+		return open(inputRedirect, O_RDONLY | O_CLOEXEC);
 
-	return 0;
+	return -2;
 }
 
 /**
@@ -105,8 +103,8 @@ void handle_SIGINT(int signo){
 void assignHomeDirectory(char *homeDirectory)
 {
 	const char *tmp;
-	// Check HOME environment variable first
-	if ((tmp = getenv("HOME")) == NULL)
+	// Check the HOME variable first
+	if ((tmp = getVariable("HOME")) == NULL)
 		// If HOME env variable empty then check the password entry of current user
     	tmp = getpwuid(getuid())->pw_dir;
     strcpy(homeDirectory, tmp);
@@ -147,148 +145,161 @@ void travelToDirectory(char *destinationDirectory)
 }
 
 /**
-* Function: initializeDynamicPidArray
+* Function: resolveBackgroundRun
 * -------------------------------------------
-* Dynamically allocated space for an array of pid pointers
+* Given a foreground only mode indicator, this returns whether the process is allowed to run in background 
+* or not
 *
-* initialSize - the beginning length to make the array
+* foregrounfOnly - indicator for current mode (1 = in foreground only; 0 = not in foreground only)
+* runInBackground - indicator parsed from input for background run or not
 */
-pid_t * initializeDynamicPidArray(int initialSize)
+int resolveBackgroundRun(int foregroundOnly, int runInBackground)
 {
-	return malloc(sizeof(pid_t) * initialSize);
+	if (foregroundOnly == 1)
+		return 0;
+	else
+		return runInBackground;
 }
 
 /**
-* Function: assignPidToArray
+* Function: writeAll
 * -------------------------------------------
-* Assigns the value at the index of arrayFrom to arrayTo
+* Writes every byte of a buffer to a file descriptor, continuing after short writes and interruptions;
+* returns the number of bytes written or -1 on error
 *
-* arrayTo - an array of pid ids to assign value to
-* arrayFrom - an array of pid ids to assign value from
-* index - the index of the value that will be assigned
+* fd - the file descriptor to write to
+* data - the bytes to write
+* length - the number of bytes
 */
-void assignPidToArray(pid_t *arrayTo, pid_t *arrayFrom, int index)
+ssize_t writeAll(int fd, const void *data, size_t length)
 {
-	arrayTo[index] = arrayFrom[index];
+	size_t written = 0;
+	ssize_t result;
+
+	while (written < length)
+	{
+		result = write(fd, (const char *) data + written, length - written);
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		written += result;
+	}
+	return written;
 }
 
 /**
-* Function: freeDynamicArray
+* Function: addTime
 * -------------------------------------------
-* Deallocated dynamic memory allocated to an array
+* Adds one timeval to another
 *
-* array - a dynamically allocated array of any type
+* total - the time to add to
+* time - the time to add
 */
-void freeDynamicArray(void *array)
+static void addTime(struct timeval *total, const struct timeval *time)
 {
-	free(array);
+	total->tv_sec += time->tv_sec;
+	total->tv_usec += time->tv_usec;
+	if (total->tv_usec >= 1000000)
+	{
+		total->tv_sec++;
+		total->tv_usec -= 1000000;
+	}
 }
 
 /**
-* Function: resizeDynamicArrayOfPids
+* Function: subtractTime
 * -------------------------------------------
-* Makes room for additional items in an existing array by creating new array
-* and copying the items over
+* Subtracts one timeval from another
 *
-* array - an array of pid ids
-* currentSize - the current size of the pid array
-* maxSize - the maximum size the array is allowed to get
+* total - the time to subtract from
+* time - the time to subtract
 */
-void resizeDynamicArrayOfPids(pid_t *array, int currentSize, int *maxSize) {
-	// Only resize if the current size of array is at maximum
-	if (currentSize == *maxSize)
+static void subtractTime(struct timeval *total, const struct timeval *time)
+{
+	total->tv_sec -= time->tv_sec;
+	total->tv_usec -= time->tv_usec;
+	if (total->tv_usec < 0)
 	{
-		pid_t *tmpArray = NULL;
-
-		// Dynamically allocate a new array of pointers
-		int newMaxSize = *maxSize * 2;
-		tmpArray = realloc(array, newMaxSize);
-
-		// Point the new array to existing pointers
-		int i;
-		for (i = 0; i < currentSize; i++)
-		{
-			assignPidToArray(tmpArray, array, i);
-		}
-
-		// Free up old array, assign new max size, and repoint old array to new resized one
-		*maxSize = newMaxSize;
-		//freeDynamicArray(array);
-		array = tmpArray;
+		total->tv_sec--;
+		total->tv_usec += 1000000;
 	}
 }
 
 /**
-* Function: appendPidToArray
+* Function: addResourceUsage
 * -------------------------------------------
-* Appends a pid id to the end of an existing array
+* Adds the times, page faults and context switches of one process to a total; the peak resident set size
+* is the largest of the two
 *
-* array - an array of pid ids
-* newPid - a new pid id to append
-* currentSize - a pointer to the current size of the pid array
-* maxNumber - a pointer to the max size the array is allocated for
+* total - the usage to add to
+* usage - the usage of the process, as reported by wait4
 */
-void appendPidToArray(pid_t *array, pid_t newPid, int *currentSize, int *maxNumber)
+void addResourceUsage(struct rusage *total, const struct rusage *usage)
 {
-	// Resize the array if necessary to make room for one more pid
-	resizeDynamicArrayOfPids(array, *currentSize, maxNumber);
-	// Append the pid to the end of the array
-	array[*currentSize] = newPid;
-	*currentSize += 1;
+	addTime(&total->ru_utime, &usage->ru_utime);
+	addTime(&total->ru_stime, &usage->ru_stime);
+	if (usage->ru_maxrss > total->ru_maxrss)
+		total->ru_maxrss = usage->ru_maxrss;
+	total->ru_minflt += usage->ru_minflt;
+	total->ru_majflt += usage->ru_majflt;
+	total->ru_nvcsw += usage->ru_nvcsw;
+	total->ru_nivcsw += usage->ru_nivcsw;
 }
 
 /**
-* Function: removePidFromArray
+* Function: subtractResourceUsage
 * -------------------------------------------
-* Removes a pid id from a given array of pid ids
+* Turns a getrusage reading into the difference from an earlier reading (the peak resident set size is
+* left as read)
 *
-* array - an array of pid ids
-* pidToRemove - a pid id to find and delete
-* currentSize - a pointer to the current size of the pid array
+* usage - the later reading; assigned the difference
+* before - the earlier reading
 */
-void removePidFromArray(pid_t *array, pid_t pidToRemove, int *currentSize)
+void subtractResourceUsage(struct rusage *usage, const struct rusage *before)
 {
-	int i;
-	// Iterate over each item in array to find and remove a given pid
-	for (i = 0; i < *currentSize; i++)
-	{
-		// If it's last item in array just set to 0 and decrement size by 1
-		if ((i == *currentSize - 1) && (array[i] == pidToRemove))
-		{
-			array[i] = 0;
-			*currentSize=*currentSize - 1;
-		}
-		// If it's not the last item then we need to shift all subsequent items back by one
-		else if (array[i] == pidToRemove)
-		{
-			// Iterate over all indeces after the current one for the pid to remove
-			int j = i;
-			for (j = i; j < *currentSize; j++)
-			{
-				// Assign value at current index to value at next index as long as next is not last
-				if (j+1 < *currentSize)
-					array[j] = array[j + 1];
-			}
-			// Assign 0 to last index and decrement size of array by 1
-			array[j + 1] = 0;
-			*currentSize=*currentSize - 1;
-		}
-	}
+	subtractTime(&usage->ru_utime, &before->ru_utime);
+	subtractTime(&usage->ru_stime, &before->ru_stime);
+	usage->ru_minflt -= before->ru_minflt;
+	usage->ru_majflt -= before->ru_majflt;
+	usage->ru_nvcsw -= before->ru_nvcsw;
+	usage->ru_nivcsw -= before->ru_nivcsw;
 }
 
 /**
-* Function: resolveBackgroundRun
+* Function: printResourceUsage
 * -------------------------------------------
-* Given a foreground only mode indicator, this returns whether the process is allowed to run in background 
-* or not
+* Prints the wall clock time since startTime followed by the user and system time, peak resident set size,
+* page faults and context switches of a command
 *
-* foregrounfOnly - indicator for current mode (1 = in foreground only; 0 = not in foreground only)
-* runInBackground - indicator parsed from input for background run or not
+* outputFd - the file descriptor to print to
+* startTime - the CLOCK_MONOTONIC time the command was started
+* usage - the resources the command used
 */
-int resolveBackgroundRun(int foregroundOnly, int runInBackground)
+void printResourceUsage(int outputFd, const struct timespec *startTime, const struct rusage *usage)
 {
-	if (foregroundOnly == 1)
-		return 0;
-	else
-		return runInBackground;
-}
\ No newline at end of file
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	dprintf(outputFd,
+		"real\t%.3fs\nuser\t%.3fs\nsys\t%.3fs\nmaxrss\t%ld KiB\n"
+		"faults\t%ld minor, %ld major\nswitches\t%ld voluntary, %ld involuntary\n",
+		(now.tv_sec - startTime->tv_sec) + (now.tv_nsec - startTime->tv_nsec) / 1e9,
+		usage->ru_utime.tv_sec + usage->ru_utime.tv_usec / 1e6,
+		usage->ru_stime.tv_sec + usage->ru_stime.tv_usec / 1e6,
+		usage->ru_maxrss, usage->ru_minflt, usage->ru_majflt, usage->ru_nvcsw, usage->ru_nivcsw);
+}
+
+/**
+* Function: monotonicNanoseconds
+* -------------------------------------------
+* Returns the current reading of the monotonic clock in nanoseconds
+*/
+unsigned long long monotonicNanoseconds()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
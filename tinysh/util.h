@@ -10,25 +10,31 @@
 #define UTIL_H_
 
 #include <sys/types.h>
+#include <sys/resource.h>
+#include <time.h>
 
 /**
-* Function: redirectStdout
+* Function: openOutputRedirect
 * -------------------------------------------
-* Redirects standard out to a given file and returns file descriptor to close later
+* Opens (creating and truncating) the file standard out should be redirected to and returns its file
+* descriptor, -1 if the file can't be opened, or -2 when no redirection was requested. The descriptor is
+* close-on-exec; the spawn path dup2's it onto the child's standard out
 *
 * redirectOutput - 0 = no, don't redirect stdout; 1 = yes, redirect away
 * outputRedirect - the name of the file to redirect output to
 */
-int redirectStdout(int redirectOutput, char *outputRedirect);
+int openOutputRedirect(int redirectOutput, char *outputRedirect);
 /**
-* Function: redirectStdin
+* Function: openInputRedirect
 * -------------------------------------------
-* Redirects standard in from a given file and returns file descriptor to close later
+* Opens the file standard in should be redirected from and returns its file descriptor, -1 if the file
+* can't be opened, or -2 when no redirection was requested. The descriptor is close-on-exec; the spawn path
+* dup2's it onto the child's standard in
 *
 * redirectInput - 0 = no, don't redirect stdin; 1 = yes, redirect away
-* outputRedirect - the name of the file to redirect output to
+* inputRedirect - the name of the file to redirect input from
 */
-int redirectStdin(int redirectInput, char *inputRedirect);
+int openInputRedirect(int redirectInput, char *inputRedirect);
 /**
 * Function: closeFile
 * -------------------------------------------
@@ -71,44 +77,62 @@ void assignHomeDirectory(char *homeDirectory);
 */
 void travelToDirectory(char *destinationDirectory);
 /**
-* Function: initializeDynamicPidArray
+* Function: resolveBackgroundRun
 * -------------------------------------------
-* Dynamically allocated space for an array of pid status pointers
+* Given a foreground only mode indicator, this returns whether the process is allowed to run in background 
+* or not
 *
-* arrayIn - the array to initialize
-* initialSize - the beginning length to make the array
+* foregrounfOnly - indicator for current mode (1 = in foreground only; 0 = not in foreground only)
+* runInBackground - indicator parsed from input for background run or not
 */
-pid_t * initializeDynamicPidArray(int initialSize);
+int resolveBackgroundRun(int foregroundOnly, int runInBackground);
 /**
-* Function: appendPidToArray
+* Function: writeAll
 * -------------------------------------------
-* Appends a pid id to the end of an existing array
+* Writes every byte of a buffer to a file descriptor, continuing after short writes and interruptions;
+* returns the number of bytes written or -1 on error
 *
-* array - an array of pid ids
-* newPid - a new pid id to append
-* currentSize - a pointer to the current size of the pid array
-* maxNumber - a pointer to the max size the array is allocated for
+* fd - the file descriptor to write to
+* data - the bytes to write
+* length - the number of bytes
 */
-void appendPidToArray(pid_t *array, pid_t newPid, int *currentSize, int *maxNumber);
+ssize_t writeAll(int fd, const void *data, size_t length);
 /**
-* Function: removePidFromArray
+* Function: addResourceUsage
 * -------------------------------------------
-* Removes a pid id from a given array of pid ids
+* Adds the times, page faults and context switches of one process to a total; the peak resident set size
+* is the largest of the two
 *
-* array - an array of pid ids
-* pidToRemove - a pid id to find and delete
-* currentSize - a pointer to the current size of the pid array
+* total - the usage to add to
+* usage - the usage of the process, as reported by wait4
 */
-void removePidFromArray(pid_t *array, pid_t pidToRemove, int *currentSize);
+void addResourceUsage(struct rusage *total, const struct rusage *usage);
 /**
-* Function: resolveBackgroundRun
+* Function: subtractResourceUsage
 * -------------------------------------------
-* Given a foreground only mode indicator, this returns whether the process is allowed to run in background 
-* or not
+* Turns a getrusage reading into the difference from an earlier reading (the peak resident set size is
+* left as read)
 *
-* foregrounfOnly - indicator for current mode (1 = in foreground only; 0 = not in foreground only)
-* runInBackground - indicator parsed from input for background run or not
+* usage - the later reading; assigned the difference
+* before - the earlier reading
 */
-int resolveBackgroundRun(int foregroundOnly, int runInBackground);
+void subtractResourceUsage(struct rusage *usage, const struct rusage *before);
+/**
+* Function: printResourceUsage
+* -------------------------------------------
+* Prints the wall clock time since startTime followed by the user and system time, peak resident set size,
+* page faults and context switches of a command
+*
+* outputFd - the file descriptor to print to
+* startTime - the CLOCK_MONOTONIC time the command was started
+* usage - the resources the command used
+*/
+void printResourceUsage(int outputFd, const struct timespec *startTime, const struct rusage *usage);
+/**
+* Function: monotonicNanoseconds
+* -------------------------------------------
+* Returns the current reading of the monotonic clock in nanoseconds
+*/
+unsigned long long monotonicNanoseconds();
 
 #endif /* UTIL_H_ */
@@ -0,0 +1,672 @@
+/***********************************************************************************************************
+ * Filename: variables.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements shell variables. Every variable, exported or not, lives in one open-addressing
+ * hash table with linear probing; removed entries leave a tombstone so probe chains stay intact, and the
+ * table doubles once live entries and tombstones fill 3/4 of it. The environment of spawned commands is
+ * built from the exported variables on demand and kept until an exported variable changes, so a script
+ * spawning many commands serializes the environment once rather than on every spawn.
+ **********************************************************************************************************/
+
+#include "variables.h"
+#include "functions.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define VARIABLE_NUMBER_SIZE 24
+
+struct variable
+{
+	char *name;					// NULL for a slot that is empty or a tombstone
+	char *value;				// NULL for a variable that is declared (exported) but not set
+	unsigned int hash;
+	int exported;
+	int deleted;				// 1 = tombstone: keep probing past this slot
+};
+
+static struct variable *slots = NULL;
+static int numberOfSlots = 0;
+static int numberOfUsedSlots = 0;		// live entries and tombstones
+static int numberOfVariables = 0;
+
+static struct shellStatus *shellStatus = NULL;
+static char processId[VARIABLE_NUMBER_SIZE];
+static char lastStatus[VARIABLE_NUMBER_SIZE];
+
+// $0 and the arguments of the running function, or of the script outside functions
+static char *noArguments[] = { NULL };
+static struct positionalParameters positional = { "smallsh", noArguments, 0 };
+static char parameterCount[VARIABLE_NUMBER_SIZE];
+static char *joinedParameters = NULL;
+static size_t joinedCapacity = 0;
+
+static char **environment = NULL;
+static int environmentStale = 1;
+static unsigned long rebuilds = 0;
+
+/**
+* Function: hashName
+* -------------------------------------------
+* Returns the FNV-1a hash of a variable name
+*
+* name - the name, not necessarily terminated
+* length - the number of bytes of name
+*/
+static unsigned int hashName(const char *name, size_t length)
+{
+	unsigned int hash = 2166136261u;
+	while (length-- > 0)
+	{
+		hash ^= (unsigned char) *name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* Function: findSlot
+* -------------------------------------------
+* Returns the slot holding a variable, or -1 if there is none
+*
+* name - the name, not necessarily terminated
+* length - the number of bytes of name
+* hash - the hash of name
+*/
+static int findSlot(const char *name, size_t length, unsigned int hash)
+{
+	int mask = numberOfSlots - 1;
+	int slot;
+
+	if (numberOfSlots == 0)
+		return -1;
+	// Probing ends at the first slot that never held anything
+	for (slot = hash & mask; slots[slot].name != NULL || slots[slot].deleted; slot = (slot + 1) & mask)
+	{
+		if (slots[slot].name != NULL && slots[slot].hash == hash &&
+			strncmp(slots[slot].name, name, length) == 0 && slots[slot].name[length] == 0)
+			return slot;
+	}
+	return -1;
+}
+
+/**
+* Function: freeSlot
+* -------------------------------------------
+* Returns the first reusable slot (empty or tombstone) on the probe sequence of a hash
+*
+* hash - the hash of the name to insert
+*/
+static int freeSlot(unsigned int hash)
+{
+	int mask = numberOfSlots - 1;
+	int slot = hash & mask;
+	while (slots[slot].name != NULL)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+/**
+* Function: growTable
+* -------------------------------------------
+* Doubles the table (or creates it) and reinserts the live variables, dropping every tombstone
+*/
+static void growTable()
+{
+	struct variable *oldSlots = slots;
+	int oldNumberOfSlots = numberOfSlots;
+	int i;
+
+	numberOfSlots = numberOfSlots ? numberOfSlots * 2 : VARIABLE_STARTING_SLOTS;
+	// Only tombstones crowding the table: rebuilding at the same size is enough
+	if (numberOfVariables * 2 < oldNumberOfSlots)
+		numberOfSlots = oldNumberOfSlots;
+	slots = calloc(numberOfSlots, sizeof(struct variable));
+	numberOfUsedSlots = numberOfVariables;
+	for (i = 0; i < oldNumberOfSlots; i++)
+		if (oldSlots[i].name != NULL)
+			slots[freeSlot(oldSlots[i].hash)] = oldSlots[i];
+	free(oldSlots);
+}
+
+/**
+* Function: isValidName
+* -------------------------------------------
+* Returns 1 if the text is a valid variable name: a letter or _ followed by letters, digits and _
+*
+* name - the name, not necessarily terminated
+* length - the number of bytes of name
+*/
+static int isValidName(const char *name, size_t length)
+{
+	size_t i;
+	if (length == 0 || isdigit((unsigned char) name[0]))
+		return 0;
+	for (i = 0; i < length; i++)
+		if (!isalnum((unsigned char) name[i]) && name[i] != '_')
+			return 0;
+	return 1;
+}
+
+/**
+* Function: setVariableLength
+* -------------------------------------------
+* Creates or changes a variable whose name isn't terminated; returns 0 on success and -1 if the name isn't
+* valid
+*
+* name - the name, not necessarily terminated
+* length - the number of bytes of name
+* value - the new value, or NULL to keep the current one
+* exportMode - 1 = export, 0 = stop exporting, VARIABLE_KEEP_EXPORT = leave as it was
+*/
+static int setVariableLength(const char *name, size_t length, const char *value, int exportMode)
+{
+	unsigned int hash = hashName(name, length);
+	int slot;
+	struct variable *variable;
+
+	if (!isValidName(name, length))
+		return -1;
+	slot = findSlot(name, length, hash);
+	if (slot < 0)
+	{
+		if ((numberOfUsedSlots + 1) * 4 > numberOfSlots * 3)
+			growTable();
+		slot = freeSlot(hash);
+		variable = &slots[slot];
+		if (!variable->deleted)
+			numberOfUsedSlots++;
+		variable->name = strndup(name, length);
+		variable->value = NULL;
+		variable->hash = hash;
+		variable->exported = 0;
+		variable->deleted = 0;
+		numberOfVariables++;
+	}
+	variable = &slots[slot];
+
+	// Only changes to what the environment holds make it stale
+	if ((variable->exported && value != NULL) || (exportMode >= 0 && exportMode != variable->exported))
+		environmentStale = 1;
+	if (value != NULL)
+	{
+		free(variable->value);
+		variable->value = strdup(value);
+	}
+	if (exportMode >= 0)
+		variable->exported = exportMode;
+	return 0;
+}
+
+/**
+* Function: initializeVariables
+* -------------------------------------------
+* Fills the variable table from the environment the shell was started with, every entry exported
+*
+* environment - the shell's environment, NAME=VALUE strings ending with NULL
+* status - the shell's status, read when $? is expanded
+*/
+void initializeVariables(char **startingEnvironment, struct shellStatus *status)
+{
+	char *separator;
+	int i;
+
+	shellStatus = status;
+	snprintf(processId, sizeof(processId), "%d", (int) getpid());
+	for (i = 0; startingEnvironment[i] != NULL; i++)
+	{
+		separator = strchr(startingEnvironment[i], '=');
+		if (separator != NULL)
+			setVariableLength(startingEnvironment[i], separator - startingEnvironment[i], separator + 1, 1);
+	}
+}
+
+/**
+* Function: positionalParameter
+* -------------------------------------------
+* Returns the value of $0, $1 ... $N or NULL past the last argument
+*
+* digits - the number, not necessarily terminated
+* length - the number of digits
+*/
+static const char * positionalParameter(const char *digits, size_t length)
+{
+	size_t index = 0;
+	size_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		index = index * 10 + (digits[i] - '0');
+		if (index > (size_t) positional.count)
+			return NULL;
+	}
+	return index == 0 ? positional.name : positional.args[index - 1];
+}
+
+/**
+* Function: joinParameters
+* -------------------------------------------
+* Returns the arguments $1 ... $N joined by spaces, as $@ and $* expand inside a word
+*/
+static const char * joinParameters()
+{
+	size_t length = 0;
+	size_t argumentLength;
+	int i;
+
+	for (i = 0; i < positional.count; i++)
+		length += strlen(positional.args[i]) + 1;
+	if (length + 1 > joinedCapacity)
+	{
+		joinedCapacity = length + 1;
+		joinedParameters = realloc(joinedParameters, joinedCapacity);
+	}
+	length = 0;
+	for (i = 0; i < positional.count; i++)
+	{
+		if (i > 0)
+			joinedParameters[length++] = ' ';
+		argumentLength = strlen(positional.args[i]);
+		memcpy(joinedParameters + length, positional.args[i], argumentLength);
+		length += argumentLength;
+	}
+	joinedParameters[length] = 0;
+	return joinedParameters;
+}
+
+/**
+* Function: lookupVariable
+* -------------------------------------------
+* Returns the value of a variable or NULL if it isn't set. Besides named variables, "$" is the shell's pid,
+* "?" the status of the last command (128 + N after signal N), "0" to "N" the positional parameters, "#"
+* their count and "@" or "*" all of them joined by spaces. The value is valid until the variable is next
+* changed
+*
+* name - the name, not necessarily terminated
+* length - the number of bytes of name
+*/
+const char * lookupVariable(const char *name, size_t length)
+{
+	int slot;
+
+	if (length == 1 && name[0] == '$')
+		return processId;
+	if (length == 1 && name[0] == '?')
+	{
+		if (shellStatus == NULL)
+			return "0";
+		snprintf(lastStatus, sizeof(lastStatus), "%d", shellStatus->signalOrTerminated ?
+			128 + shellStatus->terminationStatus : shellStatus->terminationStatus);
+		return lastStatus;
+	}
+	if (length == 1 && name[0] == '#')
+	{
+		snprintf(parameterCount, sizeof(parameterCount), "%d", positional.count);
+		return parameterCount;
+	}
+	if (length == 1 && (name[0] == '@' || name[0] == '*'))
+		return joinParameters();
+	if (length > 0 && isdigit((unsigned char) name[0]))
+		return positionalParameter(name, length);
+	slot = findSlot(name, length, hashName(name, length));
+	return slot < 0 ? NULL : slots[slot].value;
+}
+
+/**
+* Function: getVariable
+* -------------------------------------------
+* Returns the value of a variable or NULL if it isn't set; the shell's own counterpart of getenv
+*
+* name - the name of the variable
+*/
+const char * getVariable(const char *name)
+{
+	return lookupVariable(name, strlen(name));
+}
+
+/**
+* Function: setVariable
+* -------------------------------------------
+* Creates or changes a variable; returns 0 on success and -1 if the name isn't valid
+*
+* name - the name: a letter or _ followed by letters, digits and _
+* value - the new value, or NULL to keep the current one (a variable that has none is only declared)
+* exportMode - 1 = export, 0 = stop exporting, VARIABLE_KEEP_EXPORT = leave as it was
+*/
+int setVariable(const char *name, const char *value, int exportMode)
+{
+	return setVariableLength(name, strlen(name), value, exportMode);
+}
+
+/**
+* Function: unsetVariable
+* -------------------------------------------
+* Removes a variable if it exists
+*
+* name - the name of the variable
+*/
+void unsetVariable(const char *name)
+{
+	size_t length = strlen(name);
+	int slot = findSlot(name, length, hashName(name, length));
+
+	if (slot < 0)
+		return;
+	if (slots[slot].exported && slots[slot].value != NULL)
+		environmentStale = 1;
+	free(slots[slot].name);
+	free(slots[slot].value);
+	memset(&slots[slot], 0, sizeof(struct variable));
+	slots[slot].deleted = 1;
+	numberOfVariables--;
+}
+
+/**
+* Function: isAssignment
+* -------------------------------------------
+* Returns 1 if a word has the form NAME=value with a valid name and 0 otherwise
+*
+* word - the word to check
+*/
+int isAssignment(const char *word)
+{
+	const char *separator = strchr(word, '=');
+	return separator != NULL && isValidName(word, separator - word);
+}
+
+/**
+* Function: assignVariable
+* -------------------------------------------
+* Sets a variable from a NAME=value word, keeping whether it is exported
+*
+* word - a word for which isAssignment returns 1
+*/
+void assignVariable(const char *word)
+{
+	const char *separator = strchr(word, '=');
+	setVariableLength(word, separator - word, separator + 1, VARIABLE_KEEP_EXPORT);
+}
+
+/**
+* Function: swapPositionalParameters
+* -------------------------------------------
+* Exchanges the positional parameters in use with the given ones: a function call swaps its arguments in
+* and the same call afterwards swaps the caller's back, so no frame is ever copied
+*
+* parameters - the parameters to use; assigned the ones they replace
+*/
+void swapPositionalParameters(struct positionalParameters *parameters)
+{
+	struct positionalParameters previous = positional;
+
+	positional = *parameters;
+	*parameters = previous;
+}
+
+/**
+* Function: currentPositionalParameters
+* -------------------------------------------
+* Returns the positional parameters in use, valid until they are next shifted or swapped
+*/
+const struct positionalParameters * currentPositionalParameters()
+{
+	return &positional;
+}
+
+/**
+* Function: expansionStatus
+* -------------------------------------------
+* Returns the shell's status given to initializeVariables, which $? reads and command substitutions
+* assign; NULL before the variables are initialized
+*/
+struct shellStatus * expansionStatus()
+{
+	return shellStatus;
+}
+
+/**
+* Function: exportedEnvironment
+* -------------------------------------------
+* Returns the environment for a spawned command: NAME=VALUE strings of every exported variable that has a
+* value, ending with NULL. The array is only rebuilt when an exported variable changed since it was last
+* built, so back-to-back spawns share one copy; it stays valid until the next call after such a change
+*/
+char ** exportedEnvironment()
+{
+	int numberOfEntries = 0;
+	size_t textSize = 0;
+	size_t nameLength;
+	size_t valueLength;
+	char *text;
+	int i;
+
+	if (!environmentStale)
+		return environment;
+
+	for (i = 0; i < numberOfSlots; i++)
+	{
+		if (slots[i].name != NULL && slots[i].exported && slots[i].value != NULL)
+		{
+			numberOfEntries++;
+			textSize += strlen(slots[i].name) + strlen(slots[i].value) + 2;
+		}
+	}
+	// The pointers and the strings they point to share a single allocation
+	free(environment);
+	environment = malloc(sizeof(char *) * (numberOfEntries + 1) + textSize);
+	text = (char *) (environment + numberOfEntries + 1);
+	numberOfEntries = 0;
+	for (i = 0; i < numberOfSlots; i++)
+	{
+		if (slots[i].name == NULL || !slots[i].exported || slots[i].value == NULL)
+			continue;
+		environment[numberOfEntries++] = text;
+		nameLength = strlen(slots[i].name);
+		valueLength = strlen(slots[i].value);
+		memcpy(text, slots[i].name, nameLength);
+		text[nameLength] = '=';
+		memcpy(text + nameLength + 1, slots[i].value, valueLength + 1);
+		text += nameLength + valueLength + 2;
+	}
+	environment[numberOfEntries] = NULL;
+	environmentStale = 0;
+	rebuilds++;
+	return environment;
+}
+
+/**
+* Function: environmentRebuilds
+* -------------------------------------------
+* Returns how many times the environment of spawned commands has been built
+*/
+unsigned long environmentRebuilds()
+{
+	return rebuilds;
+}
+
+/**
+* Function: compareVariables
+* -------------------------------------------
+* Orders two variables by name for qsort
+*
+* first - points to a pointer to the first variable
+* second - points to a pointer to the second variable
+*/
+static int compareVariables(const void *first, const void *second)
+{
+	return strcmp((*(struct variable * const *) first)->name, (*(struct variable * const *) second)->name);
+}
+
+/**
+* Function: printQuoted
+* -------------------------------------------
+* Prints a value so that it reads back as the same word: as is when it has no special characters and in
+* single quotes otherwise
+*
+* outputFd - the file descriptor to print to
+* value - the value to print
+*/
+static void printQuoted(int outputFd, const char *value)
+{
+	if (*value != 0 && strpbrk(value, " \t\n\\'\"|<>&;()$`*?[]#~!{}") == NULL)
+	{
+		dprintf(outputFd, "%s", value);
+		return;
+	}
+	dprintf(outputFd, "'");
+	for (; *value != 0; value++)
+	{
+		if (*value == '\'')
+			dprintf(outputFd, "'\\''");
+		else
+			dprintf(outputFd, "%c", *value);
+	}
+	dprintf(outputFd, "'");
+}
+
+/**
+* Function: listVariables
+* -------------------------------------------
+* Prints the variables sorted by name, one per line
+*
+* outputFd - the file descriptor to print to
+* exportedOnly - 1 = only exported variables, each as 'export NAME=value'; 0 = every variable with a value
+*/
+static void listVariables(int outputFd, int exportedOnly)
+{
+	struct variable **sorted = malloc(sizeof(struct variable *) * (numberOfVariables + 1));
+	int numberOfSorted = 0;
+	int i;
+
+	for (i = 0; i < numberOfSlots; i++)
+		if (slots[i].name != NULL && (exportedOnly ? slots[i].exported : slots[i].value != NULL))
+			sorted[numberOfSorted++] = &slots[i];
+	qsort(sorted, numberOfSorted, sizeof(struct variable *), compareVariables);
+
+	for (i = 0; i < numberOfSorted; i++)
+	{
+		dprintf(outputFd, "%s%s", exportedOnly ? "export " : "", sorted[i]->name);
+		if (sorted[i]->value != NULL)
+		{
+			dprintf(outputFd, "=");
+			printQuoted(outputFd, sorted[i]->value);
+		}
+		dprintf(outputFd, "\n");
+	}
+	free(sorted);
+}
+
+/**
+* Function: printVariables
+* -------------------------------------------
+* Lists every variable with a value, sorted by name, as NAME=value with the value quoted where needed
+*
+* outputFd - the file descriptor to print to
+*/
+void printVariables(int outputFd)
+{
+	listVariables(outputFd, 0);
+}
+
+/**
+* Function: executeExportCommand
+* -------------------------------------------
+* Defines logic for the 'export' shell command
+*	export                - list the exported variables
+*	export NAME[=VALUE]   - export a variable to commands started afterwards, setting it when given a value
+*	export -n NAME        - stop exporting a variable and keep it in the shell
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - where exported variables are listed
+* status - unused
+*/
+int executeExportCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int exportMode = 1;
+	int result = 0;
+	char *separator;
+	int i = 1;
+
+	if (inputArgs[i] != NULL && strcmp(inputArgs[i], "-n") == 0)
+	{
+		exportMode = 0;
+		i++;
+	}
+	else if (inputArgs[i] != NULL && strcmp(inputArgs[i], "-p") == 0)
+		i++;
+	if (inputArgs[i] == NULL)
+	{
+		listVariables(outputFd, 1);
+		return 0;
+	}
+
+	for (; inputArgs[i] != NULL; i++)
+	{
+		separator = strchr(inputArgs[i], '=');
+		if (setVariableLength(inputArgs[i], separator ? (size_t) (separator - inputArgs[i]) : strlen(inputArgs[i]),
+			separator ? separator + 1 : NULL, exportMode) != 0)
+		{
+			fprintf(stderr, "export: `%s': not a valid identifier\n", inputArgs[i]);
+			result = 1;
+		}
+	}
+	return result;
+}
+
+/**
+* Function: executeUnsetCommand
+* -------------------------------------------
+* Defines logic for the 'unset' shell command, which removes each variable named, or with -f each function
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - unused
+* status - unused
+*/
+int executeUnsetCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int i = 1;
+	int functions = 0;
+
+	if (inputArgs[i] != NULL && (strcmp(inputArgs[i], "-v") == 0 || strcmp(inputArgs[i], "-f") == 0))
+		functions = inputArgs[i++][1] == 'f';
+	for (; inputArgs[i] != NULL; i++)
+	{
+		if (functions)
+			undefineFunction(inputArgs[i]);
+		else
+			unsetVariable(inputArgs[i]);
+	}
+	return 0;
+}
+
+/**
+* Function: executeShiftCommand
+* -------------------------------------------
+* Defines logic for the 'shift' shell command, which drops the first N positional parameters (1 by default)
+* so $2 becomes $1
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - unused
+* status - unused
+*/
+int executeShiftCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status)
+{
+	int count = inputArgs[1] != NULL ? atoi(inputArgs[1]) : 1;
+
+	if (count < 0 || count > positional.count)
+	{
+		printf("shift: %s: shift count out of range\n", inputArgs[1] != NULL ? inputArgs[1] : "1");
+		return 1;
+	}
+	positional.args += count;
+	positional.count -= count;
+	return 0;
+}
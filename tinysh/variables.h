@@ -0,0 +1,174 @@
+/***********************************************************************************************************
+ * Filename: variables.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for shell and exported variables, the environment handed to spawned
+ * commands and the 'export' and 'unset' builtins
+ **********************************************************************************************************/
+
+#ifndef VARIABLES_H_
+#define VARIABLES_H_
+
+#include "shell.h"
+
+#include <stddef.h>
+
+#define VARIABLE_STARTING_SLOTS 64
+// Passed to setVariable to leave a variable exported or not as it was
+#define VARIABLE_KEEP_EXPORT -1
+
+// $0 and the arguments $1 to $N of the running function, or of the script outside functions
+struct positionalParameters
+{
+	char *name;					// $0
+	char **args;				// $1 onwards, ending with NULL
+	int count;					// $#
+};
+
+/**
+* Function: initializeVariables
+* -------------------------------------------
+* Fills the variable table from the environment the shell was started with, every entry exported
+*
+* environment - the shell's environment, NAME=VALUE strings ending with NULL
+* status - the shell's status, read when $? is expanded
+*/
+void initializeVariables(char **environment, struct shellStatus *status);
+/**
+* Function: lookupVariable
+* -------------------------------------------
+* Returns the value of a variable or NULL if it isn't set. Besides named variables, "$" is the shell's pid,
+* "?" the status of the last command (128 + N after signal N), "0" to "N" the positional parameters, "#"
+* their count and "@" or "*" all of them joined by spaces. The value is valid until the variable is next
+* changed
+*
+* name - the name, not necessarily terminated
+* length - the number of bytes of name
+*/
+const char * lookupVariable(const char *name, size_t length);
+/**
+* Function: getVariable
+* -------------------------------------------
+* Returns the value of a variable or NULL if it isn't set; the shell's own counterpart of getenv
+*
+* name - the name of the variable
+*/
+const char * getVariable(const char *name);
+/**
+* Function: setVariable
+* -------------------------------------------
+* Creates or changes a variable; returns 0 on success and -1 if the name isn't valid
+*
+* name - the name: a letter or _ followed by letters, digits and _
+* value - the new value, or NULL to keep the current one (a variable that has none is only declared)
+* exportMode - 1 = export, 0 = stop exporting, VARIABLE_KEEP_EXPORT = leave as it was
+*/
+int setVariable(const char *name, const char *value, int exportMode);
+/**
+* Function: unsetVariable
+* -------------------------------------------
+* Removes a variable if it exists
+*
+* name - the name of the variable
+*/
+void unsetVariable(const char *name);
+/**
+* Function: isAssignment
+* -------------------------------------------
+* Returns 1 if a word has the form NAME=value with a valid name and 0 otherwise
+*
+* word - the word to check
+*/
+int isAssignment(const char *word);
+/**
+* Function: assignVariable
+* -------------------------------------------
+* Sets a variable from a NAME=value word, keeping whether it is exported
+*
+* word - a word for which isAssignment returns 1
+*/
+void assignVariable(const char *word);
+/**
+* Function: swapPositionalParameters
+* -------------------------------------------
+* Exchanges the positional parameters in use with the given ones: a function call swaps its arguments in
+* and the same call afterwards swaps the caller's back, so no frame is ever copied
+*
+* parameters - the parameters to use; assigned the ones they replace
+*/
+void swapPositionalParameters(struct positionalParameters *parameters);
+/**
+* Function: currentPositionalParameters
+* -------------------------------------------
+* Returns the positional parameters in use, valid until they are next shifted or swapped
+*/
+const struct positionalParameters * currentPositionalParameters();
+/**
+* Function: expansionStatus
+* -------------------------------------------
+* Returns the shell's status given to initializeVariables, which $? reads and command substitutions
+* assign; NULL before the variables are initialized
+*/
+struct shellStatus * expansionStatus();
+/**
+* Function: exportedEnvironment
+* -------------------------------------------
+* Returns the environment for a spawned command: NAME=VALUE strings of every exported variable that has a
+* value, ending with NULL. The array is only rebuilt when an exported variable changed since it was last
+* built, so back-to-back spawns share one copy; it stays valid until the next call after such a change
+*/
+char ** exportedEnvironment();
+/**
+* Function: environmentRebuilds
+* -------------------------------------------
+* Returns how many times the environment of spawned commands has been built
+*/
+unsigned long environmentRebuilds();
+/**
+* Function: printVariables
+* -------------------------------------------
+* Lists every variable with a value, sorted by name, as NAME=value with the value quoted where needed
+*
+* outputFd - the file descriptor to print to
+*/
+void printVariables(int outputFd);
+/**
+* Function: executeExportCommand
+* -------------------------------------------
+* Defines logic for the 'export' shell command
+*	export                - list the exported variables
+*	export NAME[=VALUE]   - export a variable to commands started afterwards, setting it when given a value
+*	export -n NAME        - stop exporting a variable and keep it in the shell
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - where exported variables are listed
+* status - unused
+*/
+int executeExportCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executeUnsetCommand
+* -------------------------------------------
+* Defines logic for the 'unset' shell command, which removes each variable named, or with -f each function
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - unused
+* status - unused
+*/
+int executeUnsetCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+/**
+* Function: executeShiftCommand
+* -------------------------------------------
+* Defines logic for the 'shift' shell command, which drops the first N positional parameters (1 by default)
+* so $2 becomes $1
+*
+* inputArgs - contains the arguments given to CLI component
+* inputFd - unused
+* outputFd - unused
+* status - unused
+*/
+int executeShiftCommand(char **inputArgs, int inputFd, int outputFd, struct shellStatus *status);
+
+#endif /* VARIABLES_H_ */
@@ -0,0 +1,501 @@
+/***********************************************************************************************************
+ * Filename: wildcard.c
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Implements filename expansion. A pattern is taken one '/'-separated component at a time.
+ * A component with wildcards is matched against the listing of its directory; that listing is read once
+ * with getdents64, sorted, and kept in a per-line cache, so further patterns in the same directory don't
+ * read it again. Because the listing is sorted, a component with a literal prefix such as "log*" only
+ * visits the entries starting with the prefix, found by binary search. Other components are matched
+ * against every entry once, with a matcher that backtracks only to the last '*'. The work therefore stays
+ * linear in the size of the directory (after an n log n sort) however many entries it has.
+ **********************************************************************************************************/
+
+#define _GNU_SOURCE
+
+#include "wildcard.h"
+#include "cli.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+struct matchList
+{
+	char **paths;
+	int numberOfPaths;
+	int capacity;
+};
+
+/**
+* Function: hashPath
+* -------------------------------------------
+* Returns the FNV-1a hash of a directory path
+*
+* path - the path to hash
+*/
+static unsigned int hashPath(const char *path)
+{
+	unsigned int hash = 2166136261u;
+	while (*path)
+	{
+		hash ^= (unsigned char) *path++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* Function: compareEntries
+* -------------------------------------------
+* Orders two listing entries by name for qsort
+*
+* first - points to the first entry
+* second - points to the second entry
+*/
+static int compareEntries(const void *first, const void *second)
+{
+	return strcmp(((const struct listingEntry *) first)->name, ((const struct listingEntry *) second)->name);
+}
+
+/**
+* Function: comparePaths
+* -------------------------------------------
+* Orders two matched paths for qsort
+*
+* first - points to the first path
+* second - points to the second path
+*/
+static int comparePaths(const void *first, const void *second)
+{
+	return strcmp(*(char * const *) first, *(char * const *) second);
+}
+
+/**
+* Function: initializeWildcardCache
+* -------------------------------------------
+* Starts an empty cache of directory listings for one command line
+*
+* cache - the cache to initialize
+* arena - provides the listings; they last until the arena is reset
+*/
+void initializeWildcardCache(struct wildcardCache *cache, struct arena *arena)
+{
+	memset(cache, 0, sizeof(struct wildcardCache));
+	cache->arena = arena;
+}
+
+/**
+* Function: readListing
+* -------------------------------------------
+* Returns the sorted listing of a directory, reading it with getdents64 the first time it is asked for on
+* this command line. The names point into the getdents64 buffers, which are allocated from the arena, so
+* nothing is copied per entry. A directory that can't be opened has an empty listing
+*
+* cache - the listings read so far
+* path - the directory: "" for the current one, otherwise ending with '/'
+*/
+static struct directoryListing * readListing(struct wildcardCache *cache, const char *path)
+{
+	unsigned int hash = hashPath(path);
+	struct directoryListing **bucket = &cache->buckets[hash % WILDCARD_CACHE_BUCKETS];
+	struct directoryListing *listing;
+	struct listingEntry *entries = NULL;
+	struct dirent64 *entry;
+	char *buffer;
+	ssize_t bytesRead;
+	ssize_t offset;
+	int capacity = 0;
+	int directoryFd;
+
+	for (listing = *bucket; listing != NULL; listing = listing->next)
+		if (listing->hash == hash && strcmp(listing->path, path) == 0)
+			return listing;
+
+	listing = arenaAllocate(cache->arena, sizeof(struct directoryListing));
+	listing->path = arenaAllocate(cache->arena, strlen(path) + 1);
+	strcpy(listing->path, path);
+	listing->hash = hash;
+	listing->entries = NULL;
+	listing->numberOfEntries = 0;
+	listing->next = *bucket;
+	*bucket = listing;
+	directoryFd = open(*path ? path : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (directoryFd < 0)
+		return listing;
+
+	while (1)
+	{
+		buffer = arenaAllocate(cache->arena, WILDCARD_DIRECTORY_BUFFER_SIZE);
+		bytesRead = getdents64(directoryFd, buffer, WILDCARD_DIRECTORY_BUFFER_SIZE);
+		if (bytesRead <= 0)
+			break;
+		for (offset = 0; offset < bytesRead; offset += entry->d_reclen)
+		{
+			entry = (struct dirent64 *) (buffer + offset);
+			if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+				continue;
+			if (listing->numberOfEntries == capacity)
+			{
+				capacity = capacity ? capacity * 2 : WILDCARD_STARTING_SIZE;
+				entries = realloc(entries, capacity * sizeof(struct listingEntry));
+			}
+			entries[listing->numberOfEntries].name = entry->d_name;
+			entries[listing->numberOfEntries].type = entry->d_type;
+			listing->numberOfEntries++;
+		}
+	}
+
+	close(directoryFd);
+	qsort(entries, listing->numberOfEntries, sizeof(struct listingEntry), compareEntries);
+	listing->entries = arenaAllocate(cache->arena, listing->numberOfEntries * sizeof(struct listingEntry) + 1);
+	if (listing->numberOfEntries > 0)
+		memcpy(listing->entries, entries, listing->numberOfEntries * sizeof(struct listingEntry));
+	free(entries);
+	return listing;
+}
+
+/**
+* Function: isDirectoryEntry
+* -------------------------------------------
+* Returns 1 if an entry is a directory or a symbolic link to one; only entries whose type getdents64
+* couldn't tell, and links, cost a stat
+*
+* entry - the entry to check
+* path - the entry's path; terminated here
+* pathLength - the length of path
+*/
+static int isDirectoryEntry(struct listingEntry *entry, char *path, size_t pathLength)
+{
+	struct stat fileInfo;
+	if (entry->type == DT_DIR)
+		return 1;
+	if (entry->type != DT_LNK && entry->type != DT_UNKNOWN)
+		return 0;
+	path[pathLength] = 0;
+	return stat(path, &fileInfo) == 0 && S_ISDIR(fileInfo.st_mode);
+}
+
+/**
+* Function: firstEntryFrom
+* -------------------------------------------
+* Returns the index of the first entry of a listing whose name is not below the given text
+*
+* listing - the sorted listing
+* text - the text to compare names with
+*/
+static int firstEntryFrom(struct directoryListing *listing, const char *text)
+{
+	int low = 0;
+	int high = listing->numberOfEntries;
+	int middle;
+	while (low < high)
+	{
+		middle = (low + high) / 2;
+		if (strcmp(listing->entries[middle].name, text) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+/**
+* Function: matchBracket
+* -------------------------------------------
+* Matches a character against the [...] expression at the start of a pattern; returns where the pattern
+* continues after the expression, or NULL if the '[' starts no expression (it has no closing ']') and is
+* an ordinary character
+*
+* pattern - points at the '['
+* character - the character to match
+* matched - assigned 1 if the character is in the set and 0 otherwise
+*/
+static const char * matchBracket(const char *pattern, unsigned char character, int *matched)
+{
+	const char *position = pattern + 1;
+	int negate = 0;
+	unsigned char low;
+	unsigned char high;
+
+	*matched = 0;
+	if (*position == '!' || *position == '^')
+	{
+		negate = 1;
+		position++;
+	}
+	// A ']' right after the '[' (or the negation) is a member rather than the end
+	do
+	{
+		if (*position == 0)
+			return NULL;
+		if (*position == '\\' && position[1] != 0)
+			position++;
+		low = *position++;
+		high = low;
+		if (*position == '-' && position[1] != ']' && position[1] != 0)
+		{
+			position++;
+			if (*position == '\\' && position[1] != 0)
+				position++;
+			high = *position++;
+		}
+		if (character >= low && character <= high)
+			*matched = 1;
+	}
+	while (*position != ']');
+
+	*matched ^= negate;
+	return position + 1;
+}
+
+/**
+* Function: matchPattern
+* -------------------------------------------
+* Returns 1 if a name matches a pattern component and 0 otherwise. After a mismatch the matcher goes back
+* to the last '*' and lets it take one more character, so each name is matched in linear time for the
+* patterns used in practice
+*
+* pattern - the component, with literal wildcard characters escaped
+* name - the name to match
+*/
+int matchPattern(const char *pattern, const char *name)
+{
+	const char *starPattern = NULL;
+	const char *starName = NULL;
+	const char *next;
+	int matched;
+
+	while (*name != 0)
+	{
+		if (*pattern == '*')
+		{
+			while (*pattern == '*')
+				pattern++;
+			starPattern = pattern;
+			starName = name;
+			continue;
+		}
+		if (*pattern == '?')
+		{
+			pattern++;
+			name++;
+			continue;
+		}
+		if (*pattern == '[' && (next = matchBracket(pattern, *name, &matched)) != NULL)
+		{
+			if (matched)
+			{
+				pattern = next;
+				name++;
+				continue;
+			}
+		}
+		else
+		{
+			if (*pattern == '\\' && pattern[1] != 0)
+				pattern++;
+			if (*pattern != 0 && *pattern == *name)
+			{
+				pattern++;
+				name++;
+				continue;
+			}
+		}
+		// Mismatch: let the last '*' swallow one more character, or give up if there was none
+		if (starPattern == NULL)
+			return 0;
+		pattern = starPattern;
+		name = ++starName;
+	}
+	while (*pattern == '*')
+		pattern++;
+	return *pattern == 0;
+}
+
+/**
+* Function: hasWildcard
+* -------------------------------------------
+* Returns 1 if a pattern component has an unescaped *, ? or [ and 0 otherwise
+*
+* component - the component to check
+*/
+static int hasWildcard(const char *component)
+{
+	for (; *component != 0; component++)
+	{
+		if (*component == '\\' && component[1] != 0)
+			component++;
+		else if (*component == '*' || *component == '?' || *component == '[')
+			return 1;
+	}
+	return 0;
+}
+
+/**
+* Function: literalPrefix
+* -------------------------------------------
+* Copies the part of a component before its first wildcard, without escapes, and returns its length
+*
+* component - the component
+* prefix - receives the prefix; as large as the component
+*/
+static size_t literalPrefix(const char *component, char *prefix)
+{
+	size_t length = 0;
+	for (; *component != 0 && *component != '*' && *component != '?' && *component != '['; component++)
+	{
+		if (*component == '\\' && component[1] != 0)
+			component++;
+		prefix[length++] = *component;
+	}
+	prefix[length] = 0;
+	return length;
+}
+
+/**
+* Function: addMatch
+* -------------------------------------------
+* Appends a copy of a matched path to the list
+*
+* list - the matches so far
+* arena - provides the copy and the list
+* path - the matched path
+* length - the length of path
+*/
+static void addMatch(struct matchList *list, struct arena *arena, const char *path, size_t length)
+{
+	char **paths;
+	if (list->numberOfPaths == list->capacity)
+	{
+		list->capacity = list->capacity ? list->capacity * 2 : WILDCARD_STARTING_SIZE;
+		paths = arenaAllocate(arena, list->capacity * sizeof(char *));
+		if (list->numberOfPaths > 0)
+			memcpy(paths, list->paths, list->numberOfPaths * sizeof(char *));
+		list->paths = paths;
+	}
+	list->paths[list->numberOfPaths] = arenaAllocate(arena, length + 1);
+	memcpy(list->paths[list->numberOfPaths], path, length);
+	list->paths[list->numberOfPaths][length] = 0;
+	list->numberOfPaths++;
+}
+
+/**
+* Function: expandFrom
+* -------------------------------------------
+* Matches the rest of a pattern below the directory built so far and adds every complete match
+*
+* cache - the listings read for this command line
+* list - the matches so far
+* path - the directory built so far ("" or ending with '/'); entries are appended to it while recursing
+* pathLength - the length of path
+* pattern - the components still to match
+*/
+static void expandFrom(struct wildcardCache *cache, struct matchList *list, char *path, size_t pathLength,
+	const char *pattern)
+{
+	const char *end = strchr(pattern, '/');
+	size_t componentLength = end ? (size_t) (end - pattern) : strlen(pattern);
+	char *component;
+	char *prefix;
+	size_t prefixLength;
+	size_t nameLength;
+	struct directoryListing *listing;
+	struct listingEntry *entry;
+	int i;
+
+	// The pattern ended with '/', which only a directory gets to
+	if (*pattern == 0)
+	{
+		addMatch(list, cache->arena, path, pathLength);
+		return;
+	}
+	component = strndup(pattern, componentLength);
+	prefix = malloc(componentLength + 1);
+	prefixLength = literalPrefix(component, prefix);
+
+	if (!hasWildcard(component))
+	{
+		// A literal directory on the way is simply opened when its entries are needed; a literal last
+		// component must be in its directory's listing
+		if (pathLength + prefixLength + 2 <= PATH_MAXIMUM)
+		{
+			memcpy(path + pathLength, prefix, prefixLength);
+			if (end != NULL)
+			{
+				path[pathLength + prefixLength] = '/';
+				path[pathLength + prefixLength + 1] = 0;
+				expandFrom(cache, list, path, pathLength + prefixLength + 1, end + 1);
+			}
+			else
+			{
+				path[pathLength] = 0;
+				listing = readListing(cache, path);
+				i = firstEntryFrom(listing, prefix);
+				if (i < listing->numberOfEntries && strcmp(listing->entries[i].name, prefix) == 0)
+				{
+					memcpy(path + pathLength, prefix, prefixLength);
+					addMatch(list, cache->arena, path, pathLength + prefixLength);
+				}
+			}
+		}
+		free(component);
+		free(prefix);
+		return;
+	}
+
+	path[pathLength] = 0;
+	listing = readListing(cache, path);
+	// Only the entries starting with the literal prefix can match
+	for (i = firstEntryFrom(listing, prefix); i < listing->numberOfEntries; i++)
+	{
+		entry = &listing->entries[i];
+		if (strncmp(entry->name, prefix, prefixLength) != 0)
+			break;
+		// Hidden entries only match a pattern that starts with '.'
+		if ((entry->name[0] == '.' && component[0] != '.') || !matchPattern(component, entry->name))
+			continue;
+		nameLength = strlen(entry->name);
+		if (pathLength + nameLength + 2 > PATH_MAXIMUM)
+			continue;
+		memcpy(path + pathLength, entry->name, nameLength);
+		if (end == NULL)
+			addMatch(list, cache->arena, path, pathLength + nameLength);
+		else if (isDirectoryEntry(entry, path, pathLength + nameLength))
+		{
+			path[pathLength + nameLength] = '/';
+			path[pathLength + nameLength + 1] = 0;
+			expandFrom(cache, list, path, pathLength + nameLength + 1, end + 1);
+		}
+	}
+	free(component);
+	free(prefix);
+}
+
+/**
+* Function: expandWildcards
+* -------------------------------------------
+* Returns the number of paths matching a pattern and assigns them, sorted, to matches (in the arena). In
+* the pattern * matches any run of characters, ? any one character and [...] one of a set (with ranges,
+* and ! or ^ to negate); a backslash makes the next character literal. Wildcards never match a '/', and
+* only match a leading '.' written in the pattern. A pattern ending in '/' only matches directories
+*
+* pattern - the pattern, with literal wildcard characters escaped
+* cache - the listings read for this command line so far
+* matches - assigned the matching paths
+*/
+int expandWildcards(const char *pattern, struct wildcardCache *cache, char ***matches)
+{
+	char path[PATH_MAXIMUM];
+	struct matchList list = { NULL, 0, 0 };
+
+	path[0] = 0;
+	expandFrom(cache, &list, path, 0, pattern);
+	qsort(list.paths, list.numberOfPaths, sizeof(char *), comparePaths);
+	*matches = list.paths;
+	return list.numberOfPaths;
+}
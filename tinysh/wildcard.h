@@ -0,0 +1,75 @@
+/***********************************************************************************************************
+ * Filename: wildcard.h
+ * Date: 10/16/2026
+ * Author: Adams Rosales (rosalead@)
+ *
+ * Description: Contains declarations for filename expansion of *, ? and [...] patterns
+ **********************************************************************************************************/
+
+#ifndef WILDCARD_H_
+#define WILDCARD_H_
+
+#include "arena.h"
+
+#define WILDCARD_CACHE_BUCKETS 64
+#define WILDCARD_DIRECTORY_BUFFER_SIZE 32768
+#define WILDCARD_STARTING_SIZE 64
+
+struct listingEntry
+{
+	const char *name;
+	unsigned char type;			// the d_type reported by getdents64
+};
+
+// One directory as read while expanding a line, entries sorted by name
+struct directoryListing
+{
+	struct directoryListing *next;	// next listing in the same bucket
+	char *path;						// as written in the pattern: "" for the current directory
+	unsigned int hash;
+	struct listingEntry *entries;
+	int numberOfEntries;
+};
+
+// Every directory read while expanding one command line, so each is read once however many patterns use it
+struct wildcardCache
+{
+	struct arena *arena;
+	struct directoryListing *buckets[WILDCARD_CACHE_BUCKETS];
+};
+
+/**
+* Function: initializeWildcardCache
+* -------------------------------------------
+* Starts an empty cache of directory listings for one command line
+*
+* cache - the cache to initialize
+* arena - provides the listings; they last until the arena is reset
+*/
+void initializeWildcardCache(struct wildcardCache *cache, struct arena *arena);
+/**
+* Function: expandWildcards
+* -------------------------------------------
+* Returns the number of paths matching a pattern and assigns them, sorted, to matches (in the arena). In
+* the pattern * matches any run of characters, ? any one character and [...] one of a set (with ranges,
+* and ! or ^ to negate); a backslash makes the next character literal. Wildcards never match a '/', and
+* only match a leading '.' written in the pattern. A pattern ending in '/' only matches directories
+*
+* pattern - the pattern, with literal wildcard characters escaped
+* cache - the listings read for this command line so far
+* matches - assigned the matching paths
+*/
+int expandWildcards(const char *pattern, struct wildcardCache *cache, char ***matches);
+/**
+* Function: matchPattern
+* -------------------------------------------
+* Returns 1 if a name matches a pattern component and 0 otherwise. After a mismatch the matcher goes back
+* to the last '*' and lets it take one more character, so each name is matched in linear time for the
+* patterns used in practice
+*
+* pattern - the component, with literal wildcard characters escaped
+* name - the name to match
+*/
+int matchPattern(const char *pattern, const char *name);
+
+#endif /* WILDCARD_H_ */